@@ -143,6 +143,15 @@ BUILD_CXX_FLAGS = $(BASE_FLAGS) $(CXXFLAGS)
 LINK_FLAGS      = $(LINK_OPTS) $(LDFLAGS)
 endif
 
+# --------------------------------------------------------------
+# Realtime audit build, see source/interposer/interposer-rtaudit.cpp
+
+ifeq ($(RTAUDIT),true)
+ifeq ($(LINUX),true)
+BASE_FLAGS += -DCARLA_RT_AUDIT
+endif
+endif
+
 # --------------------------------------------------------------
 # Strict test build
 
@@ -948,7 +948,14 @@ typedef enum {
     /*!
      * The engine has crashed or malfunctioned and will no longer work.
      */
-    ENGINE_CALLBACK_QUIT = 39
+    ENGINE_CALLBACK_QUIT = 39,
+
+    /*!
+     * A project save started with CarlaEngine::saveProjectAsync() or carla_save_project_async() has finished.
+     * @a value1 1 if successful, 0 otherwise
+     * @a valueStr The project filename if successful, the error otherwise
+     */
+    ENGINE_CALLBACK_PROJECT_SAVED = 40
 
 } EngineCallbackOpcode;
 
@@ -1072,7 +1079,78 @@ typedef enum {
     /*!
      * Set frontend winId, used to define as parent window for plugin UIs.
      */
-    ENGINE_OPTION_FRONTEND_WIN_ID = 17
+    ENGINE_OPTION_FRONTEND_WIN_ID = 17,
+
+    /*!
+     * Minimum number of frames a plugin is run for when splitting a block for sample-accurate events.
+     * Control events closer than this to the previous split are applied at the start of the current sub-block.
+     * Default is 16, use 0 or 1 to split at every event.
+     */
+    ENGINE_OPTION_MIN_SUB_BLOCK_SIZE = 18,
+
+    /*!
+     * Host all bridged plugins of the same bridge binary in a single process.
+     * Saves one process per plugin, but a crash will take down all plugins in that process.
+     * In rack mode, consecutive plugins of the same process are run together with a single wakeup per block.
+     * Default is no.
+     */
+    ENGINE_OPTION_SHARE_PLUGIN_BRIDGES = 19,
+
+    /*!
+     * Queue frequent engine callbacks and deliver them in batches during engine idle, at most once every this many milliseconds.
+     * Parameter, program and MIDI program changes of the same plugin are coalesced, keeping the last value.
+     * Up to 4096 callbacks can be queued between batches, if more arrive they are dropped and the next batch
+     * ends with ENGINE_CALLBACK_RELOAD_PARAMETERS and ENGINE_CALLBACK_RELOAD_PROGRAMS for every plugin.
+     * Default is 0, which calls the engine callback right away from the thread that triggered it.
+     * @see EngineBatchCallbackFunc
+     */
+    ENGINE_OPTION_CALLBACK_BATCH_INTERVAL = 20,
+
+    /*!
+     * Publish plugin meters in a shared memory region that other processes can map read-only.
+     * Default is no.
+     * @see EngineTelemetryHeader and CarlaEngine::getTelemetryFilename()
+     */
+    ENGINE_OPTION_TELEMETRY = 21,
+
+    /*!
+     * Number of points kept per channel for the downsampled scope of each plugin in the telemetry region.
+     * Default is 0, which only publishes meters.
+     * @see ENGINE_OPTION_TELEMETRY
+     */
+    ENGINE_OPTION_TELEMETRY_SCOPE_SIZE = 22,
+
+    /*!
+     * Skip processing plugins while they are silent.
+     * A plugin is skipped, and its outputs zero-filled, when it gets no events, its audio inputs are silent
+     * for longer than its tail length and its last processed block was silent too.
+     * Plugins without audio or MIDI inputs and plugins with MIDI outputs are always processed.
+     * Default is no.
+     * @see ENGINE_OPTION_SILENT_PLUGIN_TAIL
+     */
+    ENGINE_OPTION_SKIP_SILENT_PLUGINS = 23,
+
+    /*!
+     * Tail length in milliseconds used for plugins that don't report one.
+     * Default is 5000.
+     * @see ENGINE_OPTION_SKIP_SILENT_PLUGINS
+     */
+    ENGINE_OPTION_SILENT_PLUGIN_TAIL = 24,
+
+    /*!
+     * Flush denormals to zero while processing.
+     * Sets FTZ and DAZ on x86, or FZ on ARM, for each engine process cycle and restores the previous state after it.
+     * Default is yes.
+     */
+    ENGINE_OPTION_FLUSH_DENORMALS = 25,
+
+    /*!
+     * Add a tiny DC offset, about -360 dBFS, to the audio inputs of plugins in rack and patchbay modes.
+     * Keeps feedback paths out of denormals in plugins that flushing does not reach,
+     * like those using x87 math or changing the floating point state themselves.
+     * Default is no.
+     */
+    ENGINE_OPTION_ANTI_DENORMAL_OFFSET = 26
 
 } EngineOption;
 
@@ -1226,6 +1304,37 @@ enum PatchbayIcon {
  */
 typedef void (*EngineCallbackFunc)(void* ptr, EngineCallbackOpcode action, uint pluginId, int value1, int value2, float value3, const char* valueStr);
 
+/*!
+ * Engine callback event, as delivered in batches.
+ * Same arguments as EngineCallbackFunc, queued callbacks never have a string value.
+ */
+typedef struct {
+    /*!
+     * Callback opcode.
+     */
+    EngineCallbackOpcode action;
+
+    /*!
+     * Plugin Id.
+     */
+    uint pluginId;
+
+    /*!
+     * Callback values, meaning depends on the opcode.
+     */
+    int value1;
+    int value2;
+    float value3;
+
+} EngineCallbackEvent;
+
+/*!
+ * Engine batch callback function, receives queued engine callbacks in order.
+ * Only used when ENGINE_OPTION_CALLBACK_BATCH_INTERVAL is set, otherwise they go through the regular engine callback.
+ * @see EngineCallbackEvent, CarlaEngine::setBatchCallback() and carla_set_engine_batch_callback()
+ */
+typedef void (*EngineBatchCallbackFunc)(void* ptr, const EngineCallbackEvent* events, uint count);
+
 /*!
  * File callback function.
  * @see FileCallbackOpcode
@@ -1469,6 +1578,108 @@ typedef struct {
 
 } EngineDriverDeviceInfo;
 
+/*!
+ * Magic number at the start of an engine telemetry region, "CTLM".
+ */
+static const uint32_t ENGINE_TELEMETRY_MAGIC = 0x4d4c5443;
+
+/*!
+ * Layout version of engine telemetry regions.
+ */
+static const uint32_t ENGINE_TELEMETRY_VERSION = 1;
+
+/*!
+ * Engine telemetry region header.
+ * The region contains this header, followed by one EngineTelemetryPlugin per plugin slot,
+ * followed by the scope rings as float[maxPluginCount][2][scopeSize].
+ *
+ * The engine updates it once per audio block, using @a sequence as a seqlock.
+ * Readers should wait for an even sequence, copy what they need and retry if the sequence changed meanwhile.
+ * Scope points are written as they are produced, only those before the published scope position are complete.
+ * @see ENGINE_OPTION_TELEMETRY
+ */
+typedef struct {
+    /*!
+     * Always ENGINE_TELEMETRY_MAGIC.
+     */
+    uint32_t magic;
+
+    /*!
+     * Always ENGINE_TELEMETRY_VERSION.
+     */
+    uint32_t version;
+
+    /*!
+     * Update counter, odd while the engine is writing.
+     */
+    uint32_t sequence;
+
+    /*!
+     * Number of plugin slots, fixed for the lifetime of the region.
+     */
+    uint32_t maxPluginCount;
+
+    /*!
+     * Number of plugins currently loaded.
+     */
+    uint32_t pluginCount;
+
+    /*!
+     * Number of points per scope ring, 0 if there are no scopes.
+     */
+    uint32_t scopeSize;
+
+    /*!
+     * Number of audio frames represented by each scope point.
+     */
+    uint32_t scopeDecimation;
+
+    /*!
+     * Current buffer size.
+     */
+    uint32_t bufferSize;
+
+    /*!
+     * Current sample rate.
+     */
+    double sampleRate;
+
+    /*!
+     * Total number of frames processed by the engine.
+     */
+    uint64_t processedFrames;
+
+} EngineTelemetryHeader;
+
+/*!
+ * Engine telemetry of a single plugin slot.
+ * @see EngineTelemetryHeader
+ */
+typedef struct {
+    /*!
+     * Non-zero if there's a plugin in this slot.
+     */
+    uint32_t present;
+
+    /*!
+     * Total number of scope points written, the next point goes to index scopePosition % scopeSize.
+     * Goes back to 0 when the plugin in this slot changes.
+     */
+    uint32_t scopePosition;
+
+    /*!
+     * Peak values of the last block, first 2 audio inputs and outputs.
+     */
+    float insPeak[2];
+    float outsPeak[2];
+
+    /*!
+     * RMS values of the last block, first 2 audio outputs.
+     */
+    float outsRms[2];
+
+} EngineTelemetryPlugin;
+
 /** @} */
 
 #ifdef __cplusplus
@@ -25,12 +25,15 @@ struct CarlaOscData;
 #endif
 
 namespace juce {
-class MemoryOutputStream;
+class OutputStream;
 class XmlDocument;
 }
 
 CARLA_BACKEND_START_NAMESPACE
 
+class CarlaEngineSaveJob;
+class CarlaStateChunkStore;
+
 // -----------------------------------------------------------------------
 
 /*!
@@ -73,7 +76,12 @@ enum EngineType {
     /*!
      * Bridge engine type, used in BridgePlugin class.
      */
-    kEngineTypeBridge = 5
+    kEngineTypeBridge = 5,
+
+    /*!
+     * Offline engine type, renders from and to files as fast as possible.
+     */
+    kEngineTypeOffline = 6
 };
 
 /*!
@@ -228,11 +236,20 @@ struct CARLA_API EngineOptions {
 
     bool forceStereo;
     bool preferPluginBridges;
+    bool sharePluginBridges;
     bool preferUiBridges;
     bool uisAlwaysOnTop;
+    bool telemetry;
+    bool skipSilentPlugins;
+    bool flushDenormals;
+    bool antiDenormalOffset;
 
     uint maxParameters;
     uint uiBridgesTimeout;
+    uint minSubBlockSize;
+    uint callbackBatchInterval;
+    uint telemetryScopeSize;
+    uint silentPluginTail;
     uint audioNumPeriods;
     uint audioBufferSize;
     uint audioSampleRate;
@@ -829,6 +846,31 @@ public:
      * Switch plugins with id @a idA and @a idB.
      */
     bool switchPlugins(const uint idA, const uint idB) noexcept;
+
+    /*!
+     * Load the plugins of a project file as standby plugins, replacing any previous standby ones.
+     * Standby plugins are fully instantiated, restored and activated, but not processed nor reported to the host,
+     * while the current plugins keep running.
+     * @note Only plugins are loaded from the project, and only rack mode is supported.
+     */
+    bool loadStandbyProject(const char* const filename);
+
+    /*!
+     * Switch all current plugins with the standby ones, within a single audio period.
+     * The previous plugins become the standby ones, allowing to switch back or clear them later.
+     * @see ENGINE_CALLBACK_PLUGIN_REMOVED and ENGINE_CALLBACK_PLUGIN_ADDED
+     */
+    bool switchStandbyPlugins();
+
+    /*!
+     * Remove all standby plugins.
+     */
+    void clearStandbyPlugins();
+
+    /*!
+     * Get the current number of standby plugins.
+     */
+    uint getStandbyPluginCount() const noexcept;
 #endif
 
     /*!
@@ -868,6 +910,15 @@ public:
      */
     bool saveProject(const char* const filename);
 
+#ifndef BUILD_BRIDGE
+    /*!
+     * Save current project to a file in the background.
+     * Plugin states are collected before this function returns, encoding and writing them is done in other threads.
+     * When done ENGINE_CALLBACK_PROJECT_SAVED is sent from idle(), a previous save still in progress is finished first.
+     */
+    bool saveProjectAsync(const char* const filename);
+#endif
+
     // -------------------------------------------------------------------
     // Information (base)
 
@@ -887,6 +938,14 @@ public:
      */
     double getSampleRate() const noexcept;
 
+#ifndef BUILD_BRIDGE
+    /*!
+     * Get the total latency of the internal graph, in frames.
+     * Only valid in rack and patchbay modes, plugins are delay compensated against each other within it.
+     */
+    uint32_t getTotalLatency() const noexcept;
+#endif
+
     /*!
      * Get the current engine name.
      */
@@ -907,6 +966,12 @@ public:
      */
     const EngineTimeInfo& getTimeInfo() const noexcept;
 
+    /*!
+     * Get the number of process cycles run so far.
+     * Increments once per audio block, even when the transport is stopped.
+     */
+    uint32_t getProcessCycle() const noexcept;
+
     // -------------------------------------------------------------------
     // Information (peaks)
 
@@ -934,6 +999,14 @@ public:
      */
     void setCallback(const EngineCallbackFunc func, void* const ptr) noexcept;
 
+#ifndef BUILD_BRIDGE
+    /*!
+     * Set the engine batch callback to @a func.
+     * @see ENGINE_OPTION_CALLBACK_BATCH_INTERVAL
+     */
+    void setBatchCallback(const EngineBatchCallbackFunc func, void* const ptr) noexcept;
+#endif
+
     // -------------------------------------------------------------------
     // Callback
 
@@ -986,6 +1059,27 @@ public:
      */
     virtual void transportRelocate(const uint64_t frame) noexcept;
 
+#ifndef BUILD_BRIDGE
+    // -------------------------------------------------------------------
+    // Offline rendering
+
+    /*!
+     * Render the current engine graph into @a outputFile, as fast as possible.
+     * The output file format (WAV, FLAC, etc) is taken from its extension.
+     * @a inputFile and @a midiFile are optional audio and MIDI files fed into the engine inputs.
+     * If @a seconds is 0 the length of the input files is used.
+     * Only the offline engine supports this, others return false.
+     */
+    virtual bool renderOffline(const char* const outputFile, const char* const inputFile, const char* const midiFile, const double seconds);
+
+    /*!
+     * Get the time spent processing each block of the last offline render, in microseconds.
+     * Returns the number of blocks, @a times stays valid until the next render.
+     * Only the offline engine supports this, others return 0.
+     */
+    virtual uint32_t getOfflineRenderBlockTimes(const float*& times) const noexcept;
+#endif
+
     // -------------------------------------------------------------------
     // Error handling
 
@@ -1008,6 +1102,14 @@ public:
      */
     void setAboutToClose() noexcept;
 
+    /*!
+     * Ask the engine thread to idle plugin @a id as soon as possible.
+     * Plugins that have nothing to do are otherwise only idled at their own interval.
+     * @see CarlaPlugin::getIdleInterval()
+     * @note RT call
+     */
+    void requestPluginIdle(const uint id) noexcept;
+
     // -------------------------------------------------------------------
     // Options
 
@@ -1041,6 +1143,17 @@ public:
      */
     const char* getOscServerPathUDP() const noexcept;
 
+#ifndef BUILD_BRIDGE
+    // -------------------------------------------------------------------
+    // Telemetry
+
+    /*!
+     * Get the shared memory filename of the telemetry region, or an empty string if there's none.
+     * @see ENGINE_OPTION_TELEMETRY
+     */
+    const char* getTelemetryFilename() const noexcept;
+#endif
+
     // -------------------------------------------------------------------
     // Helper functions
 
@@ -1070,6 +1183,7 @@ protected:
     /*!
      * Some internal classes read directly from pData or call protected functions.
      */
+    friend class CarlaEngineThread;
     friend class CarlaPluginInstance;
     friend class EngineInternalGraph;
     friend class PendingRtEventsRunner;
@@ -1098,6 +1212,22 @@ protected:
      */
     void offlineModeChanged(const bool isOffline);
 
+#ifndef BUILD_BRIDGE
+    /*!
+     * Update the internal graph delay compensation from the plugins' current latencies.
+     * Called regularly from the main thread, calls latencyChanged() if the total changes.
+     * The engine thread only detects latency changes, the graph is never touched outside the main thread.
+     * Only audio is delayed, MIDI passed around latent plugins is not compensated.
+     */
+    void updateLatency();
+
+    /*!
+     * Report the total latency of the internal graph to the host or audio driver.
+     * The default implementation does nothing.
+     */
+    virtual void latencyChanged(const uint32_t newLatency);
+#endif
+
     /*!
      * Set a plugin (stereo) peak values.
      * @note RT call
@@ -1107,12 +1237,30 @@ protected:
     /*!
      * Common save project function for main engine and plugin.
      */
-    void saveProjectInternal(juce::MemoryOutputStream& outStrm) const;
+    void saveProjectInternal(juce::OutputStream& outStrm) const;
+
+    /*!
+     * Collect the current project state into a new save job, which the caller then writes and deletes.
+     * Plugin states are collected in the calling thread and serialized by other threads as soon as each one is ready.
+     * If @a binary is true, plugin chunks are compressed and kept out of the XML (binary projects).
+     */
+    CarlaEngineSaveJob* startProjectSave(const bool binary) const;
+
+#ifndef BUILD_BRIDGE
+    /*!
+     * Report and delete a finished background project save.
+     * If @a wait is true a save still being written is waited for, otherwise it is left running.
+     */
+    void finishProjectSave(const bool wait);
+#endif
 
     /*!
      * Common load project function for main engine and plugin.
+     * If @a reusePlugins is true, already loaded plugins that match the project are kept and only get their changed values set,
+     * plugins that do not match are removed and missing ones are added.
+     * @a chunkStore is used to resolve plugin chunks of binary projects.
      */
-    bool loadProjectInternal(juce::XmlDocument& xmlDoc);
+    bool loadProjectInternal(juce::XmlDocument& xmlDoc, const bool reusePlugins = false, CarlaStateChunkStore* const chunkStore = nullptr);
 
 #ifndef BUILD_BRIDGE
     // -------------------------------------------------------------------
@@ -1124,6 +1272,12 @@ protected:
      */
     virtual const char* const* getPatchbayConnections(const bool external) const;
     virtual void restorePatchbayConnection(const bool external, const char* const sourcePort, const char* const targetPort, const bool sendCallback);
+
+    /*!
+     * Remove an internal patchbay connection, using full port names.
+     * Used when restoring a project on top of already loaded plugins.
+     */
+    void removePatchbayConnection(const char* const sourcePort, const char* const targetPort);
 #endif
 
     // -------------------------------------------------------------------
@@ -1153,6 +1307,11 @@ public:
     // JACK
     static CarlaEngine*       newJack();
 
+#ifndef BUILD_BRIDGE
+    // Offline
+    static CarlaEngine*       newOffline();
+#endif
+
 #ifdef BUILD_BRIDGE
     // Bridge
     static CarlaEngine*       newBridge(const char* const audioPoolBaseName, const char* const rtClientBaseName, const char* const nonRtClientBaseName, const char* const nonRtServerBaseName);
@@ -31,12 +31,16 @@ using CarlaBackend::EngineProcessMode;
 using CarlaBackend::EngineTransportMode;
 using CarlaBackend::FileCallbackOpcode;
 using CarlaBackend::EngineCallbackFunc;
+using CarlaBackend::EngineBatchCallbackFunc;
+using CarlaBackend::EngineCallbackEvent;
 using CarlaBackend::FileCallbackFunc;
 using CarlaBackend::ParameterData;
 using CarlaBackend::ParameterRanges;
 using CarlaBackend::MidiProgramData;
 using CarlaBackend::CustomData;
 using CarlaBackend::EngineDriverDeviceInfo;
+using CarlaBackend::EngineTelemetryHeader;
+using CarlaBackend::EngineTelemetryPlugin;
 using CarlaBackend::CarlaEngine;
 using CarlaBackend::CarlaEngineClient;
 using CarlaBackend::CarlaPlugin;
@@ -268,6 +272,82 @@ typedef struct _CarlaTransportInfo {
 
 } CarlaTransportInfo;
 
+/*!
+ * Plugin is enabled, meaning it's fully loaded and can be used.
+ * @see CarlaRuntimeSnapshot::states
+ */
+static const uint PLUGIN_RUNTIME_STATE_ENABLED = 0x1;
+
+/*!
+ * Plugin is active and processing.
+ * Never set in plugin bridges, the active state is only known by the host.
+ * @see CarlaRuntimeSnapshot::states
+ */
+static const uint PLUGIN_RUNTIME_STATE_ACTIVE = 0x2;
+
+/*!
+ * Runtime values of all plugins, filled in a single call.
+ * All arrays are owned by the caller, any of them can be NULL if not needed.
+ * @see carla_get_runtime_snapshot()
+ */
+typedef struct _CarlaRuntimeSnapshot {
+    /*!
+     * Sequence number, increased every time plugin states or parameter values change.
+     * If it matches the one from the previous call only peaks need to be processed.
+     */
+    uint32_t sequence;
+
+    /*!
+     * Size of the per-plugin arrays, set by the caller.
+     */
+    uint32_t maxPluginCount;
+
+    /*!
+     * Number of plugins written in the per-plugin arrays.
+     */
+    uint32_t pluginCount;
+
+    /*!
+     * Plugin peaks, 4 values per plugin: input left/mono, input right, output left/mono and output right.
+     * Must have room for maxPluginCount*4 values.
+     */
+    float* peaks;
+
+    /*!
+     * Plugin run states, one per plugin.
+     * @see PLUGIN_RUNTIME_STATE_ENABLED, PLUGIN_RUNTIME_STATE_ACTIVE
+     */
+    uint* states;
+
+    /*!
+     * Size of the parameter change arrays, set by the caller.
+     * Use 0 to skip checking parameter values.
+     */
+    uint32_t maxParameterChanges;
+
+    /*!
+     * Number of parameter changes written.
+     * Changes that don't fit are reported on the next call.
+     */
+    uint32_t parameterChangeCount;
+
+    /*!
+     * Plugin of each changed parameter.
+     */
+    uint* parameterPluginIds;
+
+    /*!
+     * Index of each changed parameter.
+     */
+    uint32_t* parameterIds;
+
+    /*!
+     * New value of each changed parameter.
+     */
+    float* parameterValues;
+
+} CarlaRuntimeSnapshot;
+
 /* ------------------------------------------------------------------------------------------------------------
  * Carla Host API (C functions) */
 
@@ -317,6 +397,17 @@ CARLA_EXPORT bool carla_engine_init(const char* driverName, const char* clientNa
  */
 CARLA_EXPORT bool carla_engine_init_bridge(const char audioBaseName[6+1], const char rtClientBaseName[6+1], const char nonRtClientBaseName[6+1],
                                            const char nonRtServerBaseName[6+1], const char* clientName);
+
+# ifdef __cplusplus
+/*!
+ * Create and initialize an extra engine in bridged mode, separate from the global one.
+ * Used by shared bridge processes, which host one engine per plugin.
+ * The caller owns the returned engine, NULL is returned on failure.
+ * @note C++ only
+ */
+CARLA_EXPORT CarlaEngine* carla_engine_new_bridge(const char audioBaseName[6+1], const char rtClientBaseName[6+1], const char nonRtClientBaseName[6+1],
+                                                  const char nonRtServerBaseName[6+1], const char* clientName);
+# endif
 #endif
 
 /*!
@@ -351,6 +442,14 @@ CARLA_EXPORT void carla_set_engine_about_to_close();
 CARLA_EXPORT void carla_set_engine_callback(EngineCallbackFunc func, void* ptr);
 
 #ifndef BUILD_BRIDGE
+/*!
+ * Set the engine batch callback function, used for queued callbacks.
+ * @param func Callback function
+ * @param ptr  Callback pointer
+ * @see ENGINE_OPTION_CALLBACK_BATCH_INTERVAL
+ */
+CARLA_EXPORT void carla_set_engine_batch_callback(EngineBatchCallbackFunc func, void* ptr);
+
 /*!
  * Set an engine option.
  * @param option   Option
@@ -386,6 +485,24 @@ CARLA_EXPORT bool carla_load_project(const char* filename);
  */
 CARLA_EXPORT bool carla_save_project(const char* filename);
 
+/*!
+ * Save current project to a file in the background.
+ * Plugin states are collected before this function returns, encoding and writing them is done in other threads.
+ * ENGINE_CALLBACK_PROJECT_SAVED is sent when done.
+ */
+CARLA_EXPORT bool carla_save_project_async(const char* filename);
+
+/*!
+ * Convert an XML project file to the binary project format, with plugin chunks stored out of line.
+ * @param compress Compress chunks that get smaller with zlib
+ */
+CARLA_EXPORT bool carla_convert_project_to_binary(const char* xmlFilename, const char* binaryFilename, bool compress);
+
+/*!
+ * Convert a binary project file back to the XML project format.
+ */
+CARLA_EXPORT bool carla_convert_project_to_xml(const char* binaryFilename, const char* xmlFilename);
+
 #ifndef BUILD_BRIDGE
 /*!
  * Connect two patchbay ports.
@@ -426,6 +543,16 @@ CARLA_EXPORT void carla_transport_pause();
  */
 CARLA_EXPORT void carla_transport_relocate(uint64_t frame);
 
+/*!
+ * Render the current project into an audio file, as fast as possible.
+ * The engine must have been started with the "Offline" driver.
+ * @param outputFile Output file, its extension selects the format (wav, flac, etc)
+ * @param inputFile  Audio file fed into the engine audio inputs, may be NULL
+ * @param midiFile   Standard MIDI file fed into the engine MIDI input, may be NULL
+ * @param seconds    Length to render, use 0 to render the length of the input files
+ */
+CARLA_EXPORT bool carla_engine_render_offline(const char* outputFile, const char* inputFile, const char* midiFile, double seconds);
+
 /*!
  * Get the current transport frame.
  */
@@ -504,6 +631,31 @@ CARLA_EXPORT bool carla_replace_plugin(uint pluginId);
  * @param pluginIdB Plugin B
  */
 CARLA_EXPORT bool carla_switch_plugins(uint pluginIdA, uint pluginIdB);
+
+/*!
+ * Load the plugins of a project file as standby plugins, replacing any previous standby ones.
+ * Standby plugins are fully loaded and activated, but not processed nor reported until switched in.
+ * Meanwhile the current plugins keep running.
+ * @param filename Filename of the project
+ * @note Only supported in rack mode.
+ */
+CARLA_EXPORT bool carla_load_standby_project(const char* filename);
+
+/*!
+ * Switch all current plugins with the standby ones, within a single audio period.
+ * The previous plugins become the standby ones.
+ */
+CARLA_EXPORT bool carla_switch_standby_plugins();
+
+/*!
+ * Remove all standby plugins.
+ */
+CARLA_EXPORT void carla_clear_standby_plugins();
+
+/*!
+ * Get the current number of standby plugins.
+ */
+CARLA_EXPORT uint32_t carla_get_standby_plugin_count();
 #endif
 
 /*!
@@ -708,6 +860,14 @@ CARLA_EXPORT float carla_get_input_peak_value(uint pluginId, bool isLeft);
  */
 CARLA_EXPORT float carla_get_output_peak_value(uint pluginId, bool isLeft);
 
+/*!
+ * Get the peaks and run states of all plugins, plus the parameter values that changed since the last call.
+ * Parameter values of newly added plugins are not reported, only their later changes.
+ * This is meant to replace many calls to the functions above when updating a UI.
+ * @param snapshot Caller-provided arrays and sizes, filled with the current values
+ */
+CARLA_EXPORT bool carla_get_runtime_snapshot(CarlaRuntimeSnapshot* snapshot);
+
 /*!
  * Enable or disable a plugin.
  * @param pluginId Plugin
@@ -889,6 +1049,13 @@ CARLA_EXPORT const char* carla_get_host_osc_url_tcp();
  */
 CARLA_EXPORT const char* carla_get_host_osc_url_udp();
 
+/*!
+ * Get the shared memory filename of the engine telemetry region.
+ * Returns an empty string if the engine is not running, ENGINE_OPTION_TELEMETRY is not set or inside a plugin bridge.
+ * @see EngineTelemetryHeader
+ */
+CARLA_EXPORT const char* carla_get_telemetry_filename();
+
 /*!
  * Get the absolute filename of this carla library.
  */
@@ -156,6 +156,14 @@ public:
      */
     virtual uint32_t getLatencyInFrames() const noexcept;
 
+    /*!
+     * Get the plugin's tail length, in sample frames.
+     * This is how long the plugin keeps producing sound after its input becomes silent.
+     * Returns 0 if unknown.
+     * @note RT call
+     */
+    virtual uint32_t getTailLengthInFrames() const noexcept;
+
     // -------------------------------------------------------------------
     // Information (count)
 
@@ -395,12 +403,20 @@ public:
      */
     const CarlaStateSave& getStateSave(const bool callPrepareForSave = true);
 
+    /*!
+     * Fill @a stateSave with the plugin's current state, like getStateSave() but without calling prepareForSave().
+     * If @a copyChunkData is true the chunk is copied as raw data, leaving its encoding for when the state is written.
+     * The engine uses this to serialize plugin states in other threads.
+     */
+    void fillStateSave(CarlaStateSave& stateSave, const bool copyChunkData);
+
     /*!
      * Get the plugin's save state.
+     * If @a onlyChanges is true, values already matching the current plugin state are skipped.
      *
      * @see getStateSave()
      */
-    void loadStateSave(const CarlaStateSave& stateSave);
+    void loadStateSave(const CarlaStateSave& stateSave, const bool onlyChanges = false);
 
     /*!
      * Save the current plugin state to @a filename.
@@ -665,11 +681,18 @@ public:
     // Misc
 
     /*!
-     * Idle function (non-UI), called at regular intervals.
+     * Idle function (non-UI), called at the plugin idle interval or when requested.
      * @note: This function is NOT called from the main thread.
+     * @see getIdleInterval()
      */
     virtual void idle();
 
+    /*!
+     * Get how often the engine thread needs to call idle() and uiIdle(), in milliseconds.
+     * Returns 0 if the plugin only needs idle when it asks for it, see CarlaEngine::requestPluginIdle().
+     */
+    virtual uint getIdleInterval() const noexcept;
+
     /*!
      * Try to lock the plugin's master mutex.
      * @param forcedOffline When true, always locks and returns true
@@ -681,6 +704,12 @@ public:
      */
     void unlock() noexcept;
 
+    /*!
+     * Check if the plugin has work queued for its next process call, like external MIDI notes or a reset.
+     * @note RT call
+     */
+    bool hasPendingProcessWork() const noexcept;
+
     // -------------------------------------------------------------------
     // Plugin buffers
 
@@ -740,7 +769,7 @@ public:
     virtual void showCustomUI(const bool yesNo);
 
     /*!
-     * UI idle function, called at regular intervals.
+     * UI idle function, called at regular intervals or when requested.
      * This function is only called from the main thread if PLUGIN_NEEDS_UI_MAIN_THREAD is set.
      * @note This function may sometimes be called even if the UI is not visible yet.
      */
@@ -903,6 +932,13 @@ public:
     static CarlaPlugin* newFileGIG(const Initializer& init, const bool use16Outs);
     static CarlaPlugin* newFileSF2(const Initializer& init, const bool use16Outs);
     static CarlaPlugin* newFileSFZ(const Initializer& init);
+
+    // open a plugin binary ahead of time, used while loading projects
+    static bool prewarmLibrary(const char* const filename) noexcept;
+    static void releasePrewarmedLibraries() noexcept;
+
+    // get the binary of an LV2 plugin without loading it, nullptr if not found, free with delete[]
+    static const char* getLV2PluginBinary(CarlaEngine* const engine, const char* const uri);
 #endif
 
     // -------------------------------------------------------------------
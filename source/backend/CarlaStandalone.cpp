@@ -26,6 +26,8 @@
 
 #include "CarlaBackendUtils.hpp"
 #include "CarlaBase64Utils.hpp"
+#include "CarlaMathUtils.hpp"
+#include "CarlaStateUtils.hpp"
 
 #include "juce_audio_formats.h"
 
@@ -40,6 +42,91 @@ namespace juce {
 namespace CB = CarlaBackend;
 using CB::EngineOptions;
 
+// -------------------------------------------------------------------------------------------------------------------
+// Values last reported by carla_get_runtime_snapshot()
+
+struct CarlaRuntimeSnapshotCache {
+    struct PluginData {
+        const CarlaPlugin* plugin;
+        uint     state;
+        uint32_t parameterCount;
+        float*   parameterValues;
+    };
+
+    PluginData* plugins;
+    uint        count;
+    uint32_t    sequence;
+
+    CarlaRuntimeSnapshotCache() noexcept
+        : plugins(nullptr),
+          count(0),
+          sequence(0) {}
+
+    ~CarlaRuntimeSnapshotCache() noexcept
+    {
+        clear();
+    }
+
+    void clear() noexcept
+    {
+        if (plugins == nullptr)
+            return;
+
+        for (uint i=0; i < count; ++i)
+            resetPlugin(plugins[i], nullptr);
+
+        delete[] plugins;
+        plugins = nullptr;
+        count   = 0;
+    }
+
+    bool resize(const uint newCount) noexcept
+    {
+        if (count >= newCount)
+            return true;
+
+        clear();
+
+        try {
+            plugins = new PluginData[newCount];
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaRuntimeSnapshotCache::resize", false);
+
+        carla_zeroStructs(plugins, newCount);
+        count = newCount;
+        return true;
+    }
+
+    // start tracking a new plugin (or none), its current parameter values are not reported
+    static void resetPlugin(PluginData& data, const CarlaPlugin* const plugin) noexcept
+    {
+        delete[] data.parameterValues;
+
+        data.plugin          = plugin;
+        data.state           = 0;
+        data.parameterCount  = 0;
+        data.parameterValues = nullptr;
+
+        if (plugin == nullptr)
+            return;
+
+        const uint32_t parameterCount(plugin->getParameterCount());
+
+        if (parameterCount == 0)
+            return;
+
+        try {
+            data.parameterValues = new float[parameterCount];
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaRuntimeSnapshotCache::resetPlugin",);
+
+        data.parameterCount = parameterCount;
+
+        for (uint32_t i=0; i < parameterCount; ++i)
+            data.parameterValues[i] = plugin->getParameterValue(i);
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(CarlaRuntimeSnapshotCache)
+};
+
 // -------------------------------------------------------------------------------------------------------------------
 // Single, standalone engine
 
@@ -48,7 +135,9 @@ struct CarlaBackendStandalone {
     EngineCallbackFunc engineCallback;
     void*              engineCallbackPtr;
 #ifndef BUILD_BRIDGE
-    EngineOptions      engineOptions;
+    EngineBatchCallbackFunc engineBatchCallback;
+    void*                   engineBatchCallbackPtr;
+    EngineOptions           engineOptions;
 #endif
 
     FileCallbackFunc fileCallback;
@@ -56,16 +145,21 @@ struct CarlaBackendStandalone {
 
     CarlaString lastError;
 
+    CarlaRuntimeSnapshotCache runtimeSnapshot;
+
     CarlaBackendStandalone() noexcept
         : engine(nullptr),
           engineCallback(nullptr),
           engineCallbackPtr(nullptr),
 #ifndef BUILD_BRIDGE
+          engineBatchCallback(nullptr),
+          engineBatchCallbackPtr(nullptr),
           engineOptions(),
 #endif
           fileCallback(nullptr),
           fileCallbackPtr(nullptr),
-          lastError() {}
+          lastError(),
+          runtimeSnapshot() {}
 
     ~CarlaBackendStandalone() noexcept
     {
@@ -138,10 +232,13 @@ CarlaEngine* carla_get_engine()
 
 // -------------------------------------------------------------------------------------------------------------------
 
-static void carla_engine_init_common()
+static void carla_engine_init_common(CarlaEngine* const engine)
 {
-    gStandalone.engine->setCallback(gStandalone.engineCallback, gStandalone.engineCallbackPtr);
-    gStandalone.engine->setFileCallback(gStandalone.fileCallback, gStandalone.fileCallbackPtr);
+    engine->setCallback(gStandalone.engineCallback, gStandalone.engineCallbackPtr);
+#ifndef BUILD_BRIDGE
+    engine->setBatchCallback(gStandalone.engineBatchCallback, gStandalone.engineBatchCallbackPtr);
+#endif
+    engine->setFileCallback(gStandalone.fileCallback, gStandalone.fileCallbackPtr);
 
 #ifdef BUILD_BRIDGE
     using juce::File;
@@ -149,118 +246,133 @@ static void carla_engine_init_common()
 
     /*
     if (const char* const uisAlwaysOnTop = std::getenv("ENGINE_OPTION_FORCE_STEREO"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_FORCE_STEREO, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
+        engine->setOption(CB::ENGINE_OPTION_FORCE_STEREO, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
 
     if (const char* const uisAlwaysOnTop = std::getenv("ENGINE_OPTION_PREFER_PLUGIN_BRIDGES"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PREFER_PLUGIN_BRIDGES, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
+        engine->setOption(CB::ENGINE_OPTION_PREFER_PLUGIN_BRIDGES, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
 
     if (const char* const uisAlwaysOnTop = std::getenv("ENGINE_OPTION_PREFER_UI_BRIDGES"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PREFER_UI_BRIDGES, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
+        engine->setOption(CB::ENGINE_OPTION_PREFER_UI_BRIDGES, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
     */
 
     if (const char* const uisAlwaysOnTop = std::getenv("ENGINE_OPTION_UIS_ALWAYS_ON_TOP"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_UIS_ALWAYS_ON_TOP, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
+        engine->setOption(CB::ENGINE_OPTION_UIS_ALWAYS_ON_TOP, (std::strcmp(uisAlwaysOnTop, "true") == 0) ? 1 : 0, nullptr);
 
     if (const char* const maxParameters = std::getenv("ENGINE_OPTION_MAX_PARAMETERS"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_MAX_PARAMETERS,     std::atoi(maxParameters), nullptr);
+        engine->setOption(CB::ENGINE_OPTION_MAX_PARAMETERS,     std::atoi(maxParameters), nullptr);
 
     if (const char* const uiBridgesTimeout = std::getenv("ENGINE_OPTION_UI_BRIDGES_TIMEOUT"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_UI_BRIDGES_TIMEOUT, std::atoi(uiBridgesTimeout), nullptr);
+        engine->setOption(CB::ENGINE_OPTION_UI_BRIDGES_TIMEOUT, std::atoi(uiBridgesTimeout), nullptr);
+
+    if (const char* const minSubBlockSize = std::getenv("ENGINE_OPTION_MIN_SUB_BLOCK_SIZE"))
+        engine->setOption(CB::ENGINE_OPTION_MIN_SUB_BLOCK_SIZE, std::atoi(minSubBlockSize), nullptr);
+
+    if (const char* const flushDenormals = std::getenv("ENGINE_OPTION_FLUSH_DENORMALS"))
+        engine->setOption(CB::ENGINE_OPTION_FLUSH_DENORMALS, (std::strcmp(flushDenormals, "true") == 0) ? 1 : 0, nullptr);
 
     if (const char* const pathLADSPA = std::getenv("ENGINE_OPTION_PLUGIN_PATH_LADSPA"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_LADSPA, pathLADSPA);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_LADSPA, pathLADSPA);
 
     if (const char* const pathDSSI = std::getenv("ENGINE_OPTION_PLUGIN_PATH_DSSI"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_DSSI, pathDSSI);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_DSSI, pathDSSI);
 
     if (const char* const pathLV2 = std::getenv("ENGINE_OPTION_PLUGIN_PATH_LV2"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_LV2, pathLV2);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_LV2, pathLV2);
 
     if (const char* const pathVST2 = std::getenv("ENGINE_OPTION_PLUGIN_PATH_VST2"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_VST2, pathVST2);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_VST2, pathVST2);
 
     if (const char* const pathVST3 = std::getenv("ENGINE_OPTION_PLUGIN_PATH_VST3"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_VST3, pathVST3);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_VST3, pathVST3);
 
     if (const char* const pathGIG = std::getenv("ENGINE_OPTION_PLUGIN_PATH_GIG"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_GIG, pathGIG);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_GIG, pathGIG);
 
     if (const char* const pathSF2 = std::getenv("ENGINE_OPTION_PLUGIN_PATH_SF2"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_SF2, pathSF2);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_SF2, pathSF2);
 
     if (const char* const pathSFZ = std::getenv("ENGINE_OPTION_PLUGIN_PATH_SFZ"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_SFZ, pathSFZ);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH, CB::PLUGIN_SFZ, pathSFZ);
 
     if (const char* const binaryDir = std::getenv("ENGINE_OPTION_PATH_BINARIES"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PATH_BINARIES,   0, binaryDir);
+        engine->setOption(CB::ENGINE_OPTION_PATH_BINARIES,   0, binaryDir);
     else
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PATH_BINARIES,   0, juceBinaryDir.getFullPathName().toRawUTF8());
+        engine->setOption(CB::ENGINE_OPTION_PATH_BINARIES,   0, juceBinaryDir.getFullPathName().toRawUTF8());
 
     if (const char* const resourceDir = std::getenv("ENGINE_OPTION_PATH_RESOURCES"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PATH_RESOURCES,  0, resourceDir);
+        engine->setOption(CB::ENGINE_OPTION_PATH_RESOURCES,  0, resourceDir);
     else
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PATH_RESOURCES,  0, juceBinaryDir.getChildFile("resources").getFullPathName().toRawUTF8());
+        engine->setOption(CB::ENGINE_OPTION_PATH_RESOURCES,  0, juceBinaryDir.getChildFile("resources").getFullPathName().toRawUTF8());
 
     if (const char* const preventBadBehaviour = std::getenv("ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR, (std::strcmp(preventBadBehaviour, "true") == 0) ? 1 : 0, nullptr);
+        engine->setOption(CB::ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR, (std::strcmp(preventBadBehaviour, "true") == 0) ? 1 : 0, nullptr);
 
     if (const char* const frontendWinId = std::getenv("ENGINE_OPTION_FRONTEND_WIN_ID"))
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_FRONTEND_WIN_ID, 0, frontendWinId);
+        engine->setOption(CB::ENGINE_OPTION_FRONTEND_WIN_ID, 0, frontendWinId);
 #else
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_FORCE_STEREO,          gStandalone.engineOptions.forceStereo         ? 1 : 0,        nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_PREFER_PLUGIN_BRIDGES, gStandalone.engineOptions.preferPluginBridges ? 1 : 0,        nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_PREFER_UI_BRIDGES,     gStandalone.engineOptions.preferUiBridges     ? 1 : 0,        nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_UIS_ALWAYS_ON_TOP,     gStandalone.engineOptions.uisAlwaysOnTop      ? 1 : 0,        nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_MAX_PARAMETERS,        static_cast<int>(gStandalone.engineOptions.maxParameters),    nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_UI_BRIDGES_TIMEOUT,    static_cast<int>(gStandalone.engineOptions.uiBridgesTimeout), nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_NUM_PERIODS,     static_cast<int>(gStandalone.engineOptions.audioNumPeriods),  nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_BUFFER_SIZE,     static_cast<int>(gStandalone.engineOptions.audioBufferSize),  nullptr);
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_SAMPLE_RATE,     static_cast<int>(gStandalone.engineOptions.audioSampleRate),  nullptr);
+    engine->setOption(CB::ENGINE_OPTION_FORCE_STEREO,          gStandalone.engineOptions.forceStereo         ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_PREFER_PLUGIN_BRIDGES, gStandalone.engineOptions.preferPluginBridges ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_SHARE_PLUGIN_BRIDGES,  gStandalone.engineOptions.sharePluginBridges  ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_PREFER_UI_BRIDGES,     gStandalone.engineOptions.preferUiBridges     ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_UIS_ALWAYS_ON_TOP,     gStandalone.engineOptions.uisAlwaysOnTop      ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_MAX_PARAMETERS,        static_cast<int>(gStandalone.engineOptions.maxParameters),    nullptr);
+    engine->setOption(CB::ENGINE_OPTION_UI_BRIDGES_TIMEOUT,    static_cast<int>(gStandalone.engineOptions.uiBridgesTimeout), nullptr);
+    engine->setOption(CB::ENGINE_OPTION_MIN_SUB_BLOCK_SIZE,    static_cast<int>(gStandalone.engineOptions.minSubBlockSize),  nullptr);
+    engine->setOption(CB::ENGINE_OPTION_CALLBACK_BATCH_INTERVAL, static_cast<int>(gStandalone.engineOptions.callbackBatchInterval), nullptr);
+    engine->setOption(CB::ENGINE_OPTION_TELEMETRY,             gStandalone.engineOptions.telemetry           ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_TELEMETRY_SCOPE_SIZE,  static_cast<int>(gStandalone.engineOptions.telemetryScopeSize), nullptr);
+    engine->setOption(CB::ENGINE_OPTION_SKIP_SILENT_PLUGINS,   gStandalone.engineOptions.skipSilentPlugins   ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_SILENT_PLUGIN_TAIL,    static_cast<int>(gStandalone.engineOptions.silentPluginTail), nullptr);
+    engine->setOption(CB::ENGINE_OPTION_FLUSH_DENORMALS,       gStandalone.engineOptions.flushDenormals      ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_ANTI_DENORMAL_OFFSET,  gStandalone.engineOptions.antiDenormalOffset  ? 1 : 0,        nullptr);
+    engine->setOption(CB::ENGINE_OPTION_AUDIO_NUM_PERIODS,     static_cast<int>(gStandalone.engineOptions.audioNumPeriods),  nullptr);
+    engine->setOption(CB::ENGINE_OPTION_AUDIO_BUFFER_SIZE,     static_cast<int>(gStandalone.engineOptions.audioBufferSize),  nullptr);
+    engine->setOption(CB::ENGINE_OPTION_AUDIO_SAMPLE_RATE,     static_cast<int>(gStandalone.engineOptions.audioSampleRate),  nullptr);
 
     if (gStandalone.engineOptions.audioDevice != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_AUDIO_DEVICE,      0, gStandalone.engineOptions.audioDevice);
+        engine->setOption(CB::ENGINE_OPTION_AUDIO_DEVICE,      0, gStandalone.engineOptions.audioDevice);
 
     if (gStandalone.engineOptions.pathLADSPA != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_LADSPA, gStandalone.engineOptions.pathLADSPA);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_LADSPA, gStandalone.engineOptions.pathLADSPA);
 
     if (gStandalone.engineOptions.pathDSSI != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_DSSI, gStandalone.engineOptions.pathDSSI);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_DSSI, gStandalone.engineOptions.pathDSSI);
 
     if (gStandalone.engineOptions.pathLV2 != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_LV2, gStandalone.engineOptions.pathLV2);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_LV2, gStandalone.engineOptions.pathLV2);
 
     if (gStandalone.engineOptions.pathVST2 != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_VST2, gStandalone.engineOptions.pathVST2);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_VST2, gStandalone.engineOptions.pathVST2);
 
     if (gStandalone.engineOptions.pathVST3 != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_VST3, gStandalone.engineOptions.pathVST3);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_VST3, gStandalone.engineOptions.pathVST3);
 
     if (gStandalone.engineOptions.pathGIG != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_GIG, gStandalone.engineOptions.pathGIG);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_GIG, gStandalone.engineOptions.pathGIG);
 
     if (gStandalone.engineOptions.pathSF2 != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_SF2, gStandalone.engineOptions.pathSF2);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_SF2, gStandalone.engineOptions.pathSF2);
 
     if (gStandalone.engineOptions.pathSFZ != nullptr)
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_SFZ, gStandalone.engineOptions.pathSFZ);
+        engine->setOption(CB::ENGINE_OPTION_PLUGIN_PATH,       CB::PLUGIN_SFZ, gStandalone.engineOptions.pathSFZ);
 
     if (gStandalone.engineOptions.binaryDir != nullptr && gStandalone.engineOptions.binaryDir[0] != '\0')
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PATH_BINARIES,     0, gStandalone.engineOptions.binaryDir);
+        engine->setOption(CB::ENGINE_OPTION_PATH_BINARIES,     0, gStandalone.engineOptions.binaryDir);
 
     if (gStandalone.engineOptions.resourceDir != nullptr && gStandalone.engineOptions.resourceDir[0] != '\0')
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_PATH_RESOURCES,    0, gStandalone.engineOptions.resourceDir);
+        engine->setOption(CB::ENGINE_OPTION_PATH_RESOURCES,    0, gStandalone.engineOptions.resourceDir);
 
-    gStandalone.engine->setOption(CB::ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR,    gStandalone.engineOptions.preventBadBehaviour ? 1 : 0,  nullptr);
+    engine->setOption(CB::ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR,    gStandalone.engineOptions.preventBadBehaviour ? 1 : 0,  nullptr);
 
     if (gStandalone.engineOptions.frontendWinId != 0)
     {
         char strBuf[STR_MAX+1];
         strBuf[STR_MAX] = '\0';
         std::snprintf(strBuf, STR_MAX, P_UINTPTR, gStandalone.engineOptions.frontendWinId);
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_FRONTEND_WIN_ID, 0, strBuf);
+        engine->setOption(CB::ENGINE_OPTION_FRONTEND_WIN_ID, 0, strBuf);
     }
     else
-        gStandalone.engine->setOption(CB::ENGINE_OPTION_FRONTEND_WIN_ID, 0, "0");
+        engine->setOption(CB::ENGINE_OPTION_FRONTEND_WIN_ID, 0, "0");
 #endif
 }
 
@@ -308,7 +420,7 @@ bool carla_engine_init(const char* driverName, const char* clientName)
     gStandalone.engine->setOption(CB::ENGINE_OPTION_TRANSPORT_MODE,        static_cast<int>(gStandalone.engineOptions.transportMode), nullptr);
 #endif
 
-    carla_engine_init_common();
+    carla_engine_init_common(gStandalone.engine);
 
     if (gStandalone.engine->init(clientName))
     {
@@ -354,7 +466,7 @@ bool carla_engine_init_bridge(const char audioBaseName[6+1], const char rtClient
         return false;
     }
 
-    carla_engine_init_common();
+    carla_engine_init_common(gStandalone.engine);
 
     gStandalone.engine->setOption(CB::ENGINE_OPTION_PROCESS_MODE,   CB::ENGINE_PROCESS_MODE_BRIDGE,   nullptr);
     gStandalone.engine->setOption(CB::ENGINE_OPTION_TRANSPORT_MODE, CB::ENGINE_TRANSPORT_MODE_BRIDGE, nullptr);
@@ -372,6 +484,37 @@ bool carla_engine_init_bridge(const char audioBaseName[6+1], const char rtClient
         return false;
     }
 }
+
+CarlaEngine* carla_engine_new_bridge(const char audioBaseName[6+1], const char rtClientBaseName[6+1], const char nonRtClientBaseName[6+1],
+                                     const char nonRtServerBaseName[6+1], const char* clientName)
+{
+    CARLA_SAFE_ASSERT_RETURN(audioBaseName != nullptr && audioBaseName[0] != '\0', nullptr);
+    CARLA_SAFE_ASSERT_RETURN(rtClientBaseName != nullptr && rtClientBaseName[0] != '\0', nullptr);
+    CARLA_SAFE_ASSERT_RETURN(nonRtClientBaseName != nullptr && nonRtClientBaseName[0] != '\0', nullptr);
+    CARLA_SAFE_ASSERT_RETURN(nonRtServerBaseName != nullptr && nonRtServerBaseName[0] != '\0', nullptr);
+    CARLA_SAFE_ASSERT_RETURN(clientName != nullptr && clientName[0] != '\0', nullptr);
+    carla_debug("carla_engine_new_bridge(\"%s\", \"%s\", \"%s\", \"%s\", \"%s\")", audioBaseName, rtClientBaseName, nonRtClientBaseName, nonRtServerBaseName, clientName);
+
+    CarlaEngine* const engine(CarlaEngine::newBridge(audioBaseName, rtClientBaseName, nonRtClientBaseName, nonRtServerBaseName));
+
+    if (engine == nullptr)
+    {
+        gStandalone.lastError = "The seleted audio driver is not available!";
+        return nullptr;
+    }
+
+    carla_engine_init_common(engine);
+
+    engine->setOption(CB::ENGINE_OPTION_PROCESS_MODE,   CB::ENGINE_PROCESS_MODE_BRIDGE,   nullptr);
+    engine->setOption(CB::ENGINE_OPTION_TRANSPORT_MODE, CB::ENGINE_TRANSPORT_MODE_BRIDGE, nullptr);
+
+    if (engine->init(clientName))
+        return engine;
+
+    gStandalone.lastError = engine->getLastError();
+    delete engine;
+    return nullptr;
+}
 #endif
 
 bool carla_engine_close()
@@ -399,6 +542,8 @@ bool carla_engine_close()
     delete gStandalone.engine;
     gStandalone.engine = nullptr;
 
+    gStandalone.runtimeSnapshot.clear();
+
     return closed;
 }
 
@@ -438,6 +583,17 @@ void carla_set_engine_callback(EngineCallbackFunc func, void* ptr)
 }
 
 #ifndef BUILD_BRIDGE
+void carla_set_engine_batch_callback(EngineBatchCallbackFunc func, void* ptr)
+{
+    carla_debug("carla_set_engine_batch_callback(%p, %p)", func, ptr);
+
+    gStandalone.engineBatchCallback    = func;
+    gStandalone.engineBatchCallbackPtr = ptr;
+
+    if (gStandalone.engine != nullptr)
+        gStandalone.engine->setBatchCallback(func, ptr);
+}
+
 void carla_set_engine_option(EngineOption option, int value, const char* valueStr)
 {
     carla_debug("carla_set_engine_option(%i:%s, %i, \"%s\")", option, CB::EngineOption2Str(option), value, valueStr);
@@ -467,6 +623,11 @@ void carla_set_engine_option(EngineOption option, int value, const char* valueSt
         gStandalone.engineOptions.preferPluginBridges = (value != 0);
         break;
 
+    case CB::ENGINE_OPTION_SHARE_PLUGIN_BRIDGES:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.sharePluginBridges = (value != 0);
+        break;
+
     case CB::ENGINE_OPTION_PREFER_UI_BRIDGES:
         CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
         gStandalone.engineOptions.preferUiBridges = (value != 0);
@@ -487,6 +648,46 @@ void carla_set_engine_option(EngineOption option, int value, const char* valueSt
         gStandalone.engineOptions.uiBridgesTimeout = static_cast<uint>(value);
         break;
 
+    case CB::ENGINE_OPTION_MIN_SUB_BLOCK_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.minSubBlockSize = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_CALLBACK_BATCH_INTERVAL:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.callbackBatchInterval = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_TELEMETRY:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.telemetry = (value != 0);
+        break;
+
+    case CB::ENGINE_OPTION_TELEMETRY_SCOPE_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.telemetryScopeSize = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_SKIP_SILENT_PLUGINS:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.skipSilentPlugins = (value != 0);
+        break;
+
+    case CB::ENGINE_OPTION_SILENT_PLUGIN_TAIL:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        gStandalone.engineOptions.silentPluginTail = static_cast<uint>(value);
+        break;
+
+    case CB::ENGINE_OPTION_FLUSH_DENORMALS:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.flushDenormals = (value != 0);
+        break;
+
+    case CB::ENGINE_OPTION_ANTI_DENORMAL_OFFSET:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        gStandalone.engineOptions.antiDenormalOffset = (value != 0);
+        break;
+
     case CB::ENGINE_OPTION_AUDIO_NUM_PERIODS:
         CARLA_SAFE_ASSERT_RETURN(value >= 2 && value <= 3,);
         gStandalone.engineOptions.audioNumPeriods = static_cast<uint>(value);
@@ -649,6 +850,54 @@ bool carla_save_project(const char* filename)
     return false;
 }
 
+bool carla_save_project_async(const char* filename)
+{
+    CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+    carla_debug("carla_save_project_async(\"%s\")", filename);
+
+#ifndef BUILD_BRIDGE
+    if (gStandalone.engine != nullptr)
+        return gStandalone.engine->saveProjectAsync(filename);
+
+    carla_stderr2("Engine was never initiated");
+    gStandalone.lastError = "Engine was never initiated";
+#else
+    carla_stderr2("Async project saving is not available in plugin bridges");
+    gStandalone.lastError = "Async project saving is not available in plugin bridges";
+#endif
+    return false;
+}
+
+bool carla_convert_project_to_binary(const char* xmlFilename, const char* binaryFilename, bool compress)
+{
+    CARLA_SAFE_ASSERT_RETURN(xmlFilename != nullptr && xmlFilename[0] != '\0', false);
+    CARLA_SAFE_ASSERT_RETURN(binaryFilename != nullptr && binaryFilename[0] != '\0', false);
+    carla_debug("carla_convert_project_to_binary(\"%s\", \"%s\", %s)", xmlFilename, binaryFilename, bool2str(compress));
+
+    using juce::File;
+
+    if (CB::carla_convertProjectToBinary(File(xmlFilename), File(binaryFilename), compress))
+        return true;
+
+    gStandalone.lastError = "Failed to convert project to binary";
+    return false;
+}
+
+bool carla_convert_project_to_xml(const char* binaryFilename, const char* xmlFilename)
+{
+    CARLA_SAFE_ASSERT_RETURN(binaryFilename != nullptr && binaryFilename[0] != '\0', false);
+    CARLA_SAFE_ASSERT_RETURN(xmlFilename != nullptr && xmlFilename[0] != '\0', false);
+    carla_debug("carla_convert_project_to_xml(\"%s\", \"%s\")", binaryFilename, xmlFilename);
+
+    using juce::File;
+
+    if (CB::carla_convertProjectToXml(File(binaryFilename), File(xmlFilename)))
+        return true;
+
+    gStandalone.lastError = "Failed to convert project to XML";
+    return false;
+}
+
 #ifndef BUILD_BRIDGE
 // -------------------------------------------------------------------------------------------------------------------
 
@@ -714,6 +963,25 @@ void carla_transport_relocate(uint64_t frame)
     gStandalone.engine->transportRelocate(frame);
 }
 
+bool carla_engine_render_offline(const char* outputFile, const char* inputFile, const char* midiFile, double seconds)
+{
+    CARLA_SAFE_ASSERT_RETURN(outputFile != nullptr && outputFile[0] != '\0', false);
+    carla_debug("carla_engine_render_offline(\"%s\", \"%s\", \"%s\", %f)", outputFile, inputFile, midiFile, seconds);
+
+    if (gStandalone.engine == nullptr || ! gStandalone.engine->isRunning())
+    {
+        carla_stderr2("Engine is not running");
+        gStandalone.lastError = "Engine is not running";
+        return false;
+    }
+
+    if (gStandalone.engine->renderOffline(outputFile, inputFile, midiFile, seconds))
+        return true;
+
+    gStandalone.lastError = gStandalone.engine->getLastError();
+    return false;
+}
+
 uint64_t carla_get_current_transport_frame()
 {
     CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr && gStandalone.engine->isRunning(), 0);
@@ -859,6 +1127,47 @@ bool carla_switch_plugins(uint pluginIdA, uint pluginIdB)
     gStandalone.lastError = "Engine is not running";
     return false;
 }
+
+bool carla_load_standby_project(const char* filename)
+{
+    CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', false);
+    carla_debug("carla_load_standby_project(\"%s\")", filename);
+
+    if (gStandalone.engine != nullptr)
+        return gStandalone.engine->loadStandbyProject(filename);
+
+    carla_stderr2("Engine is not running");
+    gStandalone.lastError = "Engine is not running";
+    return false;
+}
+
+bool carla_switch_standby_plugins()
+{
+    carla_debug("carla_switch_standby_plugins()");
+
+    if (gStandalone.engine != nullptr)
+        return gStandalone.engine->switchStandbyPlugins();
+
+    carla_stderr2("Engine is not running");
+    gStandalone.lastError = "Engine is not running";
+    return false;
+}
+
+void carla_clear_standby_plugins()
+{
+    carla_debug("carla_clear_standby_plugins()");
+
+    if (gStandalone.engine != nullptr)
+        gStandalone.engine->clearStandbyPlugins();
+}
+
+uint32_t carla_get_standby_plugin_count()
+{
+    if (gStandalone.engine != nullptr)
+        return gStandalone.engine->getStandbyPluginCount();
+
+    return 0;
+}
 #endif
 
 // -------------------------------------------------------------------------------------------------------------------
@@ -1550,6 +1859,113 @@ float carla_get_output_peak_value(uint pluginId, bool isLeft)
     return gStandalone.engine->getOutputPeak(pluginId, isLeft);
 }
 
+bool carla_get_runtime_snapshot(CarlaRuntimeSnapshot* snapshot)
+{
+    CARLA_SAFE_ASSERT_RETURN(snapshot != nullptr, false);
+
+    snapshot->pluginCount          = 0;
+    snapshot->parameterChangeCount = 0;
+
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, false);
+
+    CarlaEngine* const engine(gStandalone.engine);
+    CarlaRuntimeSnapshotCache& cache(gStandalone.runtimeSnapshot);
+
+    if (! cache.resize(engine->getMaxPluginNumber()))
+        return false;
+
+    const uint enginePluginCount(engine->getCurrentPluginCount());
+    const uint pluginCount(std::min(enginePluginCount, snapshot->maxPluginCount));
+    const bool checkParameters(snapshot->maxParameterChanges > 0 && snapshot->parameterPluginIds != nullptr &&
+                               snapshot->parameterIds != nullptr && snapshot->parameterValues != nullptr);
+
+    bool changed = false;
+    uint32_t parameterChangeCount = 0;
+
+    for (uint i=0; i < pluginCount && i < cache.count; ++i)
+    {
+        CarlaPlugin* const plugin(engine->getPluginUnchecked(i));
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+        if (snapshot->peaks != nullptr)
+        {
+            float* const peaks(snapshot->peaks + i*4);
+            peaks[0] = engine->getInputPeak(i, true);
+            peaks[1] = engine->getInputPeak(i, false);
+            peaks[2] = engine->getOutputPeak(i, true);
+            peaks[3] = engine->getOutputPeak(i, false);
+        }
+
+        uint state = 0x0;
+
+        if (plugin->isEnabled())
+            state |= PLUGIN_RUNTIME_STATE_ENABLED;
+#ifndef BUILD_BRIDGE
+        if (plugin->getInternalParameterValue(CB::PARAMETER_ACTIVE) >= 0.5f)
+            state |= PLUGIN_RUNTIME_STATE_ACTIVE;
+#endif
+
+        if (snapshot->states != nullptr)
+            snapshot->states[i] = state;
+
+        CarlaRuntimeSnapshotCache::PluginData& data(cache.plugins[i]);
+
+        // plugin ids change on removal and switch, and parameters on reload
+        if (data.plugin != plugin || data.parameterCount != plugin->getParameterCount())
+        {
+            CarlaRuntimeSnapshotCache::resetPlugin(data, plugin);
+            changed = true;
+        }
+
+        if (data.state != state)
+        {
+            data.state = state;
+            changed = true;
+        }
+
+        if (! checkParameters || parameterChangeCount == snapshot->maxParameterChanges)
+            continue;
+
+        for (uint32_t j=0; j < data.parameterCount; ++j)
+        {
+            const float value(plugin->getParameterValue(j));
+
+            if (carla_isEqual(data.parameterValues[j], value))
+                continue;
+
+            // keep the old value, so the change is reported next time
+            if (parameterChangeCount == snapshot->maxParameterChanges)
+                break;
+
+            data.parameterValues[j] = value;
+
+            snapshot->parameterPluginIds[parameterChangeCount] = i;
+            snapshot->parameterIds[parameterChangeCount]       = j;
+            snapshot->parameterValues[parameterChangeCount]    = value;
+            ++parameterChangeCount;
+            changed = true;
+        }
+    }
+
+    // plugins removed since last call
+    for (uint i=enginePluginCount; i < cache.count; ++i)
+    {
+        if (cache.plugins[i].plugin == nullptr)
+            continue;
+
+        CarlaRuntimeSnapshotCache::resetPlugin(cache.plugins[i], nullptr);
+        changed = true;
+    }
+
+    if (changed)
+        ++cache.sequence;
+
+    snapshot->sequence             = cache.sequence;
+    snapshot->pluginCount          = pluginCount;
+    snapshot->parameterChangeCount = parameterChangeCount;
+    return true;
+}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 void carla_set_active(uint pluginId, bool onOff)
@@ -1827,7 +2243,13 @@ void carla_show_custom_ui(uint pluginId, bool yesNo)
     carla_debug("carla_show_custom_ui(%i, %s)", pluginId, bool2str(yesNo));
 
     if (CarlaPlugin* const plugin = gStandalone.engine->getPlugin(pluginId))
-        return plugin->showCustomUI(yesNo);
+    {
+        plugin->showCustomUI(yesNo);
+
+        // the plugin idle interval usually changes together with the UI visibility
+        gStandalone.engine->requestPluginIdle(pluginId);
+        return;
+    }
 
     carla_stderr2("carla_show_custom_ui(%i, %s) - could not find plugin", pluginId, bool2str(yesNo));
 }
@@ -1898,6 +2320,19 @@ const char* carla_get_host_osc_url_udp()
 #endif
 }
 
+const char* carla_get_telemetry_filename()
+{
+    carla_debug("carla_get_telemetry_filename()");
+
+#ifndef BUILD_BRIDGE
+    CARLA_SAFE_ASSERT_RETURN(gStandalone.engine != nullptr, gNullCharPtr);
+
+    return gStandalone.engine->getTelemetryFilename();
+#else
+    return gNullCharPtr;
+#endif
+}
+
 // -------------------------------------------------------------------------------------------------------------------
 
 #include "CarlaPluginUI.cpp"
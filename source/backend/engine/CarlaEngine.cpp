@@ -31,22 +31,362 @@
 #include "CarlaEngineUtils.hpp"
 #include "CarlaMathUtils.hpp"
 #include "CarlaPipeUtils.hpp"
+#include "CarlaSemUtils.hpp"
 #include "CarlaStateUtils.hpp"
 #include "CarlaMIDI.h"
 
 #include "jackbridge/JackBridge.hpp"
 #include "juce_core.h"
 
+using juce::Array;
 using juce::CharPointer_UTF8;
 using juce::File;
+using juce::FileOutputStream;
 using juce::MemoryOutputStream;
+using juce::OutputStream;
+using juce::OwnedArray;
 using juce::ScopedPointer;
 using juce::String;
+using juce::StringArray;
+using juce::SystemStats;
+using juce::TemporaryFile;
 using juce::XmlDocument;
 using juce::XmlElement;
 
 CARLA_BACKEND_START_NAMESPACE
 
+// -----------------------------------------------------------------------
+// Project save job.
+// Plugin states are added from the main thread, while worker threads serialize the ones already added.
+// Once all states are in, the project can be written from any thread, which allows saving in the background.
+
+static const uint kMaxSaveWorkerThreads = 8;
+
+class CarlaEngineSaveJob : public CarlaThread
+{
+public:
+    CarlaEngineSaveJob(const uint stateCount, const bool binary)
+        : CarlaThread("CarlaEngineSaveJob"),
+          fChunkStore(binary ? new CarlaStateChunkStore(true) : nullptr),
+          fHeader(1024),
+          fFooter(2048),
+          fStates(),
+          fStreams(),
+          fRealNames(),
+          fOrder(new uint[stateCount > 0 ? stateCount : 1]),
+          fStateCount(stateCount),
+          fAddedCount(0),
+          fNextIndex(0),
+          fFinished(false),
+          fSem(),
+          fSemValid(carla_sem_create2(fSem)),
+          fWorkers(),
+          fFile(),
+          fError(),
+          fResult(false)
+    {
+        for (uint i=0; i < stateCount; ++i)
+        {
+            fStates.add(nullptr);
+            fStreams.add(new MemoryOutputStream(4096));
+            fRealNames.add(String());
+        }
+
+        if (! fSemValid)
+            return;
+
+        uint numThreads = static_cast<uint>(SystemStats::getNumCpus());
+
+        if (numThreads > stateCount)
+            numThreads = stateCount;
+        if (numThreads > kMaxSaveWorkerThreads)
+            numThreads = kMaxSaveWorkerThreads;
+
+        // states not taken by workers (for example if they fail to start) are serialized when writing
+        for (uint i=0; i < numThreads; ++i)
+            fWorkers.add(new Worker(*this))->startThread();
+    }
+
+    ~CarlaEngineSaveJob() override
+    {
+        stopThread(-1);
+        stopWorkers();
+
+        if (fSemValid)
+            carla_sem_destroy2(fSem);
+
+        delete[] fOrder;
+    }
+
+    // xml declaration and engine settings, written before plugins
+    MemoryOutputStream& getHeaderStream() noexcept
+    {
+        return fHeader;
+    }
+
+    // patchbay connections and closing tag, written after plugins
+    MemoryOutputStream& getFooterStream() noexcept
+    {
+        return fFooter;
+    }
+
+    /*
+     * Add a plugin state to be serialized as soon as possible, the job takes ownership of @a stateSave.
+     * @a slot is the plugin position in the project, states can be added in any order.
+     * Must be called from a single thread.
+     */
+    void addState(const uint slot, CarlaStateSave* const stateSave, const char* const realName)
+    {
+        const uint index(fAddedCount);
+
+        if (slot >= fStateCount || index >= fStateCount || fStates.getUnchecked(static_cast<int>(slot)) != nullptr)
+        {
+            carla_safe_assert("slot < fStateCount && index < fStateCount", __FILE__, __LINE__);
+            delete stateSave;
+            return;
+        }
+
+        fStates.set(static_cast<int>(slot), stateSave);
+        fRealNames.set(static_cast<int>(slot), String(CharPointer_UTF8(realName)));
+        fOrder[index] = slot;
+
+        __atomic_store_n(&fAddedCount, index+1, __ATOMIC_RELEASE);
+
+        if (fSemValid)
+            carla_sem_post(fSem);
+    }
+
+    /*
+     * No more states will be added, workers can stop once they are done.
+     */
+    void finishStates() noexcept
+    {
+        if (__atomic_exchange_n(&fFinished, true, __ATOMIC_ACQ_REL))
+            return;
+
+        if (fSemValid)
+        {
+            for (int i=0, count=fWorkers.size(); i < count; ++i)
+                carla_sem_post(fSem);
+        }
+    }
+
+    /*
+     * Write the project as XML, waiting for all states to be serialized first.
+     * Binary projects use this for the XML part, with chunks kept in the chunk store.
+     */
+    void writeToStream(OutputStream& outStream)
+    {
+        finishStates();
+
+        // help with whatever is left, then wait for the states being serialized right now
+        serializeStates(nullptr);
+        stopWorkers();
+
+        outStream << fHeader;
+
+        for (uint i=0; i < fStateCount; ++i)
+        {
+            if (fStates.getUnchecked(static_cast<int>(i)) == nullptr)
+                continue;
+
+            outStream << "\n";
+
+            const String& realName(fRealNames[static_cast<int>(i)]);
+
+            if (realName.isNotEmpty())
+                outStream << " <!-- " << xmlSafeString(realName, true) << " -->\n";
+
+            outStream << " <Plugin>\n";
+            outStream << *fStreams.getUnchecked(static_cast<int>(i));
+            outStream << " </Plugin>\n";
+        }
+
+        outStream << fFooter;
+    }
+
+    /*
+     * Write the project to @a file, replacing it only when fully written.
+     * Files with the "carxb" extension are written as binary projects.
+     */
+    bool writeToFile(const File& file)
+    {
+        // stream directly into a temporary file, which replaces the real one only when complete
+        TemporaryFile tempFile(file, TemporaryFile::useHiddenFile);
+
+        {
+            FileOutputStream out(tempFile.getFile());
+
+            if (out.failedToOpen())
+            {
+                fError = "Failed to open file for writing";
+                return false;
+            }
+
+            if (fChunkStore != nullptr)
+            {
+                MemoryOutputStream xmlIndex;
+                writeToStream(xmlIndex);
+
+                // chunks were already compressed by the workers
+                if (! fChunkStore->writeToStream(out, xmlIndex.toUTF8(), false))
+                {
+                    fError = "Failed to write file";
+                    return false;
+                }
+            }
+            else
+            {
+                writeToStream(out);
+            }
+
+            out.flush();
+
+            if (out.getStatus().failed())
+            {
+                fError = "Failed to write file";
+                return false;
+            }
+        }
+
+        if (tempFile.overwriteTargetFileWithTemporary())
+            return true;
+
+        fError = "Failed to write file";
+        return false;
+    }
+
+    /*
+     * Write the project to @a file in this job's own thread.
+     * If the thread cannot be started the file is written before returning.
+     */
+    void startWritingToFile(const File& file)
+    {
+        fFile = file;
+
+        if (! startThread())
+            run();
+    }
+
+    bool isWriting() const noexcept
+    {
+        return isThreadRunning();
+    }
+
+    void waitForWriting() noexcept
+    {
+        stopThread(-1);
+    }
+
+    bool getResult() const noexcept
+    {
+        return fResult;
+    }
+
+    const File& getFile() const noexcept
+    {
+        return fFile;
+    }
+
+    const String& getError() const noexcept
+    {
+        return fError;
+    }
+
+protected:
+    void run() override
+    {
+        try {
+            fResult = writeToFile(fFile);
+        } CARLA_SAFE_EXCEPTION_RETURN("CarlaEngineSaveJob::run",);
+    }
+
+private:
+    class Worker : public CarlaThread
+    {
+    public:
+        Worker(CarlaEngineSaveJob& job) noexcept
+            : CarlaThread("CarlaEngineSaveWorker"),
+              kJob(job) {}
+
+    protected:
+        void run() override
+        {
+            kJob.serializeStates(this);
+        }
+
+    private:
+        CarlaEngineSaveJob& kJob;
+
+        CARLA_DECLARE_NON_COPY_CLASS(Worker)
+    };
+
+    const ScopedPointer<CarlaStateChunkStore> fChunkStore;
+
+    MemoryOutputStream fHeader, fFooter;
+    OwnedArray<CarlaStateSave> fStates;
+    OwnedArray<MemoryOutputStream> fStreams;
+    StringArray fRealNames;
+
+    uint* const fOrder; // slots, in the order they were added
+    const uint fStateCount;
+    uint fAddedCount;
+    uint fNextIndex;
+    bool fFinished;
+
+    carla_sem_t fSem; // posted for each added state, and to wake up workers when finished
+    const bool  fSemValid;
+    OwnedArray<Worker> fWorkers;
+
+    File   fFile;
+    String fError;
+    bool   fResult;
+
+    // serialize added states until there are no more, or @a thread should exit
+    void serializeStates(const CarlaThread* const thread)
+    {
+        for (;;)
+        {
+            // read the finished flag first, all states are added by the time it is set
+            const bool finished(__atomic_load_n(&fFinished, __ATOMIC_ACQUIRE));
+            const uint added(__atomic_load_n(&fAddedCount, __ATOMIC_ACQUIRE));
+            uint index(__atomic_load_n(&fNextIndex, __ATOMIC_RELAXED));
+
+            if (index < added)
+            {
+                if (__atomic_compare_exchange_n(&fNextIndex, &index, index+1, false, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+                    serializeState(fOrder[index]);
+                continue;
+            }
+
+            if (finished || thread == nullptr || thread->shouldThreadExit())
+                return;
+
+            carla_sem_timedwait_ms(fSem, 50);
+        }
+    }
+
+    void serializeState(const uint slot)
+    {
+        const CarlaStateSave* const stateSave(fStates.getUnchecked(static_cast<int>(slot)));
+        CARLA_SAFE_ASSERT_RETURN(stateSave != nullptr,);
+
+        try {
+            stateSave->dumpToMemoryStream(*fStreams.getUnchecked(static_cast<int>(slot)), fChunkStore);
+        } CARLA_SAFE_EXCEPTION("CarlaStateSave::dumpToMemoryStream");
+    }
+
+    void stopWorkers() noexcept
+    {
+        finishStates();
+
+        for (int i=0, count=fWorkers.size(); i < count; ++i)
+            fWorkers.getUnchecked(i)->stopThread(-1);
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaEngineSaveJob)
+};
+
 // -----------------------------------------------------------------------
 // Carla Engine
 
@@ -60,6 +400,12 @@ CarlaEngine::~CarlaEngine()
 {
     carla_debug("CarlaEngine::~CarlaEngine()");
 
+#ifndef BUILD_BRIDGE
+    // in case close() was not called, waits for the file to be written
+    delete pData->saveJob;
+    pData->saveJob = nullptr;
+#endif
+
     delete pData;
 }
 
@@ -198,6 +544,9 @@ CarlaEngine* CarlaEngine::newDriverByName(const char* const driverName)
         return newJack();
 
 #ifndef BUILD_BRIDGE
+    if (std::strcmp(driverName, "Offline") == 0)
+        return newOffline();
+
 # if defined(CARLA_OS_MAC) || defined(CARLA_OS_WIN)
     // -------------------------------------------------------------------
     // macos
@@ -265,6 +614,17 @@ bool CarlaEngine::close()
 {
     carla_debug("CarlaEngine::close()");
 
+#ifndef BUILD_BRIDGE
+    // states are already collected, but the file might still be written
+    finishProjectSave(true);
+
+    pData->deliverQueuedCallbacks(true);
+#endif
+
+#ifndef BUILD_BRIDGE
+    clearStandbyPlugins();
+#endif
+
     if (pData->curPluginCount != 0)
     {
         pData->aboutToClose = true;
@@ -305,6 +665,18 @@ void CarlaEngine::idle() noexcept
         }
     }
 
+#ifndef BUILD_BRIDGE
+    try {
+        updateLatency();
+    } CARLA_SAFE_EXCEPTION("updateLatency()")
+
+    try {
+        finishProjectSave(false);
+    } CARLA_SAFE_EXCEPTION("finishProjectSave()")
+
+    pData->deliverQueuedCallbacks(false);
+#endif
+
 #ifdef HAVE_LIBLO
     pData->osc.idle();
 #endif
@@ -336,7 +708,19 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
 #ifndef BUILD_BRIDGE
     CarlaPlugin* oldPlugin = nullptr;
 
-    if (pData->nextPluginId < pData->curPluginCount)
+    if (pData->standby.loading)
+    {
+        CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextPluginId == pData->maxPluginNumber, "Invalid engine internal data");
+
+        if (pData->standby.count == pData->maxPluginNumber)
+        {
+            setLastError("Maximum number of plugins reached");
+            return false;
+        }
+
+        id = pData->standby.count;
+    }
+    else if (pData->nextPluginId < pData->curPluginCount)
     {
         id = pData->nextPluginId;
         pData->nextPluginId = pData->maxPluginNumber;
@@ -525,6 +909,12 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     if (plugin == nullptr)
         return false;
 
+#ifndef BUILD_BRIDGE
+    // standby plugins use ids after the engine ones until switched in, so their callbacks are not sent
+    if (pData->standby.loading)
+        plugin->setId(pData->maxPluginNumber + id);
+#endif
+
     plugin->reload();
 
     bool canRun = true;
@@ -562,6 +952,17 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
         return false;
     }
 
+#ifndef BUILD_BRIDGE
+    // standby plugins are kept active but not processed, until switched in
+    if (pData->standby.loading)
+    {
+        plugin->setActive(true, false, true);
+
+        pData->standby.plugins[pData->standby.count++] = plugin;
+        return true;
+    }
+#endif
+
 #if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
     plugin->registerToOscClient();
 #endif
@@ -572,6 +973,8 @@ bool CarlaEngine::addPlugin(const BinaryType btype, const PluginType ptype,
     pluginData.insPeak[1]  = 0.0f;
     pluginData.outsPeak[0] = 0.0f;
     pluginData.outsPeak[1] = 0.0f;
+    pluginData.silentFrames = 0;
+    pluginData.silentOutput = false;
 
 #ifndef BUILD_BRIDGE
     if (oldPlugin != nullptr)
@@ -713,6 +1116,8 @@ bool CarlaEngine::removeAllPlugins()
         pluginData.insPeak[1]  = 0.0f;
         pluginData.outsPeak[0] = 0.0f;
         pluginData.outsPeak[1] = 0.0f;
+        pluginData.silentFrames = 0;
+        pluginData.silentOutput = false;
 
         callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
     }
@@ -815,23 +1220,26 @@ bool CarlaEngine::switchPlugins(const uint idA, const uint idB) noexcept
     CARLA_SAFE_ASSERT_RETURN_ERR(idA != idB, "Invalid operation, cannot switch plugin with itself");
     CARLA_SAFE_ASSERT_RETURN_ERR(idA < pData->curPluginCount, "Invalid plugin Id");
     CARLA_SAFE_ASSERT_RETURN_ERR(idB < pData->curPluginCount, "Invalid plugin Id");
-    carla_debug("CarlaEngine::switchPlugins(%i)", idA, idB);
+    carla_debug("CarlaEngine::switchPlugins(%i, %i)", idA, idB);
 
     CarlaPlugin* const pluginA(pData->plugins[idA].plugin);
     CarlaPlugin* const pluginB(pData->plugins[idB].plugin);
 
     CARLA_SAFE_ASSERT_RETURN_ERR(pluginA != nullptr, "Could not find plugin to switch");
-    CARLA_SAFE_ASSERT_RETURN_ERR(pluginA != nullptr, "Could not find plugin to switch");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pluginB != nullptr, "Could not find plugin to switch");
     CARLA_SAFE_ASSERT_RETURN_ERR(pluginA->getId() == idA, "Invalid engine internal data");
     CARLA_SAFE_ASSERT_RETURN_ERR(pluginB->getId() == idB, "Invalid engine internal data");
 
     const ScopedThreadStopper sts(this);
 
-    if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
-        pData->graph.replacePlugin(pluginA, pluginB);
+    {
+        const bool lockWait(isRunning() /*&& pData->options.processMode != ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS*/);
+        const ScopedActionLock sal(this, kEnginePostActionSwitchPlugins, idA, idB, lockWait);
+    }
 
-    const bool lockWait(isRunning() /*&& pData->options.processMode != ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS*/);
-    const ScopedActionLock sal(this, kEnginePostActionSwitchPlugins, idA, idB, lockWait);
+    // plugin Ids are switched now
+    if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+        pData->graph.switchPlugins(pluginA, pluginB);
 
     // TODO
     /*
@@ -848,72 +1256,279 @@ bool CarlaEngine::switchPlugins(const uint idA, const uint idB) noexcept
 
     return true;
 }
-#endif
 
-CarlaPlugin* CarlaEngine::getPlugin(const uint id) const noexcept
+bool CarlaEngine::loadStandbyProject(const char* const filename)
 {
-    CARLA_SAFE_ASSERT_RETURN_ERRN(pData->plugins != nullptr, "Invalid engine internal data");
-    CARLA_SAFE_ASSERT_RETURN_ERRN(pData->curPluginCount != 0, "Invalid engine internal data");
-    CARLA_SAFE_ASSERT_RETURN_ERRN(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
-    CARLA_SAFE_ASSERT_RETURN_ERRN(id < pData->curPluginCount, "Invalid plugin Id");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->isIdling == 0, "An operation is still being processed, please wait for it to finish");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->standby.plugins != nullptr, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextPluginId == pData->maxPluginNumber, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(! pData->standby.loading, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(filename != nullptr && filename[0] != '\0', "Invalid filename");
+    carla_debug("CarlaEngine::loadStandbyProject(\"%s\")", filename);
 
-    return pData->plugins[id].plugin;
-}
+    if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK)
+    {
+        setLastError("Standby plugins are only supported in rack mode");
+        return false;
+    }
 
-CarlaPlugin* CarlaEngine::getPluginUnchecked(const uint id) const noexcept
-{
-    return pData->plugins[id].plugin;
-}
+    const String jfilename = String(CharPointer_UTF8(filename));
+    File file(jfilename);
+    CARLA_SAFE_ASSERT_RETURN_ERR(file.existsAsFile(), "Requested file does not exist or is not a readable file");
 
-const char* CarlaEngine::getUniquePluginName(const char* const name) const
-{
-    CARLA_SAFE_ASSERT_RETURN(pData->nextAction.opcode == kEnginePostActionNull, nullptr);
-    CARLA_SAFE_ASSERT_RETURN(name != nullptr && name[0] != '\0', nullptr);
-    carla_debug("CarlaEngine::getUniquePluginName(\"%s\")", name);
+    CarlaStateChunkStore chunkStore;
+    ScopedPointer<XmlElement> xmlElement;
 
-    CarlaString sname;
-    sname = name;
+    if (CarlaStateChunkStore::isBinaryProjectFile(file))
+    {
+        String xmlIndex;
 
-    if (sname.isEmpty())
+        if (! chunkStore.openFile(file, xmlIndex))
+        {
+            setLastError("Failed to open binary project file");
+            return false;
+        }
+
+        xmlElement = XmlDocument::parse(xmlIndex);
+    }
+    else
     {
-        sname = "(No name)";
-        return sname.dup();
+        xmlElement = XmlDocument::parse(file);
     }
 
-    const std::size_t maxNameSize(carla_minConstrained<uint>(getMaxClientNameSize(), 0xff, 6U) - 6); // 6 = strlen(" (10)") + 1
+    CARLA_SAFE_ASSERT_RETURN_ERR(xmlElement != nullptr, "Failed to parse project file");
 
-    if (maxNameSize == 0 || ! isRunning())
-        return sname.dup();
+    if (! xmlElement->getTagName().equalsIgnoreCase("carla-project"))
+    {
+        setLastError("Not a valid Carla project file");
+        return false;
+    }
 
-    sname.truncate(maxNameSize);
-    sname.replace(':', '.'); // ':' is used in JACK1 to split client/port names
+    clearStandbyPlugins();
 
-    for (uint i=0; i < pData->curPluginCount; ++i)
+    pData->standby.loading = true;
+
+    for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
     {
-        CARLA_SAFE_ASSERT_BREAK(pData->plugins[i].plugin != nullptr);
+        if (! elem->getTagName().equalsIgnoreCase("plugin"))
+            continue;
 
-        // Check if unique name doesn't exist
-        if (const char* const pluginName = pData->plugins[i].plugin->getName())
+        CarlaStateSave stateSave;
+        stateSave.fillFromXmlElement(elem, &chunkStore);
+
+        callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+
+        CARLA_SAFE_ASSERT_CONTINUE(stateSave.type != nullptr);
+
+        const void* extraStuff = nullptr;
+
+        // check if using GIG or SF2 16outs
+        static const char kUse16OutsSuffix[] = " (16 outs)";
+
+        const BinaryType btype(getBinaryTypeFromFile(stateSave.binary));
+        const PluginType ptype(getPluginTypeFromString(stateSave.type));
+
+        if (CarlaString(stateSave.label).endsWith(kUse16OutsSuffix))
         {
-            if (sname != pluginName)
-                continue;
+            if (ptype == PLUGIN_GIG || ptype == PLUGIN_SF2)
+                extraStuff = "true";
         }
 
-        // Check if string has already been modified
+        if (! addPlugin(btype, ptype, stateSave.binary, stateSave.name, stateSave.label, stateSave.uniqueId, extraStuff, stateSave.options))
         {
-            const std::size_t len(sname.length());
+            carla_stderr2("Failed to load a standby plugin, error was:\n%s", getLastError());
+            continue;
+        }
 
-            // 1 digit, ex: " (2)"
-            if (sname[len-4] == ' ' && sname[len-3] == '(' && sname.isDigit(len-2) && sname[len-1] == ')')
-            {
-                const int number = sname[len-2] - '0';
+        CarlaPlugin* const plugin(pData->standby.plugins[pData->standby.count-1]);
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
 
-                if (number == 9)
-                {
-                    // next number is 10, 2 digits
-                    sname.truncate(len-4);
-                    sname += " (10)";
-                    //sname.replace(" (9)", " (10)");
+        // not processed or idled until switched in, bridges must not expect pings meanwhile
+        if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0)
+            plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
+
+        plugin->loadStateSave(stateSave);
+    }
+
+    pData->standby.loading = false;
+
+    callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+    return true;
+}
+
+bool CarlaEngine::switchStandbyPlugins()
+{
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->isIdling == 0, "An operation is still being processed, please wait for it to finish");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->plugins != nullptr, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->standby.plugins != nullptr, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextPluginId == pData->maxPluginNumber, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(! pData->standby.loading, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERR(pData->curPluginCount != 0 || pData->standby.count != 0, "No plugins to switch");
+    carla_debug("CarlaEngine::switchStandbyPlugins()");
+
+    if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK)
+    {
+        setLastError("Standby plugins are only supported in rack mode");
+        return false;
+    }
+
+    const ScopedThreadStopper sts(this);
+
+    const uint oldPluginCount(pData->curPluginCount);
+
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+    if (isOscControlRegistered())
+    {
+        for (int i=oldPluginCount; --i >= 0;)
+            oscSend_control_remove_plugin(i);
+    }
+#endif
+
+    const bool lockWait(isRunning());
+    const ScopedActionLock sal(this, kEnginePostActionSwitchStandby, 0, 0, lockWait);
+
+    for (uint i=oldPluginCount; i > 0; --i)
+    {
+        CarlaPlugin* const plugin(pData->standby.plugins[i-1]);
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+        if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0)
+            plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
+
+        callback(ENGINE_CALLBACK_PLUGIN_REMOVED, i-1, 0, 0, 0.0f, nullptr);
+    }
+
+    for (uint i=0; i < pData->curPluginCount; ++i)
+    {
+        CarlaPlugin* const plugin(pData->plugins[i].plugin);
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+#if defined(HAVE_LIBLO) && ! defined(BUILD_BRIDGE)
+        plugin->registerToOscClient();
+#endif
+
+        if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0)
+            plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "true", false);
+
+        callback(ENGINE_CALLBACK_PLUGIN_ADDED, i, 0, 0, 0.0f, plugin->getName());
+    }
+
+    return true;
+}
+
+void CarlaEngine::clearStandbyPlugins()
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->standby.plugins != nullptr || pData->standby.count == 0,);
+    CARLA_SAFE_ASSERT_RETURN(! pData->standby.loading,);
+    carla_debug("CarlaEngine::clearStandbyPlugins()");
+
+    if (pData->standby.count == 0)
+        return;
+
+    // same as removePlugin(), except standby plugins are not in the graph and were already removed from OSC when switched out
+    const ScopedThreadStopper sts(this);
+
+    for (uint i=0; i < pData->standby.count; ++i)
+    {
+        CarlaPlugin* const plugin(pData->standby.plugins[i]);
+        pData->standby.plugins[i] = nullptr;
+
+        CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr);
+
+        // plugins deactivate themselves when deleted
+        plugin->setEnabled(false);
+        delete plugin;
+
+        callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
+    }
+
+    pData->standby.count = 0;
+}
+
+uint CarlaEngine::getStandbyPluginCount() const noexcept
+{
+    return pData->standby.count;
+}
+#endif
+
+CarlaPlugin* CarlaEngine::getPlugin(const uint id) const noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN_ERRN(pData->plugins != nullptr, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERRN(pData->curPluginCount != 0, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERRN(pData->nextAction.opcode == kEnginePostActionNull, "Invalid engine internal data");
+    CARLA_SAFE_ASSERT_RETURN_ERRN(id < pData->curPluginCount, "Invalid plugin Id");
+
+    return pData->plugins[id].plugin;
+}
+
+CarlaPlugin* CarlaEngine::getPluginUnchecked(const uint id) const noexcept
+{
+    return pData->plugins[id].plugin;
+}
+
+const char* CarlaEngine::getUniquePluginName(const char* const name) const
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->nextAction.opcode == kEnginePostActionNull, nullptr);
+    CARLA_SAFE_ASSERT_RETURN(name != nullptr && name[0] != '\0', nullptr);
+    carla_debug("CarlaEngine::getUniquePluginName(\"%s\")", name);
+
+    CarlaString sname;
+    sname = name;
+
+    if (sname.isEmpty())
+    {
+        sname = "(No name)";
+        return sname.dup();
+    }
+
+    const std::size_t maxNameSize(carla_minConstrained<uint>(getMaxClientNameSize(), 0xff, 6U) - 6); // 6 = strlen(" (10)") + 1
+
+    if (maxNameSize == 0 || ! isRunning())
+        return sname.dup();
+
+    sname.truncate(maxNameSize);
+    sname.replace(':', '.'); // ':' is used in JACK1 to split client/port names
+
+#ifndef BUILD_BRIDGE
+    // standby plugins will replace the current ones, only need to be unique between themselves
+    const bool checkStandby(pData->standby.loading);
+    const uint pluginCount(checkStandby ? pData->standby.count : pData->curPluginCount);
+#else
+    const uint pluginCount(pData->curPluginCount);
+#endif
+
+    for (uint i=0; i < pluginCount; ++i)
+    {
+#ifndef BUILD_BRIDGE
+        const CarlaPlugin* const plugin(checkStandby ? pData->standby.plugins[i] : pData->plugins[i].plugin);
+#else
+        const CarlaPlugin* const plugin(pData->plugins[i].plugin);
+#endif
+        CARLA_SAFE_ASSERT_BREAK(plugin != nullptr);
+
+        // Check if unique name doesn't exist
+        if (const char* const pluginName = plugin->getName())
+        {
+            if (sname != pluginName)
+                continue;
+        }
+
+        // Check if string has already been modified
+        {
+            const std::size_t len(sname.length());
+
+            // 1 digit, ex: " (2)"
+            if (sname[len-4] == ' ' && sname[len-3] == '(' && sname.isDigit(len-2) && sname[len-1] == ')')
+            {
+                const int number = sname[len-2] - '0';
+
+                if (number == 9)
+                {
+                    // next number is 10, 2 digits
+                    sname.truncate(len-4);
+                    sname += " (10)";
+                    //sname.replace(" (9)", " (10)");
                 }
                 else
                     sname[len-2] = char('0' + number + 1);
@@ -969,7 +1584,7 @@ bool CarlaEngine::loadFile(const char* const filename)
 
     // -------------------------------------------------------------------
 
-    if (extension == "carxp" || extension == "carxs")
+    if (extension == "carxp" || extension == "carxs" || extension == "carxb")
         return loadProject(filename);
 
     // -------------------------------------------------------------------
@@ -1056,6 +1671,21 @@ bool CarlaEngine::loadProject(const char* const filename)
     File file(jfilename);
     CARLA_SAFE_ASSERT_RETURN_ERR(file.existsAsFile(), "Requested file does not exist or is not a readable file");
 
+    if (CarlaStateChunkStore::isBinaryProjectFile(file))
+    {
+        CarlaStateChunkStore chunkStore;
+        String xmlIndex;
+
+        if (! chunkStore.openFile(file, xmlIndex))
+        {
+            setLastError("Failed to open binary project file");
+            return false;
+        }
+
+        XmlDocument xml(xmlIndex);
+        return loadProjectInternal(xml, false, &chunkStore);
+    }
+
     XmlDocument xml(file);
     return loadProjectInternal(xml);
 }
@@ -1065,19 +1695,61 @@ bool CarlaEngine::saveProject(const char* const filename)
     CARLA_SAFE_ASSERT_RETURN_ERR(filename != nullptr && filename[0] != '\0', "Invalid filename");
     carla_debug("CarlaEngine::saveProject(\"%s\")", filename);
 
-    MemoryOutputStream out;
-    saveProjectInternal(out);
-
     const String jfilename = String(CharPointer_UTF8(filename));
-    File file(jfilename);
+    const File file(jfilename);
 
-    if (file.replaceWithData(out.getData(), out.getDataSize()))
+    const ScopedPointer<CarlaEngineSaveJob> job(startProjectSave(file.hasFileExtension("carxb")));
+
+    if (job->writeToFile(file))
         return true;
 
-    setLastError("Failed to write file");
+    setLastError(job->getError().toRawUTF8());
     return false;
 }
 
+#ifndef BUILD_BRIDGE
+bool CarlaEngine::saveProjectAsync(const char* const filename)
+{
+    CARLA_SAFE_ASSERT_RETURN_ERR(filename != nullptr && filename[0] != '\0', "Invalid filename");
+    carla_debug("CarlaEngine::saveProjectAsync(\"%s\")", filename);
+
+    // only one background save at a time
+    finishProjectSave(true);
+
+    const String jfilename = String(CharPointer_UTF8(filename));
+    const File file(jfilename);
+
+    pData->saveJob = startProjectSave(file.hasFileExtension("carxb"));
+    pData->saveJob->startWritingToFile(file);
+    return true;
+}
+
+void CarlaEngine::finishProjectSave(const bool wait)
+{
+    CarlaEngineSaveJob* const job(pData->saveJob);
+
+    if (job == nullptr)
+        return;
+
+    if (job->isWriting())
+    {
+        if (! wait)
+            return;
+
+        job->waitForWriting();
+    }
+
+    pData->saveJob = nullptr;
+
+    const ScopedPointer<CarlaEngineSaveJob> jobPtr(job);
+
+    if (job->getResult())
+        callback(ENGINE_CALLBACK_PROJECT_SAVED, 0, 1, 0, 0.0f, job->getFile().getFullPathName().toRawUTF8());
+    else
+        callback(ENGINE_CALLBACK_PROJECT_SAVED, 0, 0, 0, 0.0f, job->getError().toRawUTF8());
+}
+#endif
+
 // -----------------------------------------------------------------------
 // Information (base)
 
@@ -1096,6 +1768,17 @@ double CarlaEngine::getSampleRate() const noexcept
     return pData->sampleRate;
 }
 
+#ifndef BUILD_BRIDGE
+uint32_t CarlaEngine::getTotalLatency() const noexcept
+{
+    if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK &&
+        pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+        return 0;
+
+    return pData->graph.getLatency();
+}
+#endif
+
 const char* CarlaEngine::getName() const noexcept
 {
     return pData->name;
@@ -1116,6 +1799,11 @@ const EngineTimeInfo& CarlaEngine::getTimeInfo() const noexcept
     return pData->timeInfo;
 }
 
+uint32_t CarlaEngine::getProcessCycle() const noexcept
+{
+    return pData->time.cycle;
+}
+
 // -----------------------------------------------------------------------
 // Information (peaks)
 
@@ -1152,6 +1840,22 @@ void CarlaEngine::callback(const EngineCallbackOpcode action, const uint pluginI
         carla_stdout("callback while idling (%i:%s, %i, %i, %i, %f, \"%s\")", action, EngineCallbackOpcode2Str(action), pluginId, value1, value2, value3, valueStr);
     }
 
+#ifndef BUILD_BRIDGE
+    // standby plugins are not known to the host yet
+    if (action >= ENGINE_CALLBACK_PLUGIN_ADDED && action <= ENGINE_CALLBACK_RELOAD_ALL && pluginId >= pData->maxPluginNumber)
+        return;
+
+    // delivered later from idle(), which plugin engines don't call
+    if (pData->options.callbackBatchInterval > 0 && getType() != kEngineTypePlugin && EngineCallbackQueue::canQueue(action))
+    {
+        const CarlaPlugin* const plugin((pData->plugins != nullptr && pluginId < pData->curPluginCount) ? pData->plugins[pluginId].plugin : nullptr);
+
+        // when full this gets dropped, the host is asked to reload values in the next batch instead
+        pData->callbackQueue.push(plugin, action, pluginId, value1, value2, value3);
+        return;
+    }
+#endif
+
     if (pData->callback != nullptr)
     {
         if (action == ENGINE_CALLBACK_IDLE)
@@ -1174,6 +1878,16 @@ void CarlaEngine::setCallback(const EngineCallbackFunc func, void* const ptr) no
     pData->callbackPtr = ptr;
 }
 
+#ifndef BUILD_BRIDGE
+void CarlaEngine::setBatchCallback(const EngineBatchCallbackFunc func, void* const ptr) noexcept
+{
+    carla_debug("CarlaEngine::setBatchCallback(%p, %p)", func, ptr);
+
+    pData->batchCallback    = func;
+    pData->batchCallbackPtr = ptr;
+}
+#endif
+
 // -----------------------------------------------------------------------
 // File Callback
 
@@ -1221,6 +1935,23 @@ void CarlaEngine::transportRelocate(const uint64_t frame) noexcept
     pData->time.frame = frame;
 }
 
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// Offline rendering
+
+bool CarlaEngine::renderOffline(const char* const, const char* const, const char* const, const double)
+{
+    setLastError("Offline rendering is only available with the offline engine");
+    return false;
+}
+
+uint32_t CarlaEngine::getOfflineRenderBlockTimes(const float*& times) const noexcept
+{
+    times = nullptr;
+    return 0;
+}
+#endif
+
 // -----------------------------------------------------------------------
 // Error handling
 
@@ -1241,6 +1972,11 @@ void CarlaEngine::setAboutToClose() noexcept
     pData->aboutToClose = true;
 }
 
+void CarlaEngine::requestPluginIdle(const uint id) noexcept
+{
+    pData->thread.requestPluginIdle(id);
+}
+
 // -----------------------------------------------------------------------
 // Global options
 
@@ -1284,6 +2020,58 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
         pData->options.preferPluginBridges = (value != 0);
         break;
 
+    case ENGINE_OPTION_SHARE_PLUGIN_BRIDGES:
+#ifdef BUILD_BRIDGE
+        CARLA_SAFE_ASSERT_RETURN(value == 0,);
+#else
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+#endif
+        pData->options.sharePluginBridges = (value != 0);
+        break;
+
+    case ENGINE_OPTION_CALLBACK_BATCH_INTERVAL:
+#ifdef BUILD_BRIDGE
+        CARLA_SAFE_ASSERT_RETURN(value == 0,);
+#else
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+#endif
+        pData->options.callbackBatchInterval = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_TELEMETRY:
+#ifdef BUILD_BRIDGE
+        CARLA_SAFE_ASSERT_RETURN(value == 0,);
+#else
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+#endif
+        pData->options.telemetry = (value != 0);
+        break;
+
+    case ENGINE_OPTION_TELEMETRY_SCOPE_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.telemetryScopeSize = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_SKIP_SILENT_PLUGINS:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        pData->options.skipSilentPlugins = (value != 0);
+        break;
+
+    case ENGINE_OPTION_SILENT_PLUGIN_TAIL:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.silentPluginTail = static_cast<uint>(value);
+        break;
+
+    case ENGINE_OPTION_FLUSH_DENORMALS:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        pData->options.flushDenormals = (value != 0);
+        break;
+
+    case ENGINE_OPTION_ANTI_DENORMAL_OFFSET:
+        CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
+        pData->options.antiDenormalOffset = (value != 0);
+        break;
+
     case ENGINE_OPTION_PREFER_UI_BRIDGES:
         CARLA_SAFE_ASSERT_RETURN(value == 0 || value == 1,);
         pData->options.preferUiBridges = (value != 0);
@@ -1304,6 +2092,11 @@ void CarlaEngine::setOption(const EngineOption option, const int value, const ch
         pData->options.uiBridgesTimeout = static_cast<uint>(value);
         break;
 
+    case ENGINE_OPTION_MIN_SUB_BLOCK_SIZE:
+        CARLA_SAFE_ASSERT_RETURN(value >= 0,);
+        pData->options.minSubBlockSize = static_cast<uint>(value);
+        break;
+
     case ENGINE_OPTION_AUDIO_NUM_PERIODS:
         CARLA_SAFE_ASSERT_RETURN(value >= 2 && value <= 3,);
         pData->options.audioNumPeriods = static_cast<uint>(value);
@@ -1473,6 +2266,16 @@ const char* CarlaEngine::getOscServerPathUDP() const noexcept
 }
 #endif
 
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// Telemetry
+
+const char* CarlaEngine::getTelemetryFilename() const noexcept
+{
+    return pData->telemetry.getFilename();
+}
+#endif
+
 // -----------------------------------------------------------------------
 // Helper functions
 
@@ -1504,6 +2307,16 @@ void CarlaEngine::bufferSizeChanged(const uint32_t newBufferSize)
             plugin->bufferSizeChanged(newBufferSize);
     }
 
+#ifndef BUILD_BRIDGE
+    for (uint i=0; i < pData->standby.count; ++i)
+    {
+        CarlaPlugin* const plugin(pData->standby.plugins[i]);
+
+        if (plugin != nullptr && plugin->isEnabled())
+            plugin->bufferSizeChanged(newBufferSize);
+    }
+#endif
+
     callback(ENGINE_CALLBACK_BUFFER_SIZE_CHANGED, 0, static_cast<int>(newBufferSize), 0, 0.0f, nullptr);
 }
 
@@ -1527,6 +2340,16 @@ void CarlaEngine::sampleRateChanged(const double newSampleRate)
             plugin->sampleRateChanged(newSampleRate);
     }
 
+#ifndef BUILD_BRIDGE
+    for (uint i=0; i < pData->standby.count; ++i)
+    {
+        CarlaPlugin* const plugin(pData->standby.plugins[i]);
+
+        if (plugin != nullptr && plugin->isEnabled())
+            plugin->sampleRateChanged(newSampleRate);
+    }
+#endif
+
     callback(ENGINE_CALLBACK_SAMPLE_RATE_CHANGED, 0, 0, 0, static_cast<float>(newSampleRate), nullptr);
 }
 
@@ -1549,8 +2372,42 @@ void CarlaEngine::offlineModeChanged(const bool isOfflineNow)
         if (plugin != nullptr && plugin->isEnabled())
             plugin->offlineModeChanged(isOfflineNow);
     }
+
+#ifndef BUILD_BRIDGE
+    for (uint i=0; i < pData->standby.count; ++i)
+    {
+        CarlaPlugin* const plugin(pData->standby.plugins[i]);
+
+        if (plugin != nullptr && plugin->isEnabled())
+            plugin->offlineModeChanged(isOfflineNow);
+    }
+#endif
 }
 
+#ifndef BUILD_BRIDGE
+void CarlaEngine::updateLatency()
+{
+    if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK &&
+        pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+        return;
+
+    // set by the engine thread when plugin latencies change
+    const bool pluginsChanged(__atomic_exchange_n(&pData->latencyUpdatePending, false, __ATOMIC_ACQ_REL));
+
+    if (! pData->graph.updateLatency(pluginsChanged))
+        return;
+
+    const uint32_t newLatency(pData->graph.getLatency());
+    carla_debug("CarlaEngine::updateLatency() - total latency is now %u", newLatency);
+
+    latencyChanged(newLatency);
+}
+
+void CarlaEngine::latencyChanged(const uint32_t)
+{
+}
+#endif
+
 void CarlaEngine::setPluginPeaks(const uint pluginId, float const inPeaks[2], float const outPeaks[2]) noexcept
 {
     EnginePluginData& pluginData(pData->plugins[pluginId]);
@@ -1561,8 +2418,44 @@ void CarlaEngine::setPluginPeaks(const uint pluginId, float const inPeaks[2], fl
     pluginData.outsPeak[1] = outPeaks[1];
 }
 
-void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
+// -----------------------------------------------------------------------
+// Helper thread for opening plugin binaries in advance, used during project load
+
+class PluginLibraryPrewarmThread : public CarlaThread
+{
+public:
+    PluginLibraryPrewarmThread(const StringArray& filenames, const int first, const int step) noexcept
+        : CarlaThread("CarlaEngineLoadThread"),
+          kFilenames(filenames),
+          kFirst(first),
+          kStep(step) {}
+
+protected:
+    void run() override
+    {
+        for (int i=kFirst, count=kFilenames.size(); i < count && ! shouldThreadExit(); i += kStep)
+            CarlaPlugin::prewarmLibrary(kFilenames[i].toRawUTF8());
+    }
+
+private:
+    const StringArray& kFilenames;
+    const int kFirst, kStep;
+
+    CARLA_DECLARE_NON_COPY_CLASS(PluginLibraryPrewarmThread)
+};
+
+static const int kMaxLibraryPrewarmThreads = 4;
+
+void CarlaEngine::saveProjectInternal(juce::OutputStream& outStream) const
+{
+    const ScopedPointer<CarlaEngineSaveJob> job(startProjectSave(false));
+    job->writeToStream(outStream);
+}
+
+CarlaEngineSaveJob* CarlaEngine::startProjectSave(const bool binary) const
 {
+    uint stateCount = 0;
+
     // send initial prepareForSave first, giving time for bridges to act
     for (uint i=0; i < pData->curPluginCount; ++i)
     {
@@ -1576,9 +2469,13 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
                 plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
 #endif
             plugin->prepareForSave();
+            ++stateCount;
         }
     }
 
+    ScopedPointer<CarlaEngineSaveJob> job(new CarlaEngineSaveJob(stateCount, binary));
+    MemoryOutputStream& outStream(job->getHeaderStream());
+
     outStream << "<?xml version='1.0' encoding='UTF-8'?>\n";
     outStream << "<!DOCTYPE CARLA-PROJECT>\n";
     outStream << "<CARLA-PROJECT VERSION='2.0'>\n";
@@ -1596,11 +2493,13 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
 
     outSettings << "  <ForceStereo>"         << bool2str(options.forceStereo)         << "</ForceStereo>\n";
     outSettings << "  <PreferPluginBridges>" << bool2str(options.preferPluginBridges) << "</PreferPluginBridges>\n";
+    outSettings << "  <SharePluginBridges>"  << bool2str(options.sharePluginBridges)  << "</SharePluginBridges>\n";
     outSettings << "  <PreferUiBridges>"     << bool2str(options.preferUiBridges)     << "</PreferUiBridges>\n";
     outSettings << "  <UIsAlwaysOnTop>"      << bool2str(options.uisAlwaysOnTop)      << "</UIsAlwaysOnTop>\n";
 
     outSettings << "  <MaxParameters>"       << String(options.maxParameters)    << "</MaxParameters>\n";
     outSettings << "  <UIBridgesTimeout>"    << String(options.uiBridgesTimeout) << "</UIBridgesTimeout>\n";
+    outSettings << "  <MinSubBlockSize>"     << String(options.minSubBlockSize)  << "</MinSubBlockSize>\n";
 
     if (isPlugin)
     {
@@ -1619,30 +2518,37 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
 
     char strBuf[STR_MAX+1];
 
-    for (uint i=0; i < pData->curPluginCount; ++i)
+    // collect plugin states, the job serializes each one in other threads as soon as it is added.
+    // plugins running in this process go first, bridges last since they have been saving on their side meanwhile.
+    for (int pass=0; pass < 2; ++pass)
     {
-        CarlaPlugin* const plugin(pData->plugins[i].plugin);
-
-        if (plugin != nullptr && plugin->isEnabled())
+        for (uint i=0, slot=0; i < pData->curPluginCount; ++i)
         {
-            MemoryOutputStream outPlugin(4096), streamPlugin;
-            plugin->getStateSave(false).dumpToMemoryStream(streamPlugin);
+            CarlaPlugin* const plugin(pData->plugins[i].plugin);
 
-            outPlugin << "\n";
+            if (plugin == nullptr || ! plugin->isEnabled())
+                continue;
+
+            const uint pluginSlot(slot++);
+            const bool isBridge((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0);
+
+            if (isBridge != (pass == 1))
+                continue;
+
+            ScopedPointer<CarlaStateSave> stateSave(new CarlaStateSave());
+            plugin->fillStateSave(*stateSave, true);
 
             strBuf[0] = '\0';
             plugin->getRealName(strBuf);
 
-            if (strBuf[0] != '\0')
-                outPlugin << " <!-- " << xmlSafeString(strBuf, true) << " -->\n";
-
-            outPlugin << " <Plugin>\n";
-            outPlugin << streamPlugin;
-            outPlugin << " </Plugin>\n";
-            outStream << outPlugin;
+            job->addState(pluginSlot, stateSave.release(), strBuf);
         }
     }
 
+    job->finishStates();
+
+    MemoryOutputStream& outFooter(job->getFooterStream());
+
 #ifndef BUILD_BRIDGE
     // tell bridges we're done saving
     for (uint i=0; i < pData->curPluginCount; ++i)
@@ -1677,7 +2583,7 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
             }
 
             outPatchbay << " </Patchbay>\n";
-            outStream << outPatchbay;
+            outFooter << outPatchbay;
         }
     }
 
@@ -1720,15 +2626,69 @@ void CarlaEngine::saveProjectInternal(juce::MemoryOutputStream& outStream) const
             }
 
             outPatchbay << " </ExternalPatchbay>\n";
-            outStream << outPatchbay;
+            outFooter << outPatchbay;
         }
     }
 #endif
 
-    outStream << "</CARLA-PROJECT>\n";
+    outFooter << "</CARLA-PROJECT>\n";
+
+    return job.release();
+}
+
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// Check if an already loaded plugin can be reused for a project state
+
+static bool isPluginMatchingStateSave(CarlaPlugin* const plugin, const CarlaStateSave& stateSave)
+{
+    if (plugin->getType() != getPluginTypeFromString(stateSave.type))
+        return false;
+    if (plugin->getUniqueId() != stateSave.uniqueId)
+        return false;
+
+    const char* const filename(plugin->getFilename());
+
+    if (std::strcmp(filename != nullptr ? filename : "", stateSave.binary != nullptr ? stateSave.binary : "") != 0)
+        return false;
+
+    char strBuf[STR_MAX+1];
+    strBuf[0] = '\0';
+    plugin->getLabel(strBuf);
+
+    if (std::strcmp(strBuf, stateSave.label != nullptr ? stateSave.label : "") != 0)
+        return false;
+
+    // custom data cannot be reset, the new state must set every key the plugin already has
+    for (uint32_t i=0, count=plugin->getCustomDataCount(); i < count; ++i)
+    {
+        const CustomData& customData(plugin->getCustomData(i));
+        CARLA_SAFE_ASSERT_CONTINUE(customData.isValid());
+
+        bool found = false;
+
+        for (CarlaStateSave::CustomDataItenerator it = stateSave.customData.begin2(); it.valid(); it.next())
+        {
+            const CarlaStateSave::CustomData* const stateCustomData(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(stateCustomData != nullptr);
+            CARLA_SAFE_ASSERT_CONTINUE(stateCustomData->isValid());
+
+            if (std::strcmp(customData.type, stateCustomData->type) == 0 && std::strcmp(customData.key, stateCustomData->key) == 0)
+            {
+                found = true;
+                break;
+            }
+        }
+
+        if (! found)
+            return false;
+    }
+
+    return true;
 }
+#endif
 
-bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
+bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc, const bool reusePlugins, CarlaStateChunkStore* const chunkStore)
 {
     ScopedPointer<XmlElement> xmlElement(xmlDoc.getDocumentElement(true));
     CARLA_SAFE_ASSERT_RETURN_ERR(xmlElement != nullptr, "Failed to parse project file");
@@ -1778,6 +2738,11 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
                 option = ENGINE_OPTION_PREFER_PLUGIN_BRIDGES;
                 value  = text.equalsIgnoreCase("true") ? 1 : 0;
             }
+            else if (tag.equalsIgnoreCase("sharepluginbridges"))
+            {
+                option = ENGINE_OPTION_SHARE_PLUGIN_BRIDGES;
+                value  = text.equalsIgnoreCase("true") ? 1 : 0;
+            }
             else if (tag.equalsIgnoreCase("preferuibridges"))
             {
                 option = ENGINE_OPTION_PREFER_UI_BRIDGES;
@@ -1798,6 +2763,11 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
                 option = ENGINE_OPTION_UI_BRIDGES_TIMEOUT;
                 value  = text.getIntValue();
             }
+            else if (tag.equalsIgnoreCase("minsubblocksize"))
+            {
+                option = ENGINE_OPTION_MIN_SUB_BLOCK_SIZE;
+                value  = text.getIntValue();
+            }
             else if (isPlugin)
             {
                 /**/ if (tag.equalsIgnoreCase("LADSPA_PATH"))
@@ -1858,6 +2828,125 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
         break;
     }
 
+#ifndef BUILD_BRIDGE
+    // already loaded plugins matching a plugin state are reused, one per state, in the state order
+    const bool canReusePlugins(reusePlugins && ! isPreset);
+    Array<CarlaPlugin*> reusedPlugins;
+    uint placedPluginCount = 0;
+    int  stateIndex = 0;
+
+    if (canReusePlugins)
+    {
+        for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
+        {
+            if (! elem->getTagName().equalsIgnoreCase("plugin"))
+                continue;
+
+            CarlaStateSave stateSave;
+            stateSave.fillFromXmlElement(elem, chunkStore);
+
+            CarlaPlugin* reusedPlugin = nullptr;
+
+            if (stateSave.type != nullptr)
+            {
+                for (uint i=0; i < pData->curPluginCount; ++i)
+                {
+                    CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+                    if (plugin == nullptr || reusedPlugins.contains(plugin))
+                        continue;
+
+                    if (isPluginMatchingStateSave(plugin, stateSave))
+                    {
+                        reusedPlugin = plugin;
+                        break;
+                    }
+                }
+            }
+
+            // keep one entry per plugin state, even if not reused
+            reusedPlugins.add(reusedPlugin);
+        }
+
+        // remove plugins not present in the project before loading new ones
+        for (uint i=pData->curPluginCount; i > 0; --i)
+        {
+            if (! reusedPlugins.contains(pData->plugins[i-1].plugin))
+                removePlugin(i-1);
+        }
+    }
+#else
+    // unused
+    (void)reusePlugins;
+#endif
+
+    // find plugin binaries we can open in advance, while the previous plugins are being loaded
+    StringArray prewarmFilenames;
+    OwnedArray<PluginLibraryPrewarmThread> prewarmThreads;
+
+    if (! (isPreset || pData->options.preferPluginBridges))
+    {
+        for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
+        {
+            if (! elem->getTagName().equalsIgnoreCase("plugin"))
+                continue;
+
+            XmlElement* const xmlInfo(elem->getChildByName("Info"));
+
+            if (xmlInfo == nullptr)
+                continue;
+
+            const PluginType ptype(getPluginTypeFromString(xmlSafeString(xmlInfo->getChildElementAllSubText("Type", String()).trim(), false).toRawUTF8()));
+
+            String binary;
+
+            switch (ptype)
+            {
+            case PLUGIN_LADSPA:
+            case PLUGIN_DSSI:
+            case PLUGIN_VST2:
+                binary = xmlSafeString(xmlInfo->getChildElementAllSubText("Binary", String()).trim(), false);
+                break;
+            case PLUGIN_LV2: {
+                // projects only store the URI, lilv knows the binary
+                const String uri(xmlSafeString(xmlInfo->getChildElementAllSubText("URI", String()).trim(), false));
+
+                if (uri.isEmpty())
+                    break;
+
+                if (const char* const lv2Binary = CarlaPlugin::getLV2PluginBinary(this, uri.toRawUTF8()))
+                {
+                    binary = String::fromUTF8(lv2Binary);
+                    delete[] lv2Binary;
+                }
+                break;
+            }
+            default:
+                break;
+            }
+
+            if (binary.isEmpty())
+                continue;
+
+            if (! File::isAbsolutePath(binary) || ! File(binary).existsAsFile())
+                continue;
+            if (getBinaryTypeFromFile(binary.toRawUTF8()) != BINARY_NATIVE)
+                continue;
+
+            prewarmFilenames.addIfNotAlreadyThere(binary);
+        }
+
+        int numThreads = SystemStats::getNumCpus();
+
+        if (numThreads > prewarmFilenames.size())
+            numThreads = prewarmFilenames.size();
+        if (numThreads > kMaxLibraryPrewarmThreads)
+            numThreads = kMaxLibraryPrewarmThreads;
+
+        for (int i=0; i < numThreads; ++i)
+            prewarmThreads.add(new PluginLibraryPrewarmThread(prewarmFilenames, i, numThreads))->startThread();
+    }
+
     // handle plugins first
     for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
     {
@@ -1866,12 +2955,41 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
         if (isPreset || tagName.equalsIgnoreCase("plugin"))
         {
             CarlaStateSave stateSave;
-            stateSave.fillFromXmlElement(isPreset ? xmlElement.get() : elem);
+            stateSave.fillFromXmlElement(isPreset ? xmlElement.get() : elem, chunkStore);
 
             callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
 
+#ifndef BUILD_BRIDGE
+            CarlaPlugin* const reusedPlugin(canReusePlugins ? reusedPlugins[stateIndex++] : nullptr);
+#endif
+
             CARLA_SAFE_ASSERT_CONTINUE(stateSave.type != nullptr);
 
+#ifndef BUILD_BRIDGE
+            // same plugin as before, move it into place and only set what has changed
+            if (reusedPlugin != nullptr)
+            {
+                const uint id(placedPluginCount++);
+
+                if (reusedPlugin->getId() != id)
+                    switchPlugins(id, reusedPlugin->getId());
+
+                CARLA_SAFE_ASSERT(reusedPlugin->getId() == id);
+
+                if (stateSave.name != nullptr && stateSave.name[0] != '\0' && std::strcmp(reusedPlugin->getName(), stateSave.name) != 0)
+                {
+                    if (const char* const newName = CarlaEngine::renamePlugin(reusedPlugin->getId(), stateSave.name))
+                    {
+                        callback(ENGINE_CALLBACK_PLUGIN_RENAMED, reusedPlugin->getId(), 0, 0, 0.0f, newName);
+                        delete[] newName;
+                    }
+                }
+
+                reusedPlugin->loadStateSave(stateSave, true);
+                continue;
+            }
+#endif
+
             const void* extraStuff = nullptr;
 
             // check if using GIG or SF2 16outs
@@ -1893,6 +3011,15 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
                 if (CarlaPlugin* const plugin = getPlugin(pData->curPluginCount-1))
                 {
 #ifndef BUILD_BRIDGE
+                    // new plugins are added last, move them to their place between the reused ones
+                    if (canReusePlugins)
+                    {
+                        const uint id(placedPluginCount++);
+
+                        if (plugin->getId() != id)
+                            switchPlugins(id, plugin->getId());
+                    }
+
                     // deactivate bridge client-side ping check, since some plugins block during load
                     if ((plugin->getHints() & PLUGIN_IS_BRIDGE) != 0 && ! isPreset)
                         plugin->setCustomData(CUSTOM_DATA_TYPE_STRING, "__CarlaPingOnOff__", "false", false);
@@ -1910,6 +3037,15 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
             return true;
     }
 
+    // all plugins are loaded now, drop the extra references taken in advance
+    if (prewarmThreads.size() > 0)
+    {
+        for (int i=0, count=prewarmThreads.size(); i < count; ++i)
+            prewarmThreads[i]->stopThread(-1);
+
+        CarlaPlugin::releasePrewarmedLibraries();
+    }
+
 #ifndef BUILD_BRIDGE
     // tell bridges we're done loading
     for (uint i=0; i < pData->curPluginCount; ++i)
@@ -1926,6 +3062,22 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
     if (pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
     {
         const bool isUsingExternal(pData->graph.isUsingExternal());
+        const bool reuseConnections(reusePlugins && ! isUsingExternal);
+
+        // connections kept from reused plugins, stored as source and target pairs
+        StringArray oldConnections;
+
+        if (reuseConnections)
+        {
+            if (const char* const* const patchbayConns = getPatchbayConnections(false))
+            {
+                for (int i=0; patchbayConns[i] != nullptr && patchbayConns[i+1] != nullptr; ++i, ++i )
+                {
+                    oldConnections.add(String(CharPointer_UTF8(patchbayConns[i])));
+                    oldConnections.add(String(CharPointer_UTF8(patchbayConns[i+1])));
+                }
+            }
+        }
 
         for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = elem->getNextElement())
         {
@@ -1957,11 +3109,37 @@ bool CarlaEngine::loadProjectInternal(juce::XmlDocument& xmlDoc)
                         targetPort = xmlSafeString(text, false).toRawUTF8();
                 }
 
-                if (sourcePort.isNotEmpty() && targetPort.isNotEmpty())
-                    restorePatchbayConnection(false, sourcePort, targetPort, !isUsingExternal);
+                if (sourcePort.isEmpty() || targetPort.isEmpty())
+                    continue;
+
+                if (reuseConnections)
+                {
+                    bool alreadyConnected = false;
+
+                    for (int i=0; i+1 < oldConnections.size(); ++i, ++i)
+                    {
+                        if (oldConnections[i] != String(CharPointer_UTF8(sourcePort.buffer())))
+                            continue;
+                        if (oldConnections[i+1] != String(CharPointer_UTF8(targetPort.buffer())))
+                            continue;
+
+                        oldConnections.removeRange(i, 2);
+                        alreadyConnected = true;
+                        break;
+                    }
+
+                    if (alreadyConnected)
+                        continue;
+                }
+
+                restorePatchbayConnection(false, sourcePort, targetPort, !isUsingExternal);
             }
             break;
         }
+
+        // remove connections not present in the project
+        for (int i=0; i+1 < oldConnections.size(); ++i, ++i)
+            removePatchbayConnection(oldConnections[i].toRawUTF8(), oldConnections[i+1].toRawUTF8());
     }
 
     callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
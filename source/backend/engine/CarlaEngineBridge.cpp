@@ -27,6 +27,8 @@
 #include "CarlaBridgeUtils.hpp"
 #include "CarlaMIDI.h"
 
+#include "LinkedList.hpp"
+
 #include "jackbridge/JackBridge.hpp"
 
 using juce::File;
@@ -148,6 +150,8 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
 
         if (jackbridge_shm_map2<BridgeRtClientData>(shm, data))
         {
+            CarlaThread::lockMemory(data, sizeof(BridgeRtClientData));
+
             CARLA_SAFE_ASSERT(data->midiOut[0] == 0);
             setRingBuffer(&data->ringBuffer, false);
             return true;
@@ -375,7 +379,8 @@ public:
           fShmNonRtServerControl(),
           fIsOffline(false),
           fFirstIdle(true),
-          fLastPingTime(-1)
+          fLastPingTime(-1),
+          fChainedCount(0)
     {
         carla_stdout("CarlaEngineBridge::CarlaEngineBridge(\"%s\", \"%s\", \"%s\", \"%s\")", audioPoolBaseName, rtClientBaseName, nonRtClientBaseName, nonRtServerBaseName);
 
@@ -396,6 +401,7 @@ public:
     {
         carla_debug("CarlaEngineBridge::~CarlaEngineBridge()");
 
+        setChainable(false);
         clear();
     }
 
@@ -500,6 +506,7 @@ public:
             fShmNonRtServerControl.commitWrite();
         }
 
+        setChainable(true);
         startThread();
 
         return true;
@@ -510,6 +517,8 @@ public:
         carla_debug("CarlaEnginePlugin::close()");
         fLastPingTime = -1;
 
+        setChainable(false);
+
         CarlaEngine::close();
 
         stopThread(5000);
@@ -1138,12 +1147,18 @@ public:
 
             case kPluginBridgeNonRtClientShowUI:
                 if (plugin != nullptr && plugin->isEnabled())
+                {
                     plugin->showCustomUI(true);
+                    requestPluginIdle(plugin->getId());
+                }
                 break;
 
             case kPluginBridgeNonRtClientHideUI:
                 if (plugin != nullptr && plugin->isEnabled())
+                {
                     plugin->showCustomUI(false);
+                    requestPluginIdle(plugin->getId());
+                }
                 break;
 
             case kPluginBridgeNonRtClientUiParameterChange: {
@@ -1191,6 +1206,7 @@ public:
             }
 
             case kPluginBridgeNonRtClientQuit:
+                setChainable(false);
                 signalThreadShouldExit();
                 callback(ENGINE_CALLBACK_QUIT, 0, 0, 0, 0.0f, nullptr);
                 break;
@@ -1205,11 +1221,19 @@ protected:
     {
         bool timedOut = false;
         bool quitReceived = false;
+        uint32_t lastChainedCount = fChainedCount;
 
         for (; ! shouldThreadExit();)
         {
             if (! fShmRtClientControl.waitForServer(5))
             {
+                // the host is running us through another engine of the same shared bridge
+                if (lastChainedCount != fChainedCount)
+                {
+                    lastChainedCount = fChainedCount;
+                    continue;
+                }
+
                 // Give engine 1 more change to catch up.
                 if (! timedOut)
                 {
@@ -1227,300 +1251,414 @@ protected:
 
             timedOut = false;
 
-            for (; fShmRtClientControl.isDataAvailableForReading();)
-            {
-                const PluginBridgeRtClientOpcode opcode(fShmRtClientControl.readOpcode());
-                CarlaPlugin* const plugin(pData->plugins[0].plugin);
+            if (! handleRtData())
+                quitReceived = true;
+
+            fShmRtClientControl.postClient();
+        }
+
+        setChainable(false);
+        callback(ENGINE_CALLBACK_ENGINE_STOPPED, 0, 0, 0, 0.0f, nullptr);
+
+        if (! quitReceived)
+        {
+            const char* const message("Plugin bridge error, process thread has stopped");
+            const std::size_t messageSize(std::strlen(message));
+
+            const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
+            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerError);
+            fShmNonRtServerControl.writeUInt(messageSize);
+            fShmNonRtServerControl.writeCustomData(message, messageSize);
+            fShmNonRtServerControl.commitWrite();
+        }
+    }
+
+    // called from the process thread, or from the one of another engine when running a chain
+    // returns false if asked to quit
+    bool handleRtData()
+    {
+        bool quitReceived = false;
+
+        for (; fShmRtClientControl.isDataAvailableForReading();)
+        {
+            const PluginBridgeRtClientOpcode opcode(fShmRtClientControl.readOpcode());
+            CarlaPlugin* const plugin(pData->plugins[0].plugin);
 
 #ifdef DEBUG
-                if (opcode != kPluginBridgeRtClientProcess && opcode != kPluginBridgeRtClientMidiEvent) {
-                    carla_debug("CarlaEngineBridgeRtThread::run() - got opcode: %s", PluginBridgeRtClientOpcode2str(opcode));
-                }
+            if (opcode != kPluginBridgeRtClientProcess && opcode != kPluginBridgeRtClientProcessChain && opcode != kPluginBridgeRtClientMidiEvent) {
+                carla_debug("CarlaEngineBridge::handleRtData() - got opcode: %s", PluginBridgeRtClientOpcode2str(opcode));
+            }
 #endif
 
-                switch (opcode)
+            switch (opcode)
+            {
+            case kPluginBridgeRtClientNull:
+                break;
+
+            case kPluginBridgeRtClientSetAudioPool: {
+                const uint64_t poolSize(fShmRtClientControl.readULong());
+                CARLA_SAFE_ASSERT_BREAK(poolSize > 0);
+                fShmAudioPool.data = (float*)jackbridge_shm_map(fShmAudioPool.shm, static_cast<size_t>(poolSize));
+
+                if (fShmAudioPool.data != nullptr)
+                    CarlaThread::lockMemory(fShmAudioPool.data, static_cast<size_t>(poolSize));
+                break;
+            }
+
+            case kPluginBridgeRtClientSetRealtime: {
+                const int32_t  priority(fShmRtClientControl.readInt());
+                const uint64_t affinity(fShmRtClientControl.readULong());
+
+                if (! CarlaThread::setCurrentThreadRealtimePriority(priority))
+                    carla_stderr2("Bridge failed to set realtime priority %i", priority);
+
+                if (affinity != 0 && ! CarlaThread::setCurrentThreadAffinityMask(affinity))
+                    carla_stderr2("Bridge failed to set CPU affinity");
+
+                if (priority > 0)
+                    CarlaThread::prefaultCurrentThreadStack();
+                break;
+            }
+
+            case kPluginBridgeRtClientControlEventParameter: {
+                const uint32_t time(fShmRtClientControl.readUInt());
+                const uint8_t  channel(fShmRtClientControl.readByte());
+                const uint16_t param(fShmRtClientControl.readUShort());
+                const float    value(fShmRtClientControl.readFloat());
+
+                if (EngineEvent* const event = getNextFreeInputEvent())
                 {
-                case kPluginBridgeRtClientNull:
-                    break;
+                    event->type    = kEngineEventTypeControl;
+                    event->time    = time;
+                    event->channel = channel;
+                    event->ctrl.type  = kEngineControlEventTypeParameter;
+                    event->ctrl.param = param;
+                    event->ctrl.value = value;
+                }
+                break;
+            }
 
-                case kPluginBridgeRtClientSetAudioPool: {
-                    const uint64_t poolSize(fShmRtClientControl.readULong());
-                    CARLA_SAFE_ASSERT_BREAK(poolSize > 0);
-                    fShmAudioPool.data = (float*)jackbridge_shm_map(fShmAudioPool.shm, static_cast<size_t>(poolSize));
-                    break;
+            case kPluginBridgeRtClientControlEventMidiBank: {
+                const uint32_t time(fShmRtClientControl.readUInt());
+                const uint8_t  channel(fShmRtClientControl.readByte());
+                const uint16_t index(fShmRtClientControl.readUShort());
+
+                if (EngineEvent* const event = getNextFreeInputEvent())
+                {
+                    event->type    = kEngineEventTypeControl;
+                    event->time    = time;
+                    event->channel = channel;
+                    event->ctrl.type  = kEngineControlEventTypeMidiBank;
+                    event->ctrl.param = index;
+                    event->ctrl.value = 0.0f;
                 }
+                break;
+            }
 
-                case kPluginBridgeRtClientControlEventParameter: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
-                    const uint16_t param(fShmRtClientControl.readUShort());
-                    const float    value(fShmRtClientControl.readFloat());
+            case kPluginBridgeRtClientControlEventMidiProgram: {
+                const uint32_t time(fShmRtClientControl.readUInt());
+                const uint8_t  channel(fShmRtClientControl.readByte());
+                const uint16_t index(fShmRtClientControl.readUShort());
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeParameter;
-                        event->ctrl.param = param;
-                        event->ctrl.value = value;
-                    }
-                    break;
+                if (EngineEvent* const event = getNextFreeInputEvent())
+                {
+                    event->type    = kEngineEventTypeControl;
+                    event->time    = time;
+                    event->channel = channel;
+                    event->ctrl.type  = kEngineControlEventTypeMidiProgram;
+                    event->ctrl.param = index;
+                    event->ctrl.value = 0.0f;
                 }
+                break;
+            }
 
-                case kPluginBridgeRtClientControlEventMidiBank: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
-                    const uint16_t index(fShmRtClientControl.readUShort());
+            case kPluginBridgeRtClientControlEventAllSoundOff: {
+                const uint32_t time(fShmRtClientControl.readUInt());
+                const uint8_t  channel(fShmRtClientControl.readByte());
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeMidiBank;
-                        event->ctrl.param = index;
-                        event->ctrl.value = 0.0f;
-                    }
-                    break;
+                if (EngineEvent* const event = getNextFreeInputEvent())
+                {
+                    event->type    = kEngineEventTypeControl;
+                    event->time    = time;
+                    event->channel = channel;
+                    event->ctrl.type  = kEngineControlEventTypeAllSoundOff;
+                    event->ctrl.param = 0;
+                    event->ctrl.value = 0.0f;
                 }
+            }   break;
 
-                case kPluginBridgeRtClientControlEventMidiProgram: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
-                    const uint16_t index(fShmRtClientControl.readUShort());
+            case kPluginBridgeRtClientControlEventAllNotesOff: {
+                const uint32_t time(fShmRtClientControl.readUInt());
+                const uint8_t  channel(fShmRtClientControl.readByte());
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeMidiProgram;
-                        event->ctrl.param = index;
-                        event->ctrl.value = 0.0f;
-                    }
-                    break;
+                if (EngineEvent* const event = getNextFreeInputEvent())
+                {
+                    event->type    = kEngineEventTypeControl;
+                    event->time    = time;
+                    event->channel = channel;
+                    event->ctrl.type  = kEngineControlEventTypeAllNotesOff;
+                    event->ctrl.param = 0;
+                    event->ctrl.value = 0.0f;
                 }
+            }   break;
 
-                case kPluginBridgeRtClientControlEventAllSoundOff: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
+            case kPluginBridgeRtClientMidiEvent: {
+                const uint32_t time(fShmRtClientControl.readUInt());
+                const uint8_t  port(fShmRtClientControl.readByte());
+                const uint8_t  size(fShmRtClientControl.readByte());
+                CARLA_SAFE_ASSERT_BREAK(size > 0);
+
+                uint8_t data[size];
+
+                for (uint8_t i=0; i<size; ++i)
+                    data[i] = fShmRtClientControl.readByte();
+
+                if (EngineEvent* const event = getNextFreeInputEvent())
+                {
+                    event->type    = kEngineEventTypeMidi;
+                    event->time    = time;
+                    event->channel = MIDI_GET_CHANNEL_FROM_DATA(data);
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
+                    event->midi.port = port;
+                    event->midi.size = size;
+
+                    if (size > EngineMidiEvent::kDataSize)
                     {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeAllSoundOff;
-                        event->ctrl.param = 0;
-                        event->ctrl.value = 0.0f;
+                        event->midi.dataExt = data;
+                        std::memset(event->midi.data, 0, sizeof(uint8_t)*EngineMidiEvent::kDataSize);
                     }
-                }   break;
+                    else
+                    {
+                        event->midi.data[0] = MIDI_GET_STATUS_FROM_DATA(data);
 
-                case kPluginBridgeRtClientControlEventAllNotesOff: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  channel(fShmRtClientControl.readByte());
+                        uint8_t i=1;
+                        for (; i < size; ++i)
+                            event->midi.data[i] = data[i];
+                        for (; i < EngineMidiEvent::kDataSize; ++i)
+                            event->midi.data[i] = 0;
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeControl;
-                        event->time    = time;
-                        event->channel = channel;
-                        event->ctrl.type  = kEngineControlEventTypeAllNotesOff;
-                        event->ctrl.param = 0;
-                        event->ctrl.value = 0.0f;
+                        event->midi.dataExt = nullptr;
                     }
-                }   break;
+                }
+                break;
+            }
 
-                case kPluginBridgeRtClientMidiEvent: {
-                    const uint32_t time(fShmRtClientControl.readUInt());
-                    const uint8_t  port(fShmRtClientControl.readByte());
-                    const uint8_t  size(fShmRtClientControl.readByte());
-                    CARLA_SAFE_ASSERT_BREAK(size > 0);
+            case kPluginBridgeRtClientProcess:
+                processPlugin(plugin);
+                break;
 
-                    uint8_t data[size];
+            case kPluginBridgeRtClientProcessChain: {
+                processPlugin(plugin);
 
-                    for (uint8_t i=0; i<size; ++i)
-                        data[i] = fShmRtClientControl.readByte();
+                // run the following plugins of the same shared bridge, in order.
+                // the host runs the ones after a missing link by itself, they keep their data unread
+                const CarlaMutexTryLocker cmtl(sChainMutex);
 
-                    if (EngineEvent* const event = getNextFreeInputEvent())
-                    {
-                        event->type    = kEngineEventTypeMidi;
-                        event->time    = time;
-                        event->channel = MIDI_GET_CHANNEL_FROM_DATA(data);
+                CarlaEngineBridge* prev(cmtl.wasLocked() ? this : nullptr);
+                char rtClientId[6+1];
+                rtClientId[6] = '\0';
 
-                        event->midi.port = port;
-                        event->midi.size = size;
+                for (uint32_t i=0, count=fShmRtClientControl.readUInt(); i < count; ++i)
+                {
+                    fShmRtClientControl.readCustomData(rtClientId, 6);
 
-                        if (size > EngineMidiEvent::kDataSize)
-                        {
-                            event->midi.dataExt = data;
-                            std::memset(event->midi.data, 0, sizeof(uint8_t)*EngineMidiEvent::kDataSize);
-                        }
-                        else
-                        {
-                            event->midi.data[0] = MIDI_GET_STATUS_FROM_DATA(data);
+                    if (prev == nullptr)
+                        continue;
 
-                            uint8_t i=1;
-                            for (; i < size; ++i)
-                                event->midi.data[i] = data[i];
-                            for (; i < EngineMidiEvent::kDataSize; ++i)
-                                event->midi.data[i] = 0;
+                    CarlaEngineBridge* const next(getChainEngine(rtClientId));
 
-                            event->midi.dataExt = nullptr;
-                        }
-                    }
-                    break;
+                    if (next != nullptr)
+                        next->processChained(prev);
+
+                    prev = next;
                 }
+            }   break;
 
-                case kPluginBridgeRtClientProcess: {
-                    CARLA_SAFE_ASSERT_BREAK(fShmAudioPool.data != nullptr);
+            case kPluginBridgeRtClientQuit: {
+                quitReceived = true;
+                signalThreadShouldExit();
+            }   break;
+            }
+        }
 
-                    if (plugin != nullptr && plugin->isEnabled() && plugin->tryLock(false))
-                    {
-                        const BridgeTimeInfo& bridgeTimeInfo(fShmRtClientControl.data->timeInfo);
+        return ! quitReceived;
+    }
 
-                        const uint32_t audioInCount(plugin->getAudioInCount());
-                        const uint32_t audioOutCount(plugin->getAudioOutCount());
-                        const uint32_t cvInCount(plugin->getCVInCount());
-                        const uint32_t cvOutCount(plugin->getCVOutCount());
+    // called from the process thread, see handleRtData()
+    void processPlugin(CarlaPlugin* const plugin)
+    {
+        CARLA_SAFE_ASSERT_RETURN(fShmAudioPool.data != nullptr,);
 
-                        const float* audioIn[audioInCount];
-                        /* */ float* audioOut[audioOutCount];
-                        const float* cvIn[cvInCount];
-                        /* */ float* cvOut[cvOutCount];
+        const CarlaScopedDenormalsFlush sdf(pData->options.flushDenormals);
 
-                        float* fdata = fShmAudioPool.data;
+        if (plugin != nullptr && plugin->isEnabled() && plugin->tryLock(false))
+        {
+            const BridgeTimeInfo& bridgeTimeInfo(fShmRtClientControl.data->timeInfo);
 
-                        for (uint32_t i=0; i < audioInCount; ++i, fdata += pData->bufferSize)
-                            audioIn[i] = fdata;
-                        for (uint32_t i=0; i < audioOutCount; ++i, fdata += pData->bufferSize)
-                            audioOut[i] = fdata;
+            const uint32_t audioInCount(plugin->getAudioInCount());
+            const uint32_t audioOutCount(plugin->getAudioOutCount());
+            const uint32_t cvInCount(plugin->getCVInCount());
+            const uint32_t cvOutCount(plugin->getCVOutCount());
 
-                        for (uint32_t i=0; i < cvInCount; ++i, fdata += pData->bufferSize)
-                            cvIn[i] = fdata;
-                        for (uint32_t i=0; i < cvOutCount; ++i, fdata += pData->bufferSize)
-                            cvOut[i] = fdata;
+            const float* audioIn[audioInCount];
+            /* */ float* audioOut[audioOutCount];
+            const float* cvIn[cvInCount];
+            /* */ float* cvOut[cvOutCount];
 
-                        EngineTimeInfo& timeInfo(pData->timeInfo);
+            float* fdata = fShmAudioPool.data;
 
-                        timeInfo.playing = bridgeTimeInfo.playing;
-                        timeInfo.frame   = bridgeTimeInfo.frame;
-                        timeInfo.usecs   = bridgeTimeInfo.usecs;
-                        timeInfo.valid   = bridgeTimeInfo.valid;
+            for (uint32_t i=0; i < audioInCount; ++i, fdata += pData->bufferSize)
+                audioIn[i] = fdata;
+            for (uint32_t i=0; i < audioOutCount; ++i, fdata += pData->bufferSize)
+                audioOut[i] = fdata;
 
-                        if (timeInfo.valid & EngineTimeInfo::kValidBBT)
-                        {
-                            timeInfo.bbt.bar  = bridgeTimeInfo.bar;
-                            timeInfo.bbt.beat = bridgeTimeInfo.beat;
-                            timeInfo.bbt.tick = bridgeTimeInfo.tick;
+            for (uint32_t i=0; i < cvInCount; ++i, fdata += pData->bufferSize)
+                cvIn[i] = fdata;
+            for (uint32_t i=0; i < cvOutCount; ++i, fdata += pData->bufferSize)
+                cvOut[i] = fdata;
 
-                            timeInfo.bbt.beatsPerBar = bridgeTimeInfo.beatsPerBar;
-                            timeInfo.bbt.beatType    = bridgeTimeInfo.beatType;
+            EngineTimeInfo& timeInfo(pData->timeInfo);
 
-                            timeInfo.bbt.ticksPerBeat   = bridgeTimeInfo.ticksPerBeat;
-                            timeInfo.bbt.beatsPerMinute = bridgeTimeInfo.beatsPerMinute;
-                            timeInfo.bbt.barStartTick   = bridgeTimeInfo.barStartTick;
-                        }
+            timeInfo.playing = bridgeTimeInfo.playing;
+            timeInfo.frame   = bridgeTimeInfo.frame;
+            timeInfo.usecs   = bridgeTimeInfo.usecs;
+            timeInfo.valid   = bridgeTimeInfo.valid;
 
-                        plugin->initBuffers();
-                        plugin->process(audioIn, audioOut, cvIn, cvOut, pData->bufferSize);
-                        plugin->unlock();
-                    }
+            if (timeInfo.valid & EngineTimeInfo::kValidBBT)
+            {
+                timeInfo.bbt.bar  = bridgeTimeInfo.bar;
+                timeInfo.bbt.beat = bridgeTimeInfo.beat;
+                timeInfo.bbt.tick = bridgeTimeInfo.tick;
 
-                    uint8_t* midiData(fShmRtClientControl.data->midiOut);
-                    carla_zeroBytes(midiData, kBridgeRtClientDataMidiOutSize);
-                    std::size_t curMidiDataPos = 0;
+                timeInfo.bbt.beatsPerBar = bridgeTimeInfo.beatsPerBar;
+                timeInfo.bbt.beatType    = bridgeTimeInfo.beatType;
 
-                    if (pData->events.in[0].type != kEngineEventTypeNull)
-                        carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
+                timeInfo.bbt.ticksPerBeat   = bridgeTimeInfo.ticksPerBeat;
+                timeInfo.bbt.beatsPerMinute = bridgeTimeInfo.beatsPerMinute;
+                timeInfo.bbt.barStartTick   = bridgeTimeInfo.barStartTick;
+            }
 
-                    if (pData->events.out[0].type != kEngineEventTypeNull)
-                    {
-                        for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
-                        {
-                            const EngineEvent& event(pData->events.out[i]);
+            plugin->initBuffers();
+            plugin->process(audioIn, audioOut, cvIn, cvOut, pData->bufferSize);
+            plugin->unlock();
+        }
 
-                            if (event.type == kEngineEventTypeNull)
-                                break;
+        uint8_t* midiData(fShmRtClientControl.data->midiOut);
+        carla_zeroBytes(midiData, kBridgeRtClientDataMidiOutSize);
+        std::size_t curMidiDataPos = 0;
 
-                            if (event.type == kEngineEventTypeControl)
-                            {
-                                uint8_t size;
-                                uint8_t data[3];
-                                event.ctrl.convertToMidiData(event.channel, size, data);
-                                CARLA_SAFE_ASSERT_CONTINUE(size > 0 && size <= 3);
+        if (pData->events.in[0].type != kEngineEventTypeNull)
+            carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
 
-                                if (curMidiDataPos + 1U /* size*/ + 4U /* time */ + size >= kBridgeRtClientDataMidiOutSize)
-                                    break;
+        if (pData->events.out[0].type != kEngineEventTypeNull)
+        {
+            for (ushort i=0; i < kMaxEngineEventInternalCount; ++i)
+            {
+                const EngineEvent& event(pData->events.out[i]);
 
-                                // set size
-                                *midiData++ = size;
+                if (event.type == kEngineEventTypeNull)
+                    break;
 
-                                // set time
-                                *(uint32_t*)midiData = event.time;
-                                midiData = midiData + 4;
+                if (event.type == kEngineEventTypeControl)
+                {
+                    uint8_t size;
+                    uint8_t data[3];
+                    event.ctrl.convertToMidiData(event.channel, size, data);
+                    CARLA_SAFE_ASSERT_CONTINUE(size > 0 && size <= 3);
 
-                                // set data
-                                for (uint8_t j=0; j<size; ++j)
-                                    *midiData++ = data[j];
+                    if (curMidiDataPos + 1U /* size*/ + 4U /* time */ + size >= kBridgeRtClientDataMidiOutSize)
+                        break;
 
-                                curMidiDataPos += 1U /* size*/ + 4U /* time */ + size;
-                            }
-                            else if (event.type == kEngineEventTypeMidi)
-                            {
-                                const EngineMidiEvent& _midiEvent(event.midi);
+                    // set size
+                    *midiData++ = size;
 
-                                if (curMidiDataPos + 1 /* size*/ + 4 /* time */ + _midiEvent.size >= kBridgeRtClientDataMidiOutSize)
-                                    break;
+                    // set time
+                    *(uint32_t*)midiData = event.time;
+                    midiData = midiData + 4;
 
-                                const uint8_t* const _midiData(_midiEvent.dataExt != nullptr ? _midiEvent.dataExt : _midiEvent.data);
+                    // set data
+                    for (uint8_t j=0; j<size; ++j)
+                        *midiData++ = data[j];
 
-                                // set size
-                                *midiData++ = _midiEvent.size;
+                    curMidiDataPos += 1U /* size*/ + 4U /* time */ + size;
+                }
+                else if (event.type == kEngineEventTypeMidi)
+                {
+                    const EngineMidiEvent& _midiEvent(event.midi);
 
-                                // set time
-                                *(uint32_t*)midiData = event.time;
-                                midiData = midiData + 4;
+                    if (curMidiDataPos + 1 /* size*/ + 4 /* time */ + _midiEvent.size >= kBridgeRtClientDataMidiOutSize)
+                        break;
 
-                                // set data
-                                *midiData++ = uint8_t(_midiData[0] | (event.channel & MIDI_CHANNEL_BIT));
+                    const uint8_t* const _midiData(_midiEvent.dataExt != nullptr ? _midiEvent.dataExt : _midiEvent.data);
 
-                                for (uint8_t j=1; j<_midiEvent.size; ++j)
-                                    *midiData++ = _midiData[j];
+                    // set size
+                    *midiData++ = _midiEvent.size;
 
-                                curMidiDataPos += 1U /* size*/ + 4U /* time */ + _midiEvent.size;
-                            }
-                        }
+                    // set time
+                    *(uint32_t*)midiData = event.time;
+                    midiData = midiData + 4;
 
-                        carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
-                    }
+                    // set data
+                    *midiData++ = uint8_t(_midiData[0] | (event.channel & MIDI_CHANNEL_BIT));
 
-                }   break;
+                    for (uint8_t j=1; j<_midiEvent.size; ++j)
+                        *midiData++ = _midiData[j];
 
-                case kPluginBridgeRtClientQuit: {
-                    quitReceived = true;
-                    signalThreadShouldExit();
-                }   break;
+                    curMidiDataPos += 1U /* size*/ + 4U /* time */ + _midiEvent.size;
                 }
             }
 
-            fShmRtClientControl.postClient();
+            carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
         }
+    }
 
-        callback(ENGINE_CALLBACK_ENGINE_STOPPED, 0, 0, 0, 0.0f, nullptr);
+    // called from the process thread of the previous engine in a chain
+    void processChained(const CarlaEngineBridge* const prev)
+    {
+        CarlaPlugin* const plugin(pData->plugins[0].plugin);
+        CarlaPlugin* const prevPlugin(prev->pData->plugins[0].plugin);
 
-        if (! quitReceived)
+        // like in rack mode, the previous plugin outputs are this plugin inputs
+        if (plugin != nullptr && prevPlugin != nullptr && fShmAudioPool.data != nullptr && prev->fShmAudioPool.data != nullptr)
         {
-            const char* const message("Plugin bridge error, process thread has stopped");
-            const std::size_t messageSize(std::strlen(message));
+            CARLA_SAFE_ASSERT_RETURN(pData->bufferSize == prev->pData->bufferSize,);
 
-            const CarlaMutexLocker _cml(fShmNonRtServerControl.mutex);
-            fShmNonRtServerControl.writeOpcode(kPluginBridgeNonRtServerError);
-            fShmNonRtServerControl.writeUInt(messageSize);
-            fShmNonRtServerControl.writeCustomData(message, messageSize);
-            fShmNonRtServerControl.commitWrite();
+            const uint32_t bufferSize(pData->bufferSize);
+            const uint32_t prevAudioInCount(prevPlugin->getAudioInCount());
+            const uint32_t count(carla_minPositive(prevPlugin->getAudioOutCount(), plugin->getAudioInCount()));
+
+            for (uint32_t i=0; i < count; ++i)
+                carla_copyFloats(fShmAudioPool.data + (i * bufferSize),
+                                 prev->fShmAudioPool.data + ((prevAudioInCount + i) * bufferSize), bufferSize);
         }
+
+        handleRtData();
+        ++fChainedCount;
+    }
+
+    // must be called with sChainMutex locked
+    static CarlaEngineBridge* getChainEngine(const char* const rtClientId) noexcept
+    {
+        for (LinkedList<CarlaEngineBridge*>::Itenerator it = sChainEngines.begin2(); it.valid(); it.next())
+        {
+            CarlaEngineBridge* const engine(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(engine != nullptr);
+
+            if (engine->fShmRtClientControl.filename.endsWith(rtClientId))
+                return engine;
+        }
+
+        return nullptr;
+    }
+
+    void setChainable(const bool yesNo) noexcept
+    {
+        const CarlaMutexLocker cml(sChainMutex);
+
+        if (yesNo)
+            sChainEngines.append(this);
+        else
+            sChainEngines.removeOne(this);
     }
 
     // called from process thread above
@@ -1548,9 +1686,19 @@ private:
     bool fFirstIdle;
     int64_t fLastPingTime;
 
+    // times this engine was run by another one, see kPluginBridgeRtClientProcessChain
+    volatile uint32_t fChainedCount;
+
+    // engines of this process that can be run by each other
+    static CarlaMutex sChainMutex;
+    static LinkedList<CarlaEngineBridge*> sChainEngines;
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineBridge)
 };
 
+CarlaMutex CarlaEngineBridge::sChainMutex;
+LinkedList<CarlaEngineBridge*> CarlaEngineBridge::sChainEngines;
+
 // -----------------------------------------------------------------------
 
 CarlaEngine* CarlaEngine::newBridge(const char* const audioPoolBaseName, const char* const rtClientBaseName, const char* const nonRtClientBaseName, const char* const nonRtServerBaseName)
@@ -192,14 +192,23 @@ EngineOptions::EngineOptions() noexcept
 #endif
       forceStereo(false),
       preferPluginBridges(false),
+      sharePluginBridges(false),
 #ifdef CARLA_OS_WIN
       preferUiBridges(false),
 #else
       preferUiBridges(true),
 #endif
       uisAlwaysOnTop(true),
+      telemetry(false),
+      skipSilentPlugins(false),
+      flushDenormals(true),
+      antiDenormalOffset(false),
       maxParameters(MAX_DEFAULT_PARAMETERS),
       uiBridgesTimeout(4000),
+      minSubBlockSize(16),
+      callbackBatchInterval(0),
+      telemetryScopeSize(0),
+      silentPluginTail(5000),
       audioNumPeriods(2),
       audioBufferSize(512),
       audioSampleRate(44100),
@@ -552,6 +552,67 @@ bool ExternalGraph::getGroupAndPortIdFromFullName(const char* const fullPortName
     return false;
 }
 
+// -----------------------------------------------------------------------
+// Denormals
+
+// added to plugin inputs to keep feedback paths out of denormals, about -360 dBFS
+static const float kAntiDenormalOffset = 1.0e-18f;
+
+// -----------------------------------------------------------------------
+// Silent plugins
+
+// peaks below this are treated as silence, about -160 dBFS
+static const float kSilentPeakThreshold = 1.0e-8f;
+
+static inline
+bool isSilentPeak(const float peak) noexcept
+{
+    return peak < kSilentPeakThreshold;
+}
+
+static inline
+bool isSilentBuffer(const float* const buffer, const int frames) noexcept
+{
+    const juce::Range<float> range(FloatVectorOperations::findMinAndMax(buffer, frames));
+    return isSilentPeak(std::abs(range.getStart())) && isSilentPeak(std::abs(range.getEnd()));
+}
+
+/*
+ * Check if processing a plugin can be skipped for the current block.
+ * Needs its input to have been silent for longer than its tail, and its last block to have been silent too.
+ */
+static inline
+bool canSkipSilentPlugin(const EngineOptions& options, const double sampleRate, CarlaPlugin* const plugin,
+                         const EnginePluginData& pluginData, const bool inputIsSilent) noexcept
+{
+    if (! inputIsSilent || ! pluginData.silentOutput)
+        return false;
+
+    // generators can make sound on their own, and MIDI outputs may drive other plugins
+    if (plugin->getAudioInCount() == 0 && plugin->getMidiInCount() == 0)
+        return false;
+    if (plugin->getMidiOutCount() != 0)
+        return false;
+
+    uint32_t tailLength = plugin->getTailLengthInFrames();
+
+    if (tailLength == 0)
+        tailLength = static_cast<uint32_t>(sampleRate * options.silentPluginTail / 1000.0);
+
+    return pluginData.silentFrames >= tailLength;
+}
+
+static inline
+void updateSilentPlugin(EnginePluginData& pluginData, const bool inputIsSilent, const bool outputIsSilent, const uint32_t frames) noexcept
+{
+    pluginData.silentOutput = outputIsSilent;
+
+    if (! inputIsSilent)
+        pluginData.silentFrames = 0;
+    else if (pluginData.silentFrames <= UINT32_MAX - frames)
+        pluginData.silentFrames += frames;
+}
+
 // -----------------------------------------------------------------------
 // RackGraph Buffers
 
@@ -646,12 +707,102 @@ void RackGraph::Buffers::setBufferSize(const uint32_t bufferSize, const bool cre
 // -----------------------------------------------------------------------
 // RackGraph
 
+// -----------------------------------------------------------------------
+// RackGraph Latency
+
+RackGraph::Latency::Latency() noexcept
+    : total(0)
+{
+    carla_zeroPointers(plugins, MAX_RACK_PLUGINS);
+    carla_zeroStructs(frames, MAX_RACK_PLUGINS);
+    carla_zeroStructs(positions, MAX_RACK_PLUGINS);
+
+    for (uint i=0; i < MAX_RACK_PLUGINS; ++i)
+        carla_zeroPointers(buffers[i], 2);
+}
+
+RackGraph::Latency::~Latency() noexcept
+{
+    for (uint i=0; i < MAX_RACK_PLUGINS; ++i)
+    {
+        for (uint j=0; j < 2; ++j)
+        {
+            if (buffers[i][j] != nullptr)
+            {
+                delete[] buffers[i][j];
+                buffers[i][j] = nullptr;
+            }
+        }
+    }
+}
+
+void RackGraph::Latency::setDelay(const uint id, CarlaPlugin* const plugin, const uint32_t newFrames)
+{
+    CARLA_SAFE_ASSERT_RETURN(id < MAX_RACK_PLUGINS,);
+
+    for (uint j=0; j < 2; ++j)
+    {
+        if (buffers[id][j] != nullptr)
+        {
+            delete[] buffers[id][j];
+            buffers[id][j] = nullptr;
+        }
+    }
+
+    plugins[id]   = plugin;
+    frames[id]    = 0;
+    positions[id] = 0;
+
+    if (newFrames == 0)
+        return;
+
+    for (uint j=0; j < 2; ++j)
+    {
+        buffers[id][j] = new float[newFrames];
+        FloatVectorOperations::clear(buffers[id][j], static_cast<int>(newFrames));
+    }
+
+    frames[id] = newFrames;
+}
+
+void RackGraph::Latency::process(const uint id, CarlaPlugin* const plugin, float* const inBuf[2], const uint32_t bufFrames) noexcept
+{
+    if (id >= MAX_RACK_PLUGINS || plugins[id] != plugin || frames[id] == 0)
+        return;
+
+    const uint32_t size(frames[id]);
+    uint32_t pos = 0;
+
+    for (uint j=0; j < 2; ++j)
+    {
+        float* const delayBuf(buffers[id][j]);
+        float* const data(inBuf[j]);
+        pos = positions[id];
+
+        for (uint32_t k=0; k < bufFrames; ++k)
+        {
+            const float tmp(data[k]);
+            data[k] = delayBuf[pos];
+            delayBuf[pos] = tmp;
+
+            if (++pos == size)
+                pos = 0;
+        }
+    }
+
+    positions[id] = pos;
+}
+
+// -----------------------------------------------------------------------
+// RackGraph
+
 RackGraph::RackGraph(CarlaEngine* const engine, const uint32_t ins, const uint32_t outs) noexcept
     : extGraph(engine),
       inputs(ins),
       outputs(outs),
       isOffline(false),
       audioBuffers(),
+      latency(),
       kEngine(engine)
 {
     setBufferSize(engine->getBufferSize());
@@ -672,6 +823,55 @@ void RackGraph::setOffline(const bool offline) noexcept
     isOffline = offline;
 }
 
+bool RackGraph::updateLatency()
+{
+    // plugins run in series, so their latencies add up.
+    // the audio passed around plugins without audio inputs gets delayed to stay aligned with the plugin output.
+    uint32_t total = 0;
+
+    for (uint i=0, count=kEngine->getCurrentPluginCount(); i < MAX_RACK_PLUGINS; ++i)
+    {
+        CarlaPlugin* const plugin(i < count ? kEngine->getPluginUnchecked(i) : nullptr);
+        uint32_t delay = 0;
+
+        if (plugin != nullptr && plugin->isEnabled())
+        {
+            const uint32_t pluginLatency(plugin->getEngineClient()->getLatency());
+
+            total += pluginLatency;
+
+            if (plugin->getAudioInCount() == 0)
+                delay = pluginLatency;
+        }
+
+        if (latency.plugins[i] == plugin && latency.frames[i] == delay)
+            continue;
+
+        if (plugin != nullptr)
+        {
+            // blocking lock, the audio thread skips this plugin meanwhile
+            plugin->tryLock(true);
+
+            try {
+                latency.setDelay(i, plugin, delay);
+            } CARLA_SAFE_EXCEPTION("RackGraph::updateLatency");
+
+            plugin->unlock();
+        }
+        else
+        {
+            // no plugin here, so not in use by the audio thread
+            latency.setDelay(i, nullptr, 0);
+        }
+    }
+
+    if (latency.total == total)
+        return false;
+
+    latency.total = total;
+    return true;
+}
+
 bool RackGraph::connect(const uint groupA, const uint portA, const uint groupB, const uint portB) noexcept
 {
     return extGraph.connect(groupA, portA, groupB, portB, true);
@@ -775,9 +975,11 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
 
     const int iframes(static_cast<int>(frames));
 
-    // safe copy
-    float inBuf0[frames];
-    float inBuf1[frames];
+    // safe copy, using the preallocated scratch buffers
+    float* const inBuf0(audioBuffers.inBufTmp[0]);
+    float* const inBuf1(audioBuffers.inBufTmp[1]);
+    CARLA_SAFE_ASSERT_RETURN(inBuf0 != nullptr && inBuf1 != nullptr,);
+
     const float* inBuf[2] = { inBuf0, inBuf1 };
 
     // initialize audio inputs
@@ -795,6 +997,8 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
     uint32_t oldAudioOutCount = 0;
     uint32_t oldMidiOutCount  = 0;
     bool processed = false;
+    const bool skipSilent = data->options.skipSilentPlugins;
+    const bool antiDenormalOffset = data->options.antiDenormalOffset;
     juce::Range<float> range;
 
     // process plugins
@@ -838,9 +1042,56 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
         oldAudioOutCount = plugin->getAudioOutCount();
         oldMidiOutCount  = plugin->getMidiOutCount();
 
-        // process
-        plugin->initBuffers();
-        plugin->process(inBuf, outBuf, nullptr, nullptr, frames);
+        EnginePluginData& pluginData(data->plugins[i]);
+
+        if (antiDenormalOffset && oldAudioInCount > 0)
+        {
+            FloatVectorOperations::add(inBuf0, kAntiDenormalOffset, iframes);
+            FloatVectorOperations::add(inBuf1, kAntiDenormalOffset, iframes);
+        }
+
+        // set input peaks, plugins do not touch their inputs
+        if (oldAudioInCount > 0)
+        {
+            range = FloatVectorOperations::findMinAndMax(inBuf0, iframes);
+            pluginData.insPeak[0] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+
+            range = FloatVectorOperations::findMinAndMax(inBuf1, iframes);
+            pluginData.insPeak[1] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+        }
+        else
+        {
+            pluginData.insPeak[0] = 0.0f;
+            pluginData.insPeak[1] = 0.0f;
+        }
+
+        const bool inputIsSilent = skipSilent
+                                && isSilentPeak(pluginData.insPeak[0]) && isSilentPeak(pluginData.insPeak[1])
+                                && data->events.in[0].type == kEngineEventTypeNull
+                                && ! plugin->hasPendingProcessWork();
+
+        // process, unless silent for long enough, outputs are already zero
+        const bool skipped = canSkipSilentPlugin(data->options, data->sampleRate, plugin, pluginData, inputIsSilent);
+
+        if (! skipped)
+        {
+            plugin->initBuffers();
+            plugin->process(inBuf, outBuf, nullptr, nullptr, frames);
+        }
+
+        // check own output before the input is added to it
+        bool outputIsSilent = true;
+
+        if (skipSilent && ! skipped && oldAudioOutCount > 0 && oldAudioInCount == 0)
+            outputIsSilent = isSilentBuffer(outBuf[0], iframes) && isSilentBuffer(outBuf[1], iframes);
+
+        // delay audio passed around the plugin by its latency, needs to be done while the plugin is locked
+        if (oldAudioInCount == 0)
+        {
+            float* const inBufDelay[2] = { inBuf0, inBuf1 };
+            latency.process(i, plugin, inBufDelay, frames);
+        }
+
         plugin->unlock();
 
         // if plugin has no audio inputs, add input buffer
@@ -856,38 +1107,29 @@ void RackGraph::process(CarlaEngine::ProtectedData* const data, const float* inB
             FloatVectorOperations::copy(outBuf[1], outBuf[0], iframes);
         }
 
-        // set peaks
+        // set output peaks
+        if (oldAudioOutCount > 0)
         {
-            EnginePluginData& pluginData(data->plugins[i]);
+            range = FloatVectorOperations::findMinAndMax(outBuf[0], iframes);
+            pluginData.outsPeak[0] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
 
-            if (oldAudioInCount > 0)
-            {
-                range = FloatVectorOperations::findMinAndMax(inBuf0, iframes);
-                pluginData.insPeak[0] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+            range = FloatVectorOperations::findMinAndMax(outBuf[1], iframes);
+            pluginData.outsPeak[1] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
 
-                range = FloatVectorOperations::findMinAndMax(inBuf1, iframes);
-                pluginData.insPeak[1] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
-            }
-            else
-            {
-                pluginData.insPeak[0] = 0.0f;
-                pluginData.insPeak[1] = 0.0f;
-            }
+            if (oldAudioInCount > 0)
+                outputIsSilent = isSilentPeak(pluginData.outsPeak[0]) && isSilentPeak(pluginData.outsPeak[1]);
+        }
+        else
+        {
+            pluginData.outsPeak[0] = 0.0f;
+            pluginData.outsPeak[1] = 0.0f;
+        }
 
-            if (oldAudioOutCount > 0)
-            {
-                range = FloatVectorOperations::findMinAndMax(outBuf[0], iframes);
-                pluginData.outsPeak[0] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
+        if (skipSilent)
+            updateSilentPlugin(pluginData, inputIsSilent, outputIsSilent, frames);
 
-                range = FloatVectorOperations::findMinAndMax(outBuf[1], iframes);
-                pluginData.outsPeak[1] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
-            }
-            else
-            {
-                pluginData.outsPeak[0] = 0.0f;
-                pluginData.outsPeak[1] = 0.0f;
-            }
-        }
+        if (data->telemetry.isActive())
+            data->telemetry.processPlugin(i, plugin, outBuf, (oldAudioOutCount > 0) ? 2 : 0, frames);
 
         processed = true;
     }
@@ -914,12 +1156,12 @@ void RackGraph::processHelper(CarlaEngine::ProtectedData* const data, const floa
 
             if (noConnections)
             {
-                FloatVectorOperations::copy(audioBuffers.inBuf[0], inBuf[port], iframes);
+                FloatVectorOperations::copy(audioBuffers.inBuf[0], inBuf[port-1], iframes);
                 noConnections = false;
             }
             else
             {
-                FloatVectorOperations::add(audioBuffers.inBuf[0], inBuf[port], iframes);
+                FloatVectorOperations::add(audioBuffers.inBuf[0], inBuf[port-1], iframes);
             }
         }
 
@@ -1140,6 +1382,9 @@ public:
         setPlayConfigDetails(static_cast<int>(fPlugin->getAudioInCount()),
                              static_cast<int>(fPlugin->getAudioOutCount()),
                              getSampleRate(), getBlockSize());
+
+        // used by the graph for latency compensation
+        setLatencySamples(static_cast<int>(fPlugin->getEngineClient()->getLatency()));
     }
 
     ~CarlaPluginInstance() override
@@ -1211,6 +1456,8 @@ public:
 
         fPlugin->initBuffers();
 
+        bool hasEvents = false;
+
         if (CarlaEngineEventPort* const port = fPlugin->getDefaultEventInPort())
         {
             EngineEvent* const engineEvents(port->fBuffer);
@@ -1218,6 +1465,8 @@ public:
 
             carla_zeroStructs(engineEvents, kMaxEngineEventInternalCount);
             fillEngineEventsFromJuceMidiBuffer(engineEvents, midi);
+
+            hasEvents = (engineEvents[0].type != kEngineEventTypeNull);
         }
 
         midi.clear();
@@ -1240,13 +1489,41 @@ public:
             float outPeaks[2] = { 0.0f };
             juce::Range<float> range;
 
+            CarlaEngine::ProtectedData* const data(kEngine->pData);
+
+            if (data->options.antiDenormalOffset)
+            {
+                for (int i=static_cast<int>(fPlugin->getAudioInCount()); --i>=0;)
+                    FloatVectorOperations::add(audioBuffers[i], kAntiDenormalOffset, numSamples);
+            }
+
             for (int i=jmin(fPlugin->getAudioInCount(), 2U); --i>=0;)
             {
                 range = FloatVectorOperations::findMinAndMax(audioBuffers[i], numSamples);
                 inPeaks[i] = carla_maxLimited<float>(std::abs(range.getStart()), std::abs(range.getEnd()), 1.0f);
             }
 
-            fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr, static_cast<uint32_t>(numSamples));
+            EnginePluginData& pluginData(data->plugins[fPlugin->getId()]);
+            const bool skipSilent = data->options.skipSilentPlugins;
+
+            bool inputIsSilent = skipSilent && ! hasEvents && ! fPlugin->hasPendingProcessWork()
+                              && isSilentPeak(inPeaks[0]) && isSilentPeak(inPeaks[1]);
+
+            for (int i=2, count=static_cast<int>(fPlugin->getAudioInCount()); inputIsSilent && i<count; ++i)
+                inputIsSilent = isSilentBuffer(audioBuffers[i], numSamples);
+
+            // process, unless silent for long enough
+            const bool skipped = canSkipSilentPlugin(data->options, data->sampleRate, fPlugin, pluginData, inputIsSilent);
+
+            if (skipped)
+            {
+                for (int i=0; i<numChan; ++i)
+                    FloatVectorOperations::clear(audioBuffers[i], numSamples);
+            }
+            else
+            {
+                fPlugin->process(const_cast<const float**>(audioBuffers), audioBuffers, nullptr, nullptr, static_cast<uint32_t>(numSamples));
+            }
 
             for (int i=jmin(fPlugin->getAudioOutCount(), 2U); --i>=0;)
             {
@@ -1255,6 +1532,20 @@ public:
             }
 
             kEngine->setPluginPeaks(fPlugin->getId(), inPeaks, outPeaks);
+
+            if (skipSilent)
+            {
+                bool outputIsSilent = isSilentPeak(outPeaks[0]) && isSilentPeak(outPeaks[1]);
+
+                for (int i=2, count=static_cast<int>(fPlugin->getAudioOutCount()); outputIsSilent && i<count; ++i)
+                    outputIsSilent = isSilentBuffer(audioBuffers[i], numSamples);
+
+                updateSilentPlugin(pluginData, inputIsSilent, outputIsSilent, static_cast<uint32_t>(numSamples));
+            }
+
+            if (kEngine->pData->telemetry.isActive())
+                kEngine->pData->telemetry.processPlugin(fPlugin->getId(), fPlugin, audioBuffers,
+                                                        jmin(fPlugin->getAudioOutCount(), 2U), static_cast<uint32_t>(numSamples));
         }
         else
         {
@@ -1343,6 +1634,7 @@ PatchbayGraph::PatchbayGraph(CarlaEngine* const engine, const uint32_t ins, cons
       outputs(carla_fixedValue(0U, MAX_PATCHBAY_PLUGINS-2, outs)),
       retCon(),
       usingExternal(false),
+      latency(0),
       extGraph(engine),
       kEngine(engine)
 {
@@ -1432,6 +1724,49 @@ void PatchbayGraph::setOffline(const bool offline)
     graph.setNonRealtime(offline);
 }
 
+bool PatchbayGraph::updateLatency(const bool pluginsChanged)
+{
+    bool needsRebuild = false;
+
+    for (int i=0, count=pluginsChanged ? graph.getNumNodes() : 0; i < count; ++i)
+    {
+        AudioProcessorGraph::Node* const node(graph.getNode(i));
+        CARLA_SAFE_ASSERT_CONTINUE(node != nullptr);
+
+        if (! node->properties.getWithDefault("isPlugin", false))
+            continue;
+
+        CarlaPluginInstance* const instance((CarlaPluginInstance*)node->getProcessor());
+        CARLA_SAFE_ASSERT_CONTINUE(instance != nullptr);
+
+        CarlaPlugin* const plugin((CarlaPlugin*)instance->getPlatformSpecificData());
+
+        if (plugin == nullptr || ! plugin->isEnabled())
+            continue;
+
+        const int pluginLatency(static_cast<int>(plugin->getEngineClient()->getLatency()));
+
+        if (instance->getLatencySamples() == pluginLatency)
+            continue;
+
+        instance->setLatencySamples(pluginLatency);
+        needsRebuild = true;
+    }
+
+    // juce graph inserts delays where paths with different latencies merge, it swaps in the new ones when ready
+    if (needsRebuild)
+        graph.rebuild();
+
+    // the rebuild is async, and connection changes rebuild the graph too, so always check the total
+    const uint32_t newLatency(static_cast<uint32_t>(jmax(0, graph.getLatencySamples())));
+
+    if (latency == newLatency)
+        return false;
+
+    latency = newLatency;
+    return true;
+}
+
 void PatchbayGraph::addPlugin(CarlaPlugin* const plugin)
 {
     CARLA_SAFE_ASSERT_RETURN(plugin != nullptr,);
@@ -1483,6 +1818,30 @@ void PatchbayGraph::replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* con
         addNodeToPatchbay(newPlugin->getEngine(), node->nodeId, static_cast<int>(newPlugin->getId()), instance);
 }
 
+void PatchbayGraph::switchPlugins(CarlaPlugin* const pluginA, CarlaPlugin* const pluginB)
+{
+    CARLA_SAFE_ASSERT_RETURN(pluginA != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pluginB != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pluginA != pluginB,);
+    carla_debug("PatchbayGraph::switchPlugins(%p, %p)", pluginA, pluginB);
+
+    // nodes stay as they are, only their plugin Ids changed
+    AudioProcessorGraph::Node* const nodeA(graph.getNodeForId(pluginA->getPatchbayNodeId()));
+    CARLA_SAFE_ASSERT_RETURN(nodeA != nullptr,);
+
+    AudioProcessorGraph::Node* const nodeB(graph.getNodeForId(pluginB->getPatchbayNodeId()));
+    CARLA_SAFE_ASSERT_RETURN(nodeB != nullptr,);
+
+    nodeA->properties.set("pluginId", static_cast<int>(pluginA->getId()));
+    nodeB->properties.set("pluginId", static_cast<int>(pluginB->getId()));
+
+    if (! usingExternal)
+    {
+        kEngine->callback(ENGINE_CALLBACK_PATCHBAY_CLIENT_DATA_CHANGED, nodeA->nodeId, PATCHBAY_ICON_PLUGIN, static_cast<int>(pluginA->getId()), 0.0f, nullptr);
+        kEngine->callback(ENGINE_CALLBACK_PATCHBAY_CLIENT_DATA_CHANGED, nodeB->nodeId, PATCHBAY_ICON_PLUGIN, static_cast<int>(pluginB->getId()), 0.0f, nullptr);
+    }
+}
+
 void PatchbayGraph::removePlugin(CarlaPlugin* const plugin)
 {
     CARLA_SAFE_ASSERT_RETURN(plugin != nullptr,);
@@ -1961,6 +2320,40 @@ bool EngineInternalGraph::isReady() const noexcept
     return fIsReady;
 }
 
+uint32_t EngineInternalGraph::getLatency() const noexcept
+{
+    if (! fIsReady)
+        return 0;
+
+    if (fIsRack)
+    {
+        CARLA_SAFE_ASSERT_RETURN(fRack != nullptr, 0);
+        return fRack->latency.total;
+    }
+    else
+    {
+        CARLA_SAFE_ASSERT_RETURN(fPatchbay != nullptr, 0);
+        return fPatchbay->latency;
+    }
+}
+
+bool EngineInternalGraph::updateLatency(const bool pluginsChanged)
+{
+    if (! fIsReady)
+        return false;
+
+    if (fIsRack)
+    {
+        CARLA_SAFE_ASSERT_RETURN(fRack != nullptr, false);
+        return pluginsChanged && fRack->updateLatency();
+    }
+    else
+    {
+        CARLA_SAFE_ASSERT_RETURN(fPatchbay != nullptr, false);
+        return fPatchbay->updateLatency(pluginsChanged);
+    }
+}
+
 RackGraph* EngineInternalGraph::getRackGraph() const noexcept
 {
     CARLA_SAFE_ASSERT_RETURN(fIsRack, nullptr);
@@ -2012,6 +2405,12 @@ void EngineInternalGraph::replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugi
     fPatchbay->replacePlugin(oldPlugin, newPlugin);
 }
 
+void EngineInternalGraph::switchPlugins(CarlaPlugin* const pluginA, CarlaPlugin* const pluginB)
+{
+    CARLA_SAFE_ASSERT_RETURN(fPatchbay != nullptr,);
+    fPatchbay->switchPlugins(pluginA, pluginB);
+}
+
 void EngineInternalGraph::removePlugin(CarlaPlugin* const plugin)
 {
     CARLA_SAFE_ASSERT_RETURN(fPatchbay != nullptr,);
@@ -2178,6 +2577,43 @@ void CarlaEngine::restorePatchbayConnection(const bool external, const char* con
     }
 }
 
+void CarlaEngine::removePatchbayConnection(const char* const sourcePort, const char* const targetPort)
+{
+    CARLA_SAFE_ASSERT_RETURN(pData->graph.isReady(),);
+    CARLA_SAFE_ASSERT_RETURN(pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY,);
+    CARLA_SAFE_ASSERT_RETURN(sourcePort != nullptr && sourcePort[0] != '\0',);
+    CARLA_SAFE_ASSERT_RETURN(targetPort != nullptr && targetPort[0] != '\0',);
+    carla_debug("CarlaEngine::removePatchbayConnection(\"%s\", \"%s\")", sourcePort, targetPort);
+
+    PatchbayGraph* const graph = pData->graph.getPatchbayGraph();
+    CARLA_SAFE_ASSERT_RETURN(graph != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(! graph->usingExternal,);
+
+    uint groupA, portA;
+    uint groupB, portB;
+
+    if (! graph->getGroupAndPortIdFromFullName(false, sourcePort, groupA, portA))
+        return;
+    if (! graph->getGroupAndPortIdFromFullName(false, targetPort, groupB, portB))
+        return;
+
+    for (LinkedList<ConnectionToId>::Itenerator it=graph->connections.list.begin2(); it.valid(); it.next())
+    {
+        static const ConnectionToId fallback = { 0, 0, 0, 0, 0 };
+
+        const ConnectionToId& connectionToId(it.getValue(fallback));
+        CARLA_SAFE_ASSERT_CONTINUE(connectionToId.id > 0);
+
+        if (connectionToId.groupA != groupA || connectionToId.portA != portA)
+            continue;
+        if (connectionToId.groupB != groupB || connectionToId.portB != portB)
+            continue;
+
+        graph->disconnect(connectionToId.id);
+        return;
+    }
+}
+
 // -----------------------------------------------------------------------
 
 bool CarlaEngine::connectExternalGraphPort(const uint connectionType, const uint portId, const char* const portName)
@@ -118,12 +118,32 @@ struct RackGraph {
         CARLA_DECLARE_NON_COPY_CLASS(Buffers)
     } audioBuffers;
 
+    // delay lines for audio passed around plugins without audio inputs, indexed by plugin id.
+    // a delay line is only used and changed while its plugin is locked.
+    // MIDI events are not delayed.
+    struct Latency {
+        CarlaPlugin* plugins[MAX_RACK_PLUGINS];
+        uint32_t frames[MAX_RACK_PLUGINS];
+        uint32_t positions[MAX_RACK_PLUGINS];
+        float* buffers[MAX_RACK_PLUGINS][2];
+        uint32_t total;
+        Latency() noexcept;
+        ~Latency() noexcept;
+        void setDelay(const uint id, CarlaPlugin* const plugin, const uint32_t newFrames);
+        void process(const uint id, CarlaPlugin* const plugin, float* const inBuf[2], const uint32_t frames) noexcept;
+        CARLA_PREVENT_HEAP_ALLOCATION
+        CARLA_DECLARE_NON_COPY_CLASS(Latency)
+    } latency;
+
     RackGraph(CarlaEngine* const engine, const uint32_t inputs, const uint32_t outputs) noexcept;
     ~RackGraph() noexcept;
 
     void setBufferSize(const uint32_t bufferSize) noexcept;
     void setOffline(const bool offline) noexcept;
 
+    // main thread only, returns true if total latency changed
+    bool updateLatency();
+
     bool connect(const uint groupA, const uint portA, const uint groupB, const uint portB) noexcept;
     bool disconnect(const uint connectionId) noexcept;
     void refresh(const char* const deviceName);
@@ -153,6 +173,7 @@ struct PatchbayGraph {
     const uint32_t outputs;
     mutable CharStringListPtr retCon;
     bool usingExternal;
+    uint32_t latency;
 
     ExternalGraph extGraph;
 
@@ -163,8 +184,13 @@ struct PatchbayGraph {
     void setSampleRate(const double sampleRate);
     void setOffline(const bool offline);
 
+    // main thread only, returns true if total latency changed.
+    // the new delays only apply after the graph is rebuilt asynchronously, so the total is always checked.
+    bool updateLatency(const bool pluginsChanged);
+
     void addPlugin(CarlaPlugin* const plugin);
     void replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* const newPlugin);
+    void switchPlugins(CarlaPlugin* const pluginA, CarlaPlugin* const pluginB);
     void removePlugin(CarlaPlugin* const plugin);
     void removeAllPlugins();
 
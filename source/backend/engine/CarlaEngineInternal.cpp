@@ -17,6 +17,7 @@
 
 #include "CarlaEngineInternal.hpp"
 #include "CarlaPlugin.hpp"
+#include "CarlaMathUtils.hpp"
 
 CARLA_BACKEND_START_NAMESPACE
 
@@ -59,7 +60,8 @@ void EngineInternalEvents::clear() noexcept
 
 EngineInternalTime::EngineInternalTime() noexcept
     : playing(false),
-      frame(0) {}
+      frame(0),
+      cycle(0) {}
 
 // -----------------------------------------------------------------------
 // NextAction
@@ -90,6 +92,482 @@ void EngineNextAction::clearAndReset() noexcept
     mutex.unlock();
 }
 
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// StandbyPlugins
+
+EngineStandbyPlugins::EngineStandbyPlugins() noexcept
+    : plugins(nullptr),
+      count(0),
+      loading(false) {}
+
+EngineStandbyPlugins::~EngineStandbyPlugins() noexcept
+{
+    CARLA_SAFE_ASSERT(plugins == nullptr);
+    CARLA_SAFE_ASSERT(count == 0);
+    CARLA_SAFE_ASSERT(! loading);
+}
+
+// -----------------------------------------------------------------------
+// CallbackQueue
+
+EngineCallbackQueue::EngineCallbackQueue() noexcept
+    : lastBatchTime(0),
+      fWritePos(0),
+      fReadPos(0),
+      fOverflowed(false)
+{
+    carla_zeroStructs(fCells, kQueueSize);
+    carla_zeroStructs(fBatch, kQueueSize + MAX_PATCHBAY_PLUGINS*2);
+
+    for (uint i=0; i < kQueueSize; ++i)
+        fCells[i].sequence = i;
+}
+
+EngineCallbackQueue::~EngineCallbackQueue() noexcept
+{
+}
+
+bool EngineCallbackQueue::canQueue(const EngineCallbackOpcode action) noexcept
+{
+    switch (action)
+    {
+    case ENGINE_CALLBACK_PARAMETER_VALUE_CHANGED:
+    case ENGINE_CALLBACK_PARAMETER_DEFAULT_CHANGED:
+    case ENGINE_CALLBACK_PARAMETER_MIDI_CC_CHANGED:
+    case ENGINE_CALLBACK_PARAMETER_MIDI_CHANNEL_CHANGED:
+    case ENGINE_CALLBACK_PROGRAM_CHANGED:
+    case ENGINE_CALLBACK_MIDI_PROGRAM_CHANGED:
+    case ENGINE_CALLBACK_NOTE_ON:
+    case ENGINE_CALLBACK_NOTE_OFF:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool EngineCallbackQueue::push(const CarlaPlugin* const plugin, const EngineCallbackOpcode action, const uint pluginId,
+                               const int value1, const int value2, const float value3) noexcept
+{
+    uint pos(__atomic_load_n(&fWritePos, __ATOMIC_RELAXED));
+    Cell* cell;
+
+    for (;;)
+    {
+        cell = &fCells[pos & (kQueueSize-1)];
+
+        const int diff(static_cast<int>(__atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE) - pos));
+
+        if (diff == 0)
+        {
+            // claim this cell, pos is updated with the current value if another producer got it first
+            if (__atomic_compare_exchange_n(&fWritePos, &pos, pos+1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+                break;
+        }
+        else if (diff < 0)
+        {
+            // the consumer has not taken this cell yet
+            __atomic_store_n(&fOverflowed, true, __ATOMIC_RELEASE);
+            return false;
+        }
+        else
+        {
+            pos = __atomic_load_n(&fWritePos, __ATOMIC_RELAXED);
+        }
+    }
+
+    cell->plugin         = plugin;
+    cell->event.action   = action;
+    cell->event.pluginId = pluginId;
+    cell->event.value1   = value1;
+    cell->event.value2   = value2;
+    cell->event.value3   = value3;
+
+    __atomic_store_n(&cell->sequence, pos+1, __ATOMIC_RELEASE);
+    return true;
+}
+
+uint EngineCallbackQueue::takeBatch(const EnginePluginData* const plugins, const uint pluginCount) noexcept
+{
+    // taken before the queue is read, anything dropped after this goes into the next batch
+    const bool overflowed(__atomic_exchange_n(&fOverflowed, false, __ATOMIC_ACQ_REL));
+
+    uint count = 0;
+    bool slotsCleared = false;
+
+    // producers keep pushing while the queue is read, stop after one full round
+    for (uint i=0; i < kQueueSize; ++i, ++fReadPos)
+    {
+        Cell& cell(fCells[fReadPos & (kQueueSize-1)]);
+
+        if (__atomic_load_n(&cell.sequence, __ATOMIC_ACQUIRE) != fReadPos+1)
+            break;
+
+        EngineCallbackEvent event(cell.event);
+        const CarlaPlugin* const plugin(cell.plugin);
+
+        // give the cell back to producers, for the next round
+        __atomic_store_n(&cell.sequence, fReadPos+kQueueSize, __ATOMIC_RELEASE);
+
+        // plugin was removed or switched since queued
+        if (event.pluginId >= pluginCount || plugins[event.pluginId].plugin != plugin)
+        {
+            uint j=0;
+
+            for (; j < pluginCount; ++j)
+            {
+                if (plugins[j].plugin == plugin)
+                    break;
+            }
+
+            if (plugin == nullptr || j == pluginCount)
+                continue;
+
+            event.pluginId = j;
+        }
+
+        // notes are never coalesced, parameter changes by parameter, programs by plugin
+        int* slot = nullptr;
+
+        if (event.action != ENGINE_CALLBACK_NOTE_ON && event.action != ENGINE_CALLBACK_NOTE_OFF)
+        {
+            if (! slotsCleared)
+            {
+                for (uint j=0; j < kCoalesceSlotCount; ++j)
+                    fCoalesceSlots[j] = -1;
+                slotsCleared = true;
+            }
+
+            const bool isParameter(event.action != ENGINE_CALLBACK_PROGRAM_CHANGED && event.action != ENGINE_CALLBACK_MIDI_PROGRAM_CHANGED);
+            const int  keyValue(isParameter ? event.value1 : 0);
+
+            uint hash = static_cast<uint>(event.action);
+            hash = hash * 31 + event.pluginId;
+            hash = hash * 31 + static_cast<uint>(keyValue);
+
+            slot = &fCoalesceSlots[hash % kCoalesceSlotCount];
+
+            // different keys can share a slot, those are just not coalesced
+            if (*slot >= 0)
+            {
+                EngineCallbackEvent& old(fBatch[*slot]);
+
+                if (old.action == event.action && old.pluginId == event.pluginId && (! isParameter || old.value1 == event.value1))
+                {
+                    old = event;
+                    continue;
+                }
+            }
+        }
+
+        fBatch[count] = event;
+
+        if (slot != nullptr)
+            *slot = static_cast<int>(count);
+
+        ++count;
+    }
+
+    if (overflowed)
+    {
+        carla_stderr2("EngineCallbackQueue::takeBatch() - queue was full, callbacks were dropped");
+
+        // let the host read the current values again
+        for (uint i=0; i < pluginCount && i < MAX_PATCHBAY_PLUGINS; ++i)
+        {
+            if (plugins[i].plugin == nullptr)
+                continue;
+
+            EngineCallbackEvent& params(fBatch[count++]);
+            params.action   = ENGINE_CALLBACK_RELOAD_PARAMETERS;
+            params.pluginId = i;
+            params.value1   = 0;
+            params.value2   = 0;
+            params.value3   = 0.0f;
+
+            EngineCallbackEvent& programs(fBatch[count++]);
+            programs.action   = ENGINE_CALLBACK_RELOAD_PROGRAMS;
+            programs.pluginId = i;
+            programs.value1   = 0;
+            programs.value2   = 0;
+            programs.value3   = 0.0f;
+        }
+    }
+
+    return count;
+}
+
+const EngineCallbackEvent* EngineCallbackQueue::getBatch() const noexcept
+{
+    return fBatch;
+}
+
+void EngineCallbackQueue::clear() noexcept
+{
+    for (;; ++fReadPos)
+    {
+        Cell& cell(fCells[fReadPos & (kQueueSize-1)]);
+
+        if (__atomic_load_n(&cell.sequence, __ATOMIC_ACQUIRE) != fReadPos+1)
+            break;
+
+        __atomic_store_n(&cell.sequence, fReadPos+kQueueSize, __ATOMIC_RELEASE);
+    }
+
+    __atomic_store_n(&fOverflowed, false, __ATOMIC_RELEASE);
+}
+
+// -----------------------------------------------------------------------
+// Telemetry
+
+#ifdef CARLA_OS_WIN
+# define ENGINE_TELEMETRY_NAMEPREFIX "Local\\carla-telemetry_"
+#else
+# define ENGINE_TELEMETRY_NAMEPREFIX "/carla-telemetry_"
+#endif
+
+static const uint32_t kTelemetryScopeDecimation = 32;
+
+EngineTelemetry::EngineTelemetry() noexcept
+    : fFilename(),
+      fSize(0),
+      fHeader(nullptr),
+      fPlugins(nullptr),
+      fScopes(nullptr),
+      fStates(nullptr),
+      fMaxPluginCount(0),
+      fScopeSize(0),
+      fPublishedCount(0)
+{
+    carla_shm_init(fShm);
+}
+
+EngineTelemetry::~EngineTelemetry() noexcept
+{
+    // should be closed by now
+    CARLA_SAFE_ASSERT(fHeader == nullptr);
+
+    close();
+}
+
+bool EngineTelemetry::init(const uint maxPluginCount, const uint scopeSize) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(fHeader == nullptr, false);
+    CARLA_SAFE_ASSERT_RETURN(maxPluginCount > 0, false);
+
+    try {
+        fStates = new PluginState[maxPluginCount];
+    } CARLA_SAFE_EXCEPTION_RETURN("EngineTelemetry::init", false);
+
+    carla_zeroStructs(fStates, maxPluginCount);
+
+    char tmpFileBase[64];
+    std::sprintf(tmpFileBase, ENGINE_TELEMETRY_NAMEPREFIX "XXXXXX");
+
+    fShm = carla_shm_create_temp(tmpFileBase);
+
+    if (! carla_is_shm_valid(fShm))
+    {
+        close();
+        return false;
+    }
+
+    fSize = sizeof(EngineTelemetryHeader)
+          + sizeof(EngineTelemetryPlugin) * maxPluginCount
+          + sizeof(float) * 2 * scopeSize * maxPluginCount;
+
+    uint8_t* const data(static_cast<uint8_t*>(carla_shm_map(fShm, fSize)));
+
+    if (data == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    std::memset(data, 0, fSize);
+
+    fHeader  = reinterpret_cast<EngineTelemetryHeader*>(data);
+    fPlugins = reinterpret_cast<EngineTelemetryPlugin*>(data + sizeof(EngineTelemetryHeader));
+    fScopes  = (scopeSize > 0) ? reinterpret_cast<float*>(fPlugins + maxPluginCount) : nullptr;
+
+    fMaxPluginCount = maxPluginCount;
+    fScopeSize      = scopeSize;
+    fPublishedCount = 0;
+
+    fHeader->version         = ENGINE_TELEMETRY_VERSION;
+    fHeader->maxPluginCount  = maxPluginCount;
+    fHeader->scopeSize       = scopeSize;
+    fHeader->scopeDecimation = kTelemetryScopeDecimation;
+
+    // readers check this before anything else
+    __atomic_store_n(&fHeader->magic, ENGINE_TELEMETRY_MAGIC, __ATOMIC_RELEASE);
+
+    // the audio thread writes to all of it, don't let it page fault
+    CarlaThread::lockMemory(data, fSize);
+
+    fFilename = tmpFileBase;
+    return true;
+}
+
+void EngineTelemetry::close() noexcept
+{
+    fFilename.clear();
+
+    if (fHeader != nullptr)
+    {
+        CarlaThread::unlockMemory(fHeader, fSize);
+        carla_shm_unmap(fShm, fHeader);
+
+        fHeader  = nullptr;
+        fPlugins = nullptr;
+        fScopes  = nullptr;
+    }
+
+    if (carla_is_shm_valid(fShm))
+        carla_shm_close(fShm);
+
+    if (fStates != nullptr)
+    {
+        delete[] fStates;
+        fStates = nullptr;
+    }
+
+    fSize           = 0;
+    fMaxPluginCount = 0;
+    fScopeSize      = 0;
+    fPublishedCount = 0;
+}
+
+const char* EngineTelemetry::getFilename() const noexcept
+{
+    return fFilename.buffer();
+}
+
+void EngineTelemetry::resetPlugin(const uint pluginId, const CarlaPlugin* const plugin) noexcept
+{
+    PluginState& state(fStates[pluginId]);
+
+    carla_zeroStruct(state);
+    state.plugin = plugin;
+
+    if (fScopeSize > 0)
+        carla_zeroFloats(fScopes + pluginId * 2 * fScopeSize, 2 * fScopeSize);
+}
+
+void EngineTelemetry::processPlugin(const uint pluginId, const CarlaPlugin* const plugin,
+                                    const float* const* const outBuf, const uint32_t outCount, const uint32_t frames) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(fHeader != nullptr,);
+    CARLA_SAFE_ASSERT_RETURN(pluginId < fMaxPluginCount,);
+    CARLA_SAFE_ASSERT_RETURN(frames > 0,);
+
+    PluginState& state(fStates[pluginId]);
+
+    // plugin was added, removed or switched since the last block
+    if (state.plugin != plugin)
+        resetPlugin(pluginId, plugin);
+
+    const uint32_t channels(std::min<uint32_t>(outCount, 2));
+
+    for (uint32_t c=0; c < 2; ++c)
+    {
+        if (c >= channels)
+        {
+            state.outsRms[c] = 0.0f;
+            continue;
+        }
+
+        const float* const buf(outBuf[c]);
+        float sum = 0.0f;
+
+        for (uint32_t i=0; i < frames; ++i)
+            sum += buf[i] * buf[i];
+
+        state.outsRms[c] = std::sqrt(sum / static_cast<float>(frames));
+    }
+
+    if (fScopeSize == 0)
+        return;
+
+    float* const scope(fScopes + pluginId * 2 * fScopeSize);
+
+    for (uint32_t i=0; i < frames; ++i)
+    {
+        for (uint32_t c=0; c < channels; ++c)
+        {
+            const float value(outBuf[c][i]);
+
+            if (std::abs(value) > std::abs(state.scopeValue[c]))
+                state.scopeValue[c] = value;
+        }
+
+        if (++state.scopeFrames < kTelemetryScopeDecimation)
+            continue;
+
+        const uint32_t index(state.scopePosition % fScopeSize);
+
+        scope[index]              = state.scopeValue[0];
+        scope[fScopeSize + index] = state.scopeValue[1];
+
+        state.scopeValue[0] = 0.0f;
+        state.scopeValue[1] = 0.0f;
+        state.scopeFrames   = 0;
+        ++state.scopePosition;
+    }
+}
+
+void EngineTelemetry::publish(const EnginePluginData* const plugins, const uint pluginCount,
+                              const uint32_t bufferSize, const double sampleRate) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(fHeader != nullptr,);
+
+    const uint count(std::min(pluginCount, fMaxPluginCount));
+    const uint32_t sequence(fHeader->sequence);
+
+    // odd sequence while writing, readers retry
+    __atomic_store_n(&fHeader->sequence, sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    fHeader->pluginCount      = count;
+    fHeader->bufferSize       = bufferSize;
+    fHeader->sampleRate       = sampleRate;
+    fHeader->processedFrames += bufferSize;
+
+    for (uint i=0; i < count; ++i)
+    {
+        const EnginePluginData& pluginData(plugins[i]);
+        EngineTelemetryPlugin&  telemetryData(fPlugins[i]);
+
+        if (pluginData.plugin == nullptr)
+        {
+            carla_zeroStruct(telemetryData);
+            continue;
+        }
+
+        // rms and scope belong to another plugin if it was not processed since its id changed
+        const PluginState& state(fStates[i]);
+        const bool sameState(state.plugin == pluginData.plugin);
+
+        telemetryData.present       = 1;
+        telemetryData.scopePosition = sameState ? state.scopePosition : 0;
+        telemetryData.insPeak[0]    = pluginData.insPeak[0];
+        telemetryData.insPeak[1]    = pluginData.insPeak[1];
+        telemetryData.outsPeak[0]   = pluginData.outsPeak[0];
+        telemetryData.outsPeak[1]   = pluginData.outsPeak[1];
+        telemetryData.outsRms[0]    = sameState ? state.outsRms[0] : 0.0f;
+        telemetryData.outsRms[1]    = sameState ? state.outsRms[1] : 0.0f;
+    }
+
+    // slots of removed plugins
+    for (uint i=count; i < fPublishedCount; ++i)
+        carla_zeroStruct(fPlugins[i]);
+
+    fPublishedCount = count;
+
+    __atomic_store_n(&fHeader->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+#endif
+
 // -----------------------------------------------------------------------
 // CarlaEngine::ProtectedData
 
@@ -101,6 +579,14 @@ CarlaEngine::ProtectedData::ProtectedData(CarlaEngine* const engine) noexcept
 #endif
       callback(nullptr),
       callbackPtr(nullptr),
+#ifndef BUILD_BRIDGE
+      batchCallback(nullptr),
+      batchCallbackPtr(nullptr),
+      callbackQueue(),
+      telemetry(),
+      standby(),
+      saveJob(nullptr),
+#endif
       fileCallback(nullptr),
       fileCallbackPtr(nullptr),
       hints(0x0),
@@ -122,6 +608,7 @@ CarlaEngine::ProtectedData::ProtectedData(CarlaEngine* const engine) noexcept
       events(),
 #ifndef BUILD_BRIDGE
       graph(engine),
+      latencyUpdatePending(false),
 #endif
       time(),
       nextAction()
@@ -139,6 +626,8 @@ CarlaEngine::ProtectedData::~ProtectedData() noexcept
     CARLA_SAFE_ASSERT(isIdling == 0);
 #ifndef BUILD_BRIDGE
     CARLA_SAFE_ASSERT(plugins == nullptr);
+    CARLA_SAFE_ASSERT(standby.plugins == nullptr);
+    CARLA_SAFE_ASSERT(saveJob == nullptr);
 #endif
 }
 
@@ -207,8 +696,18 @@ bool CarlaEngine::ProtectedData::init(const char* const clientName)
 #ifndef BUILD_BRIDGE
     plugins = new EnginePluginData[maxPluginNumber];
     carla_zeroStructs(plugins, maxPluginNumber);
+
+    standby.plugins = new CarlaPlugin*[maxPluginNumber];
+    carla_zeroPointers(standby.plugins, maxPluginNumber);
+
+    // not fatal, the engine works the same without it
+    if (options.telemetry && ! telemetry.init(maxPluginNumber, options.telemetryScopeSize))
+        carla_stderr("Failed to create engine telemetry shared memory, continuing without it");
 #endif
 
+    // juce reads the cpu features on first use of its vector operations, make sure it doesn't happen in the audio thread
+    juce::SystemStats::hasSSE2();
+
     nextAction.ready();
     thread.startThread();
 
@@ -243,12 +742,65 @@ void CarlaEngine::ProtectedData::close()
         delete[] plugins;
         plugins = nullptr;
     }
+
+    CARLA_SAFE_ASSERT(standby.count == 0);
+
+    if (standby.plugins != nullptr)
+    {
+        delete[] standby.plugins;
+        standby.plugins = nullptr;
+    }
+
+    // anything left is about removed plugins
+    callbackQueue.clear();
+
+    telemetry.close();
 #endif
 
     events.clear();
     name.clear();
 }
 
+#ifndef BUILD_BRIDGE
+void CarlaEngine::ProtectedData::deliverQueuedCallbacks(const bool force) noexcept
+{
+    if (! force)
+    {
+        const uint32_t now(juce::Time::getMillisecondCounter());
+
+        if (now - callbackQueue.lastBatchTime < options.callbackBatchInterval)
+            return;
+
+        callbackQueue.lastBatchTime = now;
+    }
+
+    const uint count(callbackQueue.takeBatch(plugins, curPluginCount));
+
+    if (count == 0)
+        return;
+
+    const EngineCallbackEvent* const events(callbackQueue.getBatch());
+
+    if (batchCallback != nullptr)
+    {
+        try {
+            batchCallback(batchCallbackPtr, events, count);
+        } CARLA_SAFE_EXCEPTION("batchCallback");
+    }
+    else if (callback != nullptr)
+    {
+        for (uint i=0; i < count; ++i)
+        {
+            const EngineCallbackEvent& event(events[i]);
+
+            try {
+                callback(callbackPtr, event.action, event.pluginId, event.value1, event.value2, event.value3, nullptr);
+            } CARLA_SAFE_EXCEPTION_CONTINUE("callback");
+        }
+    }
+}
+#endif
+
 // -----------------------------------------------------------------------
 
 #ifndef BUILD_BRIDGE
@@ -272,6 +824,8 @@ void CarlaEngine::ProtectedData::doPluginRemove() noexcept
         plugins[i].insPeak[1]  = 0.0f;
         plugins[i].outsPeak[0] = 0.0f;
         plugins[i].outsPeak[1] = 0.0f;
+        plugins[i].silentFrames = 0;
+        plugins[i].silentOutput = false;
     }
 
     const uint id(curPluginCount);
@@ -282,6 +836,8 @@ void CarlaEngine::ProtectedData::doPluginRemove() noexcept
     plugins[id].insPeak[1]  = 0.0f;
     plugins[id].outsPeak[0] = 0.0f;
     plugins[id].outsPeak[1] = 0.0f;
+    plugins[id].silentFrames = 0;
+    plugins[id].silentOutput = false;
 }
 
 void CarlaEngine::ProtectedData::doPluginsSwitch() noexcept
@@ -304,6 +860,49 @@ void CarlaEngine::ProtectedData::doPluginsSwitch() noexcept
     plugins[idA].plugin = plugins[idB].plugin;
     plugins[idB].plugin = tmp;
 #endif
+
+    plugins[idA].plugin->setId(idA);
+    plugins[idB].plugin->setId(idB);
+
+    // silence state belongs to the plugins, start over
+    plugins[idA].silentFrames = 0;
+    plugins[idA].silentOutput = false;
+    plugins[idB].silentFrames = 0;
+    plugins[idB].silentOutput = false;
+}
+
+void CarlaEngine::ProtectedData::doStandbySwitch() noexcept
+{
+    const uint liveCount(curPluginCount);
+    const uint standbyCount(standby.count);
+
+    CARLA_SAFE_ASSERT_RETURN(liveCount <= maxPluginNumber,);
+    CARLA_SAFE_ASSERT_RETURN(standbyCount <= maxPluginNumber,);
+
+    // live plugins become standby and vice-versa
+    for (uint i=0, count=std::max(liveCount, standbyCount); i < count; ++i)
+    {
+        CarlaPlugin* const livePlugin(i < liveCount ? plugins[i].plugin : nullptr);
+        CarlaPlugin* const standbyPlugin(i < standbyCount ? standby.plugins[i] : nullptr);
+
+        if (livePlugin != nullptr)
+            livePlugin->setId(maxPluginNumber + i);
+        if (standbyPlugin != nullptr)
+            standbyPlugin->setId(i);
+
+        plugins[i].plugin      = standbyPlugin;
+        plugins[i].insPeak[0]  = 0.0f;
+        plugins[i].insPeak[1]  = 0.0f;
+        plugins[i].outsPeak[0] = 0.0f;
+        plugins[i].outsPeak[1] = 0.0f;
+        plugins[i].silentFrames = 0;
+        plugins[i].silentOutput = false;
+
+        standby.plugins[i] = livePlugin;
+    }
+
+    curPluginCount = standbyCount;
+    standby.count  = liveCount;
 }
 #endif
 
@@ -323,6 +922,9 @@ void CarlaEngine::ProtectedData::doNextPluginAction(const bool unlock) noexcept
     case kEnginePostActionSwitchPlugins:
         doPluginsSwitch();
         break;
+    case kEnginePostActionSwitchStandby:
+        doStandbySwitch();
+        break;
 #endif
     }
 
@@ -341,12 +943,21 @@ void CarlaEngine::ProtectedData::doNextPluginAction(const bool unlock) noexcept
 // PendingRtEventsRunner
 
 PendingRtEventsRunner::PendingRtEventsRunner(CarlaEngine* const engine) noexcept
-    : pData(engine->pData) {}
+    : rtAuditMarker(),
+      denormalsFlush(engine->pData->options.flushDenormals),
+      pData(engine->pData) {}
 
 PendingRtEventsRunner::~PendingRtEventsRunner() noexcept
 {
     pData->doNextPluginAction(true);
 
+#ifndef BUILD_BRIDGE
+    if (pData->telemetry.isActive())
+        pData->telemetry.publish(pData->plugins, pData->curPluginCount, pData->bufferSize, pData->sampleRate);
+#endif
+
+    ++pData->time.cycle;
+
     if (pData->time.playing)
         pData->time.frame += pData->bufferSize;
 
@@ -21,6 +21,11 @@
 #include "CarlaEngineOsc.hpp"
 #include "CarlaEngineThread.hpp"
 #include "CarlaEngineUtils.hpp"
+#include "CarlaMathUtils.hpp"
+
+#ifndef BUILD_BRIDGE
+# include "CarlaShmUtils.hpp"
+#endif
 
 // FIXME only use CARLA_PREVENT_HEAP_ALLOCATION for structs
 // maybe separate macro
@@ -72,6 +77,11 @@ public:
 
     bool isReady() const noexcept;
 
+    // total latency, including compensation delays
+    uint32_t getLatency() const noexcept;
+    // main thread only, pluginsChanged is true when the engine thread saw plugin latencies change
+    bool updateLatency(const bool pluginsChanged);
+
     RackGraph*     getRackGraph() const noexcept;
     PatchbayGraph* getPatchbayGraph() const noexcept;
 
@@ -83,6 +93,7 @@ public:
     // used for internal patchbay mode
     void addPlugin(CarlaPlugin* const plugin);
     void replacePlugin(CarlaPlugin* const oldPlugin, CarlaPlugin* const newPlugin);
+    void switchPlugins(CarlaPlugin* const pluginA, CarlaPlugin* const pluginB);
     void removePlugin(CarlaPlugin* const plugin);
     void removeAllPlugins();
 
@@ -111,6 +122,7 @@ private:
 struct EngineInternalTime {
     bool playing;
     uint64_t frame;
+    uint32_t cycle; // process cycles run so far, see CarlaEngine::getProcessCycle()
 
     EngineInternalTime() noexcept;
 
@@ -125,7 +137,8 @@ enum EnginePostAction {
     kEnginePostActionZeroCount,    // set curPluginCount to 0
 #ifndef BUILD_BRIDGE
     kEnginePostActionRemovePlugin, // remove a plugin
-    kEnginePostActionSwitchPlugins // switch between 2 plugins
+    kEnginePostActionSwitchPlugins, // switch between 2 plugins
+    kEnginePostActionSwitchStandby  // switch all plugins with the standby ones
 #endif
 };
 
@@ -143,6 +156,22 @@ struct EngineNextAction {
     CARLA_DECLARE_NON_COPY_STRUCT(EngineNextAction)
 };
 
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// EngineStandbyPlugins
+
+struct EngineStandbyPlugins {
+    CarlaPlugin** plugins; // sized as the engine max plugin number, ids start after it
+    uint count;
+    bool loading;          // new plugins are added here instead of the engine
+
+    EngineStandbyPlugins() noexcept;
+    ~EngineStandbyPlugins() noexcept;
+
+    CARLA_DECLARE_NON_COPY_STRUCT(EngineStandbyPlugins)
+};
+#endif
+
 // -----------------------------------------------------------------------
 // EnginePluginData
 
@@ -150,8 +179,127 @@ struct EnginePluginData {
     CarlaPlugin* plugin;
     float insPeak[2];
     float outsPeak[2];
+    uint32_t silentFrames; // frames since the input was last heard, see ENGINE_OPTION_SKIP_SILENT_PLUGINS
+    bool silentOutput;
+};
+
+#ifndef BUILD_BRIDGE
+// -----------------------------------------------------------------------
+// EngineCallbackQueue
+// Lock-free queue of engine callbacks, with multiple producers and a single consumer.
+// Any thread can push callbacks, the engine idle thread takes them out in batches.
+// The queue has a fixed size and never allocates. When full, new callbacks are dropped and the next
+// batch ends with a reload of parameters and programs for every plugin, dropped notes are lost.
+
+class EngineCallbackQueue
+{
+public:
+    EngineCallbackQueue() noexcept;
+    ~EngineCallbackQueue() noexcept;
+
+    // frequent callbacks without a string value, the only ones that can be queued
+    static bool canQueue(const EngineCallbackOpcode action) noexcept;
+
+    // can be called from any thread, returns false if the queue is full
+    bool push(const CarlaPlugin* const plugin, const EngineCallbackOpcode action, const uint pluginId,
+              const int value1, const int value2, const float value3) noexcept;
+
+    // consumer only, takes all queued callbacks and returns how many are in the batch.
+    // plugin ids are updated if they changed since queued, callbacks of removed plugins are dropped.
+    // the batch is only valid until the next call.
+    uint takeBatch(const EnginePluginData* const plugins, const uint pluginCount) noexcept;
+    const EngineCallbackEvent* getBatch() const noexcept;
+
+    // consumer only, drops all queued callbacks
+    void clear() noexcept;
+
+    // consumer only, time of the last batch in milliseconds
+    uint32_t lastBatchTime;
+
+private:
+    static const uint kQueueSize = 4096; // must be a power of 2
+
+    struct Cell {
+        uint sequence; // position this cell is ready for, written by its producer or the consumer
+        const CarlaPlugin* plugin;
+        EngineCallbackEvent event;
+    };
+
+    Cell fCells[kQueueSize];
+    uint fWritePos;   // shared between producers
+    uint fReadPos;    // consumer only
+    bool fOverflowed; // set by producers when full, cleared by the consumer
+
+    // a full queue plus the reload callbacks added after an overflow
+    EngineCallbackEvent fBatch[kQueueSize + MAX_PATCHBAY_PLUGINS*2];
+
+    // index of the last queued event with the same hashed key, used for coalescing
+    static const uint kCoalesceSlotCount = 4096;
+    int fCoalesceSlots[kCoalesceSlotCount];
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(EngineCallbackQueue)
 };
 
+// -----------------------------------------------------------------------
+// EngineTelemetry
+// Plugin meters and scopes in a shared memory region, for external UIs to map read-only.
+// Plugin audio is collected while processing, meters are published once per block under a seqlock.
+
+class EngineTelemetry
+{
+public:
+    EngineTelemetry() noexcept;
+    ~EngineTelemetry() noexcept;
+
+    bool init(const uint maxPluginCount, const uint scopeSize) noexcept;
+    void close() noexcept;
+
+    bool isActive() const noexcept
+    {
+        return fHeader != nullptr;
+    }
+
+    const char* getFilename() const noexcept;
+
+    // realtime, collects the rms and scope of the first 2 audio outputs of a plugin.
+    // with jack multi-client this runs on the plugin threads, each plugin only writes to its own slot.
+    void processPlugin(const uint pluginId, const CarlaPlugin* const plugin,
+                       const float* const* const outBuf, const uint32_t outCount, const uint32_t frames) noexcept;
+
+    // realtime, publishes the meters of all plugins, called once per block
+    void publish(const EnginePluginData* const plugins, const uint pluginCount,
+                 const uint32_t bufferSize, const double sampleRate) noexcept;
+
+private:
+    struct PluginState {
+        const CarlaPlugin* plugin;
+        float outsRms[2];
+        float scopeValue[2];    // value with the largest magnitude since the last scope point
+        uint32_t scopeFrames;   // frames since the last scope point
+        uint32_t scopePosition; // scope points written
+    };
+
+    carla_shm_t fShm;
+    CarlaString fFilename;
+    std::size_t fSize;
+
+    EngineTelemetryHeader* fHeader;
+    EngineTelemetryPlugin* fPlugins;
+    float* fScopes;
+
+    PluginState* fStates;
+    uint fMaxPluginCount;
+    uint fScopeSize;
+    uint fPublishedCount;
+
+    void resetPlugin(const uint pluginId, const CarlaPlugin* const plugin) noexcept;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(EngineTelemetry)
+};
+#endif
+
 // -----------------------------------------------------------------------
 // CarlaEngineProtectedData
 
@@ -170,6 +318,15 @@ struct CarlaEngine::ProtectedData {
     EngineCallbackFunc callback;
     void*              callbackPtr;
 
+#ifndef BUILD_BRIDGE
+    EngineBatchCallbackFunc batchCallback;
+    void*                   batchCallbackPtr;
+    EngineCallbackQueue     callbackQueue;
+    EngineTelemetry         telemetry;
+    EngineStandbyPlugins    standby;
+    CarlaEngineSaveJob*     saveJob; // async project save in progress
+#endif
+
     FileCallbackFunc fileCallback;
     void*            fileCallbackPtr;
 
@@ -198,6 +355,7 @@ struct CarlaEngine::ProtectedData {
     EngineInternalEvents events;
 #ifndef BUILD_BRIDGE
     EngineInternalGraph  graph;
+    bool latencyUpdatePending; // set by the engine thread, the main thread then updates the graph delays
 #endif
     EngineInternalTime   time;
     EngineNextAction     nextAction;
@@ -216,8 +374,16 @@ struct CarlaEngine::ProtectedData {
 
     void doPluginRemove() noexcept;
     void doPluginsSwitch() noexcept;
+#ifndef BUILD_BRIDGE
+    void doStandbySwitch() noexcept;
+#endif
     void doNextPluginAction(const bool unlock) noexcept;
 
+#ifndef BUILD_BRIDGE
+    // deliver queued callbacks, unless the last batch was too recent and force is false
+    void deliverQueuedCallbacks(const bool force) noexcept;
+#endif
+
     // -------------------------------------------------------------------
 
 #ifdef CARLA_PROPER_CPP11_SUPPORT
@@ -226,6 +392,40 @@ struct CarlaEngine::ProtectedData {
 #endif
 };
 
+// -----------------------------------------------------------------------
+// Realtime audit, marks the current thread as realtime for libcarla_interposer-rtaudit.
+// Does nothing unless built with RTAUDIT=true and running with the interposer preloaded.
+
+#ifdef CARLA_RT_AUDIT
+extern "C" {
+void carla_interposer_rtaudit_enter() noexcept __attribute__((weak, visibility("default")));
+void carla_interposer_rtaudit_leave() noexcept __attribute__((weak, visibility("default")));
+}
+#endif
+
+class ScopedRtAuditMarker
+{
+public:
+    ScopedRtAuditMarker() noexcept
+    {
+#ifdef CARLA_RT_AUDIT
+        if (carla_interposer_rtaudit_enter != nullptr)
+            carla_interposer_rtaudit_enter();
+#endif
+    }
+
+    ~ScopedRtAuditMarker() noexcept
+    {
+#ifdef CARLA_RT_AUDIT
+        if (carla_interposer_rtaudit_leave != nullptr)
+            carla_interposer_rtaudit_leave();
+#endif
+    }
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(ScopedRtAuditMarker)
+};
+
 // -----------------------------------------------------------------------
 
 class PendingRtEventsRunner
@@ -235,6 +435,9 @@ public:
     ~PendingRtEventsRunner() noexcept;
 
 private:
+    // declared first so they stay active while running the pending events on destruction
+    const ScopedRtAuditMarker rtAuditMarker;
+    const CarlaScopedDenormalsFlush denormalsFlush;
     CarlaEngine::ProtectedData* const pData;
 
     CARLA_PREVENT_HEAP_ALLOCATION
@@ -28,10 +28,6 @@
 #include "jackey.h"
 #include "juce_audio_basics.h"
 
-#ifdef __SSE2_MATH__
-# include <xmmintrin.h>
-#endif
-
 // must be last
 #include "jackbridge/JackBridge.hpp"
 
@@ -617,6 +613,63 @@ public:
         return nullptr;
     }
 
+    void setLatency(const uint32_t samples) noexcept override
+    {
+        const bool changed(getLatency() != samples);
+
+        CarlaEngineClient::setLatency(samples);
+
+        if (changed && fUseClient && fJackClient != nullptr)
+        {
+            // triggers the latency callback, see handleLatencyCallback()
+            try {
+                jackbridge_recompute_total_latencies(fJackClient);
+            } CARLA_SAFE_EXCEPTION("jack_recompute_total_latencies");
+        }
+    }
+
+    void handleLatencyCallback(const jack_latency_callback_mode_t mode) noexcept
+    {
+        if (! fUseClient)
+            return;
+
+        const bool isCapture(mode == JackCaptureLatency);
+        const uint32_t latency(getLatency());
+
+        // gather the worst latency range from one side of the plugin
+        jack_latency_range_t range = { 0, 0 };
+
+        for (LinkedList<CarlaEngineJackAudioPort*>::Itenerator it = fAudioPorts.begin2(); it.valid(); it.next())
+        {
+            CarlaEngineJackAudioPort* const port(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(port != nullptr);
+
+            if (port->fJackPort == nullptr || port->isInput() != isCapture)
+                continue;
+
+            jack_latency_range_t portRange = { 0, 0 };
+            jackbridge_port_get_latency_range(port->fJackPort, mode, &portRange);
+
+            range.min = std::max(range.min, portRange.min);
+            range.max = std::max(range.max, portRange.max);
+        }
+
+        range.min += latency;
+        range.max += latency;
+
+        // and report it, plus our own latency, on the other side
+        for (LinkedList<CarlaEngineJackAudioPort*>::Itenerator it = fAudioPorts.begin2(); it.valid(); it.next())
+        {
+            CarlaEngineJackAudioPort* const port(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(port != nullptr);
+
+            if (port->fJackPort == nullptr || port->isInput() == isCapture)
+                continue;
+
+            jackbridge_port_set_latency_range(port->fJackPort, mode, &range);
+        }
+    }
+
     void invalidate() noexcept
     {
         for (LinkedList<CarlaEngineJackAudioPort*>::Itenerator it = fAudioPorts.begin2(); it.valid(); it.next())
@@ -940,7 +993,7 @@ public:
         pData->bufferSize = jackbridge_get_buffer_size(fClient);
         pData->sampleRate = jackbridge_get_sample_rate(fClient);
 
-        jackbridge_set_thread_init_callback(fClient, carla_jack_thread_init_callback, nullptr);
+        jackbridge_set_thread_init_callback(fClient, carla_jack_thread_init_callback, this);
         jackbridge_set_buffer_size_callback(fClient, carla_jack_bufsize_callback, this);
         jackbridge_set_sample_rate_callback(fClient, carla_jack_srate_callback, this);
         jackbridge_set_freewheel_callback(fClient, carla_jack_freewheel_callback, this);
@@ -1118,7 +1171,7 @@ public:
 
             CARLA_SAFE_ASSERT_RETURN(client != nullptr, nullptr);
 
-            jackbridge_set_thread_init_callback(client, carla_jack_thread_init_callback, nullptr);
+            jackbridge_set_thread_init_callback(client, carla_jack_thread_init_callback, this);
 
 #ifndef BUILD_BRIDGE
             jackbridge_set_latency_callback(client, carla_jack_latency_callback_plugin, plugin);
@@ -1206,7 +1259,7 @@ public:
                 plugin->setEnabled(false);
 
                 // set new client data
-                jackbridge_set_thread_init_callback(jackClient, carla_jack_thread_init_callback, nullptr);
+                jackbridge_set_thread_init_callback(jackClient, carla_jack_thread_init_callback, this);
                 jackbridge_set_latency_callback(jackClient, carla_jack_latency_callback_plugin, plugin);
                 jackbridge_set_process_callback(jackClient, carla_jack_process_callback_plugin, plugin);
                 jackbridge_on_shutdown(jackClient, carla_jack_shutdown_callback_plugin, plugin);
@@ -1436,6 +1489,16 @@ public:
     // -------------------------------------------------------------------
 
 protected:
+#ifndef BUILD_BRIDGE
+    void latencyChanged(const uint32_t) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(fClient != nullptr,);
+
+        // triggers the latency callback, see handleJackLatencyCallback()
+        jackbridge_recompute_total_latencies(fClient);
+    }
+#endif
+
     void handleJackBufferSizeCallback(const uint32_t newBufferSize)
     {
         if (pData->bufferSize == newBufferSize)
@@ -1653,9 +1716,61 @@ protected:
 #endif // ! BUILD_BRIDGE
     }
 
-    void handleJackLatencyCallback(const jack_latency_callback_mode_t /*mode*/)
+    void handleJackLatencyCallback(const jack_latency_callback_mode_t mode)
     {
-        // TODO
+#ifndef BUILD_BRIDGE
+        if (pData->options.processMode == ENGINE_PROCESS_MODE_CONTINUOUS_RACK ||
+            pData->options.processMode == ENGINE_PROCESS_MODE_PATCHBAY)
+        {
+            const bool isCapture(mode == JackCaptureLatency);
+            const uint32_t latency(pData->graph.getLatency());
+
+            jack_port_t* const srcPorts[2] = {
+                fRackPorts[isCapture ? kRackPortAudioIn1  : kRackPortAudioOut1],
+                fRackPorts[isCapture ? kRackPortAudioIn2  : kRackPortAudioOut2]
+            };
+            jack_port_t* const dstPorts[2] = {
+                fRackPorts[isCapture ? kRackPortAudioOut1 : kRackPortAudioIn1],
+                fRackPorts[isCapture ? kRackPortAudioOut2 : kRackPortAudioIn2]
+            };
+
+            jack_latency_range_t range = { 0, 0 };
+
+            for (uint i=0; i < 2; ++i)
+            {
+                CARLA_SAFE_ASSERT_CONTINUE(srcPorts[i] != nullptr);
+
+                jack_latency_range_t portRange = { 0, 0 };
+                jackbridge_port_get_latency_range(srcPorts[i], mode, &portRange);
+
+                range.min = std::max(range.min, portRange.min);
+                range.max = std::max(range.max, portRange.max);
+            }
+
+            range.min += latency;
+            range.max += latency;
+
+            for (uint i=0; i < 2; ++i)
+            {
+                CARLA_SAFE_ASSERT_CONTINUE(dstPorts[i] != nullptr);
+
+                jackbridge_port_set_latency_range(dstPorts[i], mode, &range);
+            }
+            return;
+        }
+#endif
+
+        // single client mode, or bridge
+        for (uint i=0; i < pData->curPluginCount; ++i)
+        {
+            CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+            if (plugin == nullptr || ! plugin->isEnabled())
+                continue;
+
+            if (CarlaEngineJackClient* const client = (CarlaEngineJackClient*)plugin->getEngineClient())
+                client->handleLatencyCallback(mode);
+        }
     }
 
 #ifndef BUILD_BRIDGE
@@ -2191,18 +2306,22 @@ private:
         }
 
         setPluginPeaks(plugin->getId(), inPeaks, outPeaks);
+
+#ifndef BUILD_BRIDGE
+        if (pData->telemetry.isActive())
+            pData->telemetry.processPlugin(plugin->getId(), plugin, audioOut, audioOutCount, nframes);
+#endif
     }
 
     // -------------------------------------------------------------------
 
     #define handlePtr ((CarlaEngineJack*)arg)
 
-    static void JACKBRIDGE_API carla_jack_thread_init_callback(void*)
+    static void JACKBRIDGE_API carla_jack_thread_init_callback(void* arg)
     {
-#ifdef __SSE2_MATH__
-        // Set FTZ and DAZ flags
-        _mm_setcsr(_mm_getcsr() | 0x8040);
-#endif
+        // process cycles set it too, this also covers plugins doing work in other jack threads
+        if (handlePtr->pData->options.flushDenormals)
+            carla_enableDenormalsFlush();
     }
 
     static int JACKBRIDGE_API carla_jack_bufsize_callback(jack_nframes_t newBufferSize, void* arg)
@@ -2273,6 +2392,9 @@ private:
         CarlaEngineJack* const engine((CarlaEngineJack*)plugin->getEngine());
         CARLA_SAFE_ASSERT_RETURN(engine != nullptr, 0);
 
+        const ScopedRtAuditMarker srtam;
+        const CarlaScopedDenormalsFlush sdf(engine->pData->options.flushDenormals);
+
         if (plugin->tryLock(engine->fFreewheel))
         {
             plugin->initBuffers();
@@ -2284,9 +2406,15 @@ private:
         return 0;
     }
 
-    static void JACKBRIDGE_API carla_jack_latency_callback_plugin(jack_latency_callback_mode_t /*mode*/, void* /*arg*/)
+    static void JACKBRIDGE_API carla_jack_latency_callback_plugin(jack_latency_callback_mode_t mode, void* arg)
     {
-        // TODO
+        CarlaPlugin* const plugin((CarlaPlugin*)arg);
+        CARLA_SAFE_ASSERT_RETURN(plugin != nullptr && plugin->isEnabled(),);
+
+        CarlaEngineJackClient* const client((CarlaEngineJackClient*)plugin->getEngineClient());
+        CARLA_SAFE_ASSERT_RETURN(client != nullptr,);
+
+        client->handleLatencyCallback(mode);
     }
 
     static void JACKBRIDGE_API carla_jack_shutdown_callback_plugin(void* arg)
@@ -534,7 +534,10 @@ protected:
             CARLA_SAFE_ASSERT_RETURN(readNextLineAsBool(yesNo), true);
 
             if (CarlaPlugin* const plugin = fEngine->getPlugin(pluginId))
+            {
                 plugin->showCustomUI(yesNo);
+                fEngine->requestPluginIdle(pluginId);
+            }
         }
         else
         {
@@ -576,6 +579,7 @@ public:
           kIsPatchbay(isPatchbay),
           fIsActive(false),
           fIsRunning(false),
+          fIsLoadingState(false),
           fUiServer(this),
           fOptionsForced(false)
     {
@@ -681,7 +685,8 @@ protected:
 
     bool isRunning() const noexcept override
     {
-        return fIsRunning;
+        // the host might not be processing while setting state, plugin changes are done with no lock then
+        return fIsRunning && ! fIsLoadingState;
     }
 
     bool isOffline() const noexcept override
@@ -707,6 +712,14 @@ protected:
             pHost->dispatcher(pHost->handle, NATIVE_HOST_OPCODE_HOST_IDLE, 0, 0, nullptr, 0.0f);
     }
 
+    void latencyChanged(const uint32_t newLatency) override
+    {
+        if (pData->aboutToClose)
+            return;
+
+        pHost->dispatcher(pHost->handle, NATIVE_HOST_OPCODE_LATENCY_CHANGED, 0, static_cast<intptr_t>(newLatency), nullptr, 0.0f);
+    }
+
     // -------------------------------------------------------------------
 
     const char* renamePlugin(const uint id, const char* const newName) override
@@ -943,6 +956,12 @@ protected:
         if (! fUiServer.isPipeRunning())
             return;
 
+        // plugins are sent again after loading state
+        if (fIsLoadingState && (action == ENGINE_CALLBACK_PLUGIN_ADDED   ||
+                                action == ENGINE_CALLBACK_PLUGIN_REMOVED ||
+                                action == ENGINE_CALLBACK_PLUGIN_RENAMED))
+            return;
+
         CarlaPlugin* plugin;
 
         switch (action)
@@ -1538,6 +1557,9 @@ protected:
             }
         }
 
+        // plugins are only added and removed from here, so this is our main thread
+        updateLatency();
+
         if (fUiServer.isPipeRunning())
         {
             fUiServer.idlePipe();
@@ -1622,23 +1644,30 @@ protected:
 
     void setState(const char* const data)
     {
-        // remove all plugins from UI side
+        fOptionsForced = true;
+        const String state(data);
+        XmlDocument xml(state);
+
+        // remove all plugins from UI side, plugins might be moved around while loading
         for (int i=pData->curPluginCount; --i >= 0;)
             CarlaEngine::callback(ENGINE_CALLBACK_PLUGIN_REMOVED, i, 0, 0, 0.0f, nullptr);
 
-        // remove all plugins from backend, no lock
-        fIsRunning = false;
-        removeAllPlugins();
-        fIsRunning = true;
+        // plugins matching the new state are kept, only changed values are set on them
+        {
+            const ScopedThreadStopper sts(this);
 
-        // stopped during removeAllPlugins()
-        if (! pData->thread.isThreadRunning())
-            pData->thread.startThread();
+            fIsLoadingState = true;
+            loadProjectInternal(xml, true);
+            fIsLoadingState = false;
+        }
 
-        fOptionsForced = true;
-        const String state(data);
-        XmlDocument xml(state);
-        loadProjectInternal(xml);
+        for (uint i=0; i < pData->curPluginCount; ++i)
+        {
+            CarlaPlugin* const plugin(pData->plugins[i].plugin);
+
+            if (plugin != nullptr && plugin->isEnabled())
+                CarlaEngine::callback(ENGINE_CALLBACK_PLUGIN_ADDED, i, 0, 0, 0.0f, plugin->getName());
+        }
     }
 
     // -------------------------------------------------------------------
@@ -1790,7 +1819,7 @@ private:
     const NativeHostDescriptor* const pHost;
 
     const bool kIsPatchbay; // rack if false
-    bool fIsActive, fIsRunning;
+    bool fIsActive, fIsRunning, fIsLoadingState;
     CarlaEngineNativeUI fUiServer;
 
     bool fOptionsForced;
@@ -2073,6 +2102,7 @@ const NativePluginDescriptor* carla_get_native_patchbay_plugin()
 CARLA_BACKEND_START_NAMESPACE
 
 CarlaEngine* CarlaEngine::newJack() { return nullptr; }
+CarlaEngine* CarlaEngine::newOffline() { return nullptr; }
 
 # if defined(CARLA_OS_MAC) || defined(CARLA_OS_WIN)
 CarlaEngine*       CarlaEngine::newJuce(const AudioApi)           { return nullptr; }
@@ -0,0 +1,395 @@
+/*
+ * Carla Plugin Host
+ * Copyright (C) 2011-2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaEngineGraph.hpp"
+#include "CarlaEngineInternal.hpp"
+#include "CarlaBackendUtils.hpp"
+#include "CarlaMathUtils.hpp"
+#include "CarlaThread.hpp"
+
+#include "juce_audio_formats.h"
+
+#include <vector>
+
+using juce::AudioFormat;
+using juce::AudioFormatManager;
+using juce::AudioFormatReader;
+using juce::AudioFormatWriter;
+using juce::AudioSampleBuffer;
+using juce::File;
+using juce::FileInputStream;
+using juce::FileOutputStream;
+using juce::MidiFile;
+using juce::MidiMessage;
+using juce::MidiMessageSequence;
+using juce::ScopedPointer;
+using juce::StringPairArray;
+using juce::Time;
+
+CARLA_BACKEND_START_NAMESPACE
+
+// -------------------------------------------------------------------------------------------------------------------
+// Offline engine, renders the graph as fast as possible from and to files.
+//
+// Audio and MIDI inputs are read from files, audio outputs are written to a file.
+// While not rendering, a small thread takes the place of the audio thread for plugin actions
+// (remove, switch, etc) so that the engine can be setup like a regular one.
+
+static const uint kOfflineAudioIns  = 2;
+static const uint kOfflineAudioOuts = 2;
+
+class CarlaEngineOffline : public CarlaEngine,
+                           private CarlaThread
+{
+public:
+    CarlaEngineOffline()
+        : CarlaEngine(),
+          CarlaThread("CarlaEngineOffline"),
+          fBlockTimes(),
+          fIsRunning(false)
+    {
+        carla_debug("CarlaEngineOffline::CarlaEngineOffline()");
+
+        // there's no external transport
+        pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
+    }
+
+    ~CarlaEngineOffline() override
+    {
+        CARLA_SAFE_ASSERT(! fIsRunning);
+        carla_debug("CarlaEngineOffline::~CarlaEngineOffline()");
+    }
+
+    // -------------------------------------
+
+    bool init(const char* const clientName) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(! fIsRunning, false);
+        CARLA_SAFE_ASSERT_RETURN(clientName != nullptr && clientName[0] != '\0', false);
+        carla_debug("CarlaEngineOffline::init(\"%s\")", clientName);
+
+        if (pData->options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK && pData->options.processMode != ENGINE_PROCESS_MODE_PATCHBAY)
+        {
+            setLastError("Invalid process mode");
+            return false;
+        }
+
+        // the engine thread stops right away if we're not running yet
+        fIsRunning = true;
+
+        if (! pData->init(clientName))
+        {
+            fIsRunning = false;
+            setLastError("Failed to init internal data");
+            return false;
+        }
+
+        pData->bufferSize = pData->options.audioBufferSize;
+        pData->sampleRate = pData->options.audioSampleRate;
+
+        fAudioIns.setSize(static_cast<int>(kOfflineAudioIns), static_cast<int>(pData->bufferSize));
+        fAudioOuts.setSize(static_cast<int>(kOfflineAudioOuts), static_cast<int>(pData->bufferSize));
+
+        pData->graph.create(kOfflineAudioIns, kOfflineAudioOuts);
+        pData->graph.setOffline(true);
+
+        startThread();
+
+        patchbayRefresh(false);
+
+        callback(ENGINE_CALLBACK_ENGINE_STARTED, 0, pData->options.processMode, pData->options.transportMode, 0.0f, getCurrentDriverName());
+        return true;
+    }
+
+    bool close() override
+    {
+        carla_debug("CarlaEngineOffline::close()");
+
+        // plugin removal still needs the action thread
+        CarlaEngine::close();
+
+        stopThread(-1);
+        fIsRunning = false;
+
+        pData->graph.destroy();
+
+        fAudioIns.setSize(1, 1);
+        fAudioOuts.setSize(1, 1);
+        return true;
+    }
+
+    bool isRunning() const noexcept override
+    {
+        return fIsRunning;
+    }
+
+    bool isOffline() const noexcept override
+    {
+        return true;
+    }
+
+    EngineType getType() const noexcept override
+    {
+        return kEngineTypeOffline;
+    }
+
+    const char* getCurrentDriverName() const noexcept override
+    {
+        return "Offline";
+    }
+
+    // -------------------------------------------------------------------
+    // Offline rendering
+
+    bool renderOffline(const char* const outputFile, const char* const inputFile, const char* const midiFile, const double seconds) override
+    {
+        CARLA_SAFE_ASSERT_RETURN(fIsRunning, false);
+        CARLA_SAFE_ASSERT_RETURN(outputFile != nullptr && outputFile[0] != '\0', false);
+        carla_debug("CarlaEngineOffline::renderOffline(\"%s\", \"%s\", \"%s\", %f)", outputFile, inputFile, midiFile, seconds);
+
+        const double sampleRate(pData->sampleRate);
+        const uint32_t bufferSize(pData->bufferSize);
+
+        uint64_t totalFrames = (seconds > 0.0) ? static_cast<uint64_t>(seconds * sampleRate + 0.5) : 0;
+
+        // ---------------------------------------------------------------
+        // audio input
+
+        AudioFormatManager afm;
+        afm.registerBasicFormats();
+
+        ScopedPointer<AudioFormatReader> reader;
+
+        if (inputFile != nullptr && inputFile[0] != '\0')
+        {
+            reader = afm.createReaderFor(File(inputFile));
+
+            if (reader == nullptr)
+            {
+                setLastError("Failed to open input audio file");
+                return false;
+            }
+
+            if (std::abs(reader->sampleRate - sampleRate) > 0.5)
+                carla_stderr("CarlaEngineOffline::renderOffline() - input file sample rate mismatch, %f vs %f", reader->sampleRate, sampleRate);
+
+            if (seconds <= 0.0)
+                totalFrames = static_cast<uint64_t>(reader->lengthInSamples);
+        }
+
+        // ---------------------------------------------------------------
+        // midi input
+
+        MidiMessageSequence midiSeq;
+
+        if (midiFile != nullptr && midiFile[0] != '\0')
+        {
+            FileInputStream stream((File(midiFile)));
+            MidiFile midi;
+
+            if (stream.failedToOpen() || ! midi.readFrom(stream))
+            {
+                setLastError("Failed to open input MIDI file");
+                return false;
+            }
+
+            midi.convertTimestampTicksToSeconds();
+
+            for (int i=0, count=midi.getNumTracks(); i < count; ++i)
+            {
+                if (const MidiMessageSequence* const track = midi.getTrack(i))
+                    midiSeq.addSequence(*track, 0.0, 0.0, 1e12);
+            }
+
+            midiSeq.sort();
+
+            if (seconds <= 0.0)
+                totalFrames = std::max(totalFrames, static_cast<uint64_t>(midiSeq.getEndTime() * sampleRate + 0.5));
+        }
+
+        if (totalFrames == 0)
+        {
+            setLastError("Nothing to render, no length given and no input files");
+            return false;
+        }
+
+        // ---------------------------------------------------------------
+        // audio output
+
+        const File outFile(outputFile);
+        AudioFormat* const format(afm.findFormatForFileExtension(outFile.getFileExtension()));
+
+        if (format == nullptr || ! format->canHandleFile(outFile))
+        {
+            setLastError("Unsupported output file format");
+            return false;
+        }
+
+        outFile.deleteFile();
+        FileOutputStream* const outStream(outFile.createOutputStream());
+
+        if (outStream == nullptr)
+        {
+            setLastError("Failed to create output file");
+            return false;
+        }
+
+        // use float if the format supports it, 24bit otherwise
+        const juce::Array<int> bitDepths(format->getPossibleBitDepths());
+        const int bitDepth = bitDepths.contains(32) ? 32 : 24;
+
+        ScopedPointer<AudioFormatWriter> writer(format->createWriterFor(outStream, sampleRate, kOfflineAudioOuts, bitDepth, StringPairArray(), 0));
+
+        if (writer == nullptr)
+        {
+            delete outStream;
+            setLastError("Failed to create output file writer");
+            return false;
+        }
+
+        // ---------------------------------------------------------------
+        // render, the action thread is not needed as we process on this one
+
+        stopThread(-1);
+        offlineModeChanged(true);
+
+        // patchbay changes are applied asynchronously, but there might be no message loop running
+        pData->graph.setBufferSize(bufferSize);
+
+        transportRelocate(0);
+        transportPlay();
+        pData->timeInfo.playing = true;
+        pData->timeInfo.frame   = 0;
+
+        const float* inBuf[kOfflineAudioIns];
+        /* */ float* outBuf[kOfflineAudioOuts];
+
+        for (uint i=0; i < kOfflineAudioIns; ++i)
+            inBuf[i] = fAudioIns.getReadPointer(static_cast<int>(i));
+        for (uint i=0; i < kOfflineAudioOuts; ++i)
+            outBuf[i] = fAudioOuts.getWritePointer(static_cast<int>(i));
+
+        bool ok = true;
+        int midiIndex = 0;
+
+        fBlockTimes.clear();
+        fBlockTimes.reserve(static_cast<std::size_t>(totalFrames / bufferSize + 1));
+
+        for (uint64_t frame = 0; frame < totalFrames && ! pData->aboutToClose; frame += bufferSize)
+        {
+            const int frames = static_cast<int>(std::min<uint64_t>(bufferSize, totalFrames - frame));
+
+            const PendingRtEventsRunner prt(this);
+
+            fAudioIns.clear();
+            fAudioOuts.clear();
+
+            // mono files are copied to both inputs
+            if (reader != nullptr)
+                reader->read(&fAudioIns, 0, static_cast<int>(bufferSize), static_cast<juce::int64>(frame), true, true);
+
+            // initialize events
+            carla_zeroStructs(pData->events.in,  kMaxEngineEventInternalCount);
+            carla_zeroStructs(pData->events.out, kMaxEngineEventInternalCount);
+
+            const double blockEnd(static_cast<double>(frame + bufferSize) / sampleRate);
+
+            for (uint32_t engineEventIndex = 0; midiIndex < midiSeq.getNumEvents(); ++midiIndex)
+            {
+                const MidiMessage& midiMessage(midiSeq.getEventPointer(midiIndex)->message);
+
+                if (midiMessage.getTimeStamp() >= blockEnd)
+                    break;
+                if (midiMessage.isMetaEvent() || midiMessage.getRawDataSize() > 0xff)
+                    continue;
+                if (engineEventIndex >= kMaxEngineEventInternalCount)
+                    continue;
+
+                const int64_t eventFrame(static_cast<int64_t>(midiMessage.getTimeStamp() * sampleRate + 0.5));
+
+                EngineEvent& engineEvent(pData->events.in[engineEventIndex++]);
+                engineEvent.time = static_cast<uint32_t>(carla_fixedValue<int64_t>(0, bufferSize-1, eventFrame - static_cast<int64_t>(frame)));
+                engineEvent.fillFromMidiData(static_cast<uint8_t>(midiMessage.getRawDataSize()), midiMessage.getRawData(), 0);
+            }
+
+            const juce::int64 blockStart(Time::getHighResolutionTicks());
+
+            pData->graph.process(pData, inBuf, outBuf, bufferSize);
+
+            fBlockTimes.push_back(static_cast<float>(Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - blockStart) * 1e6));
+
+            if (! writer->writeFromFloatArrays(outBuf, static_cast<int>(kOfflineAudioOuts), frames))
+            {
+                setLastError("Failed to write to output file");
+                ok = false;
+                break;
+            }
+        }
+
+        transportPause();
+        pData->timeInfo.playing = false;
+
+        writer = nullptr;
+
+        startThread();
+
+        return ok;
+    }
+
+    uint32_t getOfflineRenderBlockTimes(const float*& times) const noexcept override
+    {
+        times = fBlockTimes.empty() ? nullptr : &fBlockTimes.front();
+        return static_cast<uint32_t>(fBlockTimes.size());
+    }
+
+    // -------------------------------------------------------------------
+
+protected:
+    void run() override
+    {
+        // take the place of the audio thread for pending plugin actions
+        for (; ! shouldThreadExit();)
+        {
+            pData->doNextPluginAction(true);
+            carla_msleep(5);
+        }
+    }
+
+    // -------------------------------------------------------------------
+
+private:
+    AudioSampleBuffer fAudioIns;
+    AudioSampleBuffer fAudioOuts;
+
+    // processing time of each block in the last render, in microseconds
+    std::vector<float> fBlockTimes;
+
+    volatile bool fIsRunning;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaEngineOffline)
+};
+
+// -----------------------------------------
+
+CarlaEngine* CarlaEngine::newOffline()
+{
+    return new CarlaEngineOffline();
+}
+
+// -----------------------------------------
+
+CARLA_BACKEND_END_NAMESPACE
@@ -176,6 +176,9 @@ public:
 
         // just to make sure
         pData->options.transportMode = ENGINE_TRANSPORT_MODE_INTERNAL;
+
+        // midi event sizes fit in a byte, this way assign() never allocates in the audio thread
+        fMidiOutVector.reserve(0xff);
     }
 
     ~CarlaEngineRtAudio() override
@@ -15,25 +15,78 @@
  * For a full copy of the GNU General Public License see the doc/GPL.txt file.
  */
 
-#include "CarlaEngine.hpp"
-#include "CarlaEngineThread.hpp"
+#include "CarlaEngineInternal.hpp"
 #include "CarlaPlugin.hpp"
 
+#include "juce_core.h"
+
 CARLA_BACKEND_START_NAMESPACE
 
 // -----------------------------------------------------------------------
 
+// regular idle of OSC, in milliseconds
+static const uint kEngineIdleInterval = 25;
+
+// longest time the thread waits for requests, only as a safety net in case a wake-up is lost
+static const uint kEngineIdleMaxWait = 1000;
+
+static const uint kEngineIdleRequestWords = (MAX_PATCHBAY_PLUGINS + 31) / 32;
+
+// -----------------------------------------------------------------------
+
 CarlaEngineThread::CarlaEngineThread(CarlaEngine* const engine) noexcept
     : CarlaThread("CarlaEngineThread"),
-      kEngine(engine)
+      kEngine(engine),
+      fSem(),
+      fSemValid(false),
+      fWakeUpPending(false)
 {
     CARLA_SAFE_ASSERT(engine != nullptr);
     carla_debug("CarlaEngineThread::CarlaEngineThread(%p)", engine);
+
+    carla_zeroStructs(fRequests, kEngineIdleRequestWords);
+    carla_zeroStructs(fNextIdleTimes, MAX_PATCHBAY_PLUGINS);
+#ifndef BUILD_BRIDGE
+    carla_zeroPointers(fLatencyPlugins, MAX_PATCHBAY_PLUGINS);
+    carla_zeroStructs(fLatencies, MAX_PATCHBAY_PLUGINS);
+#endif
+
+    fSemValid = carla_sem_create2(fSem);
 }
 
 CarlaEngineThread::~CarlaEngineThread() noexcept
 {
     carla_debug("CarlaEngineThread::~CarlaEngineThread()");
+
+    stopThread(-1);
+
+    if (fSemValid)
+        carla_sem_destroy2(fSem);
+}
+
+// -----------------------------------------------------------------------
+
+void CarlaEngineThread::requestPluginIdle(const uint pluginId) noexcept
+{
+    // standby plugins can have ids out of range, they are not idled until switched in
+    if (pluginId >= MAX_PATCHBAY_PLUGINS)
+        return;
+
+    __atomic_fetch_or(&fRequests[pluginId/32], 1U << (pluginId%32), __ATOMIC_RELEASE);
+
+    // only the first request since the last wake-up needs to post
+    if (fSemValid && ! __atomic_exchange_n(&fWakeUpPending, true, __ATOMIC_ACQ_REL))
+        carla_sem_post(fSem);
+}
+
+bool CarlaEngineThread::stopThread(const int timeOutMilliseconds) noexcept
+{
+    signalThreadShouldExit();
+
+    if (fSemValid)
+        carla_sem_post(fSem);
+
+    return CarlaThread::stopThread(timeOutMilliseconds);
 }
 
 // -----------------------------------------------------------------------
@@ -50,6 +103,10 @@ void CarlaEngineThread::run() noexcept
     const bool isPlugin(kEngine->getType() == kEngineTypePlugin);
 #endif
     float value;
+    uint32_t requests[kEngineIdleRequestWords];
+
+    // the thread is restarted when plugins are added or removed, idle everything once to catch up
+    bool idleAll = true;
 
 #ifdef BUILD_BRIDGE
     for (; /*kEngine->isRunning() &&*/ ! shouldThreadExit();)
@@ -63,9 +120,24 @@ void CarlaEngineThread::run() noexcept
         const bool oscRegisted = false;
 #endif
 
+        // take requests, any new ones from now on will wake us up again
+        __atomic_store_n(&fWakeUpPending, false, __ATOMIC_RELEASE);
+
+        for (uint i=0; i < kEngineIdleRequestWords; ++i)
+            requests[i] = __atomic_exchange_n(&fRequests[i], 0U, __ATOMIC_ACQUIRE);
+
+        const uint32_t now(juce::Time::getMillisecondCounter());
+        uint waitTime = kEngineIdleMaxWait;
+#ifndef BUILD_BRIDGE
+        bool idled = idleAll;
+#endif
+
 #ifdef HAVE_LIBLO
         if (isPlugin)
+        {
             kEngine->idleOsc();
+            waitTime = kEngineIdleInterval;
+        }
 #endif
 
         for (uint i=0, count = kEngine->getCurrentPluginCount(); i < count; ++i)
@@ -75,6 +147,35 @@ void CarlaEngineThread::run() noexcept
             CARLA_SAFE_ASSERT_CONTINUE(plugin != nullptr && plugin->isEnabled());
             CARLA_SAFE_ASSERT_UINT2(i == plugin->getId(), i, plugin->getId());
 
+            // -----------------------------------------------------------
+            // Check if idle is needed
+
+            const uint interval(oscRegisted ? kEngineIdleInterval : plugin->getIdleInterval());
+            const bool requested((requests[i/32] & (1U << (i%32))) != 0);
+
+            if (interval != 0)
+            {
+                const uint32_t timeLeft(fNextIdleTimes[i] - now);
+
+                // a time further away than the interval belongs to a removed plugin, or wrapped around
+                if (timeLeft != 0 && timeLeft <= interval && ! (idleAll || requested))
+                {
+                    waitTime = std::min(waitTime, static_cast<uint>(timeLeft));
+                    continue;
+                }
+
+                fNextIdleTimes[i] = now + interval;
+                waitTime = std::min(waitTime, interval);
+            }
+            else if (! (idleAll || requested))
+            {
+                continue;
+            }
+
+#ifndef BUILD_BRIDGE
+            idled = true;
+#endif
+
             const uint hints(plugin->getHints());
             const bool updateUI((hints & PLUGIN_HAS_CUSTOM_UI) != 0 && (hints & PLUGIN_NEEDS_UI_MAIN_THREAD) == 0);
 
@@ -127,7 +228,45 @@ void CarlaEngineThread::run() noexcept
 #endif
         }
 
-        carla_msleep(25);
+#ifndef BUILD_BRIDGE
+        // -----------------------------------------------------------
+        // Delay compensation, plugin latencies only change during idle.
+        // Changes are only detected here, the graph belongs to the main thread which updates it on its next idle.
+
+        if (idled)
+        {
+            bool latencyChanged = false;
+
+            for (uint i=0, count = kEngine->getCurrentPluginCount(); i < MAX_PATCHBAY_PLUGINS; ++i)
+            {
+                CarlaPlugin* const plugin(i < count ? kEngine->getPluginUnchecked(i) : nullptr);
+                uint32_t latency = 0;
+
+                if (plugin != nullptr && plugin->isEnabled())
+                    latency = plugin->getEngineClient()->getLatency();
+
+                if (fLatencyPlugins[i] == plugin && fLatencies[i] == latency)
+                    continue;
+
+                fLatencyPlugins[i] = plugin;
+                fLatencies[i]      = latency;
+                latencyChanged     = true;
+            }
+
+            if (latencyChanged)
+                __atomic_store_n(&kEngine->pData->latencyUpdatePending, true, __ATOMIC_RELEASE);
+        }
+#endif
+
+        idleAll = false;
+
+        // -----------------------------------------------------------
+        // Wait for requests or the next regular idle
+
+        if (fSemValid)
+            carla_sem_timedwait_ms(fSem, waitTime);
+        else
+            carla_msleep(std::min(waitTime, kEngineIdleInterval));
     }
 }
 
@@ -19,12 +19,14 @@
 #define CARLA_ENGINE_THREAD_HPP_INCLUDED
 
 #include "CarlaBackend.h"
+#include "CarlaSemUtils.hpp"
 #include "CarlaThread.hpp"
 
 CARLA_BACKEND_START_NAMESPACE
 
 // -----------------------------------------------------------------------
 // CarlaEngineThread
+// Idles plugins when they request it, or at their own interval if they have one.
 
 class CarlaEngineThread : public CarlaThread
 {
@@ -32,12 +34,35 @@ public:
     CarlaEngineThread(CarlaEngine* const engine) noexcept;
     ~CarlaEngineThread() noexcept override;
 
+    // can be called from any thread, including realtime ones
+    void requestPluginIdle(const uint pluginId) noexcept;
+
+    // wakes up the thread before stopping it, so it doesn't need to wait for the next idle
+    bool stopThread(const int timeOutMilliseconds) noexcept;
+
 protected:
     void run() noexcept override;
 
 private:
     CarlaEngine* const kEngine;
 
+    // wakes up the thread on requests, polls instead if the semaphore is not available
+    carla_sem_t fSem;
+    bool fSemValid;
+    bool fWakeUpPending;
+
+    // plugins that requested idle, one bit per plugin id
+    uint32_t fRequests[(MAX_PATCHBAY_PLUGINS + 31) / 32];
+
+    // time of the next regular idle of each plugin, only used by the thread
+    uint32_t fNextIdleTimes[MAX_PATCHBAY_PLUGINS];
+
+#ifndef BUILD_BRIDGE
+    // plugin and latency last seen in each slot, only used by the thread to detect latency changes
+    const CarlaPlugin* fLatencyPlugins[MAX_PATCHBAY_PLUGINS];
+    uint32_t fLatencies[MAX_PATCHBAY_PLUGINS];
+#endif
+
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaEngineThread)
 };
 
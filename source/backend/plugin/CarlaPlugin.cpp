@@ -74,6 +74,26 @@ struct ParamSymbol {
 #endif
 };
 
+// -------------------------------------------------------------------
+// Custom data helper, needed for CarlaPlugin::loadStateSave()
+
+static bool isCustomDataAlreadySet(const LinkedList<CustomData>& customList, const CarlaStateSave::CustomData* const stateCustomData) noexcept
+{
+    for (LinkedList<CustomData>::Itenerator it = customList.begin2(); it.valid(); it.next())
+    {
+        const CustomData& cData(it.getValue(kCustomDataFallback));
+        CARLA_SAFE_ASSERT_CONTINUE(cData.isValid());
+
+        if (std::strcmp(cData.key, stateCustomData->key) != 0)
+            continue;
+
+        return (std::strcmp(cData.type,  stateCustomData->type)  == 0 &&
+                std::strcmp(cData.value, stateCustomData->value) == 0);
+    }
+
+    return false;
+}
+
 // -------------------------------------------------------------------
 // Constructor and destructor
 
@@ -165,6 +185,11 @@ uint32_t CarlaPlugin::getLatencyInFrames() const noexcept
     return 0;
 }
 
+uint32_t CarlaPlugin::getTailLengthInFrames() const noexcept
+{
+    return 0;
+}
+
 // -------------------------------------------------------------------
 // Information (count)
 
@@ -481,7 +506,13 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
     if (callPrepareForSave)
         prepareForSave();
 
-    pData->stateSave.clear();
+    fillStateSave(pData->stateSave, false);
+    return pData->stateSave;
+}
+
+void CarlaPlugin::fillStateSave(CarlaStateSave& stateSave, const bool copyChunkData)
+{
+    stateSave.clear();
 
     const PluginType pluginType(getType());
 
@@ -492,28 +523,28 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
 
     getLabel(strBuf);
 
-    pData->stateSave.type     = carla_strdup(getPluginTypeAsString(getType()));
-    pData->stateSave.name     = carla_strdup(pData->name);
-    pData->stateSave.label    = carla_strdup(strBuf);
-    pData->stateSave.uniqueId = getUniqueId();
+    stateSave.type     = carla_strdup(getPluginTypeAsString(getType()));
+    stateSave.name     = carla_strdup(pData->name);
+    stateSave.label    = carla_strdup(strBuf);
+    stateSave.uniqueId = getUniqueId();
 #ifndef BUILD_BRIDGE
-    pData->stateSave.options  = pData->options;
+    stateSave.options  = pData->options;
 #endif
 
     if (pData->filename != nullptr)
-        pData->stateSave.binary = carla_strdup(pData->filename);
+        stateSave.binary = carla_strdup(pData->filename);
 
 #ifndef BUILD_BRIDGE
     // ---------------------------------------------------------------
     // Internals
 
-    pData->stateSave.active       = pData->active;
-    pData->stateSave.dryWet       = pData->postProc.dryWet;
-    pData->stateSave.volume       = pData->postProc.volume;
-    pData->stateSave.balanceLeft  = pData->postProc.balanceLeft;
-    pData->stateSave.balanceRight = pData->postProc.balanceRight;
-    pData->stateSave.panning      = pData->postProc.panning;
-    pData->stateSave.ctrlChannel  = pData->ctrlChannel;
+    stateSave.active       = pData->active;
+    stateSave.dryWet       = pData->postProc.dryWet;
+    stateSave.volume       = pData->postProc.volume;
+    stateSave.balanceLeft  = pData->postProc.balanceLeft;
+    stateSave.balanceRight = pData->postProc.balanceRight;
+    stateSave.panning      = pData->postProc.panning;
+    stateSave.ctrlChannel  = pData->ctrlChannel;
 #endif
 
     bool usingChunk = false;
@@ -528,7 +559,16 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
 
         if (data != nullptr && dataSize > 0)
         {
-            pData->stateSave.chunk = CarlaString::asBase64(data, dataSize).dup();
+            if (copyChunkData)
+            {
+                stateSave.chunkDataStorage.replaceWith(data, dataSize);
+                stateSave.chunkData     = stateSave.chunkDataStorage.getData();
+                stateSave.chunkDataSize = dataSize;
+            }
+            else
+            {
+                stateSave.chunk = CarlaString::asBase64(data, dataSize).dup();
+            }
 
             if (pluginType != PLUGIN_INTERNAL)
                 usingChunk = true;
@@ -540,8 +580,8 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
 
     if (pData->prog.current >= 0 && pluginType != PLUGIN_LV2 && pluginType != PLUGIN_GIG)
     {
-        pData->stateSave.currentProgramIndex = pData->prog.current;
-        pData->stateSave.currentProgramName  = carla_strdup(pData->prog.names[pData->prog.current]);
+        stateSave.currentProgramIndex = pData->prog.current;
+        stateSave.currentProgramName  = carla_strdup(pData->prog.names[pData->prog.current]);
     }
 
     // ---------------------------------------------------------------
@@ -551,8 +591,8 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
     {
         const MidiProgramData& mpData(pData->midiprog.getCurrent());
 
-        pData->stateSave.currentMidiBank    = static_cast<int32_t>(mpData.bank);
-        pData->stateSave.currentMidiProgram = static_cast<int32_t>(mpData.program);
+        stateSave.currentMidiBank    = static_cast<int32_t>(mpData.bank);
+        stateSave.currentMidiProgram = static_cast<int32_t>(mpData.program);
     }
 
     // ---------------------------------------------------------------
@@ -595,7 +635,7 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
                 stateParameter->value /= sampleRate;
         }
 
-        pData->stateSave.parameters.append(stateParameter);
+        stateSave.parameters.append(stateParameter);
     }
 
     // ---------------------------------------------------------------
@@ -612,13 +652,11 @@ const CarlaStateSave& CarlaPlugin::getStateSave(const bool callPrepareForSave)
         stateCustomData->key   = carla_strdup(cData.key);
         stateCustomData->value = carla_strdup(cData.value);
 
-        pData->stateSave.customData.append(stateCustomData);
+        stateSave.customData.append(stateCustomData);
     }
-
-    return pData->stateSave;
 }
 
-void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
+void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave, const bool onlyChanges)
 {
     char strBuf[STR_MAX+1];
     const bool usesMultiProgs(pData->hints & PLUGIN_USES_MULTI_PROGS);
@@ -645,6 +683,9 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
         else
             continue;
 
+        if (onlyChanges && isCustomDataAlreadySet(pData->custom, stateCustomData))
+            continue;
+
         setCustomData(stateCustomData->type, key, stateCustomData->value, true);
     }
 
@@ -677,7 +718,7 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
         }
 
         // set program now, if valid
-        if (programId >= 0)
+        if (programId >= 0 && ! (onlyChanges && programId == pData->prog.current))
             setProgram(programId, true, true, true);
     }
 
@@ -685,7 +726,21 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     // Part 3 - set midi program
 
     if (stateSave.currentMidiBank >= 0 && stateSave.currentMidiProgram >= 0 && ! usesMultiProgs)
-        setMidiProgramById(static_cast<uint32_t>(stateSave.currentMidiBank), static_cast<uint32_t>(stateSave.currentMidiProgram), true, true, true);
+    {
+        const uint32_t bank(static_cast<uint32_t>(stateSave.currentMidiBank));
+        const uint32_t program(static_cast<uint32_t>(stateSave.currentMidiProgram));
+
+        bool alreadySet = false;
+
+        if (onlyChanges && pData->midiprog.current >= 0)
+        {
+            const MidiProgramData& mpData(pData->midiprog.getCurrent());
+            alreadySet = (mpData.bank == bank && mpData.program == program);
+        }
+
+        if (! alreadySet)
+            setMidiProgramById(bank, program, true, true, true);
+    }
 
     // ---------------------------------------------------------------
     // Part 4a - get plugin parameter symbols
@@ -712,6 +767,9 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
 
     const float sampleRate(static_cast<float>(pData->engine->getSampleRate()));
 
+    // parameters set by the state, the others are reset when only setting changes
+    std::vector<bool> paramsInState(onlyChanges ? pData->param.count : 0, false);
+
     for (CarlaStateSave::ParameterItenerator it = stateSave.parameters.begin2(); it.valid(); it.next())
     {
         CarlaStateSave::Parameter* const stateParameter(it.getValue(nullptr));
@@ -776,17 +834,25 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
         {
             //CARLA_SAFE_ASSERT(stateParameter->isInput == (pData
 
+            const uint32_t uindex(static_cast<uint32_t>(index));
+
+            if (onlyChanges)
+                paramsInState[uindex] = true;
+
             if (! stateParameter->dummy)
             {
                 if (pData->param.data[index].hints & PARAMETER_USES_SAMPLERATE)
                     stateParameter->value *= sampleRate;
 
-                setParameterValue(static_cast<uint32_t>(index), stateParameter->value, true, true, true);
+                if (! (onlyChanges && carla_isEqual(getParameterValue(uindex), stateParameter->value)))
+                    setParameterValue(uindex, stateParameter->value, true, true, true);
             }
 
 #ifndef BUILD_BRIDGE
-            setParameterMidiCC(static_cast<uint32_t>(index), stateParameter->midiCC, true, true);
-            setParameterMidiChannel(static_cast<uint32_t>(index), stateParameter->midiChannel, true, true);
+            if (! (onlyChanges && pData->param.data[index].midiCC == stateParameter->midiCC))
+                setParameterMidiCC(uindex, stateParameter->midiCC, true, true);
+            if (! (onlyChanges && pData->param.data[index].midiChannel == stateParameter->midiChannel))
+                setParameterMidiChannel(uindex, stateParameter->midiChannel, true, true);
 #endif
         }
         else
@@ -794,7 +860,40 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     }
 
     // ---------------------------------------------------------------
-    // Part 4c - clear
+    // Part 4c - reset parameters not in the state (only when setting changes)
+
+    if (onlyChanges)
+    {
+        // a chunk is in charge of the parameter values
+        const bool usingChunk((stateSave.chunk != nullptr || stateSave.chunkData != nullptr) && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0);
+
+        for (uint32_t i=0; i < pData->param.count; ++i)
+        {
+            if (paramsInState[i])
+                continue;
+
+            const ParameterData& paramData(pData->param.data[i]);
+
+            if ((paramData.hints & PARAMETER_IS_ENABLED) == 0)
+                continue;
+
+            if (paramData.type == PARAMETER_INPUT && ! usingChunk)
+            {
+                const float defValue(pData->param.ranges[i].def);
+
+                if (! carla_isEqual(getParameterValue(i), defValue))
+                    setParameterValue(i, defValue, true, true, true);
+            }
+
+#ifndef BUILD_BRIDGE
+            if (paramData.midiCC != -1)
+                setParameterMidiCC(i, -1, true, true);
+#endif
+        }
+    }
+
+    // ---------------------------------------------------------------
+    // Part 4d - clear
 
     for (LinkedList<ParamSymbol*>::Itenerator it = paramSymbols.begin2(); it.valid(); it.next())
     {
@@ -807,6 +906,8 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     // ---------------------------------------------------------------
     // Part 5 - set custom data
 
+    bool customDataChanged = false;
+
     for (CarlaStateSave::CustomDataItenerator it = stateSave.customData.begin2(); it.valid(); it.next())
     {
         const CarlaStateSave::CustomData* const stateCustomData(it.getValue(nullptr));
@@ -821,23 +922,53 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
             continue;
         if (usesMultiProgs && std::strcmp(key, "midiPrograms") == 0)
             continue;
+        if (onlyChanges && isCustomDataAlreadySet(pData->custom, stateCustomData))
+            continue;
 
         setCustomData(stateCustomData->type, key, stateCustomData->value, true);
+        customDataChanged = true;
     }
 
     // ---------------------------------------------------------------
     // Part 5x - set lv2 state
 
-    if (pluginType == PLUGIN_LV2 && pData->custom.count() > 0)
+    if (pluginType == PLUGIN_LV2 && pData->custom.count() > 0 && (customDataChanged || ! onlyChanges))
         setCustomData(CUSTOM_DATA_TYPE_STRING, "CarlaLoadLv2StateNow", "true", true);
 
     // ---------------------------------------------------------------
     // Part 6 - set chunk
 
-    if (stateSave.chunk != nullptr && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0)
+    if ((stateSave.chunk != nullptr || stateSave.chunkData != nullptr) && (pData->options & PLUGIN_OPTION_USE_CHUNKS) != 0)
     {
-        std::vector<uint8_t> chunk(carla_getChunkFromBase64String(stateSave.chunk));
-        setChunkData(chunk.data(), chunk.size());
+        std::vector<uint8_t> chunk;
+        const void* chunkData;
+        std::size_t chunkDataSize;
+
+        // binary projects give us the raw data directly
+        if (stateSave.chunkData != nullptr)
+        {
+            chunkData     = stateSave.chunkData;
+            chunkDataSize = stateSave.chunkDataSize;
+        }
+        else
+        {
+            chunk = carla_getChunkFromBase64String(stateSave.chunk);
+            chunkData     = chunk.data();
+            chunkDataSize = chunk.size();
+        }
+
+        bool alreadySet = false;
+
+        if (onlyChanges)
+        {
+            void* data = nullptr;
+            const std::size_t dataSize(getChunkData(&data));
+
+            alreadySet = (data != nullptr && dataSize == chunkDataSize && std::memcmp(data, chunkData, dataSize) == 0);
+        }
+
+        if (! alreadySet)
+            setChunkData(chunkData, chunkDataSize);
     }
 
 #ifndef BUILD_BRIDGE
@@ -850,17 +981,31 @@ void CarlaPlugin::loadStateSave(const CarlaStateSave& stateSave)
     {
         const uint option(1u << i);
 
-        if (availOptions & option)
-            setOption(option, (stateSave.options & option) != 0, true);
+        if ((availOptions & option) == 0)
+            continue;
+
+        const bool yesNo((stateSave.options & option) != 0);
+
+        if (onlyChanges && ((pData->options & option) != 0) == yesNo)
+            continue;
+
+        setOption(option, yesNo, true);
     }
 
-    setDryWet(stateSave.dryWet, true, true);
-    setVolume(stateSave.volume, true, true);
-    setBalanceLeft(stateSave.balanceLeft, true, true);
-    setBalanceRight(stateSave.balanceRight, true, true);
-    setPanning(stateSave.panning, true, true);
-    setCtrlChannel(stateSave.ctrlChannel, true, true);
-    setActive(stateSave.active, true, true);
+    if (! (onlyChanges && carla_isEqual(pData->postProc.dryWet, stateSave.dryWet)))
+        setDryWet(stateSave.dryWet, true, true);
+    if (! (onlyChanges && carla_isEqual(pData->postProc.volume, stateSave.volume)))
+        setVolume(stateSave.volume, true, true);
+    if (! (onlyChanges && carla_isEqual(pData->postProc.balanceLeft, stateSave.balanceLeft)))
+        setBalanceLeft(stateSave.balanceLeft, true, true);
+    if (! (onlyChanges && carla_isEqual(pData->postProc.balanceRight, stateSave.balanceRight)))
+        setBalanceRight(stateSave.balanceRight, true, true);
+    if (! (onlyChanges && carla_isEqual(pData->postProc.panning, stateSave.panning)))
+        setPanning(stateSave.panning, true, true);
+    if (! (onlyChanges && pData->ctrlChannel == stateSave.ctrlChannel))
+        setCtrlChannel(stateSave.ctrlChannel, true, true);
+    if (! (onlyChanges && pData->active == stateSave.active))
+        setActive(stateSave.active, true, true);
 #endif
 
     pData->engine->callback(ENGINE_CALLBACK_UPDATE, pData->id, 0, 0, 0.0f, nullptr);
@@ -1426,7 +1571,7 @@ void CarlaPlugin::idle()
         const ScopedSingleProcessLocker sspl(this, true);
 
         pData->client->setLatency(latency);
-        pData->latency.recreateBuffers(pData->latency.channels, latency);
+        pData->latency.recreateBuffers(std::max(pData->audioIn.count, pData->audioOut.count), latency);
     }
 
     const CarlaMutexLocker sl(pData->postRtEvents.mutex);
@@ -1600,6 +1745,15 @@ void CarlaPlugin::idle()
     pData->postRtEvents.data.clear();
 }
 
+uint CarlaPlugin::getIdleInterval() const noexcept
+{
+    // custom UIs idled outside the main thread need regular updates, everything else waits for requests
+    if ((pData->hints & PLUGIN_HAS_CUSTOM_UI) != 0 && (pData->hints & PLUGIN_NEEDS_UI_MAIN_THREAD) == 0)
+        return kPluginIdleInterval;
+
+    return 0;
+}
+
 bool CarlaPlugin::tryLock(const bool forcedOffline) noexcept
 {
     if (forcedOffline)
@@ -1616,6 +1770,11 @@ void CarlaPlugin::unlock() noexcept
     pData->masterMutex.unlock();
 }
 
+bool CarlaPlugin::hasPendingProcessWork() const noexcept
+{
+    return pData->needsReset || ! pData->extNotes.data.isEmpty();
+}
+
 // -------------------------------------------------------------------
 // Plugin buffers
 
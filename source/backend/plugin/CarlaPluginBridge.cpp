@@ -40,6 +40,7 @@ using juce::File;
 using juce::ScopedPointer;
 using juce::String;
 using juce::StringArray;
+using juce::StringPairArray;
 using juce::Time;
 
 CARLA_BACKEND_START_NAMESPACE
@@ -120,6 +121,9 @@ struct BridgeAudioPool {
             size = sizeof(float);
 
         data = (float*)carla_shm_map(shm, size);
+
+        if (data != nullptr)
+            CarlaThread::lockMemory(data, size);
     }
 
     CARLA_DECLARE_NON_COPY_STRUCT(BridgeAudioPool)
@@ -221,6 +225,8 @@ struct BridgeRtClientControl : public CarlaRingBufferControl<SmallStackBuffer> {
 
         if (carla_shm_map<BridgeRtClientData>(shm, data))
         {
+            CarlaThread::lockMemory(data, sizeof(BridgeRtClientData));
+
             carla_zeroStruct(data->sem);
             carla_zeroStruct(data->timeInfo);
             carla_zeroBytes(data->midiOut, kBridgeRtClientDataMidiOutSize);
@@ -471,6 +477,90 @@ struct BridgeNonRtServerControl : public CarlaRingBufferControl<HugeStackBuffer>
 
 // -------------------------------------------------------------------------------------------------------------------
 
+struct BridgeSharedHostControl : public CarlaRingBufferControl<BigStackBuffer> {
+    BridgeSharedHostData* data;
+    CarlaString filename;
+    CarlaMutex mutex;
+    carla_shm_t shm;
+
+    BridgeSharedHostControl() noexcept
+        : data(nullptr),
+          filename(),
+          mutex()
+#ifdef CARLA_PROPER_CPP11_SUPPORT
+        , shm(carla_shm_t_INIT) {}
+#else
+    {
+        carla_shm_init(shm);
+    }
+#endif
+
+    ~BridgeSharedHostControl() noexcept override
+    {
+        clear();
+    }
+
+    bool initialize() noexcept
+    {
+        char tmpFileBase[64];
+
+        std::sprintf(tmpFileBase, PLUGIN_BRIDGE_NAMEPREFIX_SHARED_HOST "XXXXXX");
+
+        shm = carla_shm_create_temp(tmpFileBase);
+
+        CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(shm), false);
+
+        if (! carla_shm_map<BridgeSharedHostData>(shm, data))
+        {
+            carla_shm_close(shm);
+            carla_shm_init(shm);
+            return false;
+        }
+
+        setRingBuffer(&data->ringBuffer, true);
+
+        filename = tmpFileBase;
+        return true;
+    }
+
+    void clear() noexcept
+    {
+        filename.clear();
+
+        if (data != nullptr)
+        {
+            carla_shm_unmap(shm, data);
+            data = nullptr;
+            setRingBuffer(nullptr, false);
+        }
+
+        if (! carla_is_shm_valid(shm))
+            return;
+
+        carla_shm_close(shm);
+        carla_shm_init(shm);
+    }
+
+    void writeOpcode(const PluginBridgeSharedHostOpcode opcode) noexcept
+    {
+        writeUInt(static_cast<uint32_t>(opcode));
+    }
+
+    void writeString(const char* const str) noexcept
+    {
+        const uint32_t size((str != nullptr) ? static_cast<uint32_t>(std::strlen(str)) : 0);
+
+        writeUInt(size);
+
+        if (size > 0)
+            writeCustomData(str, size);
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(BridgeSharedHostControl)
+};
+
+// -------------------------------------------------------------------------------------------------------------------
+
 struct BridgeParamInfo {
     float value;
     CarlaString name;
@@ -488,6 +578,250 @@ struct BridgeParamInfo {
 
 // -------------------------------------------------------------------------------------------------------------------
 
+static void getBridgeEnvironmentOptions(const EngineOptions& options, StringPairArray& env)
+{
+    env.set("ENGINE_OPTION_FORCE_STEREO",          bool2str(options.forceStereo));
+    env.set("ENGINE_OPTION_PREFER_PLUGIN_BRIDGES", bool2str(options.preferPluginBridges));
+    env.set("ENGINE_OPTION_PREFER_UI_BRIDGES",     bool2str(options.preferUiBridges));
+    env.set("ENGINE_OPTION_UIS_ALWAYS_ON_TOP",     bool2str(options.uisAlwaysOnTop));
+    env.set("ENGINE_OPTION_FLUSH_DENORMALS",       bool2str(options.flushDenormals));
+
+    env.set("ENGINE_OPTION_MAX_PARAMETERS",     String(options.maxParameters));
+    env.set("ENGINE_OPTION_UI_BRIDGES_TIMEOUT", String(options.uiBridgesTimeout));
+    env.set("ENGINE_OPTION_MIN_SUB_BLOCK_SIZE", String(options.minSubBlockSize));
+
+    env.set("ENGINE_OPTION_PLUGIN_PATH_LADSPA", (options.pathLADSPA != nullptr) ? options.pathLADSPA : "");
+    env.set("ENGINE_OPTION_PLUGIN_PATH_DSSI",   (options.pathDSSI   != nullptr) ? options.pathDSSI   : "");
+    env.set("ENGINE_OPTION_PLUGIN_PATH_LV2",    (options.pathLV2    != nullptr) ? options.pathLV2    : "");
+    env.set("ENGINE_OPTION_PLUGIN_PATH_VST2",   (options.pathVST2   != nullptr) ? options.pathVST2   : "");
+    env.set("ENGINE_OPTION_PLUGIN_PATH_VST3",   (options.pathVST3   != nullptr) ? options.pathVST3   : "");
+    env.set("ENGINE_OPTION_PLUGIN_PATH_GIG",    (options.pathGIG    != nullptr) ? options.pathGIG    : "");
+    env.set("ENGINE_OPTION_PLUGIN_PATH_SF2",    (options.pathSF2    != nullptr) ? options.pathSF2    : "");
+    env.set("ENGINE_OPTION_PLUGIN_PATH_SFZ",    (options.pathSFZ    != nullptr) ? options.pathSFZ    : "");
+
+    env.set("ENGINE_OPTION_PATH_BINARIES",  (options.binaryDir   != nullptr) ? options.binaryDir   : "");
+    env.set("ENGINE_OPTION_PATH_RESOURCES", (options.resourceDir != nullptr) ? options.resourceDir : "");
+
+    env.set("ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR", bool2str(options.preventBadBehaviour));
+
+    char strBuf[STR_MAX+1];
+    strBuf[STR_MAX] = '\0';
+    std::snprintf(strBuf, STR_MAX, P_UINTPTR, options.frontendWinId);
+    env.set("ENGINE_OPTION_FRONTEND_WIN_ID", strBuf);
+}
+
+static void setBridgeEnvironmentOptions(const EngineOptions& options)
+{
+    StringPairArray env;
+    getBridgeEnvironmentOptions(options, env);
+
+    const StringArray& keys(env.getAllKeys());
+    const StringArray& values(env.getAllValues());
+
+    for (int i=0; i < keys.size(); ++i)
+        carla_setenv(keys[i].toRawUTF8(), values[i].toRawUTF8());
+}
+
+// -------------------------------------------------------------------------------------------------------------------
+// Bridge process shared by all plugins of the same engine and bridge binary
+
+class CarlaPluginBridgeSharedHost
+{
+public:
+    static CarlaPluginBridgeSharedHost* acquire(CarlaEngine* const engine, const String& binary)
+    {
+        const CarlaMutexLocker cml(sMutex);
+
+        for (LinkedList<CarlaPluginBridgeSharedHost*>::Itenerator it = sHosts.begin2(); it.valid(); it.next())
+        {
+            CarlaPluginBridgeSharedHost* const host(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(host != nullptr);
+
+            if (host->kEngine != engine || host->fBinary != binary || ! host->isProcessRunning())
+                continue;
+
+            ++host->fRefCount;
+            return host;
+        }
+
+        CarlaPluginBridgeSharedHost* const host(new CarlaPluginBridgeSharedHost(engine, binary));
+
+        if (! host->start())
+        {
+            delete host;
+            return nullptr;
+        }
+
+        sHosts.append(host);
+        ++host->fRefCount;
+        return host;
+    }
+
+    static void release(CarlaPluginBridgeSharedHost* const host)
+    {
+        CARLA_SAFE_ASSERT_RETURN(host != nullptr,);
+
+        const CarlaMutexLocker cml(sMutex);
+
+        CARLA_SAFE_ASSERT_RETURN(host->fRefCount > 0,);
+
+        if (--host->fRefCount != 0)
+            return;
+
+        sHosts.removeOne(host);
+        delete host;
+    }
+
+    bool isProcessRunning() const noexcept
+    {
+        return (fProcess != nullptr && fProcess->isRunning());
+    }
+
+    uintptr_t getProcessPID() const noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(fProcess != nullptr, 0);
+
+        return (uintptr_t)fProcess->getPID();
+    }
+
+    // the shared process environment is only set when it starts, so each plugin sends the current engine options
+    bool addPlugin(const char* const shmIds, const PluginType ptype, const char* const filename,
+                   const char* const label, const int64_t uniqueId)
+    {
+        StringPairArray env;
+        getBridgeEnvironmentOptions(kEngine->getOptions(), env);
+
+        const StringArray& keys(env.getAllKeys());
+        const StringArray& values(env.getAllValues());
+
+        const CarlaMutexLocker cml(fShmControl.mutex);
+
+        fShmControl.writeOpcode(kPluginBridgeSharedHostAddPlugin);
+        fShmControl.writeString(shmIds);
+        fShmControl.writeUInt(static_cast<uint32_t>(ptype));
+        fShmControl.writeLong(uniqueId);
+        fShmControl.writeString(filename);
+        fShmControl.writeString(label);
+        fShmControl.writeUInt(static_cast<uint32_t>(keys.size()));
+
+        for (int i=0; i < keys.size(); ++i)
+        {
+            fShmControl.writeString(keys[i].toRawUTF8());
+            fShmControl.writeString(values[i].toRawUTF8());
+        }
+
+        return fShmControl.commitWrite();
+    }
+
+private:
+    CarlaEngine* const kEngine;
+    const String fBinary;
+
+    uint fRefCount;
+    BridgeSharedHostControl fShmControl;
+    ScopedPointer<ChildProcess> fProcess;
+
+    static CarlaMutex sMutex;
+    static LinkedList<CarlaPluginBridgeSharedHost*> sHosts;
+
+    CarlaPluginBridgeSharedHost(CarlaEngine* const engine, const String& binary) noexcept
+        : kEngine(engine),
+          fBinary(binary),
+          fRefCount(0),
+          fShmControl(),
+          fProcess() {}
+
+    ~CarlaPluginBridgeSharedHost()
+    {
+        if (isProcessRunning())
+        {
+            {
+                const CarlaMutexLocker cml(fShmControl.mutex);
+
+                fShmControl.writeOpcode(kPluginBridgeSharedHostQuit);
+                fShmControl.commitWrite();
+            }
+
+            fProcess->waitForProcessToFinish(2000);
+
+            if (fProcess->isRunning())
+            {
+                carla_stdout("CarlaPluginBridgeSharedHost - bridge refused to close, force kill now");
+                fProcess->kill();
+            }
+        }
+
+        fProcess = nullptr;
+        fShmControl.clear();
+    }
+
+    bool start()
+    {
+        if (! fShmControl.initialize())
+        {
+            carla_stderr("CarlaPluginBridgeSharedHost - failed to create shared memory");
+            return false;
+        }
+
+        StringArray arguments;
+
+#ifndef CARLA_OS_WIN
+        // start with "wine" if needed
+        if (fBinary.endsWithIgnoreCase(".exe"))
+            arguments.add("wine");
+#endif
+
+        arguments.add(fBinary);
+        arguments.add("--shared");
+
+        fProcess = new ChildProcess();
+
+        bool started;
+
+        {
+            const EngineOptions& options(kEngine->getOptions());
+            const ScopedEngineEnvironmentLocker _seel(kEngine);
+
+#ifdef CARLA_OS_LINUX
+            const char* const oldPreload(std::getenv("LD_PRELOAD"));
+
+            if (oldPreload != nullptr)
+                ::unsetenv("LD_PRELOAD");
+#endif
+
+            setBridgeEnvironmentOptions(options);
+
+            carla_setenv("ENGINE_BRIDGE_SHARED_HOST_ID", &fShmControl.filename[fShmControl.filename.length()-6]);
+            carla_setenv("WINEDEBUG", "-all");
+
+            carla_stdout("starting shared plugin bridge, command is:\n%s --shared", fBinary.toRawUTF8());
+
+            started = fProcess->start(arguments);
+
+#ifdef CARLA_OS_LINUX
+            if (oldPreload != nullptr)
+                ::setenv("LD_PRELOAD", oldPreload, 1);
+#endif
+        }
+
+        if (! started)
+        {
+            carla_stdout("failed!");
+            fProcess = nullptr;
+            return false;
+        }
+
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginBridgeSharedHost)
+};
+
+CarlaMutex CarlaPluginBridgeSharedHost::sMutex;
+LinkedList<CarlaPluginBridgeSharedHost*> CarlaPluginBridgeSharedHost::sHosts;
+
+// -------------------------------------------------------------------------------------------------------------------
+
 class CarlaPluginBridgeThread : public CarlaThread
 {
 public:
@@ -498,7 +832,8 @@ public:
           fBinary(),
           fLabel(),
           fShmIds(),
-          fProcess() {}
+          fProcess(),
+          fSharedHost(nullptr) {}
 
     void setData(const char* const binary, const char* const label, const char* const shmIds) noexcept
     {
@@ -511,12 +846,18 @@ public:
 
         if (label != nullptr)
             fLabel = label;
-        if (fLabel.isEmpty())
-            fLabel = "\"\"";
+    }
+
+    CarlaPluginBridgeSharedHost* getSharedHost() const noexcept
+    {
+        return fSharedHost;
     }
 
     uintptr_t getProcessPID() const noexcept
     {
+        if (fSharedHost != nullptr)
+            return fSharedHost->getProcessPID();
+
         CARLA_SAFE_ASSERT_RETURN(fProcess != nullptr, 0);
 
         return (uintptr_t)fProcess->getPID();
@@ -525,6 +866,9 @@ public:
 protected:
     void run()
     {
+        if (kEngine->getOptions().sharePluginBridges)
+            return runShared();
+
         if (fProcess == nullptr)
         {
             fProcess = new ChildProcess();
@@ -534,15 +878,15 @@ protected:
             carla_stderr("CarlaPluginBridgeThread::run() - already running, giving up...");
         }
 
-        String name(kPlugin->getName());
         String filename(kPlugin->getFilename());
-
-        if (name.isEmpty())
-            name = "(none)";
+        String label(fLabel);
 
         if (filename.isEmpty())
             filename = "\"\"";
 
+        if (label.isEmpty())
+            label = "\"\"";
+
         StringArray arguments;
 
 #ifndef CARLA_OS_WIN
@@ -561,7 +905,7 @@ protected:
         arguments.add(filename);
 
         // label
-        arguments.add(fLabel);
+        arguments.add(label);
 
         // uniqueId
         arguments.add(String(static_cast<juce::int64>(kPlugin->getUniqueId())));
@@ -569,9 +913,6 @@ protected:
         bool started;
 
         {
-            char strBuf[STR_MAX+1];
-            strBuf[STR_MAX] = '\0';
-
             const EngineOptions& options(kEngine->getOptions());
             const ScopedEngineEnvironmentLocker _seel(kEngine);
 
@@ -582,77 +923,13 @@ protected:
                 ::unsetenv("LD_PRELOAD");
 #endif
 
-            carla_setenv("ENGINE_OPTION_FORCE_STEREO",          bool2str(options.forceStereo));
-            carla_setenv("ENGINE_OPTION_PREFER_PLUGIN_BRIDGES", bool2str(options.preferPluginBridges));
-            carla_setenv("ENGINE_OPTION_PREFER_UI_BRIDGES",     bool2str(options.preferUiBridges));
-            carla_setenv("ENGINE_OPTION_UIS_ALWAYS_ON_TOP",     bool2str(options.uisAlwaysOnTop));
-
-            std::snprintf(strBuf, STR_MAX, "%u", options.maxParameters);
-            carla_setenv("ENGINE_OPTION_MAX_PARAMETERS", strBuf);
-
-            std::snprintf(strBuf, STR_MAX, "%u", options.uiBridgesTimeout);
-            carla_setenv("ENGINE_OPTION_UI_BRIDGES_TIMEOUT",strBuf);
-
-            if (options.pathLADSPA != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_LADSPA", options.pathLADSPA);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_LADSPA", "");
-
-            if (options.pathDSSI != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_DSSI", options.pathDSSI);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_DSSI", "");
-
-            if (options.pathLV2 != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_LV2", options.pathLV2);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_LV2", "");
-
-            if (options.pathVST2 != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_VST2", options.pathVST2);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_VST2", "");
-
-            if (options.pathVST3 != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_VST3", options.pathVST3);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_VST3", "");
-
-            if (options.pathGIG != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_GIG", options.pathGIG);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_GIG", "");
-
-            if (options.pathSF2 != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_SF2", options.pathSF2);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_SF2", "");
-
-            if (options.pathSFZ != nullptr)
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_SFZ", options.pathSFZ);
-            else
-                carla_setenv("ENGINE_OPTION_PLUGIN_PATH_SFZ", "");
-
-            if (options.binaryDir != nullptr)
-                carla_setenv("ENGINE_OPTION_PATH_BINARIES", options.binaryDir);
-            else
-                carla_setenv("ENGINE_OPTION_PATH_BINARIES", "");
-
-            if (options.resourceDir != nullptr)
-                carla_setenv("ENGINE_OPTION_PATH_RESOURCES", options.resourceDir);
-            else
-                carla_setenv("ENGINE_OPTION_PATH_RESOURCES", "");
-
-            carla_setenv("ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR", bool2str(options.preventBadBehaviour));
-
-            std::snprintf(strBuf, STR_MAX, P_UINTPTR, options.frontendWinId);
-            carla_setenv("ENGINE_OPTION_FRONTEND_WIN_ID", strBuf);
+            setBridgeEnvironmentOptions(options);
 
             carla_setenv("ENGINE_BRIDGE_SHM_IDS", fShmIds.toRawUTF8());
             carla_setenv("WINEDEBUG", "-all");
 
             carla_stdout("starting plugin bridge, command is:\n%s \"%s\" \"%s\" \"%s\" " P_INT64,
-                         fBinary.toRawUTF8(), getPluginTypeAsString(kPlugin->getType()), filename.toRawUTF8(), fLabel.toRawUTF8(), kPlugin->getUniqueId());
+                         fBinary.toRawUTF8(), getPluginTypeAsString(kPlugin->getType()), filename.toRawUTF8(), label.toRawUTF8(), kPlugin->getUniqueId());
 
             started = fProcess->start(arguments);
 
@@ -707,6 +984,43 @@ protected:
         fProcess = nullptr;
     }
 
+    void runShared()
+    {
+        CarlaPluginBridgeSharedHost* const sharedHost(CarlaPluginBridgeSharedHost::acquire(kEngine, fBinary));
+        CARLA_SAFE_ASSERT_RETURN(sharedHost != nullptr,);
+
+        carla_stdout("adding plugin to shared bridge %s", fBinary.toRawUTF8());
+
+        if (! sharedHost->addPlugin(fShmIds.toRawUTF8(), kPlugin->getType(), kPlugin->getFilename(), fLabel.toRawUTF8(), kPlugin->getUniqueId()))
+        {
+            carla_stderr("CarlaPluginBridgeThread::runShared() - failed to send plugin to shared bridge");
+            CarlaPluginBridgeSharedHost::release(sharedHost);
+            return;
+        }
+
+        fSharedHost = sharedHost;
+
+        for (; sharedHost->isProcessRunning() && ! shouldThreadExit();)
+            carla_sleep(1);
+
+        // plugin quit is requested through its own non-rt channel, the shared process stays up for the others
+        if (! shouldThreadExit())
+        {
+            carla_stderr("CarlaPluginBridgeThread::runShared() - shared bridge crashed");
+
+            CarlaString errorString("Plugin '" + CarlaString(kPlugin->getName()) + "' has crashed!\n"
+                                    "All plugins running in the same shared bridge were affected.\n"
+                                    "Saving now will lose its current settings.\n"
+                                    "Please remove this plugin, and not rely on it from this point.");
+            kEngine->callback(CarlaBackend::ENGINE_CALLBACK_ERROR, kPlugin->getId(), 0, 0, 0.0f, errorString);
+        }
+
+        fSharedHost = nullptr;
+        CarlaPluginBridgeSharedHost::release(sharedHost);
+
+        carla_stdout("shared plugin bridge finished");
+    }
+
 private:
     CarlaEngine* const kEngine;
     CarlaPlugin* const kPlugin;
@@ -716,6 +1030,7 @@ private:
     String fShmIds;
 
     ScopedPointer<ChildProcess> fProcess;
+    CarlaPluginBridgeSharedHost* fSharedHost;
 
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPluginBridgeThread)
 };
@@ -734,6 +1049,10 @@ public:
           fSaved(true),
           fTimedOut(false),
           fTimedError(false),
+          fRealtimeSent(false),
+          fChainNext(nullptr),
+          fChained(false),
+          fChainedCycle(0),
           fLastPongTime(-1),
           fBridgeBinary(),
           fBridgeThread(engine, this),
@@ -1210,6 +1529,12 @@ public:
         CarlaPlugin::idle();
     }
 
+    uint getIdleInterval() const noexcept override
+    {
+        // the bridge needs regular pings and its non-RT data read
+        return kPluginIdleInterval;
+    }
+
     // -------------------------------------------------------------------
     // Plugin state
 
@@ -1392,39 +1717,106 @@ public:
 
         fTimedOut = false;
 
-        try {
-            waitForClient("deactivate", 2);
-        } CARLA_SAFE_EXCEPTION("deactivate - waitForClient");
-    }
+        try {
+            waitForClient("deactivate", 2);
+        } CARLA_SAFE_EXCEPTION("deactivate - waitForClient");
+    }
+
+    void process(const float** const audioIn, float** const audioOut, const float** const cvIn, float** const cvOut, const uint32_t frames) override
+    {
+        // --------------------------------------------------------------------------------------------------------
+        // Check if active
+
+        if (fTimedOut || fTimedError || ! pData->active)
+        {
+            // disable any output sound
+            for (uint32_t i=0; i < pData->audioOut.count; ++i)
+                FloatVectorOperations::clear(audioOut[i], static_cast<int>(frames));
+            for (uint32_t i=0; i < pData->cvOut.count; ++i)
+                FloatVectorOperations::clear(cvOut[i], static_cast<int>(frames));
+            return;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Check if needs reset
+
+        if (pData->needsReset)
+        {
+            // TODO
+
+            pData->needsReset = false;
+        }
+
+        // --------------------------------------------------------------------------------------------------------
+        // Check if already run by a previous plugin of the same shared bridge, see prepareChain()
+
+        const bool chained(fChained && fChainedCycle == pData->engine->getProcessCycle());
+        fChained = false;
+
+        // --------------------------------------------------------------------------------------------------------
+        // Event Input
+
+        if (! chained)
+            processEventInput();
+
+        if (! processSingle(audioIn, audioOut, cvIn, cvOut, frames, chained))
+            return;
+
+        // --------------------------------------------------------------------------------------------------------
+        // Control and MIDI Output
+
+        if (pData->event.portOut != nullptr)
+        {
+            float value;
+
+            for (uint32_t k=0; k < pData->param.count; ++k)
+            {
+                if (pData->param.data[k].type != PARAMETER_OUTPUT)
+                    continue;
+
+                if (pData->param.data[k].midiCC > 0)
+                {
+                    value = pData->param.ranges[k].getNormalizedValue(fParams[k].value);
+                    pData->event.portOut->writeControlEvent(0, pData->param.data[k].midiChannel, kEngineControlEventTypeParameter, static_cast<uint16_t>(pData->param.data[k].midiCC), value);
+                }
+            }
+
+            uint8_t size;
+            uint32_t time;
+            const uint8_t* midiData(fShmRtClientControl.data->midiOut);
+
+            for (std::size_t read=0; read<kBridgeRtClientDataMidiOutSize;)
+            {
+                size = *midiData;
+
+                if (size == 0)
+                    break;
+
+                // advance 8 bits (1 byte)
+                midiData = midiData + 1;
+
+                // get time as 32bit
+                time = *(const uint32_t*)midiData;
 
-    void process(const float** const audioIn, float** const audioOut, const float** const cvIn, float** const cvOut, const uint32_t frames) override
-    {
-        // --------------------------------------------------------------------------------------------------------
-        // Check if active
+                // advance 32 bits (4 bytes)
+                midiData = midiData + 4;
 
-        if (fTimedOut || fTimedError || ! pData->active)
-        {
-            // disable any output sound
-            for (uint32_t i=0; i < pData->audioOut.count; ++i)
-                FloatVectorOperations::clear(audioOut[i], static_cast<int>(frames));
-            for (uint32_t i=0; i < pData->cvOut.count; ++i)
-                FloatVectorOperations::clear(cvOut[i], static_cast<int>(frames));
-            return;
-        }
+                // store midi data advancing as needed
+                uint8_t data[size];
 
-        // --------------------------------------------------------------------------------------------------------
-        // Check if needs reset
+                for (uint8_t j=0; j<size; ++j)
+                    data[j] = *midiData++;
 
-        if (pData->needsReset)
-        {
-            // TODO
+                pData->event.portOut->writeMidiEvent(time, size, data);
 
-            pData->needsReset = false;
-        }
+                read += 1U /* size*/ + 4U /* time */ + size;
+            }
 
-        // --------------------------------------------------------------------------------------------------------
-        // Event Input
+        } // End of Control and MIDI Output
+    }
 
+    void processEventInput()
+    {
         if (pData->event.portIn != nullptr)
         {
             // ----------------------------------------------------------------------------------------------------
@@ -1639,67 +2031,13 @@ public:
                 }
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
         } // End of Event Input
-
-        if (! processSingle(audioIn, audioOut, cvIn, cvOut, frames))
-            return;
-
-        // --------------------------------------------------------------------------------------------------------
-        // Control and MIDI Output
-
-        if (pData->event.portOut != nullptr)
-        {
-            float value;
-
-            for (uint32_t k=0; k < pData->param.count; ++k)
-            {
-                if (pData->param.data[k].type != PARAMETER_OUTPUT)
-                    continue;
-
-                if (pData->param.data[k].midiCC > 0)
-                {
-                    value = pData->param.ranges[k].getNormalizedValue(fParams[k].value);
-                    pData->event.portOut->writeControlEvent(0, pData->param.data[k].midiChannel, kEngineControlEventTypeParameter, static_cast<uint16_t>(pData->param.data[k].midiCC), value);
-                }
-            }
-
-            uint8_t size;
-            uint32_t time;
-            const uint8_t* midiData(fShmRtClientControl.data->midiOut);
-
-            for (std::size_t read=0; read<kBridgeRtClientDataMidiOutSize;)
-            {
-                size = *midiData;
-
-                if (size == 0)
-                    break;
-
-                // advance 8 bits (1 byte)
-                midiData = midiData + 1;
-
-                // get time as 32bit
-                time = *(const uint32_t*)midiData;
-
-                // advance 32 bits (4 bytes)
-                midiData = midiData + 4;
-
-                // store midi data advancing as needed
-                uint8_t data[size];
-
-                for (uint8_t j=0; j<size; ++j)
-                    data[j] = *midiData++;
-
-                pData->event.portOut->writeMidiEvent(time, size, data);
-
-                read += 1U /* size*/ + 4U /* time */ + size;
-            }
-
-        } // End of Control and MIDI Output
     }
 
-    bool processSingle(const float** const audioIn, float** const audioOut, const float** const cvIn, float** const cvOut, const uint32_t frames)
+    bool processSingle(const float** const audioIn, float** const audioOut, const float** const cvIn, float** const cvOut, const uint32_t frames, const bool chained)
     {
         CARLA_SAFE_ASSERT_RETURN(! fTimedError, false);
         CARLA_SAFE_ASSERT_RETURN(frames > 0, false);
@@ -1738,47 +2076,9 @@ public:
         }
 
         // --------------------------------------------------------------------------------------------------------
-        // Reset audio buffers
-
-        for (uint32_t i=0; i < fInfo.aIns; ++i)
-            FloatVectorOperations::copy(fShmAudioPool.data + (i * frames), audioIn[i], static_cast<int>(frames));
-
-        // --------------------------------------------------------------------------------------------------------
-        // TimeInfo
-
-        const EngineTimeInfo& timeInfo(pData->engine->getTimeInfo());
-        BridgeTimeInfo& bridgeTimeInfo(fShmRtClientControl.data->timeInfo);
-
-        bridgeTimeInfo.playing = timeInfo.playing;
-        bridgeTimeInfo.frame   = timeInfo.frame;
-        bridgeTimeInfo.usecs   = timeInfo.usecs;
-        bridgeTimeInfo.valid   = timeInfo.valid;
-
-        if (timeInfo.valid & EngineTimeInfo::kValidBBT)
-        {
-            bridgeTimeInfo.bar  = timeInfo.bbt.bar;
-            bridgeTimeInfo.beat = timeInfo.bbt.beat;
-            bridgeTimeInfo.tick = timeInfo.bbt.tick;
-
-            bridgeTimeInfo.beatsPerBar = timeInfo.bbt.beatsPerBar;
-            bridgeTimeInfo.beatType    = timeInfo.bbt.beatType;
-
-            bridgeTimeInfo.ticksPerBeat   = timeInfo.bbt.ticksPerBeat;
-            bridgeTimeInfo.beatsPerMinute = timeInfo.bbt.beatsPerMinute;
-            bridgeTimeInfo.barStartTick   = timeInfo.bbt.barStartTick;
-        }
-
-        // --------------------------------------------------------------------------------------------------------
-        // Run plugin
-
-        {
-            fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
-            fShmRtClientControl.commitWrite();
-        }
-
-        waitForClient("process", 1);
+        // Run plugin, unless the bridge did it already
 
-        if (fTimedOut)
+        if (! chained && ! runProcess(audioIn, frames))
         {
             pData->singleMutex.unlock();
             return false;
@@ -1797,7 +2097,8 @@ public:
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float bufValue;
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1860,8 +2161,218 @@ public:
         return true;
     }
 
+    // called with singleMutex locked
+    bool runProcess(const float** const audioIn, const uint32_t frames)
+    {
+        // --------------------------------------------------------------------------------------------------------
+        // Reset audio buffers
+
+        for (uint32_t i=0; i < fInfo.aIns; ++i)
+            FloatVectorOperations::copy(fShmAudioPool.data + (i * frames), audioIn[i], static_cast<int>(frames));
+
+        writeTimeInfo();
+
+        // --------------------------------------------------------------------------------------------------------
+        // Run plugin
+
+        if (! fRealtimeSent)
+        {
+            // bridge RT thread follows the scheduling of the thread that drives it
+            fShmRtClientControl.writeOpcode(kPluginBridgeRtClientSetRealtime);
+            fShmRtClientControl.writeInt(CarlaThread::getCurrentThreadRealtimePriority());
+            fShmRtClientControl.writeULong(CarlaThread::getCurrentThreadAffinityMask());
+            fRealtimeSent = true;
+        }
+
+        const uint32_t chainCount(prepareChain());
+
+        if (chainCount == 0)
+        {
+            fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
+            fShmRtClientControl.commitWrite();
+        }
+        else
+        {
+            fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcessChain);
+            fShmRtClientControl.writeUInt(chainCount);
+
+            for (CarlaPluginBridge* next = fChainNext; next != nullptr; next = next->fChainNext)
+                fShmRtClientControl.writeCustomData(next->getRtClientId(), 6);
+
+            fShmRtClientControl.commitWrite();
+        }
+
+        waitForClient("process", 1);
+
+        if (chainCount != 0)
+            finishChain(frames);
+
+        return ! fTimedOut;
+    }
+
+    void writeTimeInfo() noexcept
+    {
+        const EngineTimeInfo& timeInfo(pData->engine->getTimeInfo());
+        BridgeTimeInfo& bridgeTimeInfo(fShmRtClientControl.data->timeInfo);
+
+        bridgeTimeInfo.playing = timeInfo.playing;
+        bridgeTimeInfo.frame   = timeInfo.frame;
+        bridgeTimeInfo.usecs   = timeInfo.usecs;
+        bridgeTimeInfo.valid   = timeInfo.valid;
+
+        if (timeInfo.valid & EngineTimeInfo::kValidBBT)
+        {
+            bridgeTimeInfo.bar  = timeInfo.bbt.bar;
+            bridgeTimeInfo.beat = timeInfo.bbt.beat;
+            bridgeTimeInfo.tick = timeInfo.bbt.tick;
+
+            bridgeTimeInfo.beatsPerBar = timeInfo.bbt.beatsPerBar;
+            bridgeTimeInfo.beatType    = timeInfo.bbt.beatType;
+
+            bridgeTimeInfo.ticksPerBeat   = timeInfo.bbt.ticksPerBeat;
+            bridgeTimeInfo.beatsPerMinute = timeInfo.bbt.beatsPerMinute;
+            bridgeTimeInfo.barStartTick   = timeInfo.bbt.barStartTick;
+        }
+    }
+
+    // --------------------------------------------------------------------------------------------------------
+    // Shared bridge chains
+    //
+    // In rack mode, the plugins right after this one that live in the same shared bridge are run by the bridge
+    // right after it, feeding each plugin outputs into the next one inputs.
+    // This costs a single wakeup of the bridge for the whole chain instead of one per plugin.
+    // Chained plugins get their events written here, and only read their outputs once the engine gets to them.
+
+    // called with singleMutex locked, returns the number of plugins chained after this one
+    uint32_t prepareChain()
+    {
+        fChainNext = nullptr;
+
+        const CarlaPluginBridgeSharedHost* const sharedHost(fBridgeThread.getSharedHost());
+
+        if (sharedHost == nullptr)
+            return 0;
+
+        const EngineOptions& options(pData->engine->getOptions());
+
+        // the engine changes the audio in between plugins otherwise
+        if (options.processMode != ENGINE_PROCESS_MODE_CONTINUOUS_RACK || options.antiDenormalOffset)
+            return 0;
+
+        const uint32_t cycle(pData->engine->getProcessCycle());
+        const uint pluginCount(pData->engine->getCurrentPluginCount());
+
+        CarlaPluginBridge* prev(this);
+        uint32_t count = 0;
+
+        for (uint id = pData->id + 1; id < pluginCount && prev->canFeedNextInChain(); ++id)
+        {
+            CarlaPlugin* const plugin(pData->engine->getPluginUnchecked(id));
+
+            if (plugin == nullptr || (plugin->getHints() & PLUGIN_IS_BRIDGE) == 0)
+                break;
+
+            CarlaPluginBridge* const next((CarlaPluginBridge*)plugin);
+
+            if (next->fBridgeThread.getSharedHost() != sharedHost || ! next->lockForChain())
+                break;
+
+            next->initBuffers();
+            next->processEventInput();
+            next->writeTimeInfo();
+
+            next->fShmRtClientControl.writeOpcode(kPluginBridgeRtClientProcess);
+            next->fShmRtClientControl.commitWrite();
+
+            next->fChained      = true;
+            next->fChainedCycle = cycle;
+            next->fChainNext    = nullptr;
+
+            prev->fChainNext = next;
+            prev = next;
+            ++count;
+        }
+
+        return count;
+    }
+
+    // called after the bridge ran the chain, runs the plugins it could not get to and unlocks them all
+    void finishChain(const uint32_t frames) noexcept
+    {
+        const CarlaPluginBridge* prev(this);
+
+        for (CarlaPluginBridge* next = fChainNext; next != nullptr; prev = next, next = next->fChainNext)
+        {
+            if (fTimedOut)
+            {
+                // the shared bridge is stuck, so are all of its plugins
+                next->fTimedOut = true;
+            }
+            else if (next->fShmRtClientControl.isDataAvailableForReading())
+            {
+                // the bridge did not get to this one, its events are still pending
+                for (uint32_t i=0; i < next->fInfo.aIns; ++i)
+                    FloatVectorOperations::copy(next->fShmAudioPool.data + (i * frames),
+                                                prev->fShmAudioPool.data + ((i + prev->fInfo.aIns) * frames), static_cast<int>(frames));
+
+                next->waitForClient("process", 1);
+            }
+
+            next->pData->singleMutex.unlock();
+            next->unlock();
+        }
+    }
+
+    bool lockForChain() noexcept
+    {
+        if (fTimedOut || fTimedError || ! pData->enabled || ! pData->active)
+            return false;
+
+        // rack mode has no cv, and stereo audio only
+        if (getAudioInCount() > 2 || getCVInCount() != 0 || getCVOutCount() != 0)
+            return false;
+
+        if (! tryLock(false))
+            return false;
+
+        if (! pData->singleMutex.tryLock())
+        {
+            unlock();
+            return false;
+        }
+
+        return true;
+    }
+
+    // outputs go untouched into the next plugin, as the engine would do in rack mode
+    bool canFeedNextInChain() const noexcept
+    {
+        if (getAudioInCount() == 0 || getAudioOutCount() != 2 || getMidiOutCount() != 0)
+            return false;
+
+#ifndef BUILD_BRIDGE
+        if ((pData->hints & PLUGIN_CAN_VOLUME) != 0 && carla_isNotEqual(pData->postProc.volume, 1.0f))
+            return false;
+        if ((pData->hints & PLUGIN_CAN_DRYWET) != 0 && carla_isNotEqual(pData->postProc.dryWet, 1.0f))
+            return false;
+        if ((pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f)))
+            return false;
+#endif
+
+        return true;
+    }
+
+    const char* getRtClientId() const noexcept
+    {
+        return fShmRtClientControl.filename.buffer() + (fShmRtClientControl.filename.length() - 6);
+    }
+
     void bufferSizeChanged(const uint32_t newBufferSize) override
     {
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#endif
+
         resizeAudioPool(newBufferSize);
 
         {
@@ -2595,6 +3106,12 @@ private:
     bool fSaved;
     bool fTimedOut;
     bool fTimedError;
+    bool fRealtimeSent;
+
+    // shared bridge chains, see prepareChain()
+    CarlaPluginBridge* fChainNext;
+    bool fChained;
+    uint32_t fChainedCycle;
 
     int64_t fLastPongTime;
 
@@ -2647,6 +3164,9 @@ private:
 
         fShmRtClientControl.commitWrite();
 
+        // engine might have restarted with a different audio thread
+        fRealtimeSent = false;
+
         waitForClient("resize-pool");
     }
 
@@ -1434,11 +1434,10 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
-                if (isSampleAccurate && event.time > timeOffset)
+                if (isSampleAccurate && pData->shouldSplitBlock(event, timeOffset))
                 {
                     if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset, midiEventCount))
                     {
-                        startTime  = 0;
                         timeOffset = event.time;
                         midiEventCount = 0;
 
@@ -1447,10 +1446,11 @@ public:
                         else
                             nextBankId = 0;
                     }
-                    else
-                        startTime += timeOffset;
                 }
 
+                // time within the current sub-block, events that did not split it keep their offset
+                startTime = event.time - timeOffset;
+
                 switch (event.type)
                 {
                 case kEngineEventTypeNull:
@@ -1737,7 +1737,8 @@ public:
                 } // switch (event.type)
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             if (frames > timeOffset)
                 processSingle(audioIn, audioOut, frames - timeOffset, timeOffset, midiEventCount);
@@ -1929,7 +1930,8 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float bufValue;
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -2018,6 +2020,10 @@ public:
         CARLA_ASSERT_INT(newBufferSize > 0, newBufferSize);
         carla_debug("CarlaPluginDSSI::bufferSizeChanged(%i) - start", newBufferSize);
 
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#endif
+
         const int iBufferSize(static_cast<int>(newBufferSize));
 
         for (uint32_t i=0; i < pData->audioIn.count; ++i)
@@ -37,6 +37,239 @@ using juce::StringArray;
 
 CARLA_BACKEND_START_NAMESPACE
 
+// -------------------------------------------------------------------------------------------------------------------
+// Process-wide SoundFont cache
+//
+// Loading a SoundFont reads all of its sample data into memory.
+// In order not to duplicate that for each instance using the same file, each SoundFont is loaded only once
+// (keyed by filename and modification time) and handed to each synth through a lightweight proxy.
+
+class FluidSynthSoundFontCache
+{
+public:
+    // returns a new proxy sfont to be given to fluid_synth_add_sfont(), or null on failure
+    static fluid_sfont_t* acquire(const char* const filename)
+    {
+        CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', nullptr);
+
+        const int64_t mtime(juce::File(filename).getLastModificationTime().toMilliseconds());
+
+        const CarlaMutexLocker cml(sMutex);
+
+        SharedSoundFont* shared = nullptr;
+
+        for (LinkedList<SharedSoundFont*>::Itenerator it = sFonts.begin2(); it.valid(); it.next())
+        {
+            SharedSoundFont* const font(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(font != nullptr);
+
+            if (font->mtime == mtime && font->filename == filename)
+            {
+                shared = font;
+                break;
+            }
+        }
+
+        if (shared == nullptr)
+        {
+            fluid_sfont_t* const sfont(load(filename));
+
+            if (sfont == nullptr)
+                return nullptr;
+
+            shared = new SharedSoundFont(filename, mtime, sfont);
+            sFonts.append(shared);
+        }
+
+        ++shared->refCount;
+
+        fluid_sfont_t* const proxy(new fluid_sfont_t);
+        carla_zeroStruct(*proxy);
+
+        proxy->data            = shared;
+        proxy->free            = _sfont_free;
+        proxy->get_name        = _sfont_get_name;
+        proxy->get_preset      = _sfont_get_preset;
+        proxy->iteration_start = _sfont_iteration_start;
+        proxy->iteration_next  = _sfont_iteration_next;
+
+        return proxy;
+    }
+
+private:
+    struct SharedSoundFont {
+        CarlaString    filename;
+        int64_t        mtime;
+        fluid_sfont_t* sfont;
+        uint           refCount;
+
+        SharedSoundFont(const char* const fname, const int64_t mt, fluid_sfont_t* const sf) noexcept
+            : filename(fname),
+              mtime(mt),
+              sfont(sf),
+              refCount(0) {}
+
+        CARLA_DECLARE_NON_COPY_STRUCT(SharedSoundFont)
+    };
+
+    static CarlaMutex sMutex;
+    static LinkedList<SharedSoundFont*> sFonts;
+
+    // load using a temporary synth, then take the sfont away from it
+    static fluid_sfont_t* load(const char* const filename)
+    {
+        fluid_settings_t* const settings(new_fluid_settings());
+        CARLA_SAFE_ASSERT_RETURN(settings != nullptr, nullptr);
+
+        fluid_synth_t* const synth(new_fluid_synth(settings));
+
+        if (synth == nullptr)
+        {
+            carla_safe_assert("synth != nullptr", __FILE__, __LINE__);
+            delete_fluid_settings(settings);
+            return nullptr;
+        }
+
+        fluid_sfont_t* sfont = nullptr;
+        const int id(fluid_synth_sfload(synth, filename, 0));
+
+        if (id >= 0)
+        {
+            sfont = fluid_synth_get_sfont_by_id(synth, static_cast<uint>(id));
+
+            if (sfont != nullptr)
+                fluid_synth_remove_sfont(synth, sfont);
+        }
+
+        delete_fluid_synth(synth);
+        delete_fluid_settings(settings);
+
+        return sfont;
+    }
+
+    static SharedSoundFont* getShared(fluid_sfont_t* const proxy) noexcept
+    {
+        return static_cast<SharedSoundFont*>(proxy->data);
+    }
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // sfont proxy
+
+    static int _sfont_free(fluid_sfont_t* proxy)
+    {
+        SharedSoundFont* const shared(getShared(proxy));
+        delete proxy;
+
+        const CarlaMutexLocker cml(sMutex);
+
+        CARLA_SAFE_ASSERT_RETURN(shared->refCount > 0, 0);
+
+        if (--shared->refCount == 0)
+        {
+            sFonts.removeOne(shared);
+            shared->sfont->free(shared->sfont);
+            delete shared;
+        }
+
+        return 0;
+    }
+
+    static char* _sfont_get_name(fluid_sfont_t* proxy)
+    {
+        fluid_sfont_t* const sfont(getShared(proxy)->sfont);
+        return sfont->get_name(sfont);
+    }
+
+    static fluid_preset_t* _sfont_get_preset(fluid_sfont_t* proxy, unsigned int bank, unsigned int prenum)
+    {
+        fluid_sfont_t* const sfont(getShared(proxy)->sfont);
+        fluid_preset_t* const real(sfont->get_preset(sfont, bank, prenum));
+
+        if (real == nullptr)
+            return nullptr;
+
+        // wrap preset so the synth sees it as belonging to the proxy
+        fluid_preset_t* const preset(new fluid_preset_t);
+        carla_zeroStruct(*preset);
+
+        preset->data        = real;
+        preset->sfont       = proxy;
+        preset->free        = _preset_free;
+        preset->get_name    = _preset_get_name;
+        preset->get_banknum = _preset_get_banknum;
+        preset->get_num     = _preset_get_num;
+        preset->noteon      = _preset_noteon;
+        preset->notify      = (real->notify != nullptr) ? _preset_notify : nullptr;
+
+        return preset;
+    }
+
+    static void _sfont_iteration_start(fluid_sfont_t* proxy)
+    {
+        fluid_sfont_t* const sfont(getShared(proxy)->sfont);
+        sfont->iteration_start(sfont);
+    }
+
+    static int _sfont_iteration_next(fluid_sfont_t* proxy, fluid_preset_t* preset)
+    {
+        fluid_sfont_t* const sfont(getShared(proxy)->sfont);
+        return sfont->iteration_next(sfont, preset);
+    }
+
+    // ---------------------------------------------------------------------------------------------------------------
+    // preset proxy
+
+    static fluid_preset_t* getReal(fluid_preset_t* const preset) noexcept
+    {
+        return static_cast<fluid_preset_t*>(preset->data);
+    }
+
+    static int _preset_free(fluid_preset_t* preset)
+    {
+        fluid_preset_t* const real(getReal(preset));
+        delete preset;
+
+        if (real->free != nullptr)
+            return real->free(real);
+        return 0;
+    }
+
+    static char* _preset_get_name(fluid_preset_t* preset)
+    {
+        fluid_preset_t* const real(getReal(preset));
+        return real->get_name(real);
+    }
+
+    static int _preset_get_banknum(fluid_preset_t* preset)
+    {
+        fluid_preset_t* const real(getReal(preset));
+        return real->get_banknum(real);
+    }
+
+    static int _preset_get_num(fluid_preset_t* preset)
+    {
+        fluid_preset_t* const real(getReal(preset));
+        return real->get_num(real);
+    }
+
+    static int _preset_noteon(fluid_preset_t* preset, fluid_synth_t* synth, int chan, int key, int vel)
+    {
+        fluid_preset_t* const real(getReal(preset));
+        return real->noteon(real, synth, chan, key, vel);
+    }
+
+    static int _preset_notify(fluid_preset_t* preset, int reason, int chan)
+    {
+        fluid_preset_t* const real(getReal(preset));
+        return real->notify(real, reason, chan);
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(FluidSynthSoundFontCache)
+};
+
+CarlaMutex FluidSynthSoundFontCache::sMutex;
+LinkedList<FluidSynthSoundFontCache::SharedSoundFont*> FluidSynthSoundFontCache::sFonts;
+
 // -----------------------------------------------------
 
 class CarlaPluginFluidSynth : public CarlaPlugin
@@ -1348,7 +1581,8 @@ public:
                 } // switch (event.type)
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             if (frames > timeOffset)
                 processSingle(audioOut, frames - timeOffset, timeOffset);
@@ -1420,7 +1654,7 @@ public:
             const bool doVolume  = (pData->hints & PLUGIN_CAN_VOLUME) != 0 && carla_isNotEqual(pData->postProc.volume, 1.0f);
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
 
-            float oldBufLeft[doBalance ? frames : 1];
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1483,6 +1717,10 @@ public:
 
     void bufferSizeChanged(const uint32_t newBufferSize) override
     {
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#endif
+
         if (! kUse16Outs)
             return;
 
@@ -1579,10 +1817,19 @@ public:
         // ---------------------------------------------------------------
         // open soundfont
 
-        const int synthId(fluid_synth_sfload(fSynth, filename, 0));
+        fluid_sfont_t* const sfont(FluidSynthSoundFontCache::acquire(filename));
+
+        if (sfont == nullptr)
+        {
+            pData->engine->setLastError("Failed to load SoundFont file");
+            return false;
+        }
+
+        const int synthId(fluid_synth_add_sfont(fSynth, sfont));
 
         if (synthId < 0)
         {
+            sfont->free(sfont);
             pData->engine->setLastError("Failed to load SoundFont file");
             return false;
         }
@@ -482,17 +482,41 @@ CarlaPlugin::ProtectedData::PostRtEvents::~PostRtEvents() noexcept
 
 void CarlaPlugin::ProtectedData::PostRtEvents::appendRT(const PluginPostRtEvent& e) noexcept
 {
+    // dense automation only needs the latest value of each parameter
+    if (e.type == kPluginPostRtEventParameterChange)
+    {
+        static PluginPostRtEvent kFallback = { kPluginPostRtEventNull, 0, 0, 0.0f };
+
+        for (RtLinkedList<PluginPostRtEvent>::Itenerator it = dataPendingRT.begin2(); it.valid(); it.next())
+        {
+            PluginPostRtEvent& pending(it.getValue(kFallback));
+
+            if (pending.type != e.type || pending.value1 != e.value1 || pending.value2 != e.value2)
+                continue;
+
+            pending.value3 = e.value3;
+            return;
+        }
+    }
+
     dataPendingRT.append(e);
 }
 
-void CarlaPlugin::ProtectedData::PostRtEvents::trySplice() noexcept
+bool CarlaPlugin::ProtectedData::PostRtEvents::trySplice() noexcept
 {
+    bool spliced = false;
+
     if (mutex.tryLock())
     {
         if (dataPendingRT.count() > 0)
+        {
             dataPendingRT.moveTo(data, true);
+            spliced = true;
+        }
         mutex.unlock();
     }
+
+    return spliced;
 }
 
 void CarlaPlugin::ProtectedData::PostRtEvents::clear() noexcept
@@ -538,7 +562,39 @@ CarlaPlugin::ProtectedData::PostProc::PostProc() noexcept
       volume(1.0f),
       balanceLeft(-1.0f),
       balanceRight(1.0f),
-      panning(0.0f) {}
+      panning(0.0f),
+      extraBuffer(nullptr),
+      extraBufferSize(0) {}
+
+CarlaPlugin::ProtectedData::PostProc::~PostProc() noexcept
+{
+    if (extraBuffer != nullptr)
+    {
+        delete[] extraBuffer;
+        extraBuffer = nullptr;
+    }
+}
+
+void CarlaPlugin::ProtectedData::PostProc::recreateBuffer(const uint32_t newFrames)
+{
+    CARLA_SAFE_ASSERT_RETURN(newFrames > 0,);
+
+    if (extraBufferSize == newFrames)
+        return;
+
+    if (extraBuffer != nullptr)
+    {
+        delete[] extraBuffer;
+        extraBuffer = nullptr;
+    }
+
+    extraBufferSize = 0;
+
+    extraBuffer = new float[newFrames];
+    extraBufferSize = newFrames;
+
+    FloatVectorOperations::clear(extraBuffer, static_cast<int>(newFrames));
+}
 #endif
 
 // -----------------------------------------------------------------------
@@ -705,6 +761,19 @@ void CarlaPlugin::ProtectedData::postponeRtEvent(const PluginPostRtEventType typ
     postRtEvents.appendRT(rtEvent);
 }
 
+// -----------------------------------------------------------------------
+// Event processing
+
+bool CarlaPlugin::ProtectedData::shouldSplitBlock(const EngineEvent& event, const uint32_t timeOffset) const noexcept
+{
+    if (event.type != kEngineEventTypeControl)
+        return false;
+    if (event.time <= timeOffset)
+        return false;
+
+    return (event.time - timeOffset >= engine->getOptions().minSubBlockSize);
+}
+
 // -----------------------------------------------------------------------
 // Library functions
 
@@ -741,6 +810,16 @@ bool CarlaPlugin::ProtectedData::uiLibClose() noexcept
     return ret;
 }
 
+bool CarlaPlugin::prewarmLibrary(const char* const filename) noexcept
+{
+    return sLibCounter.prewarm(filename);
+}
+
+void CarlaPlugin::releasePrewarmedLibraries() noexcept
+{
+    sLibCounter.releasePrewarmed();
+}
+
 // -----------------------------------------------------------------------
 
 #ifndef BUILD_BRIDGE
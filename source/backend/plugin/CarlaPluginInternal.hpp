@@ -34,6 +34,8 @@ using juce::FloatVectorOperations;
 
 CARLA_BACKEND_START_NAMESPACE
 
+struct EngineEvent;
+
 // -----------------------------------------------------------------------
 // Engine helper macro, sets lastError and returns false/NULL
 
@@ -48,6 +50,11 @@ CARLA_BACKEND_START_NAMESPACE
 
 const ushort kPluginMaxMidiEvents = 512;
 
+// -----------------------------------------------------------------------
+// Idle interval for plugins that need regular idle, in milliseconds
+
+const uint kPluginIdleInterval = 25;
+
 // -----------------------------------------------------------------------
 // Extra plugin hints, hidden from backend
 
@@ -290,8 +297,8 @@ struct CarlaPlugin::ProtectedData {
 
         PostRtEvents() noexcept;
         ~PostRtEvents() noexcept;
-        void appendRT(const PluginPostRtEvent& event) noexcept;
-        void trySplice() noexcept;
+        void appendRT(const PluginPostRtEvent& event) noexcept; // coalesces parameter changes
+        bool trySplice() noexcept; // returns true if events are ready for idle
         void clear() noexcept;
 
         CARLA_DECLARE_NON_COPY_STRUCT(PostRtEvents)
@@ -319,7 +326,13 @@ struct CarlaPlugin::ProtectedData {
         float balanceRight;
         float panning;
 
+        // scratch buffer for balance, sized on buffer size changes
+        float* extraBuffer;
+        uint32_t extraBufferSize;
+
         PostProc() noexcept;
+        ~PostProc() noexcept;
+        void recreateBuffer(const uint32_t newFrames);
 
         CARLA_DECLARE_NON_COPY_STRUCT(PostProc)
 
@@ -340,6 +353,18 @@ struct CarlaPlugin::ProtectedData {
     void postponeRtEvent(const PluginPostRtEvent& rtEvent) noexcept;
     void postponeRtEvent(const PluginPostRtEventType type, const int32_t value1, const int32_t value2, const float value3) noexcept;
 
+    // -------------------------------------------------------------------
+    // Event processing
+
+    /*!
+     * Check if processing should be split at @a event for sample accuracy.
+     * Only control events split the block, MIDI events are given to plugins with their offset instead.
+     * Sub-blocks shorter than the engine's minimum sub-block size are not created,
+     * the event is applied at the start of the current sub-block then.
+     * @note RT call
+     */
+    bool shouldSplitBlock(const EngineEvent& event, const uint32_t timeOffset) const noexcept;
+
     // -------------------------------------------------------------------
     // Library functions
 
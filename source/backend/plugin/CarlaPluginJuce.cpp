@@ -47,6 +47,7 @@ public:
           fPosInfo(),
           fChunk(),
           fUniqueId(nullptr),
+          fTailLength(0),
           fWindow()
     {
         carla_debug("CarlaPluginJuce::CarlaPluginJuce(%p, %i)", engine, id);
@@ -105,6 +106,11 @@ public:
         return fDesc.uid;
     }
 
+    uint32_t getTailLengthInFrames() const noexcept override
+    {
+        return fTailLength;
+    }
+
     // -------------------------------------------------------------------
     // Information (count)
 
@@ -663,6 +669,11 @@ public:
         try {
             fInstance->prepareToPlay(pData->engine->getSampleRate(), static_cast<int>(pData->engine->getBufferSize()));
         } catch(...) {}
+
+        try {
+            const double tailLength = fInstance->getTailLengthSeconds() * pData->engine->getSampleRate();
+            fTailLength = (tailLength > 0.0) ? static_cast<uint32_t>(tailLength + 0.5) : 0;
+        } catch(...) {}
     }
 
     void deactivate() noexcept override
@@ -938,7 +949,8 @@ public:
                 } // switch (event.type)
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
         } // End of Event Input
 
@@ -1248,6 +1260,7 @@ private:
     MemoryBlock         fChunk;
 
     const char* fUniqueId;
+    uint32_t    fTailLength;
 
     ScopedPointer<JucePluginWindow> fWindow;
 
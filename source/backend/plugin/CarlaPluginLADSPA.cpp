@@ -938,7 +938,7 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
-                if (isSampleAccurate && event.time > timeOffset)
+                if (isSampleAccurate && pData->shouldSplitBlock(event, timeOffset))
                 {
                     if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset))
                         timeOffset = event.time;
@@ -1056,7 +1056,8 @@ public:
                 } // switch (event.type)
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             if (frames > timeOffset)
                 processSingle(audioIn, audioOut, frames - timeOffset, timeOffset);
@@ -1097,6 +1098,12 @@ public:
                 }
             }
         } // End of Control Output
+
+        // --------------------------------------------------------------------------------------------------------
+        // Latency, idle updates it
+
+        if (fLatencyIndex >= 0 && pData->latency.frames != getLatencyInFrames())
+            pData->engine->requestPluginIdle(pData->id);
     }
 
     bool processSingle(const float** const audioIn, float** const audioOut, const uint32_t frames,
@@ -1209,7 +1216,8 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float bufValue;
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1319,6 +1327,10 @@ public:
         CARLA_ASSERT_INT(newBufferSize > 0, newBufferSize);
         carla_debug("CarlaPluginLADSPA::bufferSizeChanged(%i) - start", newBufferSize);
 
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#endif
+
         const int iBufferSize(static_cast<int>(newBufferSize));
 
         for (uint32_t i=0; i < pData->audioIn.count; ++i)
@@ -500,6 +500,23 @@ private:
     CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaPipeServerLV2)
 };
 
+// -----------------------------------------------------
+// Init LV2 World if needed, sets LV2_PATH for lilv
+
+static Lv2WorldClass& initLv2WorldIfNeeded(CarlaEngine* const engine)
+{
+    Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
+
+    if (engine->getOptions().pathLV2 != nullptr && engine->getOptions().pathLV2[0] != '\0')
+        lv2World.initIfNeeded(engine->getOptions().pathLV2);
+    else if (const char* const LV2_PATH = std::getenv("LV2_PATH"))
+        lv2World.initIfNeeded(LV2_PATH);
+    else
+        lv2World.initIfNeeded(LILV_DEFAULT_LV2_PATH);
+
+    return lv2World;
+}
+
 // -----------------------------------------------------
 
 class CarlaPluginLV2 : public CarlaPlugin,
@@ -523,6 +540,7 @@ public:
           fLatencyIndex(-1),
           fAtomBufferIn(),
           fAtomBufferOut(),
+          fAtomBufferOutDump(nullptr),
           fAtomForge(),
           fEventsIn(),
           fEventsOut(),
@@ -649,6 +667,12 @@ public:
             fRdfDescriptor = nullptr;
         }
 
+        if (fAtomBufferOutDump != nullptr)
+        {
+            delete[] fAtomBufferOutDump;
+            fAtomBufferOutDump = nullptr;
+        }
+
         if (fFeatures[kFeatureIdEvent] != nullptr && fFeatures[kFeatureIdEvent]->data != nullptr)
             delete (LV2_Event_Feature*)fFeatures[kFeatureIdEvent]->data;
 
@@ -1481,11 +1505,9 @@ public:
 
     void uiIdle() override
     {
-        if (fAtomBufferOut.isDataAvailableForReading())
+        if (fAtomBufferOutDump != nullptr && fAtomBufferOut.isDataAvailableForReading())
         {
-            uint8_t dumpBuf[fAtomBufferOut.getSize()];
-
-            Lv2AtomRingBuffer tmpRingBuffer(fAtomBufferOut, dumpBuf);
+            Lv2AtomRingBuffer tmpRingBuffer(fAtomBufferOut, fAtomBufferOutDump);
             CARLA_SAFE_ASSERT(tmpRingBuffer.isDataAvailableForReading());
 
             uint32_t portIndex;
@@ -1565,6 +1587,15 @@ public:
         CarlaPlugin::uiIdle();
     }
 
+    uint getIdleInterval() const noexcept override
+    {
+        // worker requests ask for idle themselves, only a running UI bridge needs regular idle
+        if (! fPipeServer.isPipeRunning())
+            return 0;
+
+        return CarlaPlugin::getIdleInterval();
+    }
+
     // -------------------------------------------------------------------
     // Plugin state
 
@@ -2320,8 +2351,14 @@ public:
             fAtomBufferIn.createBuffer(eventBufferSize);
 
         if (fExt.worker != nullptr || (fUI.type != UI::TYPE_NULL && fEventsOut.count > 0 && (fEventsOut.data[0].type & CARLA_EVENT_DATA_ATOM) != 0))
+        {
             fAtomBufferOut.createBuffer(eventBufferSize);
 
+            // used to dump the atom buffer contents on idle, the ring buffer size never changes once created
+            if (fAtomBufferOutDump == nullptr && fAtomBufferOut.getSize() > 0)
+                fAtomBufferOutDump = new uint8_t[fAtomBufferOut.getSize()];
+        }
+
         if (fEventsIn.ctrl != nullptr && fEventsIn.ctrl->port == nullptr)
             fEventsIn.ctrl->port = pData->event.portIn;
 
@@ -2914,7 +2951,8 @@ public:
                 //lv2_atom_buffer_write(&evInAtomIters[i], 0, 0, atom->type, atom->size, LV2_ATOM_BODY_CONST(atom));
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             carla_copyStruct(fLastTimeInfo, timeInfo);
         }
@@ -3024,11 +3062,10 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
-                if (isSampleAccurate && event.time > timeOffset)
+                if (isSampleAccurate && pData->shouldSplitBlock(event, timeOffset))
                 {
                     if (processSingle(audioIn, audioOut, cvIn, cvOut, event.time - timeOffset, timeOffset))
                     {
-                        startTime  = 0;
                         timeOffset = event.time;
 
                         if (pData->midiprog.current >= 0 && pData->midiprog.count > 0)
@@ -3056,10 +3093,11 @@ public:
                             evInMidiStates[j].position = event.time;
                         }
                     }
-                    else
-                        startTime += timeOffset;
                 }
 
+                // time within the current sub-block, events that did not split it keep their offset
+                startTime = event.time - timeOffset;
+
                 switch (event.type)
                 {
                 case kEngineEventTypeNull:
@@ -3344,7 +3382,8 @@ public:
                 } // switch (event.type)
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             if (frames > timeOffset)
                 processSingle(audioIn, audioOut, cvIn, cvOut, frames - timeOffset, timeOffset);
@@ -3616,7 +3655,8 @@ public:
             }
         }
 
-        pData->postRtEvents.trySplice();
+        if (pData->postRtEvents.trySplice())
+            pData->engine->requestPluginIdle(pData->id);
 
 #ifndef BUILD_BRIDGE
         // --------------------------------------------------------------------------------------------------------
@@ -3628,7 +3668,8 @@ public:
             const bool isMono    = (pData->audioIn.count == 1);
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float bufValue;
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -3714,6 +3755,10 @@ public:
         CARLA_ASSERT_INT(newBufferSize > 0, newBufferSize);
         carla_debug("CarlaPluginLV2::bufferSizeChanged(%i) - start", newBufferSize);
 
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#endif
+
         for (uint32_t i=0; i < pData->audioIn.count; ++i)
         {
             if (fAudioInBuffers[i] != nullptr)
@@ -4477,7 +4522,11 @@ public:
         atom.size = size;
         atom.type = CARLA_URI_MAP_ID_CARLA_ATOM_WORKER;
 
-        return fAtomBufferOut.putChunk(&atom, data, fEventsOut.ctrlIndex) ? LV2_WORKER_SUCCESS : LV2_WORKER_ERR_NO_SPACE;
+        if (! fAtomBufferOut.putChunk(&atom, data, fEventsOut.ctrlIndex))
+            return LV2_WORKER_ERR_NO_SPACE;
+
+        pData->engine->requestPluginIdle(pData->id);
+        return LV2_WORKER_SUCCESS;
     }
 
     LV2_Worker_Status handleWorkerRespond(const uint32_t size, const void* const data)
@@ -4715,14 +4764,7 @@ public:
         // ---------------------------------------------------------------
         // Init LV2 World if needed, sets LV2_PATH for lilv
 
-        Lv2WorldClass& lv2World(Lv2WorldClass::getInstance());
-
-        if (pData->engine->getOptions().pathLV2 != nullptr && pData->engine->getOptions().pathLV2[0] != '\0')
-            lv2World.initIfNeeded(pData->engine->getOptions().pathLV2);
-        else if (const char* const LV2_PATH = std::getenv("LV2_PATH"))
-            lv2World.initIfNeeded(LV2_PATH);
-        else
-            lv2World.initIfNeeded(LILV_DEFAULT_LV2_PATH);
+        initLv2WorldIfNeeded(pData->engine);
 
         // ---------------------------------------------------------------
         // get plugin from lv2_rdf (lilv)
@@ -5539,6 +5581,7 @@ private:
 
     Lv2AtomRingBuffer fAtomBufferIn;
     Lv2AtomRingBuffer fAtomBufferOut;
+    uint8_t*          fAtomBufferOutDump;
     LV2_Atom_Forge    fAtomForge;
 
     CarlaPluginLV2EventData fEventsIn;
@@ -6196,6 +6239,30 @@ bool CarlaPipeServerLV2::msgReceived(const char* const msg) noexcept
 
 // -------------------------------------------------------------------------------------------------------------------
 
+const char* CarlaPlugin::getLV2PluginBinary(CarlaEngine* const engine, const char* const uri)
+{
+    CARLA_SAFE_ASSERT_RETURN(engine != nullptr, nullptr);
+    CARLA_SAFE_ASSERT_RETURN(uri != nullptr && uri[0] != '\0', nullptr);
+    carla_debug("CarlaPlugin::getLV2PluginBinary(%p, \"%s\")", engine, uri);
+
+    Lv2WorldClass& lv2World(initLv2WorldIfNeeded(engine));
+
+    const LilvPlugin* const cPlugin(lv2World.getPluginFromURI(uri));
+
+    if (cPlugin == nullptr)
+        return nullptr;
+
+    const LilvNode* const binaryNode(lilv_plugin_get_library_uri(cPlugin));
+
+    if (binaryNode == nullptr)
+        return nullptr;
+
+    char* const binary(lilv_file_uri_parse(lilv_node_as_uri(binaryNode), nullptr));
+    CARLA_SAFE_ASSERT_RETURN(binary != nullptr, nullptr);
+
+    return carla_strdup_free(binary);
+}
+
 CarlaPlugin* CarlaPlugin::newLV2(const Initializer& init)
 {
     carla_debug("CarlaPlugin::newLV2({%p, \"%s\", \"%s\", " P_INT64 "})", init.engine, init.name, init.label, init.uniqueId);
@@ -1036,7 +1036,8 @@ public:
                 }
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             if (frames > timeOffset)
                 processSingle(audioOut, frames - timeOffset, timeOffset);
@@ -1103,7 +1104,7 @@ public:
             const bool doVolume  = (pData->hints & PLUGIN_CAN_VOLUME) != 0 && carla_isNotEqual(pData->postProc.volume, 1.0f);
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
 
-            float oldBufLeft[doBalance ? frames : 1];
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1151,8 +1152,15 @@ public:
     }
 
 #ifndef CARLA_OS_WIN // FIXME, need to update linuxsampler win32 build
-    void bufferSizeChanged(const uint32_t) override
+    void bufferSizeChanged(const uint32_t newBufferSize) override
     {
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#else
+        // unused
+        (void)newBufferSize;
+#endif
+
         fAudioOutputDevice.ReconnectAll();
     }
 
@@ -788,6 +788,15 @@ public:
         CarlaPlugin::uiIdle();
     }
 
+    uint getIdleInterval() const noexcept override
+    {
+        // a hidden UI has nothing to update
+        if (! fIsUiVisible)
+            return 0;
+
+        return CarlaPlugin::getIdleInterval();
+    }
+
     // -------------------------------------------------------------------
     // Plugin state
 
@@ -1736,7 +1745,8 @@ public:
                 } // switch (event.type)
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             if (frames > timeOffset)
                 processSingle(audioIn, audioOut, cvIn, cvOut, frames - timeOffset, timeOffset);
@@ -1894,7 +1904,8 @@ public:
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float bufValue;
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1974,6 +1985,10 @@ public:
         CARLA_ASSERT_INT(newBufferSize > 0, newBufferSize);
         carla_debug("CarlaPluginNative::bufferSizeChanged(%i)", newBufferSize);
 
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#endif
+
         for (uint32_t i=0; i < pData->audioIn.count; ++i)
         {
             if (fAudioInBuffers[i] != nullptr)
@@ -2251,6 +2266,10 @@ protected:
         case NATIVE_HOST_OPCODE_HOST_IDLE:
             pData->engine->callback(ENGINE_CALLBACK_IDLE, 0, 0, 0, 0.0f, nullptr);
             break;
+        case NATIVE_HOST_OPCODE_LATENCY_CHANGED:
+            CARLA_SAFE_ASSERT_BREAK(value >= 0);
+            pData->client->setLatency(static_cast<uint32_t>(value));
+            break;
         }
 
         return ret;
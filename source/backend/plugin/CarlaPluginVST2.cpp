@@ -63,6 +63,7 @@ public:
           fTimeInfo(),
           fNeedIdle(false),
           fLastChunk(nullptr),
+          fTailLength(0),
           fIsProcessing(false),
           fMainThread(pthread_self()),
 #ifdef PTW32_DLLPORT
@@ -172,6 +173,11 @@ public:
         return static_cast<int64_t>(fEffect->uniqueID);
     }
 
+    uint32_t getTailLengthInFrames() const noexcept override
+    {
+        return fTailLength;
+    }
+
     // -------------------------------------------------------------------
     // Information (count)
 
@@ -483,6 +489,14 @@ public:
         CarlaPlugin::idle();
     }
 
+    uint getIdleInterval() const noexcept override
+    {
+        if (fNeedIdle)
+            return kPluginIdleInterval;
+
+        return CarlaPlugin::getIdleInterval();
+    }
+
     void uiIdle() override
     {
         if (fUI.window != nullptr)
@@ -836,6 +850,12 @@ public:
             deactivate();
         }
 
+        // check tail length, plugins return 1 for no tail
+        {
+            const intptr_t tailSize = dispatcher(effGetTailSize, 0, 0, nullptr, 0.0f);
+            fTailLength = (tailSize > 0) ? static_cast<uint32_t>(tailSize) : 0;
+        }
+
 #if 0 // TODO
         // check latency
         if (pData->hints & PLUGIN_CAN_DRYWET)
@@ -856,6 +876,9 @@ public:
 #endif
 
         //bufferSizeChanged(pData->engine->getBufferSize());
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(pData->engine->getBufferSize());
+#endif
         reloadPrograms(true);
 
         if (pData->active)
@@ -1164,11 +1187,10 @@ public:
 
                 CARLA_ASSERT_INT2(event.time >= timeOffset, event.time, timeOffset);
 
-                if (isSampleAccurate && event.time > timeOffset)
+                if (isSampleAccurate && pData->shouldSplitBlock(event, timeOffset))
                 {
                     if (processSingle(audioIn, audioOut, event.time - timeOffset, timeOffset))
                     {
-                        startTime  = 0;
                         timeOffset = event.time;
 
                         if (fMidiEventCount > 0)
@@ -1177,10 +1199,11 @@ public:
                             fMidiEventCount = 0;
                         }
                     }
-                    else
-                        startTime += timeOffset;
                 }
 
+                // time within the current sub-block, events that did not split it keep their offset
+                startTime = event.time - timeOffset;
+
                 switch (event.type)
                 {
                 case kEngineEventTypeNull:
@@ -1404,7 +1427,8 @@ public:
                 } // switch (event.type)
             }
 
-            pData->postRtEvents.trySplice();
+            if (pData->postRtEvents.trySplice())
+                pData->engine->requestPluginIdle(pData->id);
 
             if (frames > timeOffset)
                 processSingle(audioIn, audioOut, frames - timeOffset, timeOffset);
@@ -1532,7 +1556,8 @@ public:
             const bool doBalance = (pData->hints & PLUGIN_CAN_BALANCE) != 0 && ! (carla_isEqual(pData->postProc.balanceLeft, -1.0f) && carla_isEqual(pData->postProc.balanceRight, 1.0f));
 
             bool isPair;
-            float bufValue, oldBufLeft[doBalance ? frames : 1];
+            float bufValue;
+            float* const oldBufLeft(pData->postProc.extraBuffer);
 
             for (uint32_t i=0; i < pData->audioOut.count; ++i)
             {
@@ -1599,6 +1624,10 @@ public:
         CARLA_ASSERT_INT(newBufferSize > 0, newBufferSize);
         carla_debug("CarlaPluginVST2::bufferSizeChanged(%i)", newBufferSize);
 
+#ifndef BUILD_BRIDGE
+        pData->postProc.recreateBuffer(newBufferSize);
+#endif
+
         if (pData->active)
             deactivate();
 
@@ -1852,6 +1881,7 @@ protected:
         case audioMasterNeedIdle:
             // Deprecated in VST SDK 2.4
             fNeedIdle = true;
+            pData->engine->requestPluginIdle(pData->id);
             ret = 1;
             break;
 #endif
@@ -2218,6 +2248,8 @@ private:
     bool  fNeedIdle;
     void* fLastChunk;
 
+    uint32_t fTailLength;
+
     bool      fIsProcessing;
     pthread_t fMainThread;
     pthread_t fProcThread;
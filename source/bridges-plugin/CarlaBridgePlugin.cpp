@@ -19,8 +19,11 @@
 #include "CarlaHost.h"
 
 #include "CarlaBackendUtils.hpp"
+#include "CarlaBridgeUtils.hpp"
 #include "CarlaMIDI.h"
 
+#include "LinkedList.hpp"
+
 #ifdef CARLA_OS_UNIX
 # include <signal.h>
 #endif
@@ -39,9 +42,11 @@ using juce::JUCEApplicationBase;
 using juce::Timer;
 #endif
 
+using CarlaBackend::BinaryType;
 using CarlaBackend::CarlaEngine;
 using CarlaBackend::EngineCallbackOpcode;
 using CarlaBackend::EngineCallbackOpcode2Str;
+using CarlaBackend::PluginType;
 
 using juce::CharPointer_UTF8;
 using juce::File;
@@ -105,10 +110,353 @@ static void initSignalHandler()
 
 // -------------------------------------------------------------------------
 
+static CarlaString getBridgeClientName(const char* const name, const PluginType itype, const char* const filename, const char* const label)
+{
+    CarlaString clientName;
+
+    if (name != nullptr)
+    {
+        clientName = name;
+    }
+    else if (itype == CarlaBackend::PLUGIN_LV2)
+    {
+        // LV2 requires URI
+        CARLA_SAFE_ASSERT_RETURN(label != nullptr && label[0] != '\0', clientName);
+
+        // LV2 URI is not usable as client name, create a usable name from URI
+        CarlaString label2(label);
+
+        // truncate until last valid char
+        for (std::size_t i=label2.length()-1; i != 0; --i)
+        {
+            if (! std::isalnum(label2[i]))
+                continue;
+
+            label2.truncate(i+1);
+            break;
+        }
+
+        // get last used separator
+        bool found;
+        std::size_t septmp, sep = 0;
+
+        septmp = label2.rfind('#', &found)+1;
+        if (found && septmp > sep)
+            sep = septmp;
+
+        septmp = label2.rfind('/', &found)+1;
+        if (found && septmp > sep)
+            sep = septmp;
+
+        septmp = label2.rfind('=', &found)+1;
+        if (found && septmp > sep)
+            sep = septmp;
+
+        septmp = label2.rfind(':', &found)+1;
+        if (found && septmp > sep)
+            sep = septmp;
+
+        // make name starting from the separator and first valid char
+        const char* name2 = label2.buffer() + sep;
+        for (; *name2 != '\0' && ! std::isalnum(*name2); ++name2) {}
+
+        if (*name2 != '\0')
+            clientName = name2;
+    }
+    else if (label != nullptr)
+    {
+        clientName = label;
+    }
+    else
+    {
+        const String jfilename = String(CharPointer_UTF8(filename));
+        clientName = File(jfilename).getFileNameWithoutExtension().toRawUTF8();
+    }
+
+    // if we still have no client name by now, use a dummy one
+    if (clientName.isEmpty())
+        clientName = "carla-plugin";
+
+    // just to be safe
+    clientName.toBasic();
+
+    return clientName;
+}
+
+static const void* getBridgeExtraStuff(const PluginType itype, const char*& label, const char* const clientName)
+{
+    if (itype == CarlaBackend::PLUGIN_GIG || itype == CarlaBackend::PLUGIN_SF2)
+    {
+        if (label == nullptr)
+            label = clientName;
+
+        if (std::strstr(label, " (16 outs)") != nullptr)
+            return "true";
+    }
+
+    return nullptr;
+}
+
+// -------------------------------------------------------------------------
+// Shared bridge, hosting one bridged engine per plugin inside a single process
+
+class CarlaBridgeSharedHost
+{
+public:
+    CarlaBridgeSharedHost(const BinaryType btype)
+        : kBinaryType(btype),
+          fShmControl(),
+          fSlots() {}
+
+    ~CarlaBridgeSharedHost()
+    {
+        for (LinkedList<Slot*>::Itenerator it = fSlots.begin2(); it.valid(); it.next())
+        {
+            Slot* const slot(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(slot != nullptr);
+
+            closeSlot(slot);
+        }
+
+        fSlots.clear();
+        fShmControl.clear();
+    }
+
+    bool attach(const char* const shmId) noexcept
+    {
+        return fShmControl.attach(shmId);
+    }
+
+    void idle()
+    {
+        for (; fShmControl.isDataAvailableForReading();)
+        {
+            const PluginBridgeSharedHostOpcode opcode(fShmControl.readOpcode());
+
+            switch (opcode)
+            {
+            case kPluginBridgeSharedHostNull:
+                break;
+
+            case kPluginBridgeSharedHostAddPlugin: {
+                CarlaString shmIds, filename, label;
+
+                fShmControl.readString(shmIds);
+                const PluginType ptype(static_cast<PluginType>(fShmControl.readUInt()));
+                const int64_t uniqueId(fShmControl.readLong());
+                fShmControl.readString(filename);
+                fShmControl.readString(label);
+
+                // engine options of the host at the time this plugin was added, read by the new engine
+                CarlaString key, value;
+
+                for (uint32_t i=0, count=fShmControl.readUInt(); i < count; ++i)
+                {
+                    fShmControl.readString(key);
+                    fShmControl.readString(value);
+                    CARLA_SAFE_ASSERT_CONTINUE(key.startsWith("ENGINE_OPTION_"));
+
+                    carla_setenv(key, value);
+                }
+
+                addPlugin(shmIds, ptype, filename.isNotEmpty() ? filename.buffer() : nullptr,
+                          label.isNotEmpty() ? label.buffer() : nullptr, uniqueId);
+                break;
+            }
+
+            case kPluginBridgeSharedHostQuit:
+                gCloseNow = true;
+                break;
+            }
+        }
+
+        for (LinkedList<Slot*>::Itenerator it = fSlots.begin2(); it.valid(); it.next())
+        {
+            Slot* const slot(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(slot != nullptr);
+
+            if (! slot->closeNow)
+                slot->engine->idle();
+
+            if (slot->closeNow)
+            {
+                closeSlot(slot);
+                fSlots.remove(it);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        CarlaEngine* engine;
+        volatile bool closeNow;
+    };
+
+    struct SharedHostControl : public CarlaRingBufferControl<BigStackBuffer> {
+        BridgeSharedHostData* data;
+        char shm[64];
+
+        SharedHostControl() noexcept
+            : data(nullptr)
+        {
+            carla_zeroChars(shm, 64);
+            jackbridge_shm_init(shm);
+        }
+
+        ~SharedHostControl() noexcept override
+        {
+            clear();
+        }
+
+        bool attach(const char* const shmId) noexcept
+        {
+            CARLA_SAFE_ASSERT_RETURN(! jackbridge_shm_is_valid(shm), false);
+
+            CarlaString filename(PLUGIN_BRIDGE_NAMEPREFIX_SHARED_HOST);
+            filename += shmId;
+
+            jackbridge_shm_attach(shm, filename);
+            CARLA_SAFE_ASSERT_RETURN(jackbridge_shm_is_valid(shm), false);
+
+            data = (BridgeSharedHostData*)jackbridge_shm_map(shm, sizeof(BridgeSharedHostData));
+            CARLA_SAFE_ASSERT_RETURN(data != nullptr, false);
+
+            setRingBuffer(&data->ringBuffer, false);
+            return true;
+        }
+
+        void clear() noexcept
+        {
+            data = nullptr;
+            setRingBuffer(nullptr, false);
+
+            if (! jackbridge_shm_is_valid(shm))
+                return;
+
+            jackbridge_shm_close(shm);
+            jackbridge_shm_init(shm);
+        }
+
+        PluginBridgeSharedHostOpcode readOpcode() noexcept
+        {
+            return static_cast<PluginBridgeSharedHostOpcode>(readUInt());
+        }
+
+        void readString(CarlaString& str) noexcept
+        {
+            const uint32_t size(readUInt());
+
+            if (size == 0)
+            {
+                str.clear();
+                return;
+            }
+
+            char* const buf(new char[size+1]);
+            readCustomData(buf, size);
+            buf[size] = '\0';
+            str = buf;
+            delete[] buf;
+        }
+
+        CARLA_DECLARE_NON_COPY_STRUCT(SharedHostControl)
+    };
+
+    const BinaryType kBinaryType;
+
+    SharedHostControl fShmControl;
+    LinkedList<Slot*> fSlots;
+
+    void addPlugin(const char* const shmIds, const PluginType ptype, const char* const filename, const char* label, const int64_t uniqueId)
+    {
+        CARLA_SAFE_ASSERT_RETURN(std::strlen(shmIds) == 6*4,);
+
+        char audioPoolBaseName[6+1];
+        char rtClientBaseName[6+1];
+        char nonRtClientBaseName[6+1];
+        char nonRtServerBaseName[6+1];
+
+        std::strncpy(audioPoolBaseName,   shmIds+6*0, 6);
+        std::strncpy(rtClientBaseName,    shmIds+6*1, 6);
+        std::strncpy(nonRtClientBaseName, shmIds+6*2, 6);
+        std::strncpy(nonRtServerBaseName, shmIds+6*3, 6);
+        audioPoolBaseName[6]   = '\0';
+        rtClientBaseName[6]    = '\0';
+        nonRtClientBaseName[6] = '\0';
+        nonRtServerBaseName[6] = '\0';
+
+        const CarlaString clientName(getBridgeClientName(nullptr, ptype, filename, label));
+        CARLA_SAFE_ASSERT_RETURN(clientName.isNotEmpty(),);
+
+        const void* const extraStuff(getBridgeExtraStuff(ptype, label, clientName));
+
+        CarlaEngine* const engine(carla_engine_new_bridge(audioPoolBaseName, rtClientBaseName, nonRtClientBaseName, nonRtServerBaseName, clientName));
+
+        if (engine == nullptr)
+        {
+            carla_stderr("Failed to init engine, error was:\n%s", carla_get_last_error());
+            return;
+        }
+
+        Slot* const slot(new Slot);
+        slot->engine   = engine;
+        slot->closeNow = false;
+
+        engine->setCallback(callback, slot);
+
+        if (! engine->addPlugin(kBinaryType, ptype, filename, nullptr, label, uniqueId, extraStuff, 0x0))
+        {
+            carla_stderr("Plugin failed to load, error was:\n%s", engine->getLastError());
+            closeSlot(slot);
+            return;
+        }
+
+        fSlots.append(slot);
+    }
+
+    static void closeSlot(Slot* const slot)
+    {
+        slot->engine->setAboutToClose();
+        slot->engine->removeAllPlugins();
+        slot->engine->close();
+
+        delete slot->engine;
+        delete slot;
+    }
+
+    static void callback(void* ptr, EngineCallbackOpcode action, unsigned int pluginId, int value1, int value2, float value3, const char* valueStr)
+    {
+        carla_debug("CarlaBridgeSharedHost::callback(%p, %i:%s, %i, %i, %i, %f, \"%s\")", ptr, action, EngineCallbackOpcode2Str(action), pluginId, value1, value2, value3, valueStr);
+        CARLA_SAFE_ASSERT_RETURN(ptr != nullptr,);
+
+        switch (action)
+        {
+        case CarlaBackend::ENGINE_CALLBACK_ENGINE_STOPPED:
+        case CarlaBackend::ENGINE_CALLBACK_PLUGIN_REMOVED:
+        case CarlaBackend::ENGINE_CALLBACK_QUIT:
+            ((Slot*)ptr)->closeNow = true;
+            break;
+        default:
+            break;
+        }
+
+        return; (void)pluginId; (void)value1; (void)value2; (void)value3; (void)valueStr;
+    }
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CarlaBridgeSharedHost)
+};
+
+static CarlaBridgeSharedHost* gSharedHost = nullptr;
+
+// -------------------------------------------------------------------------
+
 static String gProjectFilename;
 
 static void gIdle()
 {
+    if (gSharedHost != nullptr)
+        return gSharedHost->idle();
+
     carla_engine_idle();
 
     if (gSaveNow)
@@ -169,6 +517,23 @@ public:
 static JUCEApplicationBase* juce_CreateApplication() { return new CarlaJuceApp(); }
 #endif
 
+static void gExec(int argc, char* argv[])
+{
+#if defined(CARLA_OS_MAC) || defined(CARLA_OS_WIN)
+    JUCEApplicationBase::createInstance = &juce_CreateApplication;
+    JUCEApplicationBase::main(JUCE_MAIN_FUNCTION_ARGS);
+#else
+    for (; ! gCloseNow;)
+    {
+        gIdle();
+        carla_msleep(8);
+    }
+#endif
+
+    // may be unused
+    return; (void)argc; (void)argv;
+}
+
 // -------------------------------------------------------------------------
 
 class CarlaBridgePlugin
@@ -227,22 +592,10 @@ public:
 
         gIsInitiated = true;
 
-#if defined(CARLA_OS_MAC) || defined(CARLA_OS_WIN)
-        JUCEApplicationBase::createInstance = &juce_CreateApplication;
-        JUCEApplicationBase::main(JUCE_MAIN_FUNCTION_ARGS);
-#else
-        for (; ! gCloseNow;)
-        {
-            gIdle();
-            carla_msleep(8);
-        }
-#endif
+        gExec(argc, argv);
 
         carla_set_engine_about_to_close();
         carla_remove_plugin(0);
-
-        // may be unused
-        return; (void)argc; (void)argv;
     }
 
     // ---------------------------------------------------------------------
@@ -288,14 +641,59 @@ private:
 
 // -------------------------------------------------------------------------
 
+static int execSharedHost(int argc, char* argv[])
+{
+    const char* const shmId(std::getenv("ENGINE_BRIDGE_SHARED_HOST_ID"));
+
+    if (shmId == nullptr || std::strlen(shmId) != 6)
+    {
+        carla_stderr("Shared bridge mode can only be started by Carla");
+        return 1;
+    }
+
+    BinaryType btype = CarlaBackend::BINARY_NATIVE;
+
+    if (const char* const binaryTypeStr = std::getenv("CARLA_BRIDGE_PLUGIN_BINARY_TYPE"))
+        btype = CarlaBackend::getBinaryTypeFromString(binaryTypeStr);
+
+#ifdef CARLA_OS_LINUX
+    if (std::getenv("DISPLAY") != nullptr)
+        XInitThreads();
+#endif
+
+    CarlaBridgeSharedHost sharedHost(btype);
+
+    if (! sharedHost.attach(shmId))
+    {
+        carla_stderr("Failed to attach to shared bridge control");
+        return 1;
+    }
+
+    initSignalHandler();
+
+    gSharedHost  = &sharedHost;
+    gIsInitiated = true;
+
+    gExec(argc, argv);
+
+    gSharedHost = nullptr;
+    return 0;
+}
+
+// -------------------------------------------------------------------------
+
 int main(int argc, char* argv[])
 {
     // ---------------------------------------------------------------------
     // Check argument count
 
+    if (argc == 2 && std::strcmp(argv[1], "--shared") == 0)
+        return execSharedHost(argc, argv);
+
     if (argc != 4 && argc != 5)
     {
         carla_stdout("usage: %s <type> <filename> <label> [uniqueId]", argv[0]);
+        carla_stdout("       %s --shared", argv[0]);
         return 1;
     }
 
@@ -396,87 +794,15 @@ int main(int argc, char* argv[])
     // ---------------------------------------------------------------------
     // Set client name
 
-    CarlaString clientName;
-
-    if (name != nullptr)
-    {
-        clientName = name;
-    }
-    else if (itype == CarlaBackend::PLUGIN_LV2)
-    {
-        // LV2 requires URI
-        CARLA_SAFE_ASSERT_RETURN(label != nullptr && label[0] != '\0', 1);
-
-        // LV2 URI is not usable as client name, create a usable name from URI
-        CarlaString label2(label);
-
-        // truncate until last valid char
-        for (std::size_t i=label2.length()-1; i != 0; --i)
-        {
-            if (! std::isalnum(label2[i]))
-                continue;
-
-            label2.truncate(i+1);
-            break;
-        }
-
-        // get last used separator
-        bool found;
-        std::size_t septmp, sep = 0;
-
-        septmp = label2.rfind('#', &found)+1;
-        if (found && septmp > sep)
-            sep = septmp;
-
-        septmp = label2.rfind('/', &found)+1;
-        if (found && septmp > sep)
-            sep = septmp;
-
-        septmp = label2.rfind('=', &found)+1;
-        if (found && septmp > sep)
-            sep = septmp;
-
-        septmp = label2.rfind(':', &found)+1;
-        if (found && septmp > sep)
-            sep = septmp;
-
-        // make name starting from the separator and first valid char
-        const char* name2 = label2.buffer() + sep;
-        for (; *name2 != '\0' && ! std::isalnum(*name2); ++name2) {}
-
-        if (*name2 != '\0')
-            clientName = name2;
-    }
-    else if (label != nullptr)
-    {
-        clientName = label;
-    }
-    else
-    {
-        const String jfilename = String(CharPointer_UTF8(filename));
-        clientName = File(jfilename).getFileNameWithoutExtension().toRawUTF8();
-    }
+    const CarlaString clientName(getBridgeClientName(name, itype, filename, label));
 
-    // if we still have no client name by now, use a dummy one
     if (clientName.isEmpty())
-        clientName = "carla-plugin";
-
-    // just to be safe
-    clientName.toBasic();
+        return 1;
 
     // ---------------------------------------------------------------------
     // Set extraStuff
 
-    const void* extraStuff = nullptr;
-
-    if (itype == CarlaBackend::PLUGIN_GIG || itype == CarlaBackend::PLUGIN_SF2)
-    {
-        if (label == nullptr)
-            label = clientName;
-
-        if (std::strstr(label, " (16 outs)") != nullptr)
-            extraStuff = "true";
-    }
+    const void* const extraStuff(getBridgeExtraStuff(itype, label, clientName));
 
 #ifdef CARLA_OS_LINUX
     if (std::getenv("DISPLAY") != nullptr)
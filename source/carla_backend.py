@@ -22,7 +22,10 @@
 from abc import ABCMeta, abstractmethod
 from copy import deepcopy
 from ctypes import *
+from mmap import mmap, ACCESS_READ
+from os.path import join
 from platform import architecture
+from struct import Struct
 from sys import platform, maxsize
 
 # ------------------------------------------------------------------------------------------------------------
@@ -699,6 +702,11 @@ ENGINE_CALLBACK_ERROR = 38
 # The engine has crashed or malfunctioned and will no longer work.
 ENGINE_CALLBACK_QUIT = 39
 
+# A project save started with carla_save_project_async() has finished.
+# @a value1 1 if successful, 0 otherwise
+# @a valueStr The project filename if successful, the error otherwise
+ENGINE_CALLBACK_PROJECT_SAVED = 40
+
 # ------------------------------------------------------------------------------------------------------------
 # Engine Option
 # Engine options.
@@ -782,6 +790,55 @@ ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR = 16
 # Set frontend winId, used to define as parent window for plugin UIs.
 ENGINE_OPTION_FRONTEND_WIN_ID = 17
 
+# Minimum number of frames a plugin is run for when splitting a block for sample-accurate events.
+# Control events closer than this to the previous split are applied at the start of the current sub-block.
+# Default is 16, use 0 or 1 to split at every event.
+ENGINE_OPTION_MIN_SUB_BLOCK_SIZE = 18
+
+# Host all bridged plugins of the same bridge binary in a single process.
+# Saves one process per plugin, but a crash will take down all plugins in that process.
+# In rack mode, consecutive plugins of the same process are run together with a single wakeup per block.
+# Default is no.
+ENGINE_OPTION_SHARE_PLUGIN_BRIDGES = 19
+
+# Queue frequent engine callbacks and deliver them in batches during engine idle, at most once every this many milliseconds.
+# Parameter, program and MIDI program changes of the same plugin are coalesced, keeping the last value.
+# Up to 4096 callbacks can be queued between batches, if more arrive they are dropped and the next batch
+# ends with ENGINE_CALLBACK_RELOAD_PARAMETERS and ENGINE_CALLBACK_RELOAD_PROGRAMS for every plugin.
+# Default is 0, which calls the engine callback right away from the thread that triggered it.
+ENGINE_OPTION_CALLBACK_BATCH_INTERVAL = 20
+
+# Publish plugin meters in a shared memory region that other processes can map read-only.
+# Default is no.
+# @see CarlaTelemetryReader
+ENGINE_OPTION_TELEMETRY = 21
+
+# Number of points kept per channel for the downsampled scope of each plugin in the telemetry region.
+# Default is 0, which only publishes meters.
+ENGINE_OPTION_TELEMETRY_SCOPE_SIZE = 22
+
+# Skip processing plugins while they are silent.
+# A plugin is skipped, and its outputs zero-filled, when it gets no events, its audio inputs are silent
+# for longer than its tail length and its last processed block was silent too.
+# Plugins without audio or MIDI inputs and plugins with MIDI outputs are always processed.
+# Default is no.
+ENGINE_OPTION_SKIP_SILENT_PLUGINS = 23
+
+# Tail length in milliseconds used for plugins that don't report one.
+# Default is 5000.
+ENGINE_OPTION_SILENT_PLUGIN_TAIL = 24
+
+# Flush denormals to zero while processing.
+# Sets FTZ and DAZ on x86, or FZ on ARM, for each engine process cycle and restores the previous state after it.
+# Default is yes.
+ENGINE_OPTION_FLUSH_DENORMALS = 25
+
+# Add a tiny DC offset, about -360 dBFS, to the audio inputs of plugins in rack and patchbay modes.
+# Keeps feedback paths out of denormals in plugins that flushing does not reach,
+# like those using x87 math or changing the floating point state themselves.
+# Default is no.
+ENGINE_OPTION_ANTI_DENORMAL_OFFSET = 26
+
 # ------------------------------------------------------------------------------------------------------------
 # Engine Process Mode
 # Engine process mode.
@@ -875,6 +932,26 @@ PATCHBAY_ICON_FILE = 5
 # @see EngineCallbackOpcode and carla_set_engine_callback()
 EngineCallbackFunc = CFUNCTYPE(None, c_void_p, c_enum, c_uint, c_int, c_int, c_float, c_char_p)
 
+# Engine callback event, as delivered in batches.
+# Same arguments as EngineCallbackFunc, queued callbacks never have a string value.
+class EngineCallbackEvent(Structure):
+    _fields_ = [
+        # Callback opcode.
+        ("action", c_enum),
+
+        # Plugin Id.
+        ("pluginId", c_uint),
+
+        # Callback values, meaning depends on the opcode.
+        ("value1", c_int),
+        ("value2", c_int),
+        ("value3", c_float)
+    ]
+
+# Engine batch callback function, receives queued engine callbacks in order.
+# @see ENGINE_OPTION_CALLBACK_BATCH_INTERVAL and carla_set_engine_batch_callback()
+EngineBatchCallbackFunc = CFUNCTYPE(None, c_void_p, POINTER(EngineCallbackEvent), c_uint)
+
 # File callback function.
 # @see FileCallbackOpcode
 FileCallbackFunc = CFUNCTYPE(c_char_p, c_void_p, c_enum, c_bool, c_char_p, c_char_p)
@@ -971,6 +1048,12 @@ class EngineDriverDeviceInfo(Structure):
         ("sampleRates", POINTER(c_double))
     ]
 
+# Magic number at the start of an engine telemetry region, "CTLM".
+ENGINE_TELEMETRY_MAGIC = 0x4d4c5443
+
+# Layout version of engine telemetry regions.
+ENGINE_TELEMETRY_VERSION = 1
+
 # ------------------------------------------------------------------------------------------------------------
 # Carla Backend API (Python compatible stuff)
 
@@ -1133,6 +1216,50 @@ class CarlaTransportInfo(Structure):
         ("bpm", c_double)
     ]
 
+# Plugin is enabled, meaning it's fully loaded and can be used.
+# @see CarlaRuntimeSnapshot
+PLUGIN_RUNTIME_STATE_ENABLED = 0x1
+
+# Plugin is active and processing.
+# @see CarlaRuntimeSnapshot
+PLUGIN_RUNTIME_STATE_ACTIVE = 0x2
+
+# Runtime values of all plugins, filled in a single call.
+# All arrays are owned by the caller, any of them can be NULL if not needed.
+# @see carla_get_runtime_snapshot()
+class CarlaRuntimeSnapshot(Structure):
+    _fields_ = [
+        # Sequence number, increased every time plugin states or parameter values change.
+        ("sequence", c_uint32),
+
+        # Size of the per-plugin arrays, set by the caller.
+        ("maxPluginCount", c_uint32),
+
+        # Number of plugins written in the per-plugin arrays.
+        ("pluginCount", c_uint32),
+
+        # Plugin peaks, 4 values per plugin: input left/mono, input right, output left/mono and output right.
+        ("peaks", POINTER(c_float)),
+
+        # Plugin run states, one per plugin.
+        ("states", POINTER(c_uint)),
+
+        # Size of the parameter change arrays, set by the caller.
+        ("maxParameterChanges", c_uint32),
+
+        # Number of parameter changes written.
+        ("parameterChangeCount", c_uint32),
+
+        # Plugin of each changed parameter.
+        ("parameterPluginIds", POINTER(c_uint)),
+
+        # Index of each changed parameter.
+        ("parameterIds", POINTER(c_uint32)),
+
+        # New value of each changed parameter.
+        ("parameterValues", POINTER(c_float))
+    ]
+
 # ------------------------------------------------------------------------------------------------------------
 # Carla Host API (Python compatible stuff)
 
@@ -1182,6 +1309,16 @@ PyCarlaTransportInfo = {
     "bpm": 0.0
 }
 
+# @see CarlaRuntimeSnapshot
+# peaks is a flat list with 4 values per plugin, parameterChanges a list of (pluginId, parameterId, value)
+PyCarlaRuntimeSnapshot = {
+    'sequence': 0,
+    'pluginCount': 0,
+    'peaks': [],
+    'states': [],
+    'parameterChanges': []
+}
+
 # ------------------------------------------------------------------------------------------------------------
 # Set BINARY_NATIVE
 
@@ -1217,6 +1354,7 @@ class CarlaHostMeta(object):
         self.preferUIBridges     = False
         self.preventBadBehaviour = False
         self.uisAlwaysOnTop      = False
+        self.callbackBatching    = False
         self.maxParameters       = 0
         self.uiBridgesTimeout    = 0
 
@@ -1286,6 +1424,14 @@ class CarlaHostMeta(object):
     def set_engine_callback(self, func):
         raise NotImplementedError
 
+    # Set the engine batch callback function, used for queued callbacks.
+    # The function receives a list of (action, pluginId, value1, value2, value3) tuples.
+    # @param func Callback function
+    # @see ENGINE_OPTION_CALLBACK_BATCH_INTERVAL
+    @abstractmethod
+    def set_engine_batch_callback(self, func):
+        raise NotImplementedError
+
     # Set an engine option.
     # @param option   Option
     # @param value    Value as number
@@ -1320,6 +1466,24 @@ class CarlaHostMeta(object):
     def save_project(self, filename):
         raise NotImplementedError
 
+    # Save current project to a file in the background.
+    # Plugin states are collected before this function returns, encoding and writing them is done in other threads.
+    # ENGINE_CALLBACK_PROJECT_SAVED is sent when done.
+    @abstractmethod
+    def save_project_async(self, filename):
+        raise NotImplementedError
+
+    # Convert an XML project file to the binary project format, with plugin chunks stored out of line.
+    # @param compress Compress chunks that get smaller with zlib
+    @abstractmethod
+    def convert_project_to_binary(self, xmlFilename, binaryFilename, compress):
+        raise NotImplementedError
+
+    # Convert a binary project file back to the XML project format.
+    @abstractmethod
+    def convert_project_to_xml(self, binaryFilename, xmlFilename):
+        raise NotImplementedError
+
     # Connect two patchbay ports.
     # @param groupIdA Output group
     # @param portIdA  Output port
@@ -1359,6 +1523,16 @@ class CarlaHostMeta(object):
     def transport_relocate(self, frame):
         raise NotImplementedError
 
+    # Render the current project into an audio file, as fast as possible.
+    # The engine must have been started with the "Offline" driver.
+    # @param outputFile Output file, its extension selects the format (wav, flac, etc)
+    # @param inputFile  Audio file fed into the engine audio inputs, may be empty
+    # @param midiFile   Standard MIDI file fed into the engine MIDI input, may be empty
+    # @param seconds    Length to render, use 0 to render the length of the input files
+    @abstractmethod
+    def engine_render_offline(self, outputFile, inputFile, midiFile, seconds):
+        raise NotImplementedError
+
     # Get the current transport frame.
     @abstractmethod
     def get_current_transport_frame(self):
@@ -1434,6 +1608,31 @@ class CarlaHostMeta(object):
     def switch_plugins(self, pluginIdA, pluginIdB):
         raise NotImplementedError
 
+    # Load the plugins of a project file as standby plugins, replacing any previous standby ones.
+    # Standby plugins are fully loaded and activated, but not processed nor reported until switched in.
+    # Meanwhile the current plugins keep running.
+    # @param filename Filename of the project
+    # @note Only supported in rack mode.
+    @abstractmethod
+    def load_standby_project(self, filename):
+        raise NotImplementedError
+
+    # Switch all current plugins with the standby ones, within a single audio period.
+    # The previous plugins become the standby ones.
+    @abstractmethod
+    def switch_standby_plugins(self):
+        raise NotImplementedError
+
+    # Remove all standby plugins.
+    @abstractmethod
+    def clear_standby_plugins(self):
+        raise NotImplementedError
+
+    # Get the current number of standby plugins.
+    @abstractmethod
+    def get_standby_plugin_count(self):
+        raise NotImplementedError
+
     # Load a plugin state.
     # @param pluginId Plugin
     # @param filename Path to plugin state
@@ -1636,6 +1835,14 @@ class CarlaHostMeta(object):
     def get_output_peak_value(self, pluginId, isLeft):
         raise NotImplementedError
 
+    # Get the peaks and run states of all plugins, plus the parameter values that changed since the last call.
+    # Parameter values of newly added plugins are not reported, only their later changes.
+    # @param maxParameterChanges Maximum number of parameter changes to get, 0 to skip checking parameter values
+    # @see PyCarlaRuntimeSnapshot
+    @abstractmethod
+    def get_runtime_snapshot(self, maxParameterChanges):
+        raise NotImplementedError
+
     # Enable a plugin's option.
     # @param pluginId Plugin
     # @param option   An option from PluginOptions
@@ -1811,6 +2018,13 @@ class CarlaHostMeta(object):
     def get_host_osc_url_udp(self):
         raise NotImplementedError
 
+    # Get the shared memory filename of the engine telemetry region.
+    # Returns an empty string if the engine is not running or ENGINE_OPTION_TELEMETRY is not set.
+    # @see CarlaTelemetryReader
+    @abstractmethod
+    def get_telemetry_filename(self):
+        raise NotImplementedError
+
 # ------------------------------------------------------------------------------------------------------------
 # Carla Host object (dummy/null, does nothing)
 
@@ -1857,6 +2071,9 @@ class CarlaHostNull(CarlaHostMeta):
     def set_engine_callback(self, func):
         self.fEngineCallback = func
 
+    def set_engine_batch_callback(self, func):
+        return
+
     def set_engine_option(self, option, value, valueStr):
         return
 
@@ -1872,6 +2089,15 @@ class CarlaHostNull(CarlaHostMeta):
     def save_project(self, filename):
         return False
 
+    def save_project_async(self, filename):
+        return False
+
+    def convert_project_to_binary(self, xmlFilename, binaryFilename, compress):
+        return False
+
+    def convert_project_to_xml(self, binaryFilename, xmlFilename):
+        return False
+
     def patchbay_connect(self, groupIdA, portIdA, groupIdB, portIdB):
         return False
 
@@ -1890,6 +2116,9 @@ class CarlaHostNull(CarlaHostMeta):
     def transport_relocate(self, frame):
         return
 
+    def engine_render_offline(self, outputFile, inputFile, midiFile, seconds):
+        return False
+
     def get_current_transport_frame(self):
         return 0
 
@@ -1923,6 +2152,18 @@ class CarlaHostNull(CarlaHostMeta):
     def switch_plugins(self, pluginIdA, pluginIdB):
         return False
 
+    def load_standby_project(self, filename):
+        return False
+
+    def switch_standby_plugins(self):
+        return False
+
+    def clear_standby_plugins(self):
+        return
+
+    def get_standby_plugin_count(self):
+        return 0
+
     def load_plugin_state(self, pluginId, filename):
         return False
 
@@ -2007,6 +2248,9 @@ class CarlaHostNull(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return 0.0
 
+    def get_runtime_snapshot(self, maxParameterChanges):
+        return PyCarlaRuntimeSnapshot
+
     def set_option(self, pluginId, option, yesNo):
         return
 
@@ -2082,6 +2326,9 @@ class CarlaHostNull(CarlaHostMeta):
     def get_host_osc_url_udp(self):
         return ""
 
+    def get_telemetry_filename(self):
+        return ""
+
 # ------------------------------------------------------------------------------------------------------------
 # Carla Host object using a DLL
 
@@ -2094,6 +2341,14 @@ class CarlaHostDLL(CarlaHostMeta):
 
         self.lib = cdll.LoadLibrary(libName)
 
+        # arrays for get_runtime_snapshot, allocated on first use
+        self.fRuntimeSnapshot = CarlaRuntimeSnapshot()
+        self.fRuntimeSnapshotPeaks        = (c_float * 0)()
+        self.fRuntimeSnapshotStates       = (c_uint * 0)()
+        self.fRuntimeSnapshotPluginIds    = (c_uint * 0)()
+        self.fRuntimeSnapshotParameterIds = (c_uint32 * 0)()
+        self.fRuntimeSnapshotValues       = (c_float * 0)()
+
         self.lib.carla_get_engine_driver_count.argtypes = None
         self.lib.carla_get_engine_driver_count.restype = c_uint
 
@@ -2124,6 +2379,9 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_set_engine_callback.argtypes = [EngineCallbackFunc, c_void_p]
         self.lib.carla_set_engine_callback.restype = None
 
+        self.lib.carla_set_engine_batch_callback.argtypes = [EngineBatchCallbackFunc, c_void_p]
+        self.lib.carla_set_engine_batch_callback.restype = None
+
         self.lib.carla_set_engine_option.argtypes = [c_enum, c_int, c_char_p]
         self.lib.carla_set_engine_option.restype = None
 
@@ -2139,6 +2397,15 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_save_project.argtypes = [c_char_p]
         self.lib.carla_save_project.restype = c_bool
 
+        self.lib.carla_save_project_async.argtypes = [c_char_p]
+        self.lib.carla_save_project_async.restype = c_bool
+
+        self.lib.carla_convert_project_to_binary.argtypes = [c_char_p, c_char_p, c_bool]
+        self.lib.carla_convert_project_to_binary.restype = c_bool
+
+        self.lib.carla_convert_project_to_xml.argtypes = [c_char_p, c_char_p]
+        self.lib.carla_convert_project_to_xml.restype = c_bool
+
         self.lib.carla_patchbay_connect.argtypes = [c_uint, c_uint, c_uint, c_uint]
         self.lib.carla_patchbay_connect.restype = c_bool
 
@@ -2157,6 +2424,9 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_transport_relocate.argtypes = [c_uint64]
         self.lib.carla_transport_relocate.restype = None
 
+        self.lib.carla_engine_render_offline.argtypes = [c_char_p, c_char_p, c_char_p, c_double]
+        self.lib.carla_engine_render_offline.restype = c_bool
+
         self.lib.carla_get_current_transport_frame.argtypes = None
         self.lib.carla_get_current_transport_frame.restype = c_uint64
 
@@ -2190,6 +2460,18 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_switch_plugins.argtypes = [c_uint, c_uint]
         self.lib.carla_switch_plugins.restype = c_bool
 
+        self.lib.carla_load_standby_project.argtypes = [c_char_p]
+        self.lib.carla_load_standby_project.restype = c_bool
+
+        self.lib.carla_switch_standby_plugins.argtypes = None
+        self.lib.carla_switch_standby_plugins.restype = c_bool
+
+        self.lib.carla_clear_standby_plugins.argtypes = None
+        self.lib.carla_clear_standby_plugins.restype = None
+
+        self.lib.carla_get_standby_plugin_count.argtypes = None
+        self.lib.carla_get_standby_plugin_count.restype = c_uint32
+
         self.lib.carla_load_plugin_state.argtypes = [c_uint, c_char_p]
         self.lib.carla_load_plugin_state.restype = c_bool
 
@@ -2274,6 +2556,9 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_get_output_peak_value.argtypes = [c_uint, c_bool]
         self.lib.carla_get_output_peak_value.restype = c_float
 
+        self.lib.carla_get_runtime_snapshot.argtypes = [POINTER(CarlaRuntimeSnapshot)]
+        self.lib.carla_get_runtime_snapshot.restype = c_bool
+
         self.lib.carla_set_option.argtypes = [c_uint, c_uint, c_bool]
         self.lib.carla_set_option.restype = None
 
@@ -2349,6 +2634,9 @@ class CarlaHostDLL(CarlaHostMeta):
         self.lib.carla_get_host_osc_url_udp.argtypes = None
         self.lib.carla_get_host_osc_url_udp.restype = c_char_p
 
+        self.lib.carla_get_telemetry_filename.argtypes = None
+        self.lib.carla_get_telemetry_filename.restype = c_char_p
+
         self.lib.carla_nsm_init.argtypes = [c_int, c_char_p]
         self.lib.carla_nsm_init.restype = c_bool
 
@@ -2388,6 +2676,13 @@ class CarlaHostDLL(CarlaHostMeta):
         self._engineCallback = EngineCallbackFunc(func)
         self.lib.carla_set_engine_callback(self._engineCallback, None)
 
+    def set_engine_batch_callback(self, func):
+        def batchCallback(ptr, events, count):
+            func(ptr, [(ev.action, ev.pluginId, ev.value1, ev.value2, ev.value3) for ev in events[:count]])
+
+        self._engineBatchCallback = EngineBatchCallbackFunc(batchCallback)
+        self.lib.carla_set_engine_batch_callback(self._engineBatchCallback, None)
+
     def set_engine_option(self, option, value, valueStr):
         self.lib.carla_set_engine_option(option, value, valueStr.encode("utf-8"))
 
@@ -2404,6 +2699,15 @@ class CarlaHostDLL(CarlaHostMeta):
     def save_project(self, filename):
         return bool(self.lib.carla_save_project(filename.encode("utf-8")))
 
+    def save_project_async(self, filename):
+        return bool(self.lib.carla_save_project_async(filename.encode("utf-8")))
+
+    def convert_project_to_binary(self, xmlFilename, binaryFilename, compress):
+        return bool(self.lib.carla_convert_project_to_binary(xmlFilename.encode("utf-8"), binaryFilename.encode("utf-8"), compress))
+
+    def convert_project_to_xml(self, binaryFilename, xmlFilename):
+        return bool(self.lib.carla_convert_project_to_xml(binaryFilename.encode("utf-8"), xmlFilename.encode("utf-8")))
+
     def patchbay_connect(self, groupIdA, portIdA, groupIdB, portIdB):
         return bool(self.lib.carla_patchbay_connect(groupIdA, portIdA, groupIdB, portIdB))
 
@@ -2422,6 +2726,12 @@ class CarlaHostDLL(CarlaHostMeta):
     def transport_relocate(self, frame):
         self.lib.carla_transport_relocate(frame)
 
+    def engine_render_offline(self, outputFile, inputFile, midiFile, seconds):
+        return bool(self.lib.carla_engine_render_offline(outputFile.encode("utf-8"),
+                                                         inputFile.encode("utf-8") if inputFile else None,
+                                                         midiFile.encode("utf-8") if midiFile else None,
+                                                         seconds))
+
     def get_current_transport_frame(self):
         return int(self.lib.carla_get_current_transport_frame())
 
@@ -2458,6 +2768,18 @@ class CarlaHostDLL(CarlaHostMeta):
     def switch_plugins(self, pluginIdA, pluginIdB):
         return bool(self.lib.carla_switch_plugins(pluginIdA, pluginIdB))
 
+    def load_standby_project(self, filename):
+        return bool(self.lib.carla_load_standby_project(filename.encode("utf-8")))
+
+    def switch_standby_plugins(self):
+        return bool(self.lib.carla_switch_standby_plugins())
+
+    def clear_standby_plugins(self):
+        self.lib.carla_clear_standby_plugins()
+
+    def get_standby_plugin_count(self):
+        return int(self.lib.carla_get_standby_plugin_count())
+
     def load_plugin_state(self, pluginId, filename):
         return bool(self.lib.carla_load_plugin_state(pluginId, filename.encode("utf-8")))
 
@@ -2542,6 +2864,44 @@ class CarlaHostDLL(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return float(self.lib.carla_get_output_peak_value(pluginId, isLeft))
 
+    def get_runtime_snapshot(self, maxParameterChanges):
+        snapshot   = self.fRuntimeSnapshot
+        maxPlugins = self.get_max_plugin_number()
+
+        # arrays are kept between calls, and only grow
+        if snapshot.maxPluginCount < maxPlugins:
+            self.fRuntimeSnapshotPeaks  = (c_float * (maxPlugins * 4))()
+            self.fRuntimeSnapshotStates = (c_uint * maxPlugins)()
+            snapshot.maxPluginCount = maxPlugins
+            snapshot.peaks  = self.fRuntimeSnapshotPeaks
+            snapshot.states = self.fRuntimeSnapshotStates
+
+        if snapshot.maxParameterChanges < maxParameterChanges:
+            self.fRuntimeSnapshotPluginIds    = (c_uint * maxParameterChanges)()
+            self.fRuntimeSnapshotParameterIds = (c_uint32 * maxParameterChanges)()
+            self.fRuntimeSnapshotValues       = (c_float * maxParameterChanges)()
+            snapshot.parameterPluginIds = self.fRuntimeSnapshotPluginIds
+            snapshot.parameterIds       = self.fRuntimeSnapshotParameterIds
+            snapshot.parameterValues    = self.fRuntimeSnapshotValues
+
+        snapshot.maxParameterChanges = min(maxParameterChanges, len(self.fRuntimeSnapshotValues))
+
+        if not self.lib.carla_get_runtime_snapshot(pointer(snapshot)):
+            return PyCarlaRuntimeSnapshot
+
+        pluginCount = int(snapshot.pluginCount)
+        changeCount = int(snapshot.parameterChangeCount)
+
+        return {
+            'sequence': int(snapshot.sequence),
+            'pluginCount': pluginCount,
+            'peaks': self.fRuntimeSnapshotPeaks[:pluginCount*4],
+            'states': self.fRuntimeSnapshotStates[:pluginCount],
+            'parameterChanges': list(zip(self.fRuntimeSnapshotPluginIds[:changeCount],
+                                         self.fRuntimeSnapshotParameterIds[:changeCount],
+                                         self.fRuntimeSnapshotValues[:changeCount]))
+        }
+
     def set_option(self, pluginId, option, yesNo):
         self.lib.carla_set_option(pluginId, option, yesNo)
 
@@ -2617,6 +2977,9 @@ class CarlaHostDLL(CarlaHostMeta):
     def get_host_osc_url_udp(self):
         return charPtrToString(self.lib.carla_get_host_osc_url_udp())
 
+    def get_telemetry_filename(self):
+        return charPtrToString(self.lib.carla_get_telemetry_filename())
+
     def nsm_init(self, pid, executableName):
         return bool(self.lib.carla_nsm_init(pid, executableName.encode("utf-8")))
 
@@ -2679,6 +3042,10 @@ class CarlaHostPlugin(CarlaHostMeta):
             "bpm": 0.0
         }
 
+        # last plugin states sent in get_runtime_snapshot
+        self.fRuntimeSnapshotStates   = []
+        self.fRuntimeSnapshotSequence = 0
+
         # some other vars
         self.fBufferSize = 0
         self.fSampleRate = 0.0
@@ -2717,6 +3084,9 @@ class CarlaHostPlugin(CarlaHostMeta):
     def set_engine_callback(self, func):
         return # TODO
 
+    def set_engine_batch_callback(self, func):
+        return # callbacks are never queued here
+
     def set_engine_option(self, option, value, valueStr):
         self.sendMsg(["set_engine_option", option, int(value), valueStr])
 
@@ -2732,6 +3102,15 @@ class CarlaHostPlugin(CarlaHostMeta):
     def save_project(self, filename):
         return self.sendMsgAndSetError(["save_project", filename])
 
+    def save_project_async(self, filename):
+        return False
+
+    def convert_project_to_binary(self, xmlFilename, binaryFilename, compress):
+        return False
+
+    def convert_project_to_xml(self, binaryFilename, xmlFilename):
+        return False
+
     def patchbay_connect(self, groupIdA, portIdA, groupIdB, portIdB):
         return self.sendMsgAndSetError(["patchbay_connect", groupIdA, portIdA, groupIdB, portIdB])
 
@@ -2751,6 +3130,9 @@ class CarlaHostPlugin(CarlaHostMeta):
     def transport_relocate(self, frame):
         self.sendMsg(["transport_relocate"])
 
+    def engine_render_offline(self, outputFile, inputFile, midiFile, seconds):
+        return False
+
     def get_current_transport_frame(self):
         return self.fTransportInfo['frame']
 
@@ -2788,6 +3170,18 @@ class CarlaHostPlugin(CarlaHostMeta):
     def switch_plugins(self, pluginIdA, pluginIdB):
         return self.sendMsgAndSetError(["switch_plugins", pluginIdA, pluginIdB])
 
+    def load_standby_project(self, filename):
+        return False
+
+    def switch_standby_plugins(self):
+        return False
+
+    def clear_standby_plugins(self):
+        return
+
+    def get_standby_plugin_count(self):
+        return 0
+
     def load_plugin_state(self, pluginId, filename):
         return self.sendMsgAndSetError(["load_plugin_state", pluginId, filename])
 
@@ -2877,6 +3271,27 @@ class CarlaHostPlugin(CarlaHostMeta):
     def get_output_peak_value(self, pluginId, isLeft):
         return self.fPluginsInfo[pluginId].peaks[2 if isLeft else 3]
 
+    def get_runtime_snapshot(self, maxParameterChanges):
+        # parameter changes already arrive as callbacks here
+        peaks  = []
+        states = []
+
+        for pinfo in self.fPluginsInfo:
+            peaks  += pinfo.peaks
+            states.append(PLUGIN_RUNTIME_STATE_ENABLED|(PLUGIN_RUNTIME_STATE_ACTIVE if pinfo.internalValues[0] >= 0.5 else 0x0))
+
+        if states != self.fRuntimeSnapshotStates:
+            self.fRuntimeSnapshotStates    = states
+            self.fRuntimeSnapshotSequence += 1
+
+        return {
+            'sequence': self.fRuntimeSnapshotSequence,
+            'pluginCount': len(states),
+            'peaks': peaks,
+            'states': states,
+            'parameterChanges': []
+        }
+
     def set_option(self, pluginId, option, yesNo):
         self.sendMsg(["set_option", pluginId, option, yesNo])
 
@@ -2972,6 +3387,9 @@ class CarlaHostPlugin(CarlaHostMeta):
     def get_host_osc_url_udp(self):
         return self.fOscUDP
 
+    def get_telemetry_filename(self):
+        return ""
+
     # --------------------------------------------------------------------------------------------------------
 
     def _set_transport(self, playing, frame, bar, beat, tick, bpm):
@@ -3134,3 +3552,129 @@ class CarlaHostPlugin(CarlaHostMeta):
         self.fPluginsInfo[pluginId].peaks = [in1, in2, out1, out2]
 
 # ------------------------------------------------------------------------------------------------------------
+# Engine telemetry reader, maps the shared memory region of ENGINE_OPTION_TELEMETRY read-only.
+# Only POSIX shared memory exposed under /dev/shm is supported.
+
+class CarlaTelemetryReader(object):
+    # @see EngineTelemetryHeader and EngineTelemetryPlugin
+    kHeader = Struct("<IIIIIIIIdQ")
+    kPlugin = Struct("<II6f")
+    kSequence = Struct("<I")
+    kSequenceOffset = 8
+    kMaxRetries = 1000
+
+    def __init__(self):
+        self.fMap = None
+        self.fMaxPluginCount = 0
+        self.fScopeSize = 0
+        self.fScopeDecimation = 0
+        self.fScopeOffset = 0
+
+    def __del__(self):
+        self.close()
+
+    def open(self, filename):
+        self.close()
+
+        if not filename:
+            return False
+
+        try:
+            with open(join("/dev/shm", filename.lstrip("/")), "rb") as fd:
+                self.fMap = mmap(fd.fileno(), 0, access=ACCESS_READ)
+        except (IOError, OSError, ValueError):
+            return False
+
+        if len(self.fMap) < self.kHeader.size:
+            self.close()
+            return False
+
+        magic, version, _, maxPluginCount, _, scopeSize, scopeDecimation, _, _, _ = self.kHeader.unpack_from(self.fMap, 0)
+
+        if magic != ENGINE_TELEMETRY_MAGIC or version != ENGINE_TELEMETRY_VERSION:
+            self.close()
+            return False
+
+        self.fMaxPluginCount  = maxPluginCount
+        self.fScopeSize       = scopeSize
+        self.fScopeDecimation = scopeDecimation
+        self.fScopeOffset     = self.kHeader.size + self.kPlugin.size * maxPluginCount
+        return True
+
+    def close(self):
+        if self.fMap is not None:
+            self.fMap.close()
+            self.fMap = None
+
+        self.fMaxPluginCount = 0
+        self.fScopeSize = 0
+
+    def isOpen(self):
+        return self.fMap is not None
+
+    def getScopeSize(self):
+        return self.fScopeSize
+
+    def getScopeDecimation(self):
+        return self.fScopeDecimation
+
+    # Read the meters of all plugins.
+    # Returns None if the engine kept writing while trying.
+    def read(self):
+        if self.fMap is None:
+            return None
+
+        for _ in range(self.kMaxRetries):
+            sequence = self.kSequence.unpack_from(self.fMap, self.kSequenceOffset)[0]
+
+            if sequence & 1:
+                continue
+
+            header  = self.kHeader.unpack_from(self.fMap, 0)
+            plugins = [self.kPlugin.unpack_from(self.fMap, self.kHeader.size + self.kPlugin.size * i)
+                       for i in range(min(header[4], self.fMaxPluginCount))]
+
+            if self.kSequence.unpack_from(self.fMap, self.kSequenceOffset)[0] == sequence:
+                break
+
+        else:
+            return None
+
+        return {
+            'sequence': sequence,
+            'pluginCount': len(plugins),
+            'bufferSize': header[7],
+            'sampleRate': header[8],
+            'processedFrames': header[9],
+            'plugins': [{
+                'present': bool(present),
+                'scopePosition': scopePosition,
+                'insPeak': [inPeak1, inPeak2],
+                'outsPeak': [outPeak1, outPeak2],
+                'outsRms': [outRms1, outRms2]
+            } for present, scopePosition, inPeak1, inPeak2, outPeak1, outPeak2, outRms1, outRms2 in plugins]
+        }
+
+    # Read the last @a count scope points of a plugin, up to the scope position returned by read().
+    # Returns a tuple of left and right point lists, oldest first.
+    def read_scope(self, pluginId, scopePosition, count):
+        if self.fMap is None or self.fScopeSize == 0 or pluginId >= self.fMaxPluginCount:
+            return ([], [])
+
+        count = min(count, scopePosition, self.fScopeSize)
+
+        if count <= 0:
+            return ([], [])
+
+        scope  = Struct("<%if" % self.fScopeSize)
+        offset = self.fScopeOffset + scope.size * 2 * pluginId
+        start  = (scopePosition - count) % self.fScopeSize
+        ret    = []
+
+        for channel in range(2):
+            points = scope.unpack_from(self.fMap, offset + scope.size * channel)
+            ret.append(list(points[start:start+count] + points[:max(0, start + count - self.fScopeSize)]))
+
+        return (ret[0], ret[1])
+
+# ------------------------------------------------------------------------------------------------------------
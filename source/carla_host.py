@@ -542,7 +542,7 @@ class HostWindow(QMainWindow):
 
     @pyqtSlot()
     def slot_fileOpen(self):
-        fileFilter = self.tr("Carla Project File (*.carxp);;Carla Preset File (*.carxs)")
+        fileFilter = self.tr("Carla Project File (*.carxp);;Carla Binary Project File (*.carxb);;Carla Preset File (*.carxs)")
         filename   = QFileDialog.getOpenFileName(self, self.tr("Open Carla Project File"), self.fSavedSettings[CARLA_KEY_MAIN_PROJECT_FOLDER], filter=fileFilter)
 
         if config_UseQt5:
@@ -573,7 +573,7 @@ class HostWindow(QMainWindow):
         if self.fProjectFilename and not saveAs:
             return self.saveProjectNow()
 
-        fileFilter = self.tr("Carla Project File (*.carxp)")
+        fileFilter = self.tr("Carla Project File (*.carxp);;Carla Binary Project File (*.carxb)")
         filename   = QFileDialog.getSaveFileName(self, self.tr("Save Carla Project File"), self.fSavedSettings[CARLA_KEY_MAIN_PROJECT_FOLDER], filter=fileFilter)
 
         if config_UseQt5:
@@ -581,7 +581,7 @@ class HostWindow(QMainWindow):
         if not filename:
             return
 
-        if not filename.lower().endswith(".carxp"):
+        if not filename.lower().endswith((".carxp", ".carxb")):
             filename += ".carxp"
 
         if self.fProjectFilename != filename:
@@ -1791,20 +1791,26 @@ class HostWindow(QMainWindow):
         if self.fPluginCount == 0 or self.fCurrentlyRemovingAllPlugins:
             return
 
+        # get all peaks in a single call, parameter changes arrive as callbacks
+        peaks = self.host.get_runtime_snapshot(0)['peaks']
+
         for pitem in self.fPluginList:
             if pitem is None:
                 break
 
-            pitem.getWidget().idleFast()
+            pitem.getWidget().idleFast(peaks)
 
         for pluginId in self.fSelectedPlugins:
+            if len(peaks) < pluginId*4 + 4:
+                break
+
             self.fPeaksCleared = False
             if self.ui.peak_in.isVisible():
-                self.ui.peak_in.displayMeter(1, self.host.get_input_peak_value(pluginId, True))
-                self.ui.peak_in.displayMeter(2, self.host.get_input_peak_value(pluginId, False))
+                self.ui.peak_in.displayMeter(1, peaks[pluginId*4+0])
+                self.ui.peak_in.displayMeter(2, peaks[pluginId*4+1])
             if self.ui.peak_out.isVisible():
-                self.ui.peak_out.displayMeter(1, self.host.get_output_peak_value(pluginId, True))
-                self.ui.peak_out.displayMeter(2, self.host.get_output_peak_value(pluginId, False))
+                self.ui.peak_out.displayMeter(1, peaks[pluginId*4+2])
+                self.ui.peak_out.displayMeter(2, peaks[pluginId*4+3])
             return
 
         if self.fPeaksCleared:
@@ -2043,6 +2049,10 @@ def engineCallback(host, action, pluginId, value1, value2, value3, valueStr):
     elif action == ENGINE_CALLBACK_QUIT:
         host.QuitCallback.emit()
 
+def engineBatchCallback(host, events):
+    for action, pluginId, value1, value2, value3 in events:
+        engineCallback(host, action, pluginId, value1, value2, value3, None)
+
 # ------------------------------------------------------------------------------------------------------------
 # File callback
 
@@ -2114,6 +2124,7 @@ def initHost(initName, libPrefix, isControl, isPlugin, failError, HostClass = No
     host.isPlugin  = isPlugin
 
     host.set_engine_callback(lambda h,a,p,v1,v2,v3,vs: engineCallback(host,a,p,v1,v2,v3,vs))
+    host.set_engine_batch_callback(lambda h,events: engineBatchCallback(host,events))
     host.set_file_callback(fileCallback)
 
     # If it's a plugin the paths are already set
@@ -2168,6 +2179,11 @@ def loadHostSettings(host):
     except:
         host.uisAlwaysOnTop = CARLA_DEFAULT_UIS_ALWAYS_ON_TOP
 
+    try:
+        host.callbackBatching = settings.value(CARLA_KEY_ENGINE_CALLBACK_BATCHING, CARLA_DEFAULT_CALLBACK_BATCHING, type=bool)
+    except:
+        host.callbackBatching = CARLA_DEFAULT_CALLBACK_BATCHING
+
     # int values
     try:
         host.maxParameters = settings.value(CARLA_KEY_ENGINE_MAX_PARAMETERS, CARLA_DEFAULT_MAX_PARAMETERS, type=int)
@@ -2233,6 +2249,9 @@ def setHostSettings(host):
     host.set_engine_option(ENGINE_OPTION_PROCESS_MODE,          host.nextProcessMode,     "")
     host.set_engine_option(ENGINE_OPTION_TRANSPORT_MODE,        host.transportMode,       "")
 
+    # experimental, frequent callbacks are delivered in batches by engine_idle(), which already runs at the refresh interval
+    host.set_engine_option(ENGINE_OPTION_CALLBACK_BATCH_INTERVAL, 1 if host.callbackBatching else 0, "")
+
 # ------------------------------------------------------------------------------------------------------------
 # Set Engine settings according to carla preferences. Returns selected audio driver.
 
@@ -840,12 +840,25 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
 
     #------------------------------------------------------------------
 
-    def idleFast(self):
+    def idleFast(self, peaks=None):
+        # peaks from the host runtime snapshot, 4 per plugin, otherwise ask the host for each
+        index = self.fPluginId * 4
+
+        if peaks is not None and len(peaks) >= index + 4:
+            inPeaks  = peaks[index:index+2]
+            outPeaks = peaks[index+2:index+4]
+        else:
+            inPeaks  = None
+            outPeaks = None
+
         # Input peaks
         if self.fPeaksInputCount > 0:
+            if inPeaks is None:
+                inPeaks = [self.host.get_input_peak_value(self.fPluginId, True),
+                           self.host.get_input_peak_value(self.fPluginId, False) if self.fPeaksInputCount > 1 else 0.0]
+
             if self.fPeaksInputCount > 1:
-                peak1 = self.host.get_input_peak_value(self.fPluginId, True)
-                peak2 = self.host.get_input_peak_value(self.fPluginId, False)
+                peak1, peak2 = inPeaks
                 ledState = bool(peak1 != 0.0 or peak2 != 0.0)
 
                 if self.peak_in is not None:
@@ -853,7 +866,7 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
                     self.peak_in.displayMeter(2, peak2)
 
             else:
-                peak = self.host.get_input_peak_value(self.fPluginId, True)
+                peak = inPeaks[0]
                 ledState = bool(peak != 0.0)
 
                 if self.peak_in is not None:
@@ -865,9 +878,12 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
 
         # Output peaks
         if self.fPeaksOutputCount > 0:
+            if outPeaks is None:
+                outPeaks = [self.host.get_output_peak_value(self.fPluginId, True),
+                            self.host.get_output_peak_value(self.fPluginId, False) if self.fPeaksOutputCount > 1 else 0.0]
+
             if self.fPeaksOutputCount > 1:
-                peak1 = self.host.get_output_peak_value(self.fPluginId, True)
-                peak2 = self.host.get_output_peak_value(self.fPluginId, False)
+                peak1, peak2 = outPeaks
                 ledState = bool(peak1 != 0.0 or peak2 != 0.0)
 
                 if self.peak_out is not None:
@@ -875,7 +891,7 @@ class AbstractPluginSlot(QFrame, PluginEditParentMeta):
                     self.peak_out.displayMeter(2, peak2)
 
             else:
-                peak = self.host.get_output_peak_value(self.fPluginId, True)
+                peak = outPeaks[0]
                 ledState = bool(peak != 0.0)
 
                 if self.peak_out is not None:
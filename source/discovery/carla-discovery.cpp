@@ -47,6 +47,7 @@
 #include <iostream>
 
 #include "juce_core.h"
+using juce::ByteOrder;
 using juce::CharPointer_UTF8;
 using juce::File;
 using juce::String;
@@ -1525,6 +1526,66 @@ static void do_juce_check(const char* const filename_, const char* const stype,
 }
 #endif
 
+#ifdef HAVE_FLUIDSYNTH
+// --------------------------------------------------------------------------
+// Count SF2 presets by reading only the preset headers (pdta/phdr chunk),
+// skipping the sample data. Returns -1 if the file could not be parsed.
+
+static int do_fluidsynth_count_presets(const char* const filename)
+{
+    FILE* const fd = std::fopen(filename, "rb");
+    CARLA_SAFE_ASSERT_RETURN(fd != nullptr, -1);
+
+    int ret = -1;
+    char id[4], type[4];
+    uint32_t size;
+
+    if (std::fread(id, 4, 1, fd) == 1 && std::fread(&size, 4, 1, fd) == 1 && std::fread(type, 4, 1, fd) == 1 &&
+        std::memcmp(id, "RIFF", 4) == 0 && std::memcmp(type, "sfbk", 4) == 0)
+    {
+        // top-level LIST chunks
+        for (; ret < 0 && std::fread(id, 4, 1, fd) == 1 && std::fread(&size, 4, 1, fd) == 1;)
+        {
+            size = ByteOrder::swapIfBigEndian(size);
+
+            if (std::memcmp(id, "LIST", 4) != 0 || size < 4 || std::fread(type, 4, 1, fd) != 1)
+                break;
+
+            if (std::memcmp(type, "pdta", 4) != 0)
+            {
+                if (std::fseek(fd, static_cast<long>(size - 4 + (size & 1)), SEEK_CUR) != 0)
+                    break;
+                continue;
+            }
+
+            // pdta sub-chunks
+            for (uint32_t left = size - 4; left >= 8 && std::fread(id, 4, 1, fd) == 1 && std::fread(&size, 4, 1, fd) == 1;)
+            {
+                size = ByteOrder::swapIfBigEndian(size);
+
+                if (std::memcmp(id, "phdr", 4) == 0)
+                {
+                    // 38 bytes per preset header, the last one is the terminal "EOP" record
+                    if (size >= 38)
+                        ret = static_cast<int>(size / 38 - 1);
+                    break;
+                }
+
+                if (left < size + 8 || std::fseek(fd, static_cast<long>(size + (size & 1)), SEEK_CUR) != 0)
+                    break;
+
+                left -= size + 8 + (size & 1);
+            }
+
+            break;
+        }
+    }
+
+    std::fclose(fd);
+    return ret;
+}
+#endif
+
 static void do_fluidsynth_check(const char* const filename, const bool doInit)
 {
 #ifdef HAVE_FLUIDSYNTH
@@ -1546,7 +1607,13 @@ static void do_fluidsynth_check(const char* const filename, const bool doInit)
     int programs = 0;
 
     if (doInit)
+        programs = do_fluidsynth_count_presets(filename);
+
+    // fallback, load the whole file
+    if (doInit && programs < 0)
     {
+        programs = 0;
+
         fluid_settings_t* const f_settings = new_fluid_settings();
         CARLA_SAFE_ASSERT_RETURN(f_settings != nullptr,);
 
@@ -0,0 +1,377 @@
+/*
+ * Carla Interposer for realtime-unsafe calls
+ * Copyright (C) 2014-2015 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// -----------------------------------------------------------------------
+// Load this library with LD_PRELOAD on a Carla build made with RTAUDIT=true.
+// The engine marks its realtime threads while processing, and every allocation,
+// blocking lock or blocking syscall made during that time gets reported to stderr
+// together with its call stack. Each call stack is only reported once.
+// Use addr2line or a debug build to resolve the addresses of static symbols.
+
+#include "CarlaUtils.hpp"
+
+#include <cerrno>
+#include <cstdarg>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <poll.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/select.h>
+#include <unistd.h>
+
+// -----------------------------------------------------------------------
+// glibc internals, the real allocation functions
+
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void* __libc_memalign(size_t, size_t);
+void  __libc_free(void*);
+}
+
+// -----------------------------------------------------------------------
+// Function typedefs
+
+typedef int     (*PthreadMutexLockFunc)(pthread_mutex_t*);
+typedef int     (*PthreadCondWaitFunc)(pthread_cond_t*, pthread_mutex_t*);
+typedef int     (*PthreadCondTimedWaitFunc)(pthread_cond_t*, pthread_mutex_t*, const struct timespec*);
+typedef int     (*SemWaitFunc)(sem_t*);
+typedef int     (*SemTimedWaitFunc)(sem_t*, const struct timespec*);
+typedef int     (*NanoSleepFunc)(const struct timespec*, struct timespec*);
+typedef int     (*USleepFunc)(useconds_t);
+typedef ssize_t (*ReadFunc)(int, void*, size_t);
+typedef ssize_t (*WriteFunc)(int, const void*, size_t);
+typedef int     (*PollFunc)(struct pollfd*, nfds_t, int);
+typedef int     (*SelectFunc)(int, fd_set*, fd_set*, fd_set*, struct timeval*);
+
+// -----------------------------------------------------------------------
+// Per-thread state, initial-exec so that accessing it never allocates
+
+#define RTAUDIT_TLS __thread __attribute__((tls_model("initial-exec")))
+
+// > 0 while the engine is processing in this thread
+static RTAUDIT_TLS int sRtDepth = 0;
+
+// true while reporting, calls made by the report itself are not checked
+static RTAUDIT_TLS bool sReporting = false;
+
+// -----------------------------------------------------------------------
+// Reported call stacks, identified by a hash of their addresses
+
+static const int kMaxStackFrames   = 32;
+static const int kMaxReportedStacks = 1024;
+
+static ulong sReportedStacks[kMaxReportedStacks];
+static int   sTotalCalls   = 0;
+static int   sTotalReports = 0;
+
+static bool shouldReportStack(void* const* const frames, const int count) noexcept
+{
+    ulong hash = 5381;
+
+    for (int i=0; i < count; ++i)
+        hash = hash * 33 + reinterpret_cast<ulong>(frames[i]);
+
+    if (hash == 0)
+        hash = 1;
+
+    for (int i=0; i < kMaxReportedStacks; ++i)
+    {
+        const ulong old(__sync_val_compare_and_swap(&sReportedStacks[i], 0, hash));
+
+        if (old == 0)
+            return true;
+        if (old == hash)
+            return false;
+    }
+
+    // table is full, report everything from now on
+    return true;
+}
+
+static void reportCall(const char* const what)
+{
+    sReporting = true;
+
+    __sync_add_and_fetch(&sTotalCalls, 1);
+
+    void* frames[kMaxStackFrames];
+    const int count(::backtrace(frames, kMaxStackFrames));
+
+    if (shouldReportStack(frames, count))
+    {
+        __sync_add_and_fetch(&sTotalReports, 1);
+
+        carla_stderr2("Carla RT audit: %s called from a realtime thread, call stack follows", what);
+
+        // skip ourselves
+        ::backtrace_symbols_fd(frames+1, count-1, STDERR_FILENO);
+    }
+
+    sReporting = false;
+}
+
+#define RTAUDIT_CHECK(what)                     \
+    if (sRtDepth > 0 && ! sReporting)           \
+        reportCall(what);
+
+// -----------------------------------------------------------------------
+// Calling the real functions
+
+static PthreadMutexLockFunc     real_pthread_mutex_lock     = nullptr;
+static PthreadCondWaitFunc      real_pthread_cond_wait      = nullptr;
+static PthreadCondTimedWaitFunc real_pthread_cond_timedwait = nullptr;
+static SemWaitFunc              real_sem_wait               = nullptr;
+static SemTimedWaitFunc         real_sem_timedwait          = nullptr;
+static NanoSleepFunc            real_nanosleep              = nullptr;
+static USleepFunc               real_usleep                 = nullptr;
+static ReadFunc                 real_read                   = nullptr;
+static WriteFunc                real_write                  = nullptr;
+static PollFunc                 real_poll                   = nullptr;
+static SelectFunc               real_select                 = nullptr;
+
+static void* getRealFunction(const char* const name, const char* const version = nullptr) noexcept
+{
+    // the default pthread_cond symbols are the old ABI ones, prefer the current version
+    if (version != nullptr)
+    {
+        if (void* const func = ::dlvsym(RTLD_NEXT, name, version))
+            return func;
+    }
+
+    return ::dlsym(RTLD_NEXT, name);
+}
+
+#define RTAUDIT_RESOLVE(name, ...) \
+    if (real_##name == nullptr) \
+        real_##name = (__typeof__(real_##name))getRealFunction(#name, ##__VA_ARGS__);
+
+static void resolveRealFunctions() noexcept
+{
+    RTAUDIT_RESOLVE(pthread_mutex_lock)
+    RTAUDIT_RESOLVE(pthread_cond_wait, "GLIBC_2.3.2")
+    RTAUDIT_RESOLVE(pthread_cond_timedwait, "GLIBC_2.3.2")
+    RTAUDIT_RESOLVE(sem_wait)
+    RTAUDIT_RESOLVE(sem_timedwait)
+    RTAUDIT_RESOLVE(nanosleep)
+    RTAUDIT_RESOLVE(usleep)
+    RTAUDIT_RESOLVE(read)
+    RTAUDIT_RESOLVE(write)
+    RTAUDIT_RESOLVE(poll)
+    RTAUDIT_RESOLVE(select)
+}
+
+// -----------------------------------------------------------------------
+// Library init and summary
+
+__attribute__((constructor))
+static void carla_interposer_rtaudit_init()
+{
+    resolveRealFunctions();
+
+    // backtrace loads libgcc on first use, do it now instead of inside a report
+    void* frames[1];
+    ::backtrace(frames, 1);
+}
+
+__attribute__((destructor))
+static void carla_interposer_rtaudit_fini()
+{
+    if (sTotalCalls == 0)
+        return;
+
+    carla_stderr2("Carla RT audit: %i unsafe calls made from realtime threads, %i different call stacks",
+                  sTotalCalls, sTotalReports);
+}
+
+// -----------------------------------------------------------------------
+// Realtime thread marking, called by the engine
+
+CARLA_EXPORT
+void carla_interposer_rtaudit_enter() noexcept
+{
+    ++sRtDepth;
+}
+
+CARLA_EXPORT
+void carla_interposer_rtaudit_leave() noexcept
+{
+    --sRtDepth;
+}
+
+// -----------------------------------------------------------------------
+// Allocations
+
+CARLA_EXPORT
+void* malloc(size_t size)
+{
+    RTAUDIT_CHECK("malloc")
+    return __libc_malloc(size);
+}
+
+CARLA_EXPORT
+void* calloc(size_t nmemb, size_t size)
+{
+    RTAUDIT_CHECK("calloc")
+    return __libc_calloc(nmemb, size);
+}
+
+CARLA_EXPORT
+void* realloc(void* ptr, size_t size)
+{
+    RTAUDIT_CHECK("realloc")
+    return __libc_realloc(ptr, size);
+}
+
+CARLA_EXPORT
+void* memalign(size_t alignment, size_t size)
+{
+    RTAUDIT_CHECK("memalign")
+    return __libc_memalign(alignment, size);
+}
+
+CARLA_EXPORT
+void* aligned_alloc(size_t alignment, size_t size)
+{
+    RTAUDIT_CHECK("aligned_alloc")
+    return __libc_memalign(alignment, size);
+}
+
+CARLA_EXPORT
+int posix_memalign(void** memptr, size_t alignment, size_t size)
+{
+    RTAUDIT_CHECK("posix_memalign")
+
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+        return EINVAL;
+
+    void* const ptr(__libc_memalign(alignment, size));
+
+    if (ptr == nullptr)
+        return ENOMEM;
+
+    *memptr = ptr;
+    return 0;
+}
+
+CARLA_EXPORT
+void free(void* ptr)
+{
+    if (ptr == nullptr)
+        return;
+
+    RTAUDIT_CHECK("free")
+    __libc_free(ptr);
+}
+
+// -----------------------------------------------------------------------
+// Locks
+
+CARLA_EXPORT
+int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    RTAUDIT_CHECK("pthread_mutex_lock")
+    RTAUDIT_RESOLVE(pthread_mutex_lock)
+    return real_pthread_mutex_lock(mutex);
+}
+
+CARLA_EXPORT
+int pthread_cond_wait(pthread_cond_t* cond, pthread_mutex_t* mutex)
+{
+    RTAUDIT_CHECK("pthread_cond_wait")
+    RTAUDIT_RESOLVE(pthread_cond_wait, "GLIBC_2.3.2")
+    return real_pthread_cond_wait(cond, mutex);
+}
+
+CARLA_EXPORT
+int pthread_cond_timedwait(pthread_cond_t* cond, pthread_mutex_t* mutex, const struct timespec* abstime)
+{
+    RTAUDIT_CHECK("pthread_cond_timedwait")
+    RTAUDIT_RESOLVE(pthread_cond_timedwait, "GLIBC_2.3.2")
+    return real_pthread_cond_timedwait(cond, mutex, abstime);
+}
+
+CARLA_EXPORT
+int sem_wait(sem_t* sem)
+{
+    RTAUDIT_CHECK("sem_wait")
+    RTAUDIT_RESOLVE(sem_wait)
+    return real_sem_wait(sem);
+}
+
+CARLA_EXPORT
+int sem_timedwait(sem_t* sem, const struct timespec* abstime)
+{
+    RTAUDIT_CHECK("sem_timedwait")
+    RTAUDIT_RESOLVE(sem_timedwait)
+    return real_sem_timedwait(sem, abstime);
+}
+
+// -----------------------------------------------------------------------
+// Blocking syscalls
+
+CARLA_EXPORT
+int nanosleep(const struct timespec* req, struct timespec* rem)
+{
+    RTAUDIT_CHECK("nanosleep")
+    RTAUDIT_RESOLVE(nanosleep)
+    return real_nanosleep(req, rem);
+}
+
+CARLA_EXPORT
+int usleep(useconds_t usec)
+{
+    RTAUDIT_CHECK("usleep")
+    RTAUDIT_RESOLVE(usleep)
+    return real_usleep(usec);
+}
+
+CARLA_EXPORT
+ssize_t read(int fd, void* buf, size_t count)
+{
+    RTAUDIT_CHECK("read")
+    RTAUDIT_RESOLVE(read)
+    return real_read(fd, buf, count);
+}
+
+CARLA_EXPORT
+ssize_t write(int fd, const void* buf, size_t count)
+{
+    RTAUDIT_CHECK("write")
+    RTAUDIT_RESOLVE(write)
+    return real_write(fd, buf, count);
+}
+
+CARLA_EXPORT
+int poll(struct pollfd* fds, nfds_t nfds, int timeout)
+{
+    RTAUDIT_CHECK("poll")
+    RTAUDIT_RESOLVE(poll)
+    return real_poll(fds, nfds, timeout);
+}
+
+CARLA_EXPORT
+int select(int nfds, fd_set* readfds, fd_set* writefds, fd_set* exceptfds, struct timeval* timeout)
+{
+    RTAUDIT_CHECK("select")
+    RTAUDIT_RESOLVE(select)
+    return real_select(nfds, readfds, writefds, exceptfds, timeout);
+}
+
+// -----------------------------------------------------------------------
@@ -581,8 +581,9 @@ private:
 
         setNodeDelay (node.nodeId, maxLatency + processor.getLatencySamples());
 
+        // the audio and midi output nodes both have no outputs, so keep the largest
         if (numOuts == 0)
-            totalLatency = maxLatency;
+            totalLatency = jmax (totalLatency, maxLatency);
 
         renderingOps.add (new ProcessBufferOp (&node, audioChannelsToUse,
                                                totalChans, midiBufferToUse));
@@ -904,6 +905,10 @@ AudioProcessorGraph::~AudioProcessorGraph()
 {
     clearRenderingSequence();
     clear();
+
+    const ScopedLock sl (renderSequenceLock);
+    jassert (renderSequenceInUse.get() == nullptr);
+    retiredRenderSequences.clear();
 }
 
 const String AudioProcessorGraph::getName() const
@@ -1136,23 +1141,91 @@ bool AudioProcessorGraph::removeIllegalConnections()
     return doneAnything;
 }
 
-//==============================================================================
-static void deleteRenderOpArray (Array<void*>& ops)
+void AudioProcessorGraph::rebuild()
 {
-    for (int i = ops.size(); --i >= 0;)
-        delete static_cast<GraphRenderingOps::AudioGraphRenderingOp*> (ops.getUnchecked(i));
+    triggerAsyncUpdate();
 }
 
-void AudioProcessorGraph::clearRenderingSequence()
+//==============================================================================
+struct AudioProcessorGraph::RenderSequence
 {
-    Array<void*> oldOps;
+    RenderSequence() {}
 
+    ~RenderSequence()
     {
-        const ScopedLock sl (getCallbackLock());
-        renderingOps.swapWith (oldOps);
+        for (int i = renderingOps.size(); --i >= 0;)
+            delete static_cast<GraphRenderingOps::AudioGraphRenderingOp*> (renderingOps.getUnchecked(i));
     }
 
-    deleteRenderOpArray (oldOps);
+    // allocates everything the audio thread will need, so that perform() never has to
+    void prepareBuffers (const int numRenderingBuffers, const int numMidiBuffers, const int blockSize)
+    {
+        renderingBuffers.setSize (numRenderingBuffers, blockSize);
+        renderingBuffers.clear();
+
+        while (midiBuffers.size() < numMidiBuffers)
+            midiBuffers.add (new MidiBuffer())->ensureSize (midiBufferSizeToPreallocate);
+    }
+
+    void perform (const int numSamples)
+    {
+        // the block size changed without a new sequence being built
+        if (numSamples > renderingBuffers.getNumSamples())
+        {
+            jassertfalse;
+            return;
+        }
+
+        for (int i = 0; i < renderingOps.size(); ++i)
+        {
+            GraphRenderingOps::AudioGraphRenderingOp* const op
+                = (GraphRenderingOps::AudioGraphRenderingOp*) renderingOps.getUnchecked(i);
+
+            op->perform (renderingBuffers, midiBuffers, numSamples);
+        }
+    }
+
+    enum { midiBufferSizeToPreallocate = 2048 };
+
+    Array<void*> renderingOps;
+    AudioSampleBuffer renderingBuffers;
+    OwnedArray<MidiBuffer> midiBuffers;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderSequence)
+};
+
+void AudioProcessorGraph::publishRenderSequence (RenderSequence* const newSequence)
+{
+    const ScopedLock sl (renderSequenceLock);
+
+    if (RenderSequence* const oldSequence = renderSequence.exchange (newSequence))
+        retiredRenderSequences.add (oldSequence);
+
+    // anything the audio thread isn't holding now can go, as it'll only pick up the new one from here on
+    RenderSequence* const sequenceInUse = renderSequenceInUse.get();
+
+    for (int i = retiredRenderSequences.size(); --i >= 0;)
+        if (retiredRenderSequences.getUnchecked(i) != sequenceInUse)
+            retiredRenderSequences.remove (i);
+}
+
+AudioProcessorGraph::RenderSequence* AudioProcessorGraph::acquireRenderSequence() noexcept
+{
+    // mark the sequence as in use before checking it's still the current one, so that
+    // publishRenderSequence() can never delete it while we're about to use it
+    for (;;)
+    {
+        RenderSequence* const sequence = renderSequence.get();
+        renderSequenceInUse.set (sequence);
+
+        if (renderSequence.get() == sequence)
+            return sequence;
+    }
+}
+
+void AudioProcessorGraph::clearRenderingSequence()
+{
+    publishRenderSequence (nullptr);
 }
 
 bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
@@ -1177,9 +1250,7 @@ bool AudioProcessorGraph::isAnInputTo (const uint32 possibleInputId,
 
 void AudioProcessorGraph::buildRenderingSequence()
 {
-    Array<void*> newRenderingOps;
-    int numRenderingBuffersNeeded = 2;
-    int numMidiBuffersNeeded = 1;
+    ScopedPointer<RenderSequence> newSequence (new RenderSequence());
 
     {
         MessageManagerLock mml;
@@ -1204,30 +1275,15 @@ void AudioProcessorGraph::buildRenderingSequence()
             }
         }
 
-        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newRenderingOps);
+        GraphRenderingOps::RenderingOpSequenceCalculator calculator (*this, orderedNodes, newSequence->renderingOps);
 
-        numRenderingBuffersNeeded = calculator.getNumBuffersNeeded();
-        numMidiBuffersNeeded = calculator.getNumMidiBuffersNeeded();
+        newSequence->prepareBuffers (calculator.getNumBuffersNeeded(),
+                                     calculator.getNumMidiBuffersNeeded(),
+                                     getBlockSize());
     }
 
-    {
-        // swap over to the new rendering sequence..
-        const ScopedLock sl (getCallbackLock());
-
-        renderingBuffers.setSize (numRenderingBuffersNeeded, getBlockSize());
-        renderingBuffers.clear();
-
-        for (int i = midiBuffers.size(); --i >= 0;)
-            midiBuffers.getUnchecked(i)->clear();
-
-        while (midiBuffers.size() < numMidiBuffersNeeded)
-            midiBuffers.add (new MidiBuffer());
-
-        renderingOps.swapWith (newRenderingOps);
-    }
-
-    // delete the old ones..
-    deleteRenderOpArray (newRenderingOps);
+    // swap over to the new rendering sequence, without blocking the audio thread..
+    publishRenderSequence (newSequence.release());
 }
 
 void AudioProcessorGraph::handleAsyncUpdate()
@@ -1242,8 +1298,9 @@ void AudioProcessorGraph::prepareToPlay (double /*sampleRate*/, int estimatedSam
     currentAudioOutputBuffer.setSize (jmax (1, getNumOutputChannels()), estimatedSamplesPerBlock);
     currentMidiInputBuffer = nullptr;
     currentMidiOutputBuffer.clear();
+    currentMidiOutputBuffer.ensureSize (RenderSequence::midiBufferSizeToPreallocate);
 
-    clearRenderingSequence();
+    // the new sequence replaces the current one in a single swap, so the audio thread never sees an empty graph
     buildRenderingSequence();
 }
 
@@ -1252,8 +1309,7 @@ void AudioProcessorGraph::releaseResources()
     for (int i = 0; i < nodes.size(); ++i)
         nodes.getUnchecked(i)->unprepare();
 
-    renderingBuffers.setSize (1, 1);
-    midiBuffers.clear();
+    clearRenderingSequence();
 
     currentAudioInputBuffer = nullptr;
     currentAudioOutputBuffer.setSize (1, 1);
@@ -1297,13 +1353,10 @@ void AudioProcessorGraph::processBlock (AudioSampleBuffer& buffer, MidiBuffer& m
     currentMidiInputBuffer = &midiMessages;
     currentMidiOutputBuffer.clear();
 
-    for (int i = 0; i < renderingOps.size(); ++i)
-    {
-        GraphRenderingOps::AudioGraphRenderingOp* const op
-            = (GraphRenderingOps::AudioGraphRenderingOp*) renderingOps.getUnchecked(i);
+    if (RenderSequence* const sequence = acquireRenderSequence())
+        sequence->perform (numSamples);
 
-        op->perform (renderingBuffers, midiBuffers, numSamples);
-    }
+    renderSequenceInUse.set (nullptr);
 
     for (int i = 0; i < buffer.getNumChannels(); ++i)
         buffer.copyFrom (i, 0, currentAudioOutputBuffer, i, 0, numSamples);
@@ -243,6 +243,14 @@ public:
     */
     bool removeIllegalConnections();
 
+    /** Rebuilds the rendering sequence asynchronously.
+
+        Call this after changing the latency of one of the nodes, so that the graph
+        can update its delay compensation. The current sequence keeps being used
+        until the new one is ready.
+    */
+    void rebuild();
+
     //==============================================================================
     /** A special number that represents the midi channel of a node.
 
@@ -380,9 +388,14 @@ private:
     ReferenceCountedArray<Node> nodes;
     OwnedArray<Connection> connections;
     uint32 lastNodeId;
-    AudioSampleBuffer renderingBuffers;
-    OwnedArray<MidiBuffer> midiBuffers;
-    Array<void*> renderingOps;
+
+    // The rendering ops and the buffers they use are built together off the audio thread,
+    // then published to it by swapping a single pointer. A sequence that has been replaced
+    // is only deleted once the audio thread is no longer using it.
+    struct RenderSequence;
+    Atomic<RenderSequence*> renderSequence, renderSequenceInUse;
+    OwnedArray<RenderSequence> retiredRenderSequences;
+    CriticalSection renderSequenceLock;
 
     friend class AudioGraphIOProcessor;
     AudioSampleBuffer* currentAudioInputBuffer;
@@ -393,6 +406,8 @@ private:
     void handleAsyncUpdate() override;
     void clearRenderingSequence();
     void buildRenderingSequence();
+    void publishRenderSequence (RenderSequence*);
+    RenderSequence* acquireRenderSequence() noexcept;
     bool isAnInputTo (uint32 possibleInputId, uint32 possibleDestinationId, int recursionCheck) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProcessorGraph)
@@ -345,7 +345,7 @@ private:
     };
 }
 #ifndef DOXYGEN
- JUCE_PACKED
+ /*JUCE_PACKED*/
 #endif
 ;
 
@@ -25,12 +25,60 @@
 #include <math.h>
 #include "reverb.h"
 
+#if defined(__SSE2__) && !defined(REV1_NO_SIMD)
+# include <emmintrin.h>
+# define REV1_SIMD
+#elif (defined(__ARM_NEON__) || defined(__ARM_NEON)) && !defined(REV1_NO_SIMD)
+# include <arm_neon.h>
+# define REV1_SIMD
+#endif
+
 namespace REV1 {
 
 
 // -----------------------------------------------------------------------
 
 
+#ifdef REV1_SIMD
+
+// 4 x float vector, the 8 lines of the FDN are processed as two of these.
+
+#ifdef __SSE2__
+typedef __m128 v4f;
+static inline v4f  v4_load (const float *p) { return _mm_loadu_ps (p); }
+static inline void v4_store (float *p, v4f v) { _mm_storeu_ps (p, v); }
+static inline v4f  v4_set1 (float x) { return _mm_set1_ps (x); }
+static inline v4f  v4_set (float a, float b, float c, float d) { return _mm_setr_ps (a, b, c, d); }
+static inline v4f  v4_add (v4f a, v4f b) { return _mm_add_ps (a, b); }
+static inline v4f  v4_sub (v4f a, v4f b) { return _mm_sub_ps (a, b); }
+static inline v4f  v4_mul (v4f a, v4f b) { return _mm_mul_ps (a, b); }
+// { x1, x0, x3, x2 }
+static inline v4f  v4_swap1 (v4f v) { return _mm_shuffle_ps (v, v, _MM_SHUFFLE (2, 3, 0, 1)); }
+// { x2, x3, x0, x1 }
+static inline v4f  v4_swap2 (v4f v) { return _mm_shuffle_ps (v, v, _MM_SHUFFLE (1, 0, 3, 2)); }
+#else
+typedef float32x4_t v4f;
+static inline v4f  v4_load (const float *p) { return vld1q_f32 (p); }
+static inline void v4_store (float *p, v4f v) { vst1q_f32 (p, v); }
+static inline v4f  v4_set1 (float x) { return vdupq_n_f32 (x); }
+static inline v4f  v4_set (float a, float b, float c, float d)
+{
+    const float v [4] = { a, b, c, d };
+    return vld1q_f32 (v);
+}
+static inline v4f  v4_add (v4f a, v4f b) { return vaddq_f32 (a, b); }
+static inline v4f  v4_sub (v4f a, v4f b) { return vsubq_f32 (a, b); }
+static inline v4f  v4_mul (v4f a, v4f b) { return vmulq_f32 (a, b); }
+static inline v4f  v4_swap1 (v4f v) { return vrev64q_f32 (v); }
+static inline v4f  v4_swap2 (v4f v) { return vcombine_f32 (vget_high_f32 (v), vget_low_f32 (v)); }
+#endif
+
+#endif
+
+
+// -----------------------------------------------------------------------
+
+
 Diff1::Diff1 (void) :
     _size (0),
     _line (0)
@@ -289,9 +337,9 @@ void Reverb::prepare (int nfram)
 }
 
 
-void Reverb::process (int nfram, float *inp [], float *out [])
+void Reverb::process_fdn (int nfram, float *inp [], float *out [])
 {	
-    int   i, n;
+    int   i;
     float *p0, *p1;
     float *q0, *q1, *q2, *q3;
     float t, g, x0, x1, x2, x3, x4, x5, x6, x7;
@@ -359,6 +407,168 @@ void Reverb::process (int nfram, float *inp [], float *out [])
         _delay [6].write (_filt1 [6].process (g * x6));
         _delay [7].write (_filt1 [7].process (g * x7));
     }
+}
+
+
+#ifdef REV1_SIMD
+
+void Reverb::process_fdn_simd (int nfram, float *inp [], float *out [])
+{
+    int   i, j;
+    float *p0, *p1;
+    float *q0, *q1, *q2, *q3;
+    float t0, t1, x [8];
+    float *dline [8], *fline [8];
+    int   di [8], ds [8], fi [8], fs [8];
+    v4f   xa, xb, ya, yb, za, zb;
+    v4f   ca, cb, gmfa, gmfb, gloa, glob, wloa, wlob, whia, whib;
+    v4f   sloa, slob, shia, shib;
+
+    const v4f g  = v4_set1 (sqrtf (0.125f));
+    const v4f e  = v4_set1 (1e-10f);
+    const float sgn1 [4] = { 1, -1, 1, -1 };
+    const float sgn2 [4] = { 1, 1, -1, -1 };
+    const v4f s1 = v4_load (sgn1);
+    const v4f s2 = v4_load (sgn2);
+
+    p0 = inp [0];
+    p1 = inp [1];
+    q0 = out [0];
+    q1 = out [1];
+    q2 = out [2];
+    q3 = out [3];
+
+    // Work on local copies of the line pointers and indices.
+    for (j = 0; j < 8; j++)
+    {
+        dline [j] = _diff1 [j]._line;
+        di [j] = _diff1 [j]._i;
+        ds [j] = _diff1 [j]._size;
+        fline [j] = _delay [j]._line;
+        fi [j] = _delay [j]._i;
+        fs [j] = _delay [j]._size;
+    }
+
+    // Lines 0-3 are in the 'a' vectors, lines 4-7 in the 'b' ones.
+    for (j = 0; j < 8; j++) x [j] = _diff1 [j]._c;
+    ca = v4_load (x); cb = v4_load (x + 4);
+    for (j = 0; j < 8; j++) x [j] = _filt1 [j]._gmf;
+    gmfa = v4_load (x); gmfb = v4_load (x + 4);
+    for (j = 0; j < 8; j++) x [j] = _filt1 [j]._glo;
+    gloa = v4_load (x); glob = v4_load (x + 4);
+    for (j = 0; j < 8; j++) x [j] = _filt1 [j]._wlo;
+    wloa = v4_load (x); wlob = v4_load (x + 4);
+    for (j = 0; j < 8; j++) x [j] = _filt1 [j]._whi;
+    whia = v4_load (x); whib = v4_load (x + 4);
+    for (j = 0; j < 8; j++) x [j] = _filt1 [j]._slo;
+    sloa = v4_load (x); slob = v4_load (x + 4);
+    for (j = 0; j < 8; j++) x [j] = _filt1 [j]._shi;
+    shia = v4_load (x); shib = v4_load (x + 4);
+
+    for (i = 0; i < nfram; i++)
+    {
+	_vdelay0.write (p0 [i]);
+	_vdelay1.write (p1 [i]);
+
+	t0 = 0.3f * _vdelay0.read ();
+	t1 = 0.3f * _vdelay1.read ();
+	xa = v4_set (fline [0][fi [0]], fline [1][fi [1]], fline [2][fi [2]], fline [3][fi [3]]);
+	xb = v4_set (fline [4][fi [4]], fline [5][fi [5]], fline [6][fi [6]], fline [7][fi [7]]);
+	xa = v4_add (xa, v4_mul (s2, v4_set1 (t0)));
+	xb = v4_add (xb, v4_mul (s2, v4_set1 (t1)));
+
+	// Diffusers, same as Diff1::process ().
+	za = v4_set (dline [0][di [0]], dline [1][di [1]], dline [2][di [2]], dline [3][di [3]]);
+	zb = v4_set (dline [4][di [4]], dline [5][di [5]], dline [6][di [6]], dline [7][di [7]]);
+	xa = v4_sub (xa, v4_mul (ca, za));
+	xb = v4_sub (xb, v4_mul (cb, zb));
+	v4_store (x, xa);
+	v4_store (x + 4, xb);
+	for (j = 0; j < 8; j++)
+	{
+	    dline [j][di [j]] = x [j];
+	    if (++di [j] == ds [j]) di [j] = 0;
+	}
+	xa = v4_add (za, v4_mul (ca, xa));
+	xb = v4_add (zb, v4_mul (cb, xb));
+
+	// 8 point Hadamard transform.
+	xa = v4_add (v4_swap1 (xa), v4_mul (s1, xa));
+	xb = v4_add (v4_swap1 (xb), v4_mul (s1, xb));
+	xa = v4_add (v4_swap2 (xa), v4_mul (s2, xa));
+	xb = v4_add (v4_swap2 (xb), v4_mul (s2, xb));
+	ya = v4_add (xa, xb);
+	yb = v4_sub (xa, xb);
+	v4_store (x, ya);
+	v4_store (x + 4, yb);
+
+	if (_ambis)
+	{
+            _g0 += _d0;
+            _g1 += _d1;
+	    q0 [i] = _g0 * x [0];
+	    q1 [i] = _g1 * x [1];
+	    q2 [i] = _g1 * x [4];
+	    q3 [i] = _g1 * x [2];
+	}
+	else
+	{
+            _g1 += _d1;
+	    q0 [i] = _g1 * (x [1] + x [2]);
+	    q1 [i] = _g1 * (x [1] - x [2]);
+	}
+
+	// Damping filters, same as Filt1::process ().
+	ya = v4_mul (g, ya);
+	yb = v4_mul (g, yb);
+	sloa = v4_add (sloa, v4_add (v4_mul (wloa, v4_sub (ya, sloa)), e));
+	slob = v4_add (slob, v4_add (v4_mul (wlob, v4_sub (yb, slob)), e));
+	ya = v4_add (ya, v4_mul (gloa, sloa));
+	yb = v4_add (yb, v4_mul (glob, slob));
+	shia = v4_add (shia, v4_mul (whia, v4_sub (ya, shia)));
+	shib = v4_add (shib, v4_mul (whib, v4_sub (yb, shib)));
+	v4_store (x, v4_mul (gmfa, shia));
+	v4_store (x + 4, v4_mul (gmfb, shib));
+	for (j = 0; j < 8; j++)
+	{
+	    fline [j][fi [j]] = x [j];
+	    if (++fi [j] == fs [j]) fi [j] = 0;
+	}
+    }
+
+    for (j = 0; j < 8; j++)
+    {
+        _diff1 [j]._i = di [j];
+        _delay [j]._i = fi [j];
+    }
+
+    v4_store (x, sloa);
+    v4_store (x + 4, slob);
+    for (j = 0; j < 8; j++) _filt1 [j]._slo = x [j];
+    v4_store (x, shia);
+    v4_store (x + 4, shib);
+    for (j = 0; j < 8; j++) _filt1 [j]._shi = x [j];
+}
+
+#endif
+
+
+void Reverb::process (int nfram, float *inp [], float *out [])
+{	
+    int   i, n;
+    float *p0, *p1;
+    float *q0, *q1;
+
+    p0 = inp [0];
+    p1 = inp [1];
+    q0 = out [0];
+    q1 = out [1];
+
+#ifdef REV1_SIMD
+    process_fdn_simd (nfram, inp, out);
+#else
+    process_fdn (nfram, inp, out);
+#endif
 
     n = _ambis ? 4 : 2;
     _pareq1.process (nfram, n, out);
@@ -185,6 +185,8 @@ public:
 
 private:
 
+    void process_fdn (int nfram, float *inp [], float *out []);
+    void process_fdn_simd (int nfram, float *inp [], float *out []);
 
     float   _fsamp;
     bool    _ambis;
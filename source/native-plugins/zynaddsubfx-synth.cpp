@@ -17,16 +17,19 @@
 
 #include "CarlaNativeExtUI.hpp"
 #include "CarlaMIDI.h"
+#include "CarlaSemUtils.hpp"
 #include "CarlaThread.hpp"
 #include "LinkedList.hpp"
 
 #include "CarlaMathUtils.hpp"
 
+#include "Misc/Allocator.h"
 #include "Misc/Master.h"
 #include "Misc/MiddleWare.h"
 #include "Misc/Part.h"
 #include "Misc/Util.h"
 
+#include <atomic>
 #include <ctime>
 #include <set>
 #include <string>
@@ -183,6 +186,251 @@ private:
 
 static ZynAddSubFxPrograms sPrograms;
 
+// -----------------------------------------------------------------------
+// Renders zyn parts across a pool of realtime worker threads.
+// The audio thread takes part in the work and waits for all parts to finish,
+// mixing stays in Master::AudioOut so the output is the same as serial rendering.
+
+class ZynAddSubFxPartRenderer
+{
+public:
+    ZynAddSubFxPartRenderer()
+        : fWorkers(),
+          fSem(),
+          fDoneSem(),
+          fSemValid(false),
+          fWorkersPriority(-1),
+          fAudioPriority(-1),
+          fMaster(nullptr),
+          fJobState(0),
+          fPendingJobs(0),
+          fAudioWaiting(false)
+    {
+        carla_zeroStruct(fParts);
+    }
+
+    ~ZynAddSubFxPartRenderer()
+    {
+        stop();
+    }
+
+    bool isRunning() const noexcept
+    {
+        return fWorkers.count() > 0;
+    }
+
+    // workers get the given realtime priority from the start, so they are ready for the next audio block
+    void start(const int rtPriority)
+    {
+        CARLA_SAFE_ASSERT_RETURN(! isRunning(),);
+
+#ifdef CARLA_OS_MAC
+        // no usable unnamed semaphores, keep rendering serially
+        return;
+
+        // unused
+        (void)rtPriority;
+#else
+        const int numCpus(juce::SystemStats::getNumCpus());
+
+        if (numCpus <= 1)
+            return;
+
+        if (! carla_sem_create2(fSem))
+            return;
+
+        if (! carla_sem_create2(fDoneSem))
+        {
+            carla_sem_destroy2(fSem);
+            return;
+        }
+
+        fSemValid = true;
+        fWorkersPriority.store(rtPriority, std::memory_order_relaxed);
+        fAudioPriority.store(-1, std::memory_order_relaxed);
+
+        for (int i=0, count=std::min(numCpus-1, kMaxWorkers); i < count; ++i)
+        {
+            Worker* const worker(new Worker(this));
+            worker->setRealtimeOptions(rtPriority);
+
+            if (! worker->startThread())
+            {
+                delete worker;
+                break;
+            }
+
+            fWorkers.append(worker);
+        }
+#endif
+    }
+
+    void stop()
+    {
+        for (LinkedList<Worker*>::Itenerator it = fWorkers.begin2(); it.valid(); it.next())
+        {
+            Worker* const worker(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(worker != nullptr);
+
+            worker->signalThreadShouldExit();
+        }
+
+        for (LinkedList<Worker*>::Itenerator it = fWorkers.begin2(); it.valid(); it.next())
+        {
+            Worker* const worker(it.getValue(nullptr));
+            CARLA_SAFE_ASSERT_CONTINUE(worker != nullptr);
+
+            carla_sem_post(fSem);
+            worker->stopThread(1500);
+            delete worker;
+        }
+
+        fWorkers.clear();
+
+        fWorkersPriority.store(-1, std::memory_order_relaxed);
+        fAudioPriority.store(-1, std::memory_order_relaxed);
+
+        if (fSemValid)
+        {
+            carla_sem_destroy2(fSem);
+            carla_sem_destroy2(fDoneSem);
+            fSemValid = false;
+        }
+    }
+
+    // non-RT, can be called without the plugin lock.
+    // true if the audio thread runs with a different priority than the workers got,
+    // which is only known after the first block, so the first start can guess wrong.
+    bool needsRestart(int& rtPriority) const noexcept
+    {
+        rtPriority = fAudioPriority.load(std::memory_order_relaxed);
+
+        return rtPriority >= 0 && rtPriority != fWorkersPriority.load(std::memory_order_relaxed);
+    }
+
+    void render(Master* const master, const int* const parts, const int count) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(count > 0 && count <= NUM_MIDI_PARTS,);
+
+        if (count == 1 || ! isRunning())
+        {
+            for (int i=0; i < count; ++i)
+                master->renderPart(parts[i]);
+            return;
+        }
+
+        // only checked once per start, see needsRestart()
+        if (fAudioPriority.load(std::memory_order_relaxed) < 0)
+            fAudioPriority.store(CarlaThread::getCurrentThreadRealtimePriority(), std::memory_order_relaxed);
+
+        master->memory->setConcurrent(true);
+
+        fMaster = master;
+        std::memcpy(fParts, parts, sizeof(int)*static_cast<size_t>(count));
+        fPendingJobs.store(count, std::memory_order_relaxed);
+
+        // generation << 16 | job count << 8 | next job
+        const uint32_t generation(((fJobState.load(std::memory_order_relaxed) >> 16) + 1) & 0xffff);
+        fJobState.store((generation << 16) | (static_cast<uint32_t>(count) << 8), std::memory_order_release);
+
+        for (int i=0, wake=std::min(count-1, static_cast<int>(fWorkers.count())); i < wake; ++i)
+            carla_sem_post(fSem);
+
+        // takes every part that no worker started yet, so late workers never delay us
+        work();
+
+        // the remaining parts are being rendered right now, spin for a short while as parts are short.
+        // if a worker got preempted, sleep until it is done instead of burning the CPU.
+        for (int i=0; i < kMaxSpins && fPendingJobs.load(std::memory_order_acquire) != 0; ++i) {}
+
+        if (fPendingJobs.load(std::memory_order_acquire) != 0)
+        {
+            fAudioWaiting.store(true);
+
+            for (; fPendingJobs.load() != 0;)
+                carla_sem_timedwait_ms(fDoneSem, 1);
+
+            fAudioWaiting.store(false);
+        }
+
+        master->memory->setConcurrent(false);
+    }
+
+private:
+    static const int kMaxWorkers = 3;
+    static const int kMaxSpins   = 20000;
+
+    class Worker : public CarlaThread
+    {
+    public:
+        Worker(ZynAddSubFxPartRenderer* const renderer)
+            : CarlaThread("ZynAddSubFxPartRenderer"),
+              kRenderer(renderer) {}
+
+    protected:
+        void run() noexcept override
+        {
+            for (; ! shouldThreadExit();)
+            {
+                if (! carla_sem_timedwait(kRenderer->fSem, 1))
+                    continue;
+
+                if (shouldThreadExit())
+                    break;
+
+                kRenderer->work();
+            }
+        }
+
+    private:
+        ZynAddSubFxPartRenderer* const kRenderer;
+    };
+
+    LinkedList<Worker*> fWorkers;
+    carla_sem_t fSem;
+    carla_sem_t fDoneSem;
+    bool fSemValid;
+
+    std::atomic<int> fWorkersPriority; // -1 if not running
+    std::atomic<int> fAudioPriority;   // -1 if unknown
+
+    Master* fMaster;
+    int fParts[NUM_MIDI_PARTS];
+    std::atomic<uint32_t> fJobState;
+    std::atomic<int> fPendingJobs;
+    std::atomic<bool> fAudioWaiting;
+
+    void work() noexcept
+    {
+        uint32_t state(fJobState.load(std::memory_order_acquire));
+
+        for (;;)
+        {
+            const uint32_t next((state >> 0) & 0xff);
+            const uint32_t count((state >> 8) & 0xff);
+
+            if (next >= count)
+                break;
+
+            // a successful exchange means this job belongs to the current render call
+            if (! fJobState.compare_exchange_weak(state, state + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+                continue;
+
+            try {
+                fMaster->renderPart(fParts[next]);
+            } CARLA_SAFE_EXCEPTION("ZynAddSubFX renderPart");
+
+            // wake up the audio thread if it went to sleep waiting for this last part
+            if (fPendingJobs.fetch_sub(1) == 1 && fAudioWaiting.exchange(false))
+                carla_sem_post(fDoneSem);
+
+            state = fJobState.load(std::memory_order_acquire);
+        }
+    }
+
+    CARLA_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ZynAddSubFxPartRenderer)
+};
+
 // -----------------------------------------------------------------------
 
 class ZynAddSubFxPlugin : public NativePluginAndUiClass,
@@ -202,6 +450,7 @@ public:
         kParamModAmp,        // FM Gain
         kParamResCenter,     // Resonance center frequency
         kParamResBandwidth,  // Resonance bandwidth
+        kParamParallelParts, // Render parts in parallel
         kParamCount
     };
 
@@ -212,7 +461,9 @@ public:
           fMaster(nullptr),
           fSynth(),
           fIsActive(false),
-          fMutex()
+          fMutex(),
+          fPartRenderer(),
+          fPartRendererPriority(0)
     {
         sPrograms.initIfNeeded();
         fConfig.init();
@@ -235,6 +486,7 @@ public:
         fParameters[kParamModAmp]       = 127.0f;
         fParameters[kParamResCenter]    = 64.0f;
         fParameters[kParamResBandwidth] = 64.0f;
+        fParameters[kParamParallelParts] = 0.0f;
 
         fSynth.buffersize = static_cast<int>(getBufferSize());
         fSynth.samplerate = static_cast<uint>(getSampleRate());
@@ -408,6 +660,16 @@ protected:
                 break;
             }
         }
+        else if (index == kParamParallelParts)
+        {
+            // not automable, toggling starts and stops threads
+            hints &= ~NATIVE_PARAMETER_IS_AUTOMABLE;
+            hints |= NATIVE_PARAMETER_IS_BOOLEAN;
+            param.name = "Multi-core Parts";
+            param.ranges.def = 0.0f;
+            param.ranges.min = 0.0f;
+            param.ranges.max = 1.0f;
+        }
 
         param.hints = static_cast<NativeParameterHints>(hints);
 
@@ -493,6 +755,24 @@ protected:
                     fMaster->part[npart]->SetController(zynControl, static_cast<int>(value));
             }
         }
+        else if (index == kParamParallelParts)
+        {
+            const bool parallel(value >= 0.5f);
+
+            fParameters[index] = parallel ? 1.0f : 0.0f;
+
+            if (parallel == fPartRenderer.isRunning())
+                return;
+
+            const CarlaMutexLocker cml(fMutex);
+
+            if (parallel)
+                fPartRenderer.start(fPartRendererPriority);
+            else
+                fPartRenderer.stop();
+
+            _setPartRenderCallback();
+        }
     }
 
     void setMidiProgram(const uint8_t channel, const uint32_t bank, const uint32_t program) override
@@ -740,6 +1020,9 @@ private:
 
     CarlaMutex fMutex;
 
+    ZynAddSubFxPartRenderer fPartRenderer;
+    int fPartRendererPriority; // last known audio thread priority, given to new workers
+
     static MidiControllers getZynControlFromIndex(const uint index)
     {
         switch (index)
@@ -784,12 +1067,28 @@ private:
 
     void run() noexcept override
     {
+        int rtPriority;
+
         for (; ! shouldThreadExit();)
         {
             try {
                 fMiddleWare->tick();
             } CARLA_SAFE_EXCEPTION("ZynAddSubFX MiddleWare tick");
 
+            // restart part workers with the audio thread priority, the audio thread skips one block meanwhile
+            if (fPartRenderer.needsRestart(rtPriority))
+            {
+                const CarlaMutexLocker cml(fMutex);
+
+                if (fPartRenderer.needsRestart(rtPriority))
+                {
+                    fPartRendererPriority = rtPriority;
+                    fPartRenderer.stop();
+                    fPartRenderer.start(rtPriority);
+                    _setPartRenderCallback();
+                }
+            }
+
             carla_msleep(1);
         }
     }
@@ -855,6 +1154,20 @@ private:
     {
         fMaster = m;
         fMaster->setMasterChangedCallback(__masterChangedCallback, this);
+        _setPartRenderCallback();
+    }
+
+    void _setPartRenderCallback()
+    {
+        if (fPartRenderer.isRunning())
+            fMaster->setPartRenderCallback(__partRenderCallback, this);
+        else
+            fMaster->setPartRenderCallback(nullptr, nullptr);
+    }
+
+    static void __partRenderCallback(void* ptr, Master* m, const int* parts, int count)
+    {
+        ((ZynAddSubFxPlugin*)ptr)->fPartRenderer.render(m, parts, count);
     }
 
     static void __masterChangedCallback(void* ptr, Master* m)
@@ -3,6 +3,7 @@
 #include <cassert>
 #include <utility>
 #include <cstdio>
+#include <atomic>
 #include "tlsf/tlsf.h"
 #include "Allocator.h"
 
@@ -31,6 +32,27 @@ struct AllocatorImpl
     //nice values
     next_t *pools = 0;
     unsigned long long totalAlloced = 0;
+
+    //parts may be rendered in parallel, and notes get freed while rendering
+    //the lock is only taken while that happens, see Allocator::setConcurrent()
+    std::atomic<bool> concurrent{false};
+    std::atomic_flag lock = ATOMIC_FLAG_INIT;
+};
+
+struct AllocatorLocker
+{
+    AllocatorLocker(AllocatorImpl *impl_)
+        : impl(impl_->concurrent.load(std::memory_order_relaxed) ? impl_ : nullptr)
+    {
+        if(impl)
+            while(impl->lock.test_and_set(std::memory_order_acquire)) {}
+    }
+    ~AllocatorLocker()
+    {
+        if(impl)
+            impl->lock.clear(std::memory_order_release);
+    }
+    AllocatorImpl *impl;
 };
 
 Allocator::Allocator(void)
@@ -57,8 +79,14 @@ Allocator::~Allocator(void)
     delete impl;
 }
 
+void Allocator::setConcurrent(bool concurrent)
+{
+    impl->concurrent.store(concurrent, std::memory_order_relaxed);
+}
+
 void *AllocatorClass::alloc_mem(size_t mem_size)
 {
+    AllocatorLocker locker(impl);
     impl->totalAlloced += mem_size;
     void *mem = tlsf_malloc(impl->tlsf, mem_size);
     //printf("Allocator.malloc(%p, %d) = %p\n", impl, mem_size, mem);
@@ -69,6 +97,7 @@ void *AllocatorClass::alloc_mem(size_t mem_size)
 void AllocatorClass::dealloc_mem(void *memory)
 {
     //printf("dealloc_mem(%d)\n", tlsf_block_size(memory));
+    AllocatorLocker locker(impl);
     tlsf_free(impl->tlsf, memory);
     //free(memory);
 }
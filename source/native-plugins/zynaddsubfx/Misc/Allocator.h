@@ -80,6 +80,11 @@ class Allocator
 
     unsigned long long totalAlloced() const;
 
+    //Set while other threads may (de)allocate at the same time as the
+    //caller, the pool is only locked while this is enabled.
+    //Must be changed before the other threads start and after they stop.
+    void setConcurrent(bool concurrent);
+
     struct AllocatorImpl *impl;
 };
 
@@ -314,9 +314,11 @@ Master::Master(const SYNTH_T &synth_, Config* config)
         fakepeakpart[npart]  = 0;
     }
 
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart) {
         part[npart] = new Part(*memory, synth, config->cfg.GzipCompression,
                                config->cfg.Interpolation, &microtonal, fft);
+        partprng[npart] = prng_state + npart;
+    }
 
     //Insertion Effects init
     for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
@@ -349,6 +351,8 @@ Master::Master(const SYNTH_T &synth_, Config* config)
 
     mastercb = 0;
     mastercb_ptr = 0;
+    partrendercb = 0;
+    partrendercb_ptr = 0;
 }
 
 void Master::applyOscEvent(const char *msg)
@@ -558,6 +562,30 @@ void Master::setMasterChangedCallback(void(*cb)(void*,Master*), void *ptr)
     mastercb_ptr = ptr;
 }
 
+void Master::setPartRenderCallback(void(*cb)(void*,Master*,const int*,int), void *ptr)
+{
+    partrendercb     = cb;
+    partrendercb_ptr = ptr;
+}
+
+void Master::renderPart(int npart)
+{
+    //Each part has its own random state, so the output does not depend on
+    //which thread renders it
+    prng_t *oldprng = prng_current;
+    prng_current    = &partprng[npart];
+
+    part[npart]->ComputePartSmps();
+
+    //Insertion effects of this part
+    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
+        if(Pinsparts[nefx] == npart)
+            insefx[nefx]->out(part[npart]->partoutl,
+                              part[npart]->partoutr);
+
+    prng_current = oldprng;
+}
+
 #if 0
 template <class T>
 struct def_skip
@@ -684,18 +712,21 @@ void Master::AudioOut(float *outl, float *outr)
     memset(outr, 0, synth.bufferbytes);
 
     //Compute part samples and store them part[npart]->partoutl,partoutr
-    for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
-        if(part[npart]->Penabled)
-            part[npart]->ComputePartSmps();
-
-    //Insertion effects
-    for(int nefx = 0; nefx < NUM_INS_EFX; ++nefx)
-        if(Pinsparts[nefx] >= 0) {
-            int efxpart = Pinsparts[nefx];
-            if(part[efxpart]->Penabled)
-                insefx[nefx]->out(part[efxpart]->partoutl,
-                                  part[efxpart]->partoutr);
-        }
+    //Insertion effects are applied per part, in the same order as before
+    if(partrendercb) {
+        int enabledparts[NUM_MIDI_PARTS];
+        int count = 0;
+        for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+            if(part[npart]->Penabled)
+                enabledparts[count++] = npart;
+        if(count > 0)
+            partrendercb(partrendercb_ptr, this, enabledparts, count);
+    }
+    else {
+        for(int npart = 0; npart < NUM_MIDI_PARTS; ++npart)
+            if(part[npart]->Penabled)
+                renderPart(npart);
+    }
 
 
     //Apply the part volumes and pannings (after insertion effects)
@@ -111,6 +111,13 @@ class Master
         //Set callback to run when master changes
         void setMasterChangedCallback(void(*cb)(void*,Master*),void *ptr);
 
+        //Set callback to render the enabled parts, possibly in parallel
+        //It must call renderPart() exactly once for each of the given parts
+        void setPartRenderCallback(void(*cb)(void*,Master*,const int*,int),void *ptr);
+
+        //Compute one part and apply its insertion effects (thread safe between parts)
+        void renderPart(int npart) REALTIME;
+
         /**parts \todo see if this can be made to be dynamic*/
         class Part * part[NUM_MIDI_PARTS];
 
@@ -186,6 +193,13 @@ class Master
         //Callback When Master changes
         void(*mastercb)(void*,Master*);
         void* mastercb_ptr;
+
+        //Callback to render parts
+        void(*partrendercb)(void*,Master*,const int*,int);
+        void* partrendercb_ptr;
+
+        //Random state of each part, used while it renders
+        uint32_t partprng[NUM_MIDI_PARTS];
 };
 
 #endif
@@ -45,6 +45,7 @@
 #include <rtosc/rtosc.h>
 
 prng_t prng_state = 0x1234;
+thread_local prng_t *prng_current = &prng_state;
 
 /*
  * Transform the velocity according the scaling parameter (velocity sensing)
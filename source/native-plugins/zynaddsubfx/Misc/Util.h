@@ -112,6 +112,10 @@ T array_max(const T *data, size_t len)
 typedef uint32_t prng_t;
 extern prng_t prng_state;
 
+//State used by prng() in the current thread, parts point it to their own
+//state while rendering so that they can be rendered in parallel
+extern thread_local prng_t *prng_current;
+
 // Portable Pseudo-Random Number Generator
 inline prng_t prng_r(prng_t &p)
 {
@@ -120,7 +124,7 @@ inline prng_t prng_r(prng_t &p)
 
 inline prng_t prng(void)
 {
-    return prng_r(prng_state) & 0x7fffffff;
+    return prng_r(*prng_current) & 0x7fffffff;
 }
 
 inline void sprng(prng_t p)
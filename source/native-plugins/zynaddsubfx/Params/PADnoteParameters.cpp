@@ -27,7 +27,20 @@
 #include "../Synth/Resonance.h"
 #include "../Synth/OscilGen.h"
 #include "../Misc/WavFile.h"
+#include "../Misc/XMLwrapper.h"
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <dirent.h>
+#include <utime.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif
 
 #include <rtosc/ports.h>
 #include <rtosc/port-sugar.h>
@@ -586,19 +599,12 @@ static float Pbwscale_translate(char Pbwscale)
 void PADnoteParameters::generatespectrum_bandwidthMode(float *spectrum,
                                                        int size,
                                                        float basefreq,
-                                                       float *profile,
+                                                       const float *harmonics,
+                                                       const float *profile,
                                                        int profilesize,
                                                        float bwadjust)
 {
-    float harmonics[synth.oscilsize];
     memset(spectrum, 0, sizeof(float) * size);
-    memset(harmonics, 0, sizeof(float) * synth.oscilsize);
-
-    //get the harmonic structure from the oscillator (I am using the frequency amplitudes, only)
-    oscilgen->get(harmonics, basefreq, false);
-
-    //normalize
-    normalize_max(harmonics, synth.oscilsize / 2);
 
     //Constants across harmonics
     const float power = Pbwscale_translate(Pbwscale);
@@ -662,17 +668,10 @@ void PADnoteParameters::generatespectrum_bandwidthMode(float *spectrum,
  */
 void PADnoteParameters::generatespectrum_otherModes(float *spectrum,
                                                     int size,
-                                                    float basefreq)
+                                                    float basefreq,
+                                                    const float *harmonics)
 {
-    float harmonics[synth.oscilsize];
     memset(spectrum,  0, sizeof(float) * size);
-    memset(harmonics, 0, sizeof(float) * synth.oscilsize);
-
-    //get the harmonic structure from the oscillator (I am using the frequency amplitudes, only)
-    oscilgen->get(harmonics, basefreq, false);
-
-    //normalize
-    normalize_max(harmonics, synth.oscilsize / 2);
 
     for(int nh = 1; nh < synth.oscilsize / 2; ++nh) { //for each harmonic
         const float realfreq = getNhr(nh) * basefreq;
@@ -737,6 +736,233 @@ void PADnoteParameters::applyparameters(std::function<bool()> do_abort)
         deletesample(i);
 }
 
+/*
+ * On disk cache of the generated samples
+ *
+ * Generating the samples is expensive, so the result is kept in
+ * $XDG_CACHE_HOME/zynaddsubfx/padsynth (or ~/.cache/zynaddsubfx/padsynth),
+ * keyed by a hash of the parameters which affect them.
+ * Loading an entry updates its modification time, and the least recently
+ * used entries are removed when the cache grows over PAD_CACHE_MAXTOTAL.
+ */
+#define PAD_CACHE_MAGIC    "ZYNPAD01"
+#define PAD_CACHE_MAXSIZE  (128 * 1024 * 1024)
+#define PAD_CACHE_MAXTOTAL (512 * 1024 * 1024)
+
+static std::string padCacheDir(bool create)
+{
+    std::string dir;
+    const char *env = getenv("XDG_CACHE_HOME");
+    if(env && *env)
+        dir = env;
+    else {
+#ifdef _WIN32
+        env = getenv("LOCALAPPDATA");
+        if(!env || !*env)
+            return "";
+        dir = env;
+#else
+        env = getenv("HOME");
+        if(!env || !*env)
+            return "";
+        dir = std::string(env) + "/.cache";
+#endif
+    }
+
+    const char *subdirs[] = {"", "/zynaddsubfx", "/zynaddsubfx/padsynth"};
+    std::string path;
+    for(int i = 0; i < 3; ++i) {
+        path = dir + subdirs[i];
+        if(!create)
+            continue;
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), S_IRWXU | S_IRWXG | S_IROTH | S_IXOTH);
+#endif
+    }
+    return path;
+}
+
+static std::string padCacheFile(uint64_t key, bool create)
+{
+    const std::string dir = padCacheDir(create);
+    if(dir.empty())
+        return "";
+    char name[32];
+    snprintf(name, sizeof(name), "/%016llx.pad", (unsigned long long)key);
+    return dir + name;
+}
+
+static bool padCacheLoad(uint64_t key, int samplemax, int samplesize,
+        PADnoteParameters::callback cb)
+{
+    const std::string filename = padCacheFile(key, false);
+    if(filename.empty())
+        return false;
+    FILE *file = fopen(filename.c_str(), "rb");
+    if(!file)
+        return false;
+
+    char     magic[8];
+    uint64_t fkey = 0;
+    int32_t  fsamplemax = 0, fsamplesize = 0;
+    bool     ok = fread(magic, sizeof(magic), 1, file) == 1
+                  && fread(&fkey, sizeof(fkey), 1, file) == 1
+                  && fread(&fsamplemax, sizeof(fsamplemax), 1, file) == 1
+                  && fread(&fsamplesize, sizeof(fsamplesize), 1, file) == 1
+                  && !memcmp(magic, PAD_CACHE_MAGIC, sizeof(magic))
+                  && fkey == key && fsamplemax == samplemax
+                  && fsamplesize == samplesize;
+
+    //read everything first, so a truncated file does not yield partial data
+    const int extra_samples = 5;
+    PADnoteParameters::Sample *smps =
+        ok ? new PADnoteParameters::Sample[samplemax] : NULL;
+    int loaded = 0;
+    for(; ok && loaded < samplemax; ++loaded) {
+        PADnoteParameters::Sample &smp = smps[loaded];
+        smp.size = samplesize;
+        smp.smp  = new float[samplesize + extra_samples];
+        ok = fread(&smp.basefreq, sizeof(float), 1, file) == 1
+             && fread(smp.smp, sizeof(float), samplesize, file)
+                == (size_t)samplesize;
+        if(!ok) {
+            delete[] smp.smp;
+            break;
+        }
+        for(int i = 0; i < extra_samples; ++i)
+            smp.smp[i + samplesize] = smp.smp[i];
+    }
+    fclose(file);
+
+    if(!ok) {
+        for(int i = 0; i < loaded; ++i)
+            delete[] smps[i].smp;
+        delete[] smps;
+        return false;
+    }
+
+    //mark as recently used
+    utime(filename.c_str(), NULL);
+
+    for(int nsample = 0; nsample < samplemax; ++nsample)
+        cb(nsample, smps[nsample]);
+    delete[] smps;
+    return true;
+}
+
+//Removes the least recently used entries until the cache fits in
+//PAD_CACHE_MAXTOTAL, keeping the one which was just written
+static void padCacheTrim(const std::string &keep)
+{
+    const std::string dirname = padCacheDir(false);
+    if(dirname.empty())
+        return;
+    DIR *dir = opendir(dirname.c_str());
+    if(!dir)
+        return;
+
+    struct entry {
+        time_t      mtime;
+        off_t       size;
+        std::string filename;
+    };
+    std::vector<entry> entries;
+    uint64_t total = 0;
+
+    struct dirent *fn;
+    while((fn = readdir(dir))) {
+        const std::string name = fn->d_name;
+        if(name.size() < 4 || name.compare(name.size() - 4, 4, ".pad"))
+            continue;
+        const std::string filename = dirname + "/" + name;
+        struct stat st;
+        if(stat(filename.c_str(), &st) != 0)
+            continue;
+        total += st.st_size;
+        if(filename != keep)
+            entries.push_back({st.st_mtime, st.st_size, filename});
+    }
+    closedir(dir);
+
+    if(total <= PAD_CACHE_MAXTOTAL)
+        return;
+
+    std::sort(entries.begin(), entries.end(),
+              [](const entry &a, const entry &b) {return a.mtime < b.mtime;});
+    for(const entry &e:entries) {
+        if(total <= PAD_CACHE_MAXTOTAL)
+            break;
+        if(remove(e.filename.c_str()) == 0)
+            total -= e.size;
+    }
+}
+
+static void padCacheSave(uint64_t key, int samplemax, int samplesize,
+        const PADnoteParameters::Sample *smps)
+{
+    if((size_t)samplemax * samplesize * sizeof(float) > PAD_CACHE_MAXSIZE)
+        return;
+    const std::string filename = padCacheFile(key, true);
+    if(filename.empty())
+        return;
+
+    //write to a temporary file first, so readers never see partial data
+    const std::string tmpname = filename + ".tmp";
+    FILE *file = fopen(tmpname.c_str(), "wb");
+    if(!file)
+        return;
+
+    const int32_t fsamplemax = samplemax, fsamplesize = samplesize;
+    bool ok = fwrite(PAD_CACHE_MAGIC, 8, 1, file) == 1
+              && fwrite(&key, sizeof(key), 1, file) == 1
+              && fwrite(&fsamplemax, sizeof(fsamplemax), 1, file) == 1
+              && fwrite(&fsamplesize, sizeof(fsamplesize), 1, file) == 1;
+    for(int nsample = 0; ok && nsample < samplemax; ++nsample)
+        ok = fwrite(&smps[nsample].basefreq, sizeof(float), 1, file) == 1
+             && fwrite(smps[nsample].smp, sizeof(float), samplesize, file)
+                == (size_t)samplesize;
+    ok = (fclose(file) == 0) && ok;
+
+#ifdef _WIN32
+    remove(filename.c_str());
+#endif
+    if(!ok || rename(tmpname.c_str(), filename.c_str()) != 0) {
+        remove(tmpname.c_str());
+        return;
+    }
+
+    padCacheTrim(filename);
+}
+
+uint64_t PADnoteParameters::sampleHash()
+{
+    XMLwrapper xml;
+    xml.beginbranch("PADSYNTH_SAMPLES");
+    add2XMLsamples(&xml);
+    xml.endbranch();
+
+    //64 bit FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    auto feed = [&hash](const void *data, size_t size) {
+        const unsigned char *bytes = (const unsigned char *)data;
+        for(size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+
+    char *data = xml.getXMLdata();
+    if(data) {
+        feed(data, strlen(data));
+        free(data);
+    }
+    feed(&synth.samplerate, sizeof(synth.samplerate));
+    feed(&synth.oscilsize, sizeof(synth.oscilsize));
+    return hash;
+}
+
 //Requires
 // - Pquality.samplesize
 // - Pquality.basenote
@@ -748,7 +974,6 @@ void PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
 {
     const int samplesize   = (((int) 1) << (Pquality.samplesize + 14));
     const int spectrumsize = samplesize / 2;
-    float    *spectrum     = new float[spectrumsize];
     const int profilesize = 512;
     float     profile[profilesize];
 
@@ -771,71 +996,135 @@ void PADnoteParameters::sampleGenerator(PADnoteParameters::callback cb,
     if(samplemax == 0)
         samplemax = 1;
 
-    //prepare a BIG FFT
-    FFTwrapper *fft      = new FFTwrapper(samplesize);
-    fft_t      *fftfreqs = new fft_t[samplesize / 2];
+    //reuse the samples of an identical earlier run
+    const uint64_t key = sampleHash();
+    if(padCacheLoad(key, samplemax, samplesize, cb))
+        return;
 
     //this is used to compute frequency relation to the base frequency
     float adj[samplemax];
     for(int nsample = 0; nsample < samplemax; ++nsample)
         adj[nsample] = (Pquality.oct + 1.0f) * (float)nsample / samplemax;
+
+    //The oscillator is not thread safe, so get the harmonic structure (I am
+    //using the frequency amplitudes, only) and the seeds of the random
+    //phases here, before the samples are computed in parallel
+    const int oscilsize  = synth.oscilsize;
+    float    *harmonics  = new float[samplemax * oscilsize];
+    std::vector<float>  basefreqs(samplemax);
+    std::vector<prng_t> seeds(samplemax);
     for(int nsample = 0; nsample < samplemax; ++nsample) {
-        if(do_abort())
-            goto exit;
-        const float basefreqadjust =
-            powf(2.0f, adj[nsample] - adj[samplemax - 1] * 0.5f);
-
-        if(Pmode == 0)
-            generatespectrum_bandwidthMode(spectrum,
-                                           spectrumsize,
-                                           basefreq * basefreqadjust,
-                                           profile,
-                                           profilesize,
-                                           bwadjust);
-        else
-            generatespectrum_otherModes(spectrum, spectrumsize,
-                                        basefreq * basefreqadjust);
-
-        //the last samples contains the first samples
-        //(used for linear/cubic interpolation)
-        const int extra_samples = 5;
-        PADnoteParameters::Sample newsample;
-        newsample.smp = new float[samplesize + extra_samples];
-
-        newsample.smp[0] = 0.0f;
-        for(int i = 1; i < spectrumsize; ++i) //randomize the phases
-            fftfreqs[i] = FFTpolar(spectrum[i], (float)RND * 2 * PI);
-        //that's all; here is the only ifft for the whole sample;
-        //no windows are used ;-)
-        fft->freqs2smps(fftfreqs, newsample.smp);
-
-
-        //normalize(rms)
-        float rms = 0.0f;
-        for(int i = 0; i < samplesize; ++i)
-            rms += newsample.smp[i] * newsample.smp[i];
-        rms = sqrt(rms);
-        if(rms < 0.000001f)
-            rms = 1.0f;
-        rms *= sqrt(262144.0f / samplesize);//262144=2^18
-        for(int i = 0; i < samplesize; ++i)
-            newsample.smp[i] *= 1.0f / rms * 50.0f;
-
-        //prepare extra samples used by the linear or cubic interpolation
-        for(int i = 0; i < extra_samples; ++i)
-            newsample.smp[i + samplesize] = newsample.smp[i];
+        float *h = harmonics + nsample * oscilsize;
+        basefreqs[nsample] = basefreq
+                             * powf(2.0f, adj[nsample] - adj[samplemax - 1] * 0.5f);
+        memset(h, 0, sizeof(float) * oscilsize);
+        oscilgen->get(h, basefreqs[nsample], false);
+        normalize_max(h, oscilsize / 2);
+        seeds[nsample] = prng();
+    }
 
-        //yield new sample
-        newsample.size     = samplesize;
-        newsample.basefreq = basefreq * basefreqadjust;
-        cb(nsample, newsample);
+    //each thread needs its own BIG FFT and spectrum
+    int nthreads = std::thread::hardware_concurrency();
+    nthreads = limit(nthreads, 1, 4);
+    nthreads = limit(nthreads, 1, samplemax);
+    std::vector<FFTwrapper *> fft(nthreads);
+    std::vector<fft_t *>      fftfreqs(nthreads);
+    std::vector<float *>      spectrum(nthreads);
+    for(int t = 0; t < nthreads; ++t) {
+        fft[t]      = new FFTwrapper(samplesize);
+        fftfreqs[t] = new fft_t[spectrumsize];
+        spectrum[t] = new float[spectrumsize];
     }
-exit:
+
+    PADnoteParameters::Sample *smps = new PADnoteParameters::Sample[samplemax];
+    for(int nsample = 0; nsample < samplemax; ++nsample)
+        smps[nsample].smp = NULL;
+
+    std::atomic<int>  next(0);
+    std::atomic<bool> aborted(false);
+    auto work = [&](int t) {
+        for(int nsample; !aborted && (nsample = next++) < samplemax;) {
+            //only the calling thread may check for an abort
+            if(t == 0 && do_abort()) {
+                aborted = true;
+                break;
+            }
+            const float *h = harmonics + nsample * oscilsize;
+            if(Pmode == 0)
+                generatespectrum_bandwidthMode(spectrum[t],
+                                               spectrumsize,
+                                               basefreqs[nsample],
+                                               h,
+                                               profile,
+                                               profilesize,
+                                               bwadjust);
+            else
+                generatespectrum_otherModes(spectrum[t], spectrumsize,
+                                            basefreqs[nsample], h);
+
+            //the last samples contains the first samples
+            //(used for linear/cubic interpolation)
+            const int extra_samples = 5;
+            PADnoteParameters::Sample newsample;
+            newsample.smp = new float[samplesize + extra_samples];
+
+            prng_t seed = seeds[nsample];
+            newsample.smp[0] = 0.0f;
+            for(int i = 1; i < spectrumsize; ++i) //randomize the phases
+                fftfreqs[t][i] = FFTpolar(spectrum[t][i],
+                        (prng_r(seed) & 0x7fffffff) / (INT32_MAX * 1.0f)
+                        * 2 * PI);
+            //that's all; here is the only ifft for the whole sample;
+            //no windows are used ;-)
+            fft[t]->freqs2smps(fftfreqs[t], newsample.smp);
+
+
+            //normalize(rms)
+            float rms = 0.0f;
+            for(int i = 0; i < samplesize; ++i)
+                rms += newsample.smp[i] * newsample.smp[i];
+            rms = sqrt(rms);
+            if(rms < 0.000001f)
+                rms = 1.0f;
+            rms *= sqrt(262144.0f / samplesize);//262144=2^18
+            for(int i = 0; i < samplesize; ++i)
+                newsample.smp[i] *= 1.0f / rms * 50.0f;
+
+            //prepare extra samples used by the linear or cubic interpolation
+            for(int i = 0; i < extra_samples; ++i)
+                newsample.smp[i + samplesize] = newsample.smp[i];
+
+            newsample.size     = samplesize;
+            newsample.basefreq = basefreqs[nsample];
+            smps[nsample]      = newsample;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for(int t = 1; t < nthreads; ++t)
+        threads.push_back(std::thread(work, t));
+    work(0);
+    for(auto &thread:threads)
+        thread.join();
+
+    if(!aborted)
+        padCacheSave(key, samplemax, samplesize, smps);
+
+    //yield the new samples in order, up to the first one which was aborted
+    int nsample = 0;
+    for(; nsample < samplemax && smps[nsample].smp; ++nsample)
+        cb(nsample, smps[nsample]);
+    for(; nsample < samplemax; ++nsample)
+        delete[] smps[nsample].smp;
 
     //Cleanup
-    delete (fft);
-    delete[] fftfreqs;
-    delete[] spectrum;
+    delete[] smps;
+    delete[] harmonics;
+    for(int t = 0; t < nthreads; ++t) {
+        delete fft[t];
+        delete[] fftfreqs[t];
+        delete[] spectrum[t];
+    }
 }
 
 void PADnoteParameters::export2wav(std::string basefilename)
@@ -859,10 +1148,8 @@ void PADnoteParameters::export2wav(std::string basefilename)
     }
 }
 
-void PADnoteParameters::add2XML(XMLwrapper *xml)
+void PADnoteParameters::add2XMLsamples(XMLwrapper *xml)
 {
-    xml->setPadSynth(true);
-
     xml->addparbool("stereo", PStereo);
     xml->addpar("mode", Pmode);
     xml->addpar("bandwidth", Pbandwidth);
@@ -904,6 +1191,12 @@ void PADnoteParameters::add2XML(XMLwrapper *xml)
     xml->addpar("octaves", Pquality.oct);
     xml->addpar("samples_per_octave", Pquality.smpoct);
     xml->endbranch();
+}
+
+void PADnoteParameters::add2XML(XMLwrapper *xml)
+{
+    xml->setPadSynth(true);
+    add2XMLsamples(xml);
 
     xml->beginbranch("AMPLITUDE_PARAMETERS");
     xml->addpar("volume", PVolume);
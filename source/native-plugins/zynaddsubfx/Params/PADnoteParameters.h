@@ -28,6 +28,7 @@
 #include "Presets.h"
 #include <string>
 #include <functional>
+#include <stdint.h>
 
 /**
  * Parameters for PAD synthesis
@@ -171,12 +172,19 @@ class PADnoteParameters:public Presets
         void generatespectrum_bandwidthMode(float *spectrum,
                                             int size,
                                             float basefreq,
-                                            float *profile,
+                                            const float *harmonics,
+                                            const float *profile,
                                             int profilesize,
                                             float bwadjust);
         void generatespectrum_otherModes(float *spectrum,
                                          int size,
-                                         float basefreq);
+                                         float basefreq,
+                                         const float *harmonics);
+        //Parameters which affect the generated samples (without the
+        //amplitude/frequency/filter sections)
+        void add2XMLsamples(XMLwrapper *xml);
+        //Key of the sample cache, derived from add2XMLsamples()
+        uint64_t sampleHash();
         void deletesamples();
         void deletesample(int n);
 
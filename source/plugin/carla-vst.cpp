@@ -520,6 +520,19 @@ protected:
         case NATIVE_HOST_OPCODE_HOST_IDLE:
             hostCallback(audioMasterIdle);
             break;
+
+        case NATIVE_HOST_OPCODE_LATENCY_CHANGED:
+            CARLA_SAFE_ASSERT_BREAK(value >= 0);
+#ifdef VESTIGE_HEADER
+            {
+                int32_t* const initialDelay = (int32_t*)&fEffect->empty3[0];
+                *initialDelay = static_cast<int32_t>(value);
+            }
+#else
+            fEffect->initialDelay = static_cast<int32_t>(value);
+#endif
+            hostCallback(audioMasterIOChanged);
+            break;
         }
 
         // unused for now
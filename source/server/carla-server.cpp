@@ -0,0 +1,2026 @@
+/*
+ * Carla Server
+ * Copyright (C) 2011-2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#include "CarlaHost.h"
+#include "CarlaMIDI.h"
+
+#include "CarlaMutex.hpp"
+#include "CarlaServerUtils.hpp"
+#include "CarlaString.hpp"
+
+#include <cerrno>
+#include <ctime>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#ifndef MSG_NOSIGNAL
+# define MSG_NOSIGNAL 0
+#endif
+
+CARLA_BACKEND_USE_NAMESPACE
+
+// -------------------------------------------------------------------------
+
+static const uint32_t    kServerEngineIdleInterval  = 30;               // ms
+static const uint32_t    kServerDefaultInterval     = 50;               // ms
+static const uint32_t    kServerMinimumInterval     = 5;                // ms
+static const uint32_t    kServerMaxParameterChanges = 4096;
+static const uint32_t    kServerMaxRequestsPerCycle = 256;
+static const uint        kServerMaxClients          = 64;
+static const std::size_t kServerMaxReadPerCycle     = 1024*1024;
+static const std::size_t kServerMaxClientOutput     = 64*1024*1024;
+
+static volatile bool gCloseNow = false;
+static volatile bool gSaveNow  = false;
+
+static void closeSignalHandler(int) noexcept
+{
+    gCloseNow = true;
+}
+
+static void saveSignalHandler(int) noexcept
+{
+    gSaveNow = true;
+}
+
+static void initSignalHandler()
+{
+    struct sigaction sint;
+    struct sigaction sterm;
+    struct sigaction susr1;
+
+    carla_zeroStruct(sint);
+    sint.sa_handler = closeSignalHandler;
+    sint.sa_flags   = SA_RESTART;
+    sigemptyset(&sint.sa_mask);
+    sigaction(SIGINT, &sint, nullptr);
+
+    carla_zeroStruct(sterm);
+    sterm.sa_handler = closeSignalHandler;
+    sterm.sa_flags   = SA_RESTART;
+    sigemptyset(&sterm.sa_mask);
+    sigaction(SIGTERM, &sterm, nullptr);
+
+    carla_zeroStruct(susr1);
+    susr1.sa_handler = saveSignalHandler;
+    susr1.sa_flags   = SA_RESTART;
+    sigemptyset(&susr1.sa_mask);
+    sigaction(SIGUSR1, &susr1, nullptr);
+
+    // clients going away must not kill the server
+    signal(SIGPIPE, SIG_IGN);
+}
+
+// -------------------------------------------------------------------------
+
+static uint32_t getTimeInMs() noexcept
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint32_t>(ts.tv_sec*1000 + ts.tv_nsec/1000000);
+}
+
+static bool isTimeReached(const uint32_t now, const uint32_t time) noexcept
+{
+    return static_cast<int32_t>(now - time) >= 0;
+}
+
+static bool setNonBlocking(const int fd) noexcept
+{
+    const int flags = fcntl(fd, F_GETFL);
+    CARLA_SAFE_ASSERT_RETURN(flags != -1, false);
+
+    return (fcntl(fd, F_SETFL, flags|O_NONBLOCK) == 0 && fcntl(fd, F_SETFD, FD_CLOEXEC) == 0);
+}
+
+// -------------------------------------------------------------------------
+// Growable byte buffer, used for socket input and output
+
+struct ServerBuffer {
+    uint8_t* data;
+    std::size_t size;
+    std::size_t capacity;
+
+    ServerBuffer() noexcept
+        : data(nullptr),
+          size(0),
+          capacity(0) {}
+
+    ~ServerBuffer() noexcept
+    {
+        if (data != nullptr)
+            std::free(data);
+    }
+
+    bool reserve(const std::size_t extra) noexcept
+    {
+        if (size + extra <= capacity)
+            return true;
+
+        std::size_t newCapacity = (capacity != 0) ? capacity : 4096;
+
+        for (; newCapacity < size + extra;)
+            newCapacity *= 2;
+
+        uint8_t* const newData = static_cast<uint8_t*>(std::realloc(data, newCapacity));
+        CARLA_SAFE_ASSERT_RETURN(newData != nullptr, false);
+
+        data     = newData;
+        capacity = newCapacity;
+        return true;
+    }
+
+    bool append(const void* const buf, const std::size_t bufSize) noexcept
+    {
+        if (! reserve(bufSize))
+            return false;
+
+        std::memcpy(data+size, buf, bufSize);
+        size += bufSize;
+        return true;
+    }
+
+    void consume(const std::size_t bytes) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(bytes <= size,);
+
+        size -= bytes;
+
+        if (size != 0)
+        {
+            std::memmove(data, data+bytes, size);
+        }
+        else if (capacity > kServerMaxReadPerCycle)
+        {
+            // give back memory from a burst of big messages
+            std::free(data);
+            data     = nullptr;
+            capacity = 0;
+        }
+    }
+
+    void swapWith(ServerBuffer& other) noexcept
+    {
+        uint8_t* const tmpData        = data;
+        const std::size_t tmpSize     = size;
+        const std::size_t tmpCapacity = capacity;
+
+        data     = other.data;
+        size     = other.size;
+        capacity = other.capacity;
+
+        other.data     = tmpData;
+        other.size     = tmpSize;
+        other.capacity = tmpCapacity;
+    }
+
+    CARLA_DECLARE_NON_COPY_STRUCT(ServerBuffer)
+};
+
+// -------------------------------------------------------------------------
+// Writes a single message into a buffer, see CarlaServerUtils.hpp for the format
+
+class ServerWriter
+{
+public:
+    ServerWriter(ServerBuffer& buffer, const uint16_t opcode, const uint32_t requestId) noexcept
+        : fBuffer(buffer),
+          fStart(buffer.size),
+          fOk(true)
+    {
+        writeUInt(0);
+        writeUShort(opcode);
+        writeUShort(0);
+        writeUInt(requestId);
+    }
+
+    void writeByte(const uint8_t value) noexcept
+    {
+        _write(&value, 1);
+    }
+
+    void writeUShort(const uint16_t value) noexcept
+    {
+        const uint8_t bytes[2] = { static_cast<uint8_t>(value), static_cast<uint8_t>(value >> 8) };
+        _write(bytes, 2);
+    }
+
+    void writeUInt(const uint32_t value) noexcept
+    {
+        const uint8_t bytes[4] = { static_cast<uint8_t>(value),       static_cast<uint8_t>(value >> 8),
+                                   static_cast<uint8_t>(value >> 16), static_cast<uint8_t>(value >> 24) };
+        _write(bytes, 4);
+    }
+
+    void writeInt(const int32_t value) noexcept
+    {
+        writeUInt(static_cast<uint32_t>(value));
+    }
+
+    void writeULong(const uint64_t value) noexcept
+    {
+        writeUInt(static_cast<uint32_t>(value));
+        writeUInt(static_cast<uint32_t>(value >> 32));
+    }
+
+    void writeLong(const int64_t value) noexcept
+    {
+        writeULong(static_cast<uint64_t>(value));
+    }
+
+    void writeFloat(const float value) noexcept
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(uint32_t));
+        writeUInt(bits);
+    }
+
+    void writeDouble(const double value) noexcept
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(uint64_t));
+        writeULong(bits);
+    }
+
+    void writeString(const char* const value) noexcept
+    {
+        const std::size_t size = (value != nullptr) ? std::strlen(value) : 0;
+
+        writeUInt(static_cast<uint32_t>(size));
+        _write(value, size);
+    }
+
+    /*
+     * Set the payload size of the message.
+     * Returns false and drops the message if writing failed or the message is too big.
+     */
+    bool finish() noexcept
+    {
+        const std::size_t payloadSize = fBuffer.size - fStart - kCarlaServerHeaderSize;
+
+        if (! fOk || payloadSize > kCarlaServerMaxPayloadSize)
+        {
+            fBuffer.size = fStart;
+            return false;
+        }
+
+        uint8_t* const header = fBuffer.data + fStart;
+        header[0] = static_cast<uint8_t>(payloadSize);
+        header[1] = static_cast<uint8_t>(payloadSize >> 8);
+        header[2] = static_cast<uint8_t>(payloadSize >> 16);
+        header[3] = static_cast<uint8_t>(payloadSize >> 24);
+        return true;
+    }
+
+private:
+    ServerBuffer& fBuffer;
+    const std::size_t fStart;
+    bool fOk;
+
+    void _write(const void* const buf, const std::size_t size) noexcept
+    {
+        if (fOk && size != 0 && ! fBuffer.append(buf, size))
+            fOk = false;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(ServerWriter)
+};
+
+// -------------------------------------------------------------------------
+// Reads values from a single message payload, see CarlaServerUtils.hpp for the format
+
+class ServerReader
+{
+public:
+    ServerReader(const uint8_t* const data, const uint32_t size) noexcept
+        : fData(data),
+          fSize(size),
+          fPos(0),
+          fOk(true) {}
+
+    bool isOk() const noexcept
+    {
+        return fOk;
+    }
+
+    bool canRead(const std::size_t size) const noexcept
+    {
+        return fOk && fSize - fPos >= size;
+    }
+
+    bool readByte(uint8_t& value) noexcept
+    {
+        return _read(&value, 1);
+    }
+
+    bool readUInt(uint32_t& value) noexcept
+    {
+        uint8_t bytes[4];
+
+        if (! _read(bytes, 4))
+            return false;
+
+        value = static_cast<uint32_t>(bytes[0])       | static_cast<uint32_t>(bytes[1]) << 8
+              | static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+        return true;
+    }
+
+    bool readInt(int32_t& value) noexcept
+    {
+        uint32_t bits;
+
+        if (! readUInt(bits))
+            return false;
+
+        value = static_cast<int32_t>(bits);
+        return true;
+    }
+
+    bool readULong(uint64_t& value) noexcept
+    {
+        uint32_t low, high;
+
+        if (! (readUInt(low) && readUInt(high)))
+            return false;
+
+        value = static_cast<uint64_t>(high) << 32 | low;
+        return true;
+    }
+
+    bool readLong(int64_t& value) noexcept
+    {
+        uint64_t bits;
+
+        if (! readULong(bits))
+            return false;
+
+        value = static_cast<int64_t>(bits);
+        return true;
+    }
+
+    bool readFloat(float& value) noexcept
+    {
+        uint32_t bits;
+
+        if (! readUInt(bits))
+            return false;
+
+        std::memcpy(&value, &bits, sizeof(float));
+        return true;
+    }
+
+    bool readString(CarlaString& value) noexcept
+    {
+        uint32_t size;
+
+        if (! readUInt(size))
+            return false;
+
+        if (! canRead(size))
+        {
+            fOk = false;
+            return false;
+        }
+
+        char* const strBuf = static_cast<char*>(std::malloc(size+1));
+        CARLA_SAFE_ASSERT_RETURN(strBuf != nullptr, false);
+
+        std::memcpy(strBuf, fData+fPos, size);
+        strBuf[size] = '\0';
+        fPos += size;
+
+        value = strBuf;
+        std::free(strBuf);
+        return true;
+    }
+
+private:
+    const uint8_t* const fData;
+    const uint32_t fSize;
+    uint32_t fPos;
+    bool fOk;
+
+    bool _read(void* const buf, const uint32_t size) noexcept
+    {
+        if (! canRead(size))
+        {
+            fOk = false;
+            return false;
+        }
+
+        std::memcpy(buf, fData+fPos, size);
+        fPos += size;
+        return true;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(ServerReader)
+};
+
+// -------------------------------------------------------------------------
+
+struct ServerClient {
+    int fd;
+    uint32_t mask;
+    uint32_t interval;
+    uint32_t nextTelemetry;
+    uint32_t helloDeadline;
+    bool isTcp;
+    bool authenticated;
+    bool closing;
+    CarlaString name;
+    ServerBuffer input;
+    ServerBuffer output;
+
+    ServerClient(const int sock, const bool tcp, const char* const clientName) noexcept
+        : fd(sock),
+          mask(0x0),
+          interval(kServerDefaultInterval),
+          nextTelemetry(0),
+          helloDeadline(getTimeInMs() + kCarlaServerHelloTimeout),
+          isTcp(tcp),
+          authenticated(! tcp),
+          closing(false),
+          name(clientName),
+          input(),
+          output() {}
+
+    CARLA_DECLARE_NON_COPY_STRUCT(ServerClient)
+};
+
+struct ServerOptions {
+    const char* driverName;
+    const char* clientName;
+    int processMode;
+    const char* unixPath;
+    const char* tcpAddress;
+    const char* tokenFile;
+    const char* projectFile;
+    const char* resourcesPath;
+
+    ServerOptions() noexcept
+        : driverName("JACK"),
+          clientName("Carla-Server"),
+          processMode(-1),
+          unixPath(nullptr),
+          tcpAddress(nullptr),
+          tokenFile(nullptr),
+          projectFile(nullptr),
+          resourcesPath(nullptr) {}
+};
+
+// -------------------------------------------------------------------------
+
+class CarlaServer
+{
+public:
+    CarlaServer() noexcept
+        : fUnixFd(-1),
+          fTcpFd(-1),
+          fUnixPath(),
+          fToken(),
+          fTokenFile(),
+          fDriverName(),
+          fProjectFile(),
+          fClientCount(0),
+          fCallbackMutex(),
+          fCallbackBuffer(),
+          fCallbackScratch(),
+          fCallbackSubscribers(false),
+          fEngineQuit(false),
+          fReply(),
+          fEvent(),
+          fSnapshotPeaks(nullptr),
+          fSnapshotStates(nullptr),
+          fSnapshotPluginIds(nullptr),
+          fSnapshotParameterIds(nullptr),
+          fSnapshotParameterValues(nullptr),
+          fSnapshotInterval(0),
+          fNextSnapshot(0)
+    {
+        carla_zeroStructs(fClients, kServerMaxClients);
+        carla_zeroStruct(fSnapshot);
+    }
+
+    ~CarlaServer() noexcept
+    {
+        close();
+    }
+
+    bool openUnixSocket(const char* const path)
+    {
+        struct sockaddr_un addr;
+        carla_zeroStruct(addr);
+        addr.sun_family = AF_UNIX;
+
+        if (std::strlen(path) >= sizeof(addr.sun_path))
+        {
+            carla_stderr2("Socket path '%s' is too long", path);
+            return false;
+        }
+
+        std::strcpy(addr.sun_path, path);
+
+        // check for a running server before taking over a stale socket
+        int sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        CARLA_SAFE_ASSERT_RETURN(sock != -1, false);
+
+        if (::connect(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0)
+        {
+            ::close(sock);
+            carla_stderr2("Another server is already listening at '%s'", path);
+            return false;
+        }
+
+        ::close(sock);
+        ::unlink(path);
+
+        sock = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        CARLA_SAFE_ASSERT_RETURN(sock != -1, false);
+
+        // create the socket file as owner-only right away, a chmod after bind leaves a window with default permissions
+        const mode_t oldMask = ::umask(S_IXUSR|S_IRWXG|S_IRWXO);
+        const bool bound = (::bind(sock, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+        const int bindErrno = errno;
+        ::umask(oldMask);
+
+        if (! bound || ::listen(sock, 16) != 0 || ! setNonBlocking(sock))
+        {
+            carla_stderr2("Failed to listen at '%s': %s", path, std::strerror(bound ? errno : bindErrno));
+            ::close(sock);
+            return false;
+        }
+
+        fUnixFd   = sock;
+        fUnixPath = path;
+        carla_stdout("Listening at '%s'", path);
+        return true;
+    }
+
+    /*
+     * Create a new random token for TCP clients and write it to @a path, only readable by the current user.
+     */
+    bool createToken(const char* const path)
+    {
+        uint8_t bytes[32];
+
+        const int randomFd = ::open("/dev/urandom", O_RDONLY|O_CLOEXEC);
+
+        if (randomFd == -1 || ::read(randomFd, bytes, sizeof(bytes)) != static_cast<ssize_t>(sizeof(bytes)))
+        {
+            carla_stderr2("Failed to generate a token: %s", std::strerror(errno));
+
+            if (randomFd != -1)
+                ::close(randomFd);
+            return false;
+        }
+
+        ::close(randomFd);
+
+        char token[sizeof(bytes)*2+2];
+
+        for (std::size_t i=0; i < sizeof(bytes); ++i)
+            std::snprintf(token+i*2, 3, "%02x", bytes[i]);
+
+        // never follow links, and fix the permissions of an existing file before writing to it
+        const int fd = ::open(path, O_WRONLY|O_CREAT|O_TRUNC|O_NOFOLLOW|O_CLOEXEC, S_IRUSR|S_IWUSR);
+
+        if (fd == -1 || ::fchmod(fd, S_IRUSR|S_IWUSR) != 0)
+        {
+            carla_stderr2("Failed to create token file '%s': %s", path, std::strerror(errno));
+
+            if (fd != -1)
+                ::close(fd);
+            return false;
+        }
+
+        const std::size_t tokenSize = sizeof(bytes)*2;
+        token[tokenSize]   = '\n';
+        token[tokenSize+1] = '\0';
+
+        const bool written = ::write(fd, token, tokenSize+1) == static_cast<ssize_t>(tokenSize+1);
+        ::close(fd);
+
+        if (! written)
+        {
+            carla_stderr2("Failed to write token file '%s'", path);
+            ::unlink(path);
+            return false;
+        }
+
+        token[tokenSize] = '\0';
+
+        fToken     = token;
+        fTokenFile = path;
+        carla_stdout("TCP token written to '%s'", path);
+        return true;
+    }
+
+    bool openTcpSocket(const char* const address)
+    {
+        CarlaString host, port;
+
+        if (const char* const sep = std::strrchr(address, ':'))
+        {
+            const char* hostStart = address;
+            std::size_t hostSize  = static_cast<std::size_t>(sep - address);
+
+            // "[::1]:port" style for IPv6
+            if (hostSize > 2 && address[0] == '[' && address[hostSize-1] == ']')
+            {
+                hostStart += 1;
+                hostSize  -= 2;
+            }
+
+            host = hostStart;
+            host.truncate(hostSize);
+            port = sep+1;
+        }
+        else
+        {
+            // only listen locally unless told otherwise
+            host = "127.0.0.1";
+            port = address;
+        }
+
+        struct addrinfo hints;
+        carla_zeroStruct(hints);
+        hints.ai_family   = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags    = AI_PASSIVE;
+
+        struct addrinfo* res = nullptr;
+
+        if (const int ret = ::getaddrinfo(host.isNotEmpty() ? host.buffer() : nullptr, port, &hints, &res))
+        {
+            carla_stderr2("Invalid TCP address '%s': %s", address, ::gai_strerror(ret));
+            return false;
+        }
+
+        int sock = -1;
+
+        for (struct addrinfo* ai = res; ai != nullptr; ai = ai->ai_next)
+        {
+            sock = ::socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+
+            if (sock == -1)
+                continue;
+
+            const int on = 1;
+            ::setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+            if (::bind(sock, ai->ai_addr, ai->ai_addrlen) == 0 && ::listen(sock, 16) == 0 && setNonBlocking(sock))
+                break;
+
+            ::close(sock);
+            sock = -1;
+        }
+
+        ::freeaddrinfo(res);
+
+        if (sock == -1)
+        {
+            carla_stderr2("Failed to listen at TCP address '%s': %s", address, std::strerror(errno));
+            return false;
+        }
+
+        fTcpFd = sock;
+        carla_stdout("Listening at TCP address '%s'", address);
+        return true;
+    }
+
+    bool startEngine(const ServerOptions& options)
+    {
+        carla_set_engine_callback(engineCallback, this);
+
+        if (options.processMode >= 0)
+            carla_set_engine_option(ENGINE_OPTION_PROCESS_MODE, options.processMode, nullptr);
+
+        if (const char* const libFolder = carla_get_library_folder())
+        {
+            carla_set_engine_option(ENGINE_OPTION_PATH_BINARIES, 0, libFolder);
+
+            if (options.resourcesPath == nullptr)
+            {
+                CarlaString resourcesPath(libFolder);
+                resourcesPath += "/resources";
+
+                if (::access(resourcesPath, F_OK) != 0)
+                {
+                    resourcesPath  = libFolder;
+                    resourcesPath += "/../../share/carla/resources";
+                }
+
+                carla_set_engine_option(ENGINE_OPTION_PATH_RESOURCES, 0, resourcesPath);
+            }
+        }
+
+        if (options.resourcesPath != nullptr)
+            carla_set_engine_option(ENGINE_OPTION_PATH_RESOURCES, 0, options.resourcesPath);
+
+        if (! carla_engine_init(options.driverName, options.clientName))
+        {
+            carla_stderr2("Failed to start engine: %s", carla_get_last_error());
+            return false;
+        }
+
+        fDriverName = options.driverName;
+
+        if (! allocSnapshot())
+            return false;
+
+        if (options.projectFile != nullptr)
+        {
+            fProjectFile = options.projectFile;
+
+            if (::access(options.projectFile, F_OK) == 0 && ! carla_load_project(options.projectFile))
+                carla_stderr2("Failed to load project '%s': %s", options.projectFile, carla_get_last_error());
+        }
+
+        carla_stdout("Engine started, driver '%s', buffer size %u, sample rate %g",
+                     options.driverName, carla_get_buffer_size(), carla_get_sample_rate());
+        return true;
+    }
+
+    void close() noexcept
+    {
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            ServerClient* const client(fClients[i]);
+
+            ::close(client->fd);
+            delete client;
+            fClients[i] = nullptr;
+        }
+        fClientCount = 0;
+
+        if (fUnixFd != -1)
+        {
+            ::close(fUnixFd);
+            ::unlink(fUnixPath);
+            fUnixFd = -1;
+        }
+
+        if (fTcpFd != -1)
+        {
+            ::close(fTcpFd);
+            fTcpFd = -1;
+        }
+
+        if (fTokenFile.isNotEmpty())
+        {
+            ::unlink(fTokenFile);
+            fTokenFile.clear();
+        }
+
+        if (carla_is_engine_running())
+            carla_engine_close();
+
+        carla_set_engine_callback(nullptr, nullptr);
+
+        freeSnapshot();
+    }
+
+    bool run()
+    {
+        uint32_t nextIdle = getTimeInMs();
+
+        for (; ! gCloseNow;)
+        {
+            if (fEngineQuit || ! carla_is_engine_running())
+            {
+                carla_stderr2("Engine stopped unexpectedly");
+                return false;
+            }
+
+            if (gSaveNow)
+            {
+                gSaveNow = false;
+
+                if (fProjectFile.isNotEmpty() && ! carla_save_project(fProjectFile))
+                    carla_stderr2("Failed to save project '%s': %s", fProjectFile.buffer(), carla_get_last_error());
+            }
+
+            // wait for socket activity or the next timer
+            const uint32_t now = getTimeInMs();
+            int timeout = isTimeReached(now, nextIdle) ? 0 : static_cast<int>(nextIdle - now);
+
+            if (fSnapshotInterval != 0)
+            {
+                const int snapshotTimeout = isTimeReached(now, fNextSnapshot) ? 0 : static_cast<int>(fNextSnapshot - now);
+
+                if (snapshotTimeout < timeout)
+                    timeout = snapshotTimeout;
+            }
+
+            const nfds_t pollFdCount = preparePollFds();
+
+            if (hasPendingInput())
+                timeout = 0;
+
+            if (::poll(fPollFds, pollFdCount, timeout) < 0 && errno != EINTR)
+            {
+                carla_stderr2("poll failed: %s", std::strerror(errno));
+                return false;
+            }
+
+            handlePollFds();
+
+            // process requests, up to a limit per client so the engine idles regularly
+            for (uint i=0; i < fClientCount; ++i)
+            {
+                ServerClient* const client(fClients[i]);
+
+                if (! client->closing)
+                    processClientInput(client);
+            }
+
+            if (isTimeReached(getTimeInMs(), nextIdle))
+            {
+                carla_engine_idle();
+                nextIdle = getTimeInMs() + kServerEngineIdleInterval;
+            }
+
+            flushCallbacks();
+
+            if (fSnapshotInterval != 0 && isTimeReached(getTimeInMs(), fNextSnapshot))
+                runSnapshot();
+
+            flushAndCleanClients();
+        }
+
+        return true;
+    }
+
+private:
+    int fUnixFd;
+    int fTcpFd;
+    CarlaString fUnixPath;
+    CarlaString fToken;
+    CarlaString fTokenFile;
+    CarlaString fDriverName;
+    CarlaString fProjectFile;
+    ServerClient* fClients[kServerMaxClients];
+    uint fClientCount;
+
+    // engine callbacks, might be written from non-main threads
+    CarlaMutex fCallbackMutex;
+    ServerBuffer fCallbackBuffer;
+    ServerBuffer fCallbackScratch;
+    volatile bool fCallbackSubscribers;
+    volatile bool fEngineQuit;
+
+    // scratch buffers for replies and events
+    ServerBuffer fReply;
+    ServerBuffer fEvent;
+
+    // listening sockets first, then one per client
+    struct pollfd fPollFds[kServerMaxClients+2];
+
+    CarlaRuntimeSnapshot fSnapshot;
+    float*    fSnapshotPeaks;
+    uint*     fSnapshotStates;
+    uint*     fSnapshotPluginIds;
+    uint32_t* fSnapshotParameterIds;
+    float*    fSnapshotParameterValues;
+    uint32_t  fSnapshotInterval;
+    uint32_t  fNextSnapshot;
+
+    // ---------------------------------------------------------------------
+
+    static void engineCallback(void* ptr, EngineCallbackOpcode action, uint pluginId, int value1, int value2, float value3, const char* valueStr)
+    {
+        CarlaServer* const self = static_cast<CarlaServer*>(ptr);
+        CARLA_SAFE_ASSERT_RETURN(self != nullptr,);
+
+        switch (action)
+        {
+        case ENGINE_CALLBACK_IDLE:
+            return;
+        case ENGINE_CALLBACK_QUIT:
+            self->fEngineQuit = true;
+            break;
+        default:
+            break;
+        }
+
+        if (! self->fCallbackSubscribers)
+            return;
+
+        const CarlaMutexLocker cml(self->fCallbackMutex);
+
+        ServerWriter writer(self->fCallbackBuffer, kCarlaServerEventCallback, 0);
+        writer.writeUInt(static_cast<uint32_t>(action));
+        writer.writeUInt(pluginId);
+        writer.writeInt(value1);
+        writer.writeInt(value2);
+        writer.writeFloat(value3);
+        writer.writeString(valueStr);
+        writer.finish();
+    }
+
+    // ---------------------------------------------------------------------
+
+    bool allocSnapshot() noexcept
+    {
+        const uint maxPluginCount = carla_get_max_plugin_number();
+        CARLA_SAFE_ASSERT_RETURN(maxPluginCount != 0, false);
+
+        fSnapshotPeaks           = new float[maxPluginCount*4];
+        fSnapshotStates          = new uint[maxPluginCount];
+        fSnapshotPluginIds       = new uint[kServerMaxParameterChanges];
+        fSnapshotParameterIds    = new uint32_t[kServerMaxParameterChanges];
+        fSnapshotParameterValues = new float[kServerMaxParameterChanges];
+
+        fSnapshot.maxPluginCount     = maxPluginCount;
+        fSnapshot.peaks              = fSnapshotPeaks;
+        fSnapshot.states             = fSnapshotStates;
+        fSnapshot.parameterPluginIds = fSnapshotPluginIds;
+        fSnapshot.parameterIds       = fSnapshotParameterIds;
+        fSnapshot.parameterValues    = fSnapshotParameterValues;
+        return true;
+    }
+
+    void freeSnapshot() noexcept
+    {
+        delete[] fSnapshotPeaks;
+        delete[] fSnapshotStates;
+        delete[] fSnapshotPluginIds;
+        delete[] fSnapshotParameterIds;
+        delete[] fSnapshotParameterValues;
+
+        fSnapshotPeaks           = nullptr;
+        fSnapshotStates          = nullptr;
+        fSnapshotPluginIds       = nullptr;
+        fSnapshotParameterIds    = nullptr;
+        fSnapshotParameterValues = nullptr;
+        carla_zeroStruct(fSnapshot);
+    }
+
+    void runSnapshot()
+    {
+        const uint32_t now = getTimeInMs();
+        fNextSnapshot = now + fSnapshotInterval;
+
+        bool wantsParameters = false;
+        bool wantsTelemetry  = false;
+
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            ServerClient* const client(fClients[i]);
+
+            if (client->closing)
+                continue;
+            if (client->mask & kCarlaServerSubscribeParameters)
+                wantsParameters = true;
+            if ((client->mask & kCarlaServerSubscribeTelemetry) != 0 && isTimeReached(now, client->nextTelemetry))
+                wantsTelemetry = true;
+        }
+
+        fSnapshot.maxParameterChanges = wantsParameters ? kServerMaxParameterChanges : 0;
+
+        if (! carla_get_runtime_snapshot(&fSnapshot))
+            return;
+
+        if (wantsTelemetry)
+        {
+            fEvent.size = 0;
+
+            ServerWriter writer(fEvent, kCarlaServerEventTelemetry, 0);
+            writer.writeULong(carla_get_current_transport_frame());
+            writer.writeUInt(fSnapshot.pluginCount);
+
+            for (uint32_t i=0; i < fSnapshot.pluginCount; ++i)
+            {
+                writer.writeUInt(fSnapshot.states[i]);
+
+                for (uint32_t j=0; j < 4; ++j)
+                    writer.writeFloat(fSnapshot.peaks[i*4+j]);
+            }
+
+            if (writer.finish())
+            {
+                for (uint i=0; i < fClientCount; ++i)
+                {
+                    ServerClient* const client(fClients[i]);
+
+                    if ((client->mask & kCarlaServerSubscribeTelemetry) == 0 || ! isTimeReached(now, client->nextTelemetry))
+                        continue;
+
+                    client->nextTelemetry = now + client->interval;
+                    sendToClient(client, fEvent);
+                }
+            }
+        }
+
+        if (! wantsParameters)
+            return;
+
+        // changes that do not fit are reported on the next call, get them now
+        for (uint32_t tries = 0; fSnapshot.parameterChangeCount != 0 && tries < 16; ++tries)
+        {
+            fEvent.size = 0;
+
+            ServerWriter writer(fEvent, kCarlaServerEventParameterValues, 0);
+            writer.writeUInt(fSnapshot.parameterChangeCount);
+
+            for (uint32_t i=0; i < fSnapshot.parameterChangeCount; ++i)
+            {
+                writer.writeUInt(fSnapshot.parameterPluginIds[i]);
+                writer.writeUInt(fSnapshot.parameterIds[i]);
+                writer.writeFloat(fSnapshot.parameterValues[i]);
+            }
+
+            if (writer.finish())
+                broadcast(kCarlaServerSubscribeParameters, fEvent);
+
+            if (fSnapshot.parameterChangeCount < kServerMaxParameterChanges)
+                break;
+            if (! carla_get_runtime_snapshot(&fSnapshot))
+                break;
+        }
+    }
+
+    void updateSubscriptions() noexcept
+    {
+        bool callbackSubscribers = false;
+        uint32_t snapshotInterval = 0;
+
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            ServerClient* const client(fClients[i]);
+
+            if (client->closing)
+                continue;
+
+            if (client->mask & kCarlaServerSubscribeCallbacks)
+                callbackSubscribers = true;
+
+            if ((client->mask & (kCarlaServerSubscribeParameters|kCarlaServerSubscribeTelemetry)) != 0)
+            {
+                if (snapshotInterval == 0 || client->interval < snapshotInterval)
+                    snapshotInterval = client->interval;
+            }
+        }
+
+        fCallbackSubscribers = callbackSubscribers;
+
+        if (snapshotInterval != 0 && fSnapshotInterval == 0)
+            fNextSnapshot = getTimeInMs();
+
+        fSnapshotInterval = snapshotInterval;
+    }
+
+    // ---------------------------------------------------------------------
+
+    nfds_t preparePollFds() noexcept
+    {
+        fPollFds[0].fd      = fUnixFd;
+        fPollFds[0].events  = POLLIN;
+        fPollFds[0].revents = 0;
+        fPollFds[1].fd      = fTcpFd;
+        fPollFds[1].events  = POLLIN;
+        fPollFds[1].revents = 0;
+
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            const ServerClient* const client(fClients[i]);
+            struct pollfd& pollFd(fPollFds[i+2]);
+
+            pollFd.fd      = client->closing ? -1 : client->fd;
+            pollFd.events  = static_cast<short>(client->output.size != 0 ? (POLLIN|POLLOUT) : POLLIN);
+            pollFd.revents = 0;
+        }
+
+        return static_cast<nfds_t>(fClientCount + 2);
+    }
+
+    void handlePollFds()
+    {
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            ServerClient* const client(fClients[i]);
+
+            if (fPollFds[i+2].fd != client->fd)
+                continue;
+
+            const short revents = fPollFds[i+2].revents;
+
+            if (revents & (POLLIN|POLLHUP|POLLERR))
+                readClient(client);
+            if (revents & POLLOUT)
+                writeClient(client);
+        }
+
+        if (fPollFds[0].revents & POLLIN)
+            acceptClient(fUnixFd, false);
+        if (fPollFds[1].revents & POLLIN)
+            acceptClient(fTcpFd, true);
+    }
+
+    void acceptClient(const int listenFd, const bool isTcp)
+    {
+        for (;;)
+        {
+            struct sockaddr_storage addr;
+            socklen_t addrLen = sizeof(addr);
+
+            const int sock = ::accept(listenFd, (struct sockaddr*)&addr, &addrLen);
+
+            if (sock == -1)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK)
+                    carla_stderr2("accept failed: %s", std::strerror(errno));
+                return;
+            }
+
+            if (! setNonBlocking(sock))
+            {
+                ::close(sock);
+                continue;
+            }
+
+            char clientName[NI_MAXHOST+NI_MAXSERV+2];
+
+            if (isTcp)
+            {
+                const int on = 1;
+                ::setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+                char host[NI_MAXHOST], serv[NI_MAXSERV];
+
+                if (::getnameinfo((struct sockaddr*)&addr, addrLen, host, sizeof(host), serv, sizeof(serv), NI_NUMERICHOST|NI_NUMERICSERV) == 0)
+                    std::snprintf(clientName, sizeof(clientName), "%s:%s", host, serv);
+                else
+                    std::strcpy(clientName, "tcp");
+            }
+            else
+            {
+                std::snprintf(clientName, sizeof(clientName), "unix:%i", sock);
+            }
+
+            if (fClientCount >= kServerMaxClients)
+            {
+                carla_stderr2("Too many clients, refusing '%s'", clientName);
+                ::close(sock);
+                continue;
+            }
+
+            fClients[fClientCount++] = new ServerClient(sock, isTcp, clientName);
+            carla_stdout("Client '%s' connected", clientName);
+        }
+    }
+
+    void readClient(ServerClient* const client)
+    {
+        for (std::size_t total = 0; total < kServerMaxReadPerCycle;)
+        {
+            if (! client->input.reserve(65536))
+            {
+                client->closing = true;
+                return;
+            }
+
+            const ssize_t r = ::recv(client->fd, client->input.data + client->input.size,
+                                     client->input.capacity - client->input.size, 0);
+
+            if (r > 0)
+            {
+                client->input.size += static_cast<std::size_t>(r);
+                total += static_cast<std::size_t>(r);
+                continue;
+            }
+
+            if (r < 0 && errno == EINTR)
+                continue;
+
+            if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+
+            // closed by client, or failed
+            client->closing = true;
+            return;
+        }
+    }
+
+    void writeClient(ServerClient* const client)
+    {
+        for (; client->output.size != 0;)
+        {
+            const ssize_t r = ::send(client->fd, client->output.data, client->output.size, MSG_NOSIGNAL);
+
+            if (r > 0)
+            {
+                client->output.consume(static_cast<std::size_t>(r));
+                continue;
+            }
+
+            if (r < 0 && errno == EINTR)
+                continue;
+
+            if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                return;
+
+            client->closing = true;
+            return;
+        }
+    }
+
+    bool hasPendingInput() const noexcept
+    {
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            const ServerClient* const client(fClients[i]);
+
+            if (client->closing || client->input.size < kCarlaServerHeaderSize)
+                continue;
+            if (client->input.size >= kCarlaServerHeaderSize + readUInt(client->input.data))
+                return true;
+        }
+
+        return false;
+    }
+
+    void processClientInput(ServerClient* const client)
+    {
+        if (! client->authenticated && isTimeReached(getTimeInMs(), client->helloDeadline))
+        {
+            carla_stderr2("Client '%s' did not authenticate in time, closing connection", client->name.buffer());
+            client->closing = true;
+            return;
+        }
+
+        std::size_t offset = 0;
+
+        for (uint32_t handled = 0; handled < kServerMaxRequestsPerCycle && ! client->closing; ++handled)
+        {
+            const std::size_t available = client->input.size - offset;
+
+            if (available < kCarlaServerHeaderSize)
+                break;
+
+            const uint8_t* const header = client->input.data + offset;
+            const uint32_t payloadSize  = readUInt(header);
+            const uint16_t opcode       = static_cast<uint16_t>(header[4] | header[5] << 8);
+            const uint32_t requestId    = readUInt(header + 8);
+
+            if (payloadSize > (client->authenticated ? kCarlaServerMaxPayloadSize : kCarlaServerMaxHelloSize))
+            {
+                carla_stderr2("Client '%s' sent a message too big (%u bytes), closing connection", client->name.buffer(), payloadSize);
+                sendError(client, requestId, "Message too big");
+                client->closing = true;
+                break;
+            }
+
+            if (available < kCarlaServerHeaderSize + payloadSize)
+                break;
+
+            if (! client->authenticated && opcode != kCarlaServerRequestHello)
+            {
+                carla_stderr2("Client '%s' sent a request before authenticating, closing connection", client->name.buffer());
+                sendError(client, requestId, "Not authenticated");
+                client->closing = true;
+                break;
+            }
+
+            ServerReader reader(header + kCarlaServerHeaderSize, payloadSize);
+            handleRequest(client, opcode, requestId, reader);
+
+            offset += kCarlaServerHeaderSize + payloadSize;
+        }
+
+        client->input.consume(offset);
+    }
+
+    void flushAndCleanClients()
+    {
+        uint count = 0;
+
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            ServerClient* const client(fClients[i]);
+
+            // closing clients get a last chance to receive the error that closed them
+            if (client->output.size != 0)
+                writeClient(client);
+
+            if (! client->closing)
+            {
+                fClients[count++] = client;
+                continue;
+            }
+
+            carla_stdout("Client '%s' disconnected", client->name.buffer());
+
+            ::close(client->fd);
+            delete client;
+        }
+
+        if (count == fClientCount)
+            return;
+
+        for (uint i=count; i < fClientCount; ++i)
+            fClients[i] = nullptr;
+
+        fClientCount = count;
+        updateSubscriptions();
+    }
+
+    void sendError(ServerClient* const client, const uint32_t requestId, const char* const error)
+    {
+        fReply.size = 0;
+
+        ServerWriter writer(fReply, kCarlaServerReplyError, requestId);
+        writer.writeString(error);
+        writer.finish();
+
+        sendToClient(client, fReply);
+    }
+
+    void sendToClient(ServerClient* const client, const ServerBuffer& buffer)
+    {
+        if (client->closing || buffer.size == 0)
+            return;
+
+        if (client->output.size + buffer.size > kServerMaxClientOutput)
+        {
+            carla_stderr2("Client '%s' is not reading its messages, closing connection", client->name.buffer());
+            client->closing = true;
+            return;
+        }
+
+        if (! client->output.append(buffer.data, buffer.size))
+            client->closing = true;
+    }
+
+    void broadcast(const uint32_t mask, const ServerBuffer& buffer)
+    {
+        for (uint i=0; i < fClientCount; ++i)
+        {
+            ServerClient* const client(fClients[i]);
+
+            if (client->mask & mask)
+                sendToClient(client, buffer);
+        }
+    }
+
+    void flushCallbacks()
+    {
+        {
+            const CarlaMutexLocker cml(fCallbackMutex);
+
+            if (fCallbackBuffer.size == 0)
+                return;
+
+            fCallbackScratch.size = 0;
+            fCallbackScratch.swapWith(fCallbackBuffer);
+        }
+
+        broadcast(kCarlaServerSubscribeCallbacks, fCallbackScratch);
+        fCallbackScratch.size = 0;
+    }
+
+    static uint32_t readUInt(const uint8_t* const data) noexcept
+    {
+        return static_cast<uint32_t>(data[0])       | static_cast<uint32_t>(data[1]) << 8
+             | static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24;
+    }
+
+    // ---------------------------------------------------------------------
+
+    void handleRequest(ServerClient* const client, const uint16_t opcode, const uint32_t requestId, ServerReader& reader)
+    {
+        fReply.size = 0;
+
+        ServerWriter writer(fReply, kCarlaServerReplyOk, requestId);
+        const char* error = nullptr;
+
+        switch (static_cast<CarlaServerRequestOpcode>(opcode))
+        {
+        case kCarlaServerRequestNull:
+            break;
+
+        case kCarlaServerRequestHello: {
+            uint32_t version;
+            CarlaString token;
+
+            if (! (reader.readUInt(version) && reader.readString(token)))
+                break;
+
+            if (version != CARLA_SERVER_PROTOCOL_VERSION)
+            {
+                error = "Unsupported protocol version";
+                break;
+            }
+
+            if (client->isTcp && ! isValidToken(token))
+            {
+                carla_stderr2("Client '%s' sent an invalid token, closing connection", client->name.buffer());
+                error = "Invalid token";
+                break;
+            }
+
+            client->authenticated = true;
+            writer.writeUInt(CARLA_SERVER_PROTOCOL_VERSION);
+            break;
+        }
+
+        case kCarlaServerRequestPing:
+            break;
+
+        case kCarlaServerRequestEngineInfo:
+            writer.writeString(fDriverName);
+            writer.writeUInt(carla_get_buffer_size());
+            writer.writeDouble(carla_get_sample_rate());
+            writer.writeUInt(carla_get_current_plugin_count());
+            writer.writeUInt(carla_get_max_plugin_number());
+            writer.writeByte(carla_is_engine_running() ? 1 : 0);
+            writer.writeString(carla_get_telemetry_filename());
+            break;
+
+        case kCarlaServerRequestSessionInfo: {
+            uint32_t flags;
+
+            if (! reader.readUInt(flags))
+                break;
+
+            const uint32_t pluginCount = carla_get_current_plugin_count();
+            writer.writeUInt(pluginCount);
+
+            for (uint32_t i=0; i < pluginCount; ++i)
+                writeSessionPlugin(writer, i, flags);
+            break;
+        }
+
+        case kCarlaServerRequestAddPlugin: {
+            uint32_t btype, ptype, options;
+            int64_t uniqueId;
+            CarlaString filename, name, label;
+
+            if (! (reader.readUInt(btype) && reader.readUInt(ptype) && reader.readString(filename) && reader.readString(name) &&
+                   reader.readString(label) && reader.readLong(uniqueId) && reader.readUInt(options)))
+                break;
+
+            if (! carla_add_plugin(static_cast<BinaryType>(btype), static_cast<PluginType>(ptype),
+                                   filename.isNotEmpty() ? filename.buffer() : nullptr,
+                                   name.isNotEmpty() ? name.buffer() : nullptr,
+                                   label, uniqueId, nullptr, options))
+            {
+                error = carla_get_last_error();
+                break;
+            }
+
+            writer.writeUInt(carla_get_current_plugin_count()-1);
+            break;
+        }
+
+        case kCarlaServerRequestRemovePlugin: {
+            uint32_t pluginId;
+
+            if (! reader.readUInt(pluginId))
+                break;
+
+            if (! isValidPlugin(pluginId, error))
+                break;
+
+            if (! carla_remove_plugin(pluginId))
+                error = carla_get_last_error();
+            break;
+        }
+
+        case kCarlaServerRequestRemoveAllPlugins:
+            if (! carla_remove_all_plugins())
+                error = carla_get_last_error();
+            break;
+
+        case kCarlaServerRequestRenamePlugin: {
+            uint32_t pluginId;
+            CarlaString name;
+
+            if (! (reader.readUInt(pluginId) && reader.readString(name)))
+                break;
+
+            if (! isValidPlugin(pluginId, error))
+                break;
+
+            if (const char* const newName = carla_rename_plugin(pluginId, name))
+                writer.writeString(newName);
+            else
+                error = carla_get_last_error();
+            break;
+        }
+
+        case kCarlaServerRequestSetParameterValues: {
+            uint32_t count;
+
+            if (! reader.readUInt(count))
+                break;
+
+            // validate the full size first, so malformed requests are not partially applied
+            if (! reader.canRead(static_cast<std::size_t>(count)*12))
+            {
+                error = "Malformed request";
+                break;
+            }
+
+            const uint32_t pluginCount = carla_get_current_plugin_count();
+            uint32_t applied = 0;
+
+            for (uint32_t i=0; i < count; ++i)
+            {
+                uint32_t pluginId    = 0;
+                int32_t  parameterId = 0;
+                float    value       = 0.0f;
+
+                reader.readUInt(pluginId);
+                reader.readInt(parameterId);
+                reader.readFloat(value);
+
+                if (pluginId < pluginCount && setParameterValue(pluginId, parameterId, value))
+                    ++applied;
+            }
+
+            writer.writeUInt(applied);
+            break;
+        }
+
+        case kCarlaServerRequestSetProgram: {
+            uint32_t pluginId, programId;
+
+            if (! (reader.readUInt(pluginId) && reader.readUInt(programId)))
+                break;
+
+            if (! isValidPlugin(pluginId, error))
+                break;
+
+            if (programId < carla_get_program_count(pluginId))
+                carla_set_program(pluginId, programId);
+            else
+                error = "Invalid program";
+            break;
+        }
+
+        case kCarlaServerRequestSetMidiProgram: {
+            uint32_t pluginId, midiProgramId;
+
+            if (! (reader.readUInt(pluginId) && reader.readUInt(midiProgramId)))
+                break;
+
+            if (! isValidPlugin(pluginId, error))
+                break;
+
+            if (midiProgramId < carla_get_midi_program_count(pluginId))
+                carla_set_midi_program(pluginId, midiProgramId);
+            else
+                error = "Invalid MIDI program";
+            break;
+        }
+
+        case kCarlaServerRequestSendMidiNote: {
+            uint32_t pluginId;
+            uint8_t channel, note, velocity;
+
+            if (! (reader.readUInt(pluginId) && reader.readByte(channel) && reader.readByte(note) && reader.readByte(velocity)))
+                break;
+
+            if (! isValidPlugin(pluginId, error))
+                break;
+
+            if (channel < MAX_MIDI_CHANNELS && note < MAX_MIDI_NOTE && velocity < MAX_MIDI_VALUE)
+                carla_send_midi_note(pluginId, channel, note, velocity);
+            else
+                error = "Invalid MIDI note";
+            break;
+        }
+
+        case kCarlaServerRequestPatchbayConnect: {
+            uint32_t groupA, portA, groupB, portB;
+
+            if (! (reader.readUInt(groupA) && reader.readUInt(portA) && reader.readUInt(groupB) && reader.readUInt(portB)))
+                break;
+
+            if (! carla_patchbay_connect(groupA, portA, groupB, portB))
+                error = carla_get_last_error();
+            break;
+        }
+
+        case kCarlaServerRequestPatchbayDisconnect: {
+            uint32_t connectionId;
+
+            if (! reader.readUInt(connectionId))
+                break;
+
+            if (! carla_patchbay_disconnect(connectionId))
+                error = carla_get_last_error();
+            break;
+        }
+
+        case kCarlaServerRequestPatchbayRefresh: {
+            uint8_t external;
+
+            if (! reader.readByte(external))
+                break;
+
+            if (! carla_patchbay_refresh(external != 0))
+                error = carla_get_last_error();
+            break;
+        }
+
+        case kCarlaServerRequestTransportPlay:
+            carla_transport_play();
+            break;
+
+        case kCarlaServerRequestTransportPause:
+            carla_transport_pause();
+            break;
+
+        case kCarlaServerRequestTransportRelocate: {
+            uint64_t frame;
+
+            if (! reader.readULong(frame))
+                break;
+
+            carla_transport_relocate(frame);
+            break;
+        }
+
+        case kCarlaServerRequestLoadProject: {
+            CarlaString filename;
+
+            if (! reader.readString(filename))
+                break;
+
+            if (! carla_load_project(filename))
+                error = carla_get_last_error();
+            break;
+        }
+
+        case kCarlaServerRequestSaveProject: {
+            CarlaString filename;
+
+            if (! reader.readString(filename))
+                break;
+
+            if (! carla_save_project(filename))
+                error = carla_get_last_error();
+            break;
+        }
+
+        case kCarlaServerRequestSubscribe: {
+            uint32_t mask, interval;
+
+            if (! (reader.readUInt(mask) && reader.readUInt(interval)))
+                break;
+
+            if (interval == 0)
+                interval = kServerDefaultInterval;
+            else if (interval < kServerMinimumInterval)
+                interval = kServerMinimumInterval;
+
+            client->mask          = mask;
+            client->interval      = interval;
+            client->nextTelemetry = getTimeInMs();
+            updateSubscriptions();
+            break;
+        }
+
+        default:
+            error = "Unknown request";
+            break;
+        }
+
+        if (error == nullptr && ! reader.isOk())
+            error = "Malformed request";
+
+        if (error == nullptr && ! writer.finish())
+            error = "Reply too big";
+
+        if (error != nullptr)
+        {
+            fReply.size = 0;
+
+            ServerWriter errorWriter(fReply, kCarlaServerReplyError, requestId);
+            errorWriter.writeString(error);
+            errorWriter.finish();
+        }
+
+        // events caused by this request go before its reply
+        flushCallbacks();
+        sendToClient(client, fReply);
+
+        // a failed hello does not authenticate, the reply above is the last message
+        if (! client->authenticated)
+            client->closing = true;
+    }
+
+    // compares the whole token regardless of where it differs
+    bool isValidToken(const CarlaString& token) const noexcept
+    {
+        if (fToken.isEmpty() || token.length() != fToken.length())
+            return false;
+
+        const char* const a = token.buffer();
+        const char* const b = fToken.buffer();
+        uint8_t diff = 0;
+
+        for (std::size_t i=0, size=fToken.length(); i < size; ++i)
+            diff = static_cast<uint8_t>(diff | (a[i] ^ b[i]));
+
+        return diff == 0;
+    }
+
+    bool isValidPlugin(const uint32_t pluginId, const char*& error) const noexcept
+    {
+        if (pluginId < carla_get_current_plugin_count())
+            return true;
+
+        error = "Invalid plugin";
+        return false;
+    }
+
+    bool setParameterValue(const uint32_t pluginId, const int32_t parameterId, const float value)
+    {
+        if (parameterId >= 0)
+        {
+            if (static_cast<uint32_t>(parameterId) >= carla_get_parameter_count(pluginId))
+                return false;
+
+            carla_set_parameter_value(pluginId, static_cast<uint32_t>(parameterId), value);
+            return true;
+        }
+
+        switch (parameterId)
+        {
+        case PARAMETER_ACTIVE:
+            carla_set_active(pluginId, value >= 0.5f);
+            return true;
+        case PARAMETER_DRYWET:
+            carla_set_drywet(pluginId, value);
+            return true;
+        case PARAMETER_VOLUME:
+            carla_set_volume(pluginId, value);
+            return true;
+        case PARAMETER_BALANCE_LEFT:
+            carla_set_balance_left(pluginId, value);
+            return true;
+        case PARAMETER_BALANCE_RIGHT:
+            carla_set_balance_right(pluginId, value);
+            return true;
+        case PARAMETER_PANNING:
+            carla_set_panning(pluginId, value);
+            return true;
+        case PARAMETER_CTRL_CHANNEL:
+            if (value < -1.0f || value >= static_cast<float>(MAX_MIDI_CHANNELS))
+                return false;
+            carla_set_ctrl_channel(pluginId, static_cast<int8_t>(value));
+            return true;
+        }
+
+        return false;
+    }
+
+    void writeSessionPlugin(ServerWriter& writer, const uint32_t pluginId, const uint32_t flags)
+    {
+        const CarlaPluginInfo* info = carla_get_plugin_info(pluginId);
+
+        // the plugin count was already sent, write an empty record to keep the reply parseable
+        if (info == nullptr)
+        {
+            carla_safe_assert("info != nullptr", __FILE__, __LINE__);
+
+            static const CarlaPluginInfo nullInfo;
+            info = &nullInfo;
+        }
+
+        writer.writeUInt(pluginId);
+        writer.writeUInt(static_cast<uint32_t>(info->type));
+        writer.writeUInt(static_cast<uint32_t>(info->category));
+        writer.writeUInt(info->hints);
+        writer.writeUInt(info->optionsEnabled);
+        writer.writeLong(info->uniqueId);
+        writer.writeString(info->name);
+        writer.writeString(info->label);
+        writer.writeString(info->maker);
+        writer.writeString(info->filename);
+
+        const CarlaPortCountInfo* const audioInfo = carla_get_audio_port_count_info(pluginId);
+        const CarlaPortCountInfo* const midiInfo  = carla_get_midi_port_count_info(pluginId);
+        writer.writeUInt(audioInfo != nullptr ? audioInfo->ins  : 0);
+        writer.writeUInt(audioInfo != nullptr ? audioInfo->outs : 0);
+        writer.writeUInt(midiInfo  != nullptr ? midiInfo->ins   : 0);
+        writer.writeUInt(midiInfo  != nullptr ? midiInfo->outs  : 0);
+
+        writer.writeByte(carla_get_internal_parameter_value(pluginId, PARAMETER_ACTIVE) >= 0.5f ? 1 : 0);
+        writer.writeFloat(carla_get_internal_parameter_value(pluginId, PARAMETER_DRYWET));
+        writer.writeFloat(carla_get_internal_parameter_value(pluginId, PARAMETER_VOLUME));
+        writer.writeFloat(carla_get_internal_parameter_value(pluginId, PARAMETER_BALANCE_LEFT));
+        writer.writeFloat(carla_get_internal_parameter_value(pluginId, PARAMETER_BALANCE_RIGHT));
+        writer.writeFloat(carla_get_internal_parameter_value(pluginId, PARAMETER_PANNING));
+        writer.writeInt(static_cast<int32_t>(carla_get_internal_parameter_value(pluginId, PARAMETER_CTRL_CHANNEL)));
+        writer.writeInt(carla_get_current_program_index(pluginId));
+        writer.writeInt(carla_get_current_midi_program_index(pluginId));
+
+        const uint32_t parameterCount = carla_get_parameter_count(pluginId);
+        writer.writeUInt(parameterCount);
+
+        for (uint32_t i=0; i < parameterCount; ++i)
+        {
+            if (flags & kCarlaServerSessionParameterInfo)
+            {
+                const ParameterData*       const paramData   = carla_get_parameter_data(pluginId, i);
+                const CarlaParameterInfo*  const paramInfo   = carla_get_parameter_info(pluginId, i);
+                const ParameterRanges*     const paramRanges = carla_get_parameter_ranges(pluginId, i);
+
+                writer.writeUInt(paramData != nullptr ? static_cast<uint32_t>(paramData->type) : 0);
+                writer.writeUInt(paramData != nullptr ? paramData->hints : 0);
+                writer.writeString(paramInfo != nullptr ? paramInfo->name   : nullptr);
+                writer.writeString(paramInfo != nullptr ? paramInfo->symbol : nullptr);
+                writer.writeString(paramInfo != nullptr ? paramInfo->unit   : nullptr);
+                writer.writeFloat(paramRanges != nullptr ? paramRanges->def : 0.0f);
+                writer.writeFloat(paramRanges != nullptr ? paramRanges->min : 0.0f);
+                writer.writeFloat(paramRanges != nullptr ? paramRanges->max : 1.0f);
+            }
+
+            if (flags & kCarlaServerSessionParameterValues)
+                writer.writeFloat(carla_get_current_parameter_value(pluginId, i));
+        }
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaServer)
+};
+
+// -------------------------------------------------------------------------
+
+static void printUsage(const char* const argv0)
+{
+    carla_stdout("usage: %s [options]\n"
+                 "\n"
+                 "Headless Carla host, controlled through a binary protocol (see CarlaServerUtils.hpp).\n"
+                 "\n"
+                 "Options:\n"
+                 "  --driver NAME           Engine driver to use (default: JACK)\n"
+                 "  --client-name NAME      Engine client name (default: Carla-Server)\n"
+                 "  --process-mode MODE     single, multi, rack or patchbay\n"
+                 "  --unix PATH             UNIX socket to listen at (default: $XDG_RUNTIME_DIR/carla-server.sock)\n"
+                 "  --no-unix               Do not listen on a UNIX socket\n"
+                 "  --tcp [HOST:]PORT       Also listen on TCP (HOST defaults to 127.0.0.1)\n"
+                 "  --token-file FILE       Where to write the token TCP clients must send\n"
+                 "                          (default: $XDG_RUNTIME_DIR/carla-server.token)\n"
+                 "  --project FILE          Load project at startup, SIGUSR1 saves it back\n"
+                 "  --resources DIR         Path to Carla resources\n"
+                 "  -h, --help              Show this help", argv0);
+}
+
+int main(int argc, char* argv[])
+{
+    ServerOptions options;
+    bool useUnix = true;
+
+    for (int i=1; i < argc; ++i)
+    {
+        const char* const arg = argv[i];
+
+        if (std::strcmp(arg, "-h") == 0 || std::strcmp(arg, "--help") == 0)
+        {
+            printUsage(argv[0]);
+            return 0;
+        }
+
+        if (std::strcmp(arg, "--no-unix") == 0)
+        {
+            useUnix = false;
+            continue;
+        }
+
+        if (i+1 >= argc)
+        {
+            carla_stderr2("Invalid or incomplete argument '%s'", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+
+        const char* const value = argv[++i];
+
+        /**/ if (std::strcmp(arg, "--driver") == 0)
+            options.driverName = value;
+        else if (std::strcmp(arg, "--client-name") == 0)
+            options.clientName = value;
+        else if (std::strcmp(arg, "--unix") == 0)
+            options.unixPath = value;
+        else if (std::strcmp(arg, "--tcp") == 0)
+            options.tcpAddress = value;
+        else if (std::strcmp(arg, "--token-file") == 0)
+            options.tokenFile = value;
+        else if (std::strcmp(arg, "--project") == 0)
+            options.projectFile = value;
+        else if (std::strcmp(arg, "--resources") == 0)
+            options.resourcesPath = value;
+        else if (std::strcmp(arg, "--process-mode") == 0)
+        {
+            /**/ if (std::strcmp(value, "single") == 0)
+                options.processMode = ENGINE_PROCESS_MODE_SINGLE_CLIENT;
+            else if (std::strcmp(value, "multi") == 0)
+                options.processMode = ENGINE_PROCESS_MODE_MULTIPLE_CLIENTS;
+            else if (std::strcmp(value, "rack") == 0)
+                options.processMode = ENGINE_PROCESS_MODE_CONTINUOUS_RACK;
+            else if (std::strcmp(value, "patchbay") == 0)
+                options.processMode = ENGINE_PROCESS_MODE_PATCHBAY;
+            else
+            {
+                carla_stderr2("Invalid process mode '%s'", value);
+                return 1;
+            }
+        }
+        else
+        {
+            carla_stderr2("Invalid argument '%s'", arg);
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    CarlaString defaultPathPrefix;
+
+    if (const char* const runtimeDir = std::getenv("XDG_RUNTIME_DIR"))
+    {
+        defaultPathPrefix  = runtimeDir;
+        defaultPathPrefix += "/carla-server";
+    }
+    else
+    {
+        defaultPathPrefix  = "/tmp/carla-server-";
+        defaultPathPrefix += CarlaString(static_cast<uint>(::getuid()));
+    }
+
+    CarlaString unixPath, tokenFile;
+
+    if (options.unixPath != nullptr)
+    {
+        unixPath = options.unixPath;
+    }
+    else
+    {
+        unixPath  = defaultPathPrefix;
+        unixPath += ".sock";
+    }
+
+    if (options.tokenFile != nullptr)
+    {
+        tokenFile = options.tokenFile;
+    }
+    else
+    {
+        tokenFile  = defaultPathPrefix;
+        tokenFile += ".token";
+    }
+
+    if (! useUnix && options.tcpAddress == nullptr)
+    {
+        carla_stderr2("Nothing to listen at, use --unix or --tcp");
+        return 1;
+    }
+
+    initSignalHandler();
+
+    CarlaServer server;
+
+    if (useUnix && ! server.openUnixSocket(unixPath))
+        return 1;
+
+    if (options.tcpAddress != nullptr && ! (server.createToken(tokenFile) && server.openTcpSocket(options.tcpAddress)))
+        return 1;
+
+    if (! server.startEngine(options))
+        return 1;
+
+    const bool ok = server.run();
+    server.close();
+
+    return ok ? 0 : 1;
+}
+
+// -------------------------------------------------------------------------
@@ -0,0 +1,563 @@
+/*
+ * Carla Server Tests
+ * Copyright (C) 2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// Starts a carla-server with the offline driver and talks to it over its UNIX and TCP sockets.
+//
+// usage: CarlaServer [path/to/carla-server] [path/to/resources]
+
+#include "CarlaBackend.h"
+#include "CarlaServerUtils.hpp"
+
+#include <cassert>
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+
+// the checks below are done with assert
+#ifdef NDEBUG
+# error This test must be built without NDEBUG
+#endif
+
+CARLA_BACKEND_USE_NAMESPACE
+
+static const int kTimeout = 10000; // ms, longer than kCarlaServerHelloTimeout
+
+// -----------------------------------------------------------------------
+
+struct Message {
+    std::vector<uint8_t> data;
+
+    void u8(const uint8_t value)
+    {
+        data.push_back(value);
+    }
+
+    void u32(const uint32_t value)
+    {
+        for (uint i=0; i < 4; ++i)
+            data.push_back(static_cast<uint8_t>(value >> (i*8)));
+    }
+
+    void i64(const int64_t value)
+    {
+        u32(static_cast<uint32_t>(value));
+        u32(static_cast<uint32_t>(static_cast<uint64_t>(value) >> 32));
+    }
+
+    void f32(const float value)
+    {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(uint32_t));
+        u32(bits);
+    }
+
+    void str(const char* const value)
+    {
+        const std::size_t size(std::strlen(value));
+
+        u32(static_cast<uint32_t>(size));
+        data.insert(data.end(), value, value+size);
+    }
+};
+
+struct Reply {
+    uint16_t opcode;
+    uint32_t requestId;
+    std::vector<uint8_t> payload;
+
+    Reply()
+        : opcode(0),
+          requestId(0),
+          payload() {}
+
+    uint32_t u32(const std::size_t offset) const
+    {
+        assert(offset + 4 <= payload.size());
+
+        return static_cast<uint32_t>(payload[offset])         | static_cast<uint32_t>(payload[offset+1]) << 8
+             | static_cast<uint32_t>(payload[offset+2]) << 16 | static_cast<uint32_t>(payload[offset+3]) << 24;
+    }
+
+    std::string str(const std::size_t offset) const
+    {
+        const uint32_t size(u32(offset));
+        assert(offset + 4 + size <= payload.size());
+
+        return std::string(payload.begin() + static_cast<long>(offset + 4), payload.begin() + static_cast<long>(offset + 4 + size));
+    }
+};
+
+// -----------------------------------------------------------------------
+
+class TestClient
+{
+public:
+    TestClient()
+        : fd(-1),
+          input() {}
+
+    ~TestClient()
+    {
+        if (fd != -1)
+            ::close(fd);
+    }
+
+    bool connectUnix(const char* const path)
+    {
+        struct sockaddr_un addr;
+        carla_zeroStruct(addr);
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, path, sizeof(addr.sun_path)-1);
+
+        fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        return fd != -1 && ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+
+    bool connectTcp(const uint16_t port)
+    {
+        struct sockaddr_in addr;
+        carla_zeroStruct(addr);
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        return fd != -1 && ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+    }
+
+    void sendRaw(const std::vector<uint8_t>& data)
+    {
+        for (std::size_t done = 0; done < data.size();)
+        {
+            const ssize_t r = ::send(fd, &data[done], data.size()-done, MSG_NOSIGNAL);
+            assert(r > 0);
+            done += static_cast<std::size_t>(r);
+        }
+    }
+
+    // appends a message to @a out, so several can be sent at once
+    static void pack(std::vector<uint8_t>& out, const uint16_t opcode, const uint32_t requestId, const Message& msg)
+    {
+        Message header;
+        header.u32(static_cast<uint32_t>(msg.data.size()));
+        header.u8(static_cast<uint8_t>(opcode));
+        header.u8(static_cast<uint8_t>(opcode >> 8));
+        header.u8(0);
+        header.u8(0);
+        header.u32(requestId);
+
+        out.insert(out.end(), header.data.begin(), header.data.end());
+        out.insert(out.end(), msg.data.begin(), msg.data.end());
+    }
+
+    void send(const uint16_t opcode, const uint32_t requestId, const Message& msg = Message())
+    {
+        std::vector<uint8_t> data;
+        pack(data, opcode, requestId, msg);
+        sendRaw(data);
+    }
+
+    // waits for the next reply, skipping events. returns false if the connection was closed
+    bool receive(Reply& reply)
+    {
+        for (;;)
+        {
+            if (input.size() >= kCarlaServerHeaderSize)
+            {
+                const uint32_t size = static_cast<uint32_t>(input[0]) | static_cast<uint32_t>(input[1]) << 8
+                                    | static_cast<uint32_t>(input[2]) << 16 | static_cast<uint32_t>(input[3]) << 24;
+
+                if (input.size() >= kCarlaServerHeaderSize + size)
+                {
+                    reply.opcode    = static_cast<uint16_t>(input[4] | input[5] << 8);
+                    reply.requestId = static_cast<uint32_t>(input[8]) | static_cast<uint32_t>(input[9]) << 8
+                                    | static_cast<uint32_t>(input[10]) << 16 | static_cast<uint32_t>(input[11]) << 24;
+                    reply.payload.assign(input.begin() + kCarlaServerHeaderSize, input.begin() + kCarlaServerHeaderSize + size);
+                    input.erase(input.begin(), input.begin() + kCarlaServerHeaderSize + size);
+
+                    if (reply.requestId == 0 && reply.opcode >= kCarlaServerEventCallback)
+                        continue;
+
+                    return true;
+                }
+            }
+
+            struct pollfd pfd;
+            pfd.fd      = fd;
+            pfd.events  = POLLIN;
+            pfd.revents = 0;
+
+            assert(::poll(&pfd, 1, kTimeout) == 1);
+
+            uint8_t buf[4096];
+            const ssize_t r = ::recv(fd, buf, sizeof(buf), 0);
+
+            if (r <= 0)
+                return false;
+
+            input.insert(input.end(), buf, buf+r);
+        }
+    }
+
+    Reply expect(const uint32_t requestId, const uint16_t opcode)
+    {
+        Reply reply;
+        assert(receive(reply));
+        assert(reply.requestId == requestId);
+
+        if (reply.opcode != opcode && reply.opcode == kCarlaServerReplyError)
+            carla_stderr2("request %u failed: %s", requestId, reply.str(0).c_str());
+
+        assert(reply.opcode == opcode);
+        return reply;
+    }
+
+    void expectClosed()
+    {
+        Reply reply;
+        assert(! receive(reply));
+    }
+
+    void hello(const uint32_t requestId, const char* const token)
+    {
+        Message msg;
+        msg.u32(CARLA_SERVER_PROTOCOL_VERSION);
+        msg.str(token);
+        send(kCarlaServerRequestHello, requestId, msg);
+    }
+
+private:
+    int fd;
+    std::vector<uint8_t> input;
+
+    CARLA_DECLARE_NON_COPY_CLASS(TestClient)
+};
+
+// -----------------------------------------------------------------------
+
+static bool waitForFile(const char* const path)
+{
+    for (int i=0; i < kTimeout/10; ++i)
+    {
+        if (::access(path, F_OK) == 0)
+            return true;
+        carla_msleep(10);
+    }
+
+    return false;
+}
+
+static std::string readToken(const char* const path)
+{
+    struct stat st;
+    assert(::stat(path, &st) == 0);
+
+    // must only be readable by the server user
+    assert((st.st_mode & 0777) == (S_IRUSR|S_IWUSR));
+
+    char buf[128];
+    const int fd = ::open(path, O_RDONLY);
+    assert(fd != -1);
+
+    const ssize_t r = ::read(fd, buf, sizeof(buf)-1);
+    ::close(fd);
+    assert(r > 1 && buf[r-1] == '\n');
+
+    return std::string(buf, static_cast<std::size_t>(r-1));
+}
+
+static void testUnauthenticated(const uint16_t port, const std::string& token)
+{
+    // requests before hello close the connection
+    {
+        TestClient client;
+        assert(client.connectTcp(port));
+
+        client.send(kCarlaServerRequestPing, 1);
+        client.expect(1, kCarlaServerReplyError);
+        client.expectClosed();
+    }
+
+    // wrong token, same size as the right one
+    {
+        TestClient client;
+        assert(client.connectTcp(port));
+
+        std::string wrongToken(token);
+        wrongToken[wrongToken.size()-1] = (wrongToken[wrongToken.size()-1] == '0') ? '1' : '0';
+
+        client.hello(1, wrongToken.c_str());
+        client.expect(1, kCarlaServerReplyError);
+        client.expectClosed();
+    }
+
+    // empty token
+    {
+        TestClient client;
+        assert(client.connectTcp(port));
+
+        client.hello(1, "");
+        client.expect(1, kCarlaServerReplyError);
+        client.expectClosed();
+    }
+
+    // big messages are refused before hello, without waiting for their payload
+    {
+        TestClient client;
+        assert(client.connectTcp(port));
+
+        std::vector<uint8_t> data;
+        Message msg;
+        msg.data.resize(kCarlaServerMaxHelloSize+1);
+        TestClient::pack(data, kCarlaServerRequestHello, 1, msg);
+        data.resize(kCarlaServerHeaderSize);
+
+        client.sendRaw(data);
+        client.expect(1, kCarlaServerReplyError);
+        client.expectClosed();
+    }
+
+    // nothing sent at all
+    {
+        TestClient client;
+        assert(client.connectTcp(port));
+
+        client.expectClosed();
+    }
+
+    // right token
+    {
+        TestClient client;
+        assert(client.connectTcp(port));
+
+        client.hello(1, token.c_str());
+        assert(client.expect(1, kCarlaServerReplyOk).u32(0) == CARLA_SERVER_PROTOCOL_VERSION);
+
+        client.send(kCarlaServerRequestPing, 2);
+        client.expect(2, kCarlaServerReplyOk);
+    }
+}
+
+static void testPipelining(TestClient& client)
+{
+    std::vector<uint8_t> data;
+
+    Message addPlugin;
+    addPlugin.u32(BINARY_NATIVE);
+    addPlugin.u32(PLUGIN_INTERNAL);
+    addPlugin.str("");
+    addPlugin.str("");
+    addPlugin.str("lfo");
+    addPlugin.i64(0);
+    addPlugin.u32(0x0);
+
+    Message setParameters;
+    setParameters.u32(4);
+    // valid
+    setParameters.u32(0); setParameters.u32(0);                                    setParameters.f32(0.5f);
+    setParameters.u32(0); setParameters.u32(static_cast<uint32_t>(PARAMETER_VOLUME)); setParameters.f32(1.0f);
+    // invalid parameter and plugin, skipped
+    setParameters.u32(0); setParameters.u32(9999);                                 setParameters.f32(0.5f);
+    setParameters.u32(7); setParameters.u32(0);                                    setParameters.f32(0.5f);
+
+    Message sessionInfo;
+    sessionInfo.u32(kCarlaServerSessionParameterValues);
+
+    // all in a single write, replies must come back in order
+    TestClient::pack(data, kCarlaServerRequestAddPlugin,          10, addPlugin);
+    TestClient::pack(data, kCarlaServerRequestSetParameterValues, 11, setParameters);
+    TestClient::pack(data, kCarlaServerRequestPing,               12, Message());
+    TestClient::pack(data, kCarlaServerRequestEngineInfo,         13, Message());
+    TestClient::pack(data, kCarlaServerRequestSessionInfo,        14, sessionInfo);
+    client.sendRaw(data);
+
+    assert(client.expect(10, kCarlaServerReplyOk).u32(0) == 0);
+    assert(client.expect(11, kCarlaServerReplyOk).u32(0) == 2);
+    client.expect(12, kCarlaServerReplyOk);
+
+    const Reply engineInfo(client.expect(13, kCarlaServerReplyOk));
+    assert(engineInfo.str(0) == "Offline");
+
+    const Reply session(client.expect(14, kCarlaServerReplyOk));
+    assert(session.u32(0) == 1);
+    assert(session.u32(4) == 0);
+
+    // a big batch of parameter changes
+    Message manyParameters;
+    manyParameters.u32(10000);
+
+    for (uint32_t i=0; i < 10000; ++i)
+    {
+        manyParameters.u32(0);
+        manyParameters.u32(0);
+        manyParameters.f32(static_cast<float>(i % 100) / 100.0f);
+    }
+
+    client.send(kCarlaServerRequestSetParameterValues, 15, manyParameters);
+    assert(client.expect(15, kCarlaServerReplyOk).u32(0) == 10000);
+}
+
+static void testMalformed(TestClient& client)
+{
+    // payload too short
+    {
+        Message msg;
+        msg.u8(0);
+        client.send(kCarlaServerRequestSetProgram, 20, msg);
+        client.expect(20, kCarlaServerReplyError);
+    }
+
+    // parameter count bigger than the payload, nothing is applied
+    {
+        Message msg;
+        msg.u32(3);
+        msg.u32(0); msg.u32(0); msg.f32(0.25f);
+        client.send(kCarlaServerRequestSetParameterValues, 21, msg);
+        client.expect(21, kCarlaServerReplyError);
+    }
+
+    // string size past the end of the payload
+    {
+        Message msg;
+        msg.u32(0);
+        msg.u32(1000);
+        msg.u8('a');
+        client.send(kCarlaServerRequestRenamePlugin, 22, msg);
+        client.expect(22, kCarlaServerReplyError);
+    }
+
+    // unknown opcode
+    client.send(0xffff, 23);
+    client.expect(23, kCarlaServerReplyError);
+
+    // the connection is still usable after all that
+    client.send(kCarlaServerRequestPing, 24);
+    client.expect(24, kCarlaServerReplyOk);
+
+    // too big, only the header is needed for the server to give up
+    {
+        Message header;
+        header.u32(kCarlaServerMaxPayloadSize+1);
+        header.u8(static_cast<uint8_t>(kCarlaServerRequestPing));
+        header.u8(0);
+        header.u8(0);
+        header.u8(0);
+        header.u32(25);
+
+        client.sendRaw(header.data);
+        client.expect(25, kCarlaServerReplyError);
+        client.expectClosed();
+    }
+}
+
+// -----------------------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+    const char* const serverPath    = (argc > 1) ? argv[1] : "../../bin/carla-server";
+    const char* const resourcesPath = (argc > 2) ? argv[2] : "../../resources";
+
+    char tmpDir[] = "/tmp/carla-server-test-XXXXXX";
+    assert(::mkdtemp(tmpDir) != nullptr);
+
+    const std::string unixPath(std::string(tmpDir) + "/server.sock");
+    const std::string tokenPath(std::string(tmpDir) + "/server.token");
+    const uint16_t port = static_cast<uint16_t>(20000 + ::getpid() % 20000);
+
+    char portStr[32];
+    std::snprintf(portStr, sizeof(portStr), "127.0.0.1:%u", port);
+
+    const pid_t pid = ::fork();
+    assert(pid != -1);
+
+    if (pid == 0)
+    {
+        ::execl(serverPath, serverPath, "--driver", "Offline", "--process-mode", "rack", "--resources", resourcesPath,
+                "--unix", unixPath.c_str(), "--tcp", portStr, "--token-file", tokenPath.c_str(), static_cast<char*>(nullptr));
+        carla_stderr2("Failed to start '%s': %s", serverPath, std::strerror(errno));
+        ::_exit(1);
+    }
+
+    assert(waitForFile(unixPath.c_str()));
+    assert(waitForFile(tokenPath.c_str()));
+
+    // socket is created owner-only, not changed after bind
+    {
+        struct stat st;
+        assert(::stat(unixPath.c_str(), &st) == 0);
+        assert((st.st_mode & 0777) == (S_IRUSR|S_IWUSR));
+    }
+
+    const std::string token(readToken(tokenPath.c_str()));
+    assert(token.size() == 64);
+
+    // engine starts after the sockets are open, wait for its first reply
+    {
+        TestClient client;
+        assert(client.connectUnix(unixPath.c_str()));
+
+        client.hello(1, "");
+        assert(client.expect(1, kCarlaServerReplyOk).u32(0) == CARLA_SERVER_PROTOCOL_VERSION);
+    }
+
+    testUnauthenticated(port, token);
+
+    {
+        TestClient client;
+        assert(client.connectTcp(port));
+
+        client.hello(1, token.c_str());
+        client.expect(1, kCarlaServerReplyOk);
+
+        testPipelining(client);
+        testMalformed(client);
+    }
+
+    // server keeps running after all those clients
+    {
+        TestClient client;
+        assert(client.connectUnix(unixPath.c_str()));
+
+        client.send(kCarlaServerRequestPing, 1);
+        client.expect(1, kCarlaServerReplyOk);
+    }
+
+    ::kill(pid, SIGTERM);
+
+    int status = 0;
+    assert(::waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // sockets and token are removed on exit
+    assert(::access(unixPath.c_str(), F_OK) != 0);
+    assert(::access(tokenPath.c_str(), F_OK) != 0);
+    ::rmdir(tmpDir);
+
+    carla_stdout("All tests passed");
+    return 0;
+}
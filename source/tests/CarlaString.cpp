@@ -15,6 +15,7 @@
  * For a full copy of the GNU General Public License see the doc/GPL.txt file.
  */
 
+#include "CarlaBase64Utils.hpp"
 #include "CarlaString.hpp"
 
 int main()
@@ -239,6 +240,31 @@ int main()
 
     carla_stdout("FINAL: \"%s\"", str5.buffer());
 
+    // base64, all padding variants
+    {
+        const char* const kRaw = "Carla base64 test";
+
+        for (std::size_t i=0; i <= 4; ++i)
+        {
+            const std::size_t size(std::strlen(kRaw)-i);
+            const CarlaString b64(CarlaString::asBase64(kRaw, size));
+            assert(b64.length() == ((size+2)/3)*4);
+
+            const std::vector<uint8_t> chunk(carla_getChunkFromBase64String(b64));
+            assert(chunk.size() == size);
+            assert(std::memcmp(chunk.data(), kRaw, size) == 0);
+        }
+
+        assert(CarlaString::asBase64("Man", 3) == "TWFu");
+        assert(CarlaString::asBase64("Ma", 2) == "TWE=");
+        assert(CarlaString::asBase64("M", 1) == "TQ==");
+
+        // whitespace and line breaks from XML are skipped, missing padding is fine
+        const std::vector<uint8_t> chunk(carla_getChunkFromBase64String(" Q2Fy\r\nbGEg\n YmFz\tZTY0IHRlc3Q"));
+        assert(chunk.size() == std::strlen(kRaw));
+        assert(std::memcmp(chunk.data(), kRaw, chunk.size()) == 0);
+    }
+
     // clear
     str.clear();
     assert(str.length() == 0);
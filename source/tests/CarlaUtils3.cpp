@@ -24,6 +24,7 @@
 #include "CarlaOscUtils.hpp"
 #include "CarlaPatchbayUtils.hpp"
 #include "CarlaShmUtils.hpp"
+#include "CarlaThread.hpp"
 
 // -----------------------------------------------------------------------
 
@@ -73,6 +74,39 @@ static void test_CarlaJuceUtils()
 
 typedef void (*nullFunc)();
 
+class LibCounterTestThread : public CarlaThread
+{
+public:
+    LibCounterTestThread(LibCounter& lc, const char* const filename) noexcept
+        : CarlaThread("LibCounterTestThread"),
+          ok(true),
+          fLibCounter(lc),
+          fFilename(filename) {}
+
+    bool ok;
+
+protected:
+    void run() override
+    {
+        for (int i=0; i < 1000; ++i)
+        {
+            void* const lib = fLibCounter.open(fFilename);
+
+            if (lib == nullptr)
+            {
+                ok = false;
+                continue;
+            }
+
+            fLibCounter.close(lib);
+        }
+    }
+
+private:
+    LibCounter& fLibCounter;
+    const char* const fFilename;
+};
+
 static void test_CarlaLibUtils() noexcept
 {
     void* const libNot = lib_open("/libzzzzz...");
@@ -108,6 +142,33 @@ static void test_CarlaLibUtils() noexcept
     assert(test4 == test5);
     lc.close(test5);
 
+    // test prewarm, stays open until released
+    const bool prewarmed = lc.prewarm("/usr/lib/liblo.so");
+    assert(prewarmed);
+    void* const test6 = lc.open("/usr/lib/liblo.so.0");
+    lc.releasePrewarmed();
+    void* const test7 = lc.open("/usr/lib/liblo.so");
+    assert(test6 == test7);
+    lc.close(test6); lc.close(test7);
+
+    // test opening and closing from many threads at once
+    {
+        LibCounterTestThread threads[4] = {
+            { lc, "/usr/lib/liblo.so" },
+            { lc, "/usr/lib/liblo.so.0" },
+            { lc, "/usr/lib/liblrdf.so.0" },
+            { lc, "/libzzzzz..." }
+        };
+
+        for (int i=0; i < 4; ++i)
+            threads[i].startThread();
+        for (int i=0; i < 4; ++i)
+            threads[i].stopThread(-1);
+
+        assert(threads[0].ok && threads[1].ok && threads[2].ok);
+        assert(! threads[3].ok);
+    }
+
     // open non-delete a few times, tests for cleanup on destruction
     lc.open("/usr/lib/liblrdf.so.0");
     lc.open("/usr/lib/liblrdf.so.0");
@@ -21,14 +21,149 @@
 
 #include "CarlaStateUtils.cpp"
 
+// -----------------------------------------------------------------------
+// binary project helpers
+
+using juce::File;
+using juce::FileOutputStream;
+using juce::MemoryBlock;
+using juce::String;
+using juce::XmlDocument;
+using juce::XmlElement;
+
+static void writeTestProject(const File& file, const std::vector<CarlaString>& chunks)
+{
+    FileOutputStream outStream(file);
+    assert(! outStream.failedToOpen());
+
+    outStream << "<!DOCTYPE CARLA-PROJECT>\n";
+    outStream << "<CARLA-PROJECT VERSION='2.0'>\n";
+
+    for (std::size_t i=0; i < chunks.size(); ++i)
+    {
+        outStream << " <Plugin>\n";
+        outStream << "  <Info>\n";
+        outStream << "   <Type>VST2</Type>\n";
+        outStream << "   <Name>Test " << String(static_cast<int>(i)) << "</Name>\n";
+        outStream << "  </Info>\n";
+        outStream << "  <Data>\n";
+        outStream << "   <Chunk>\n" << chunks[i].buffer() << "\n</Chunk>\n";
+        outStream << "  </Data>\n";
+        outStream << " </Plugin>\n";
+    }
+
+    outStream << "</CARLA-PROJECT>\n";
+    outStream.flush();
+}
+
+static std::vector<std::vector<uint8_t> > readTestProjectChunks(const File& file)
+{
+    XmlDocument xmlDoc(file);
+    juce::ScopedPointer<XmlElement> xmlElement(xmlDoc.getDocumentElement(false));
+    assert(xmlElement != nullptr);
+
+    std::vector<std::vector<uint8_t> > chunks;
+
+    for (XmlElement* plugin = xmlElement->getFirstChildElement(); plugin != nullptr; plugin = plugin->getNextElement())
+    {
+        XmlElement* const data(plugin->getChildByName("Data"));
+        assert(data != nullptr);
+
+        XmlElement* const chunk(data->getChildByName("Chunk"));
+        assert(chunk != nullptr);
+
+        chunks.push_back(carla_getChunkFromBase64String(chunk->getAllSubText().trim().toRawUTF8()));
+    }
+
+    return chunks;
+}
+
 // -----------------------------------------------------------------------
 // main
 
 int main()
 {
-    CarlaBackend::StateSave save;
+    CarlaBackend::CarlaStateSave save;
     save.type = carla_strdup("NONE");
-    carla_stdout(save.toString().toRawUTF8());
+
+    {
+        juce::MemoryOutputStream stream;
+        save.dumpToMemoryStream(stream);
+        carla_stdout(stream.toString().toRawUTF8());
+    }
+
+    // -------------------------------------------------------------------
+    // XML -> binary -> XML round-trip
+
+    const File tmpDir(File::getSpecialLocation(File::tempDirectory).getChildFile("carla-utils4-test"));
+    tmpDir.deleteRecursively();
+    assert(tmpDir.createDirectory());
+
+    const File xmlFile(tmpDir.getChildFile("project.carxp"));
+    const File binFile(tmpDir.getChildFile("project.carbp"));
+    const File outFile(tmpDir.getChildFile("project-out.carxp"));
+
+    // compressible, random (stored raw), duplicated and empty chunks
+    std::vector<std::vector<uint8_t> > chunks(4);
+    chunks[0].assign(256*1024, 0x5a);
+    chunks[1].resize(4096);
+    for (std::size_t i=0; i < chunks[1].size(); ++i)
+        chunks[1][i] = static_cast<uint8_t>((i * 2654435761U) >> 13);
+    chunks[2] = chunks[0];
+
+    std::vector<CarlaString> base64Chunks;
+    for (std::size_t i=0; i < chunks.size(); ++i)
+        base64Chunks.push_back(CarlaString::asBase64(chunks[i].data(), chunks[i].size()));
+
+    writeTestProject(xmlFile, base64Chunks);
+
+    for (int compress=0; compress < 2; ++compress)
+    {
+        assert(CarlaBackend::carla_convertProjectToBinary(xmlFile, binFile, compress != 0));
+        assert(CarlaBackend::CarlaStateChunkStore::isBinaryProjectFile(binFile));
+        assert(! CarlaBackend::CarlaStateChunkStore::isBinaryProjectFile(xmlFile));
+
+        // duplicated chunk is only stored once
+        if (compress != 0)
+            assert(binFile.getSize() < 64*1024);
+        else
+            assert(binFile.getSize() < 2*256*1024);
+
+        assert(CarlaBackend::carla_convertProjectToXml(binFile, outFile));
+        assert(readTestProjectChunks(outFile) == chunks);
+    }
+
+    // -------------------------------------------------------------------
+    // invalid decompressed sizes are rejected
+
+    {
+        MemoryBlock data;
+        assert(binFile.loadFileAsData(data));
+
+        // first chunk table entry size field, after the 24 byte header and 16 bytes of offset and stored size
+        uint8_t* const dataSize(static_cast<uint8_t*>(data.getData()) + 24 + 16);
+
+        const File badFile(tmpDir.getChildFile("project-bad.carbp"));
+
+        // over the compression ratio limit
+        const uint64_t storedSize(juce::ByteOrder::littleEndianInt64(dataSize-8));
+        const uint64_t tooBig(storedSize * 2000);
+
+        for (int i=0; i < 8; ++i)
+            dataSize[i] = static_cast<uint8_t>(tooBig >> (i*8));
+
+        assert(badFile.replaceWithData(data.getData(), data.getSize()));
+        assert(! CarlaBackend::carla_convertProjectToXml(badFile, outFile));
+
+        // over the maximum chunk size too
+        for (int i=0; i < 8; ++i)
+            dataSize[i] = (i == 4) ? 0x01 : 0x00;
+
+        assert(badFile.replaceWithData(data.getData(), data.getSize()));
+        assert(! CarlaBackend::carla_convertProjectToXml(badFile, outFile));
+    }
+
+    tmpDir.deleteRecursively();
 
     return 0;
 }
@@ -0,0 +1,496 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// Engine benchmark, builds a rack or patchbay graph out of internal plugins and
+// renders it with the offline engine, without an audio device.
+//
+// Input audio and MIDI files are generated from a fixed seed before rendering, so two runs
+// with the same arguments process exactly the same data and can be compared against each other.
+//
+// usage: EngineBenchmark [--mode=rack|patchbay] [--topology=serial|parallel]
+//                        [--plugins=N] [--labels=bypass,lfo,...] [--buffer-size=N]
+//                        [--sample-rate=N] [--blocks=N] [--warmup=N] [--seed=N]
+
+#include "../backend/engine/CarlaEngineGraph.hpp"
+
+#include "CarlaPlugin.hpp"
+
+#include "CarlaMIDI.h"
+#include "CarlaUtils.hpp"
+
+#include "juce_audio_formats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <string>
+#include <vector>
+
+using juce::AudioFormatWriter;
+using juce::AudioSampleBuffer;
+using juce::File;
+using juce::FileOutputStream;
+using juce::MidiFile;
+using juce::MidiMessage;
+using juce::MidiMessageSequence;
+using juce::ScopedPointer;
+using juce::StringPairArray;
+using juce::WavAudioFormat;
+
+// -----------------------------------------------------------------------
+// allocation counter, only active on the rendering thread while counting
+
+static std::atomic<bool> gCountAllocations(false);
+static std::atomic<uint64_t> gAllocationCount(0);
+static thread_local bool tIsRenderThread = false;
+
+void* operator new(std::size_t size)
+{
+    if (tIsRenderThread && gCountAllocations.load(std::memory_order_relaxed))
+        gAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+    if (void* const ptr = std::malloc(size != 0 ? size : 1))
+        return ptr;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+// -----------------------------------------------------------------------
+
+CARLA_BACKEND_USE_NAMESPACE
+
+static const uint kBenchAudioIns  = 2;
+static const uint kBenchAudioOuts = 2;
+
+// same values as in CarlaEngineGraph.cpp
+static const uint kBenchAudioInputPortOffset  = MAX_PATCHBAY_PLUGINS*1;
+static const uint kBenchAudioOutputPortOffset = MAX_PATCHBAY_PLUGINS*2;
+static const uint kBenchMidiInputPortOffset   = MAX_PATCHBAY_PLUGINS*3;
+static const uint kBenchMidiOutputPortOffset  = MAX_PATCHBAY_PLUGINS*3+1;
+
+// ticks per quarter note of the generated MIDI file, at the default 120 BPM
+static const int    kBenchMidiTicksPerQuarterNote = 9600;
+static const double kBenchMidiTicksPerSecond      = kBenchMidiTicksPerQuarterNote * 2.0;
+
+struct BenchmarkOptions {
+    bool patchbay;
+    bool parallel;
+    uint plugins;
+    const char* labels;
+    uint32_t bufferSize;
+    uint32_t sampleRate;
+    uint blocks;
+    uint warmup;
+    uint32_t seed;
+
+    BenchmarkOptions() noexcept
+        : patchbay(false),
+          parallel(false),
+          plugins(8),
+          labels("bypass,midithrough,lfo"),
+          bufferSize(256),
+          sampleRate(48000),
+          blocks(20000),
+          warmup(200),
+          seed(1) {}
+};
+
+// patchbay groups of the engine inputs and outputs, taken from the engine callbacks
+struct BenchmarkGroups {
+    uint audioIn, audioOut, midiIn;
+
+    BenchmarkGroups() noexcept
+        : audioIn(0),
+          audioOut(0),
+          midiIn(0) {}
+};
+
+static void engineCallback(void* ptr, EngineCallbackOpcode action, uint pluginId, int value1, int, float, const char* valueStr)
+{
+    if (action != ENGINE_CALLBACK_PATCHBAY_CLIENT_ADDED || value1 != PATCHBAY_ICON_HARDWARE || valueStr == nullptr)
+        return;
+
+    BenchmarkGroups* const groups((BenchmarkGroups*)ptr);
+
+    /**/ if (std::strcmp(valueStr, "Audio Input") == 0)
+        groups->audioIn = pluginId;
+    else if (std::strcmp(valueStr, "Audio Output") == 0)
+        groups->audioOut = pluginId;
+    else if (std::strcmp(valueStr, "Midi Input") == 0)
+        groups->midiIn = pluginId;
+}
+
+// -----------------------------------------------------------------------
+// input files
+
+// deterministic white noise in [-1, 1)
+static float nextRandom(uint32_t& state) noexcept
+{
+    state = state * 1664525U + 1013904223U;
+    return static_cast<float>(state >> 8) / static_cast<float>(1U << 23) - 1.0f;
+}
+
+static bool writeInputAudio(const File& file, const BenchmarkOptions& opts)
+{
+    FileOutputStream* const stream(file.createOutputStream());
+    CARLA_SAFE_ASSERT_RETURN(stream != nullptr, false);
+
+    WavAudioFormat wav;
+    ScopedPointer<AudioFormatWriter> writer(wav.createWriterFor(stream, opts.sampleRate, kBenchAudioOuts, 32, StringPairArray(), 0));
+
+    if (writer == nullptr)
+    {
+        delete stream;
+        return false;
+    }
+
+    AudioSampleBuffer buffer(static_cast<int>(kBenchAudioIns), static_cast<int>(opts.bufferSize));
+    uint32_t state(opts.seed);
+
+    for (uint i=0; i < opts.blocks; ++i)
+    {
+        for (uint j=0; j < kBenchAudioIns; ++j)
+        {
+            float* const buf(buffer.getWritePointer(static_cast<int>(j)));
+
+            for (uint32_t k=0; k < opts.bufferSize; ++k)
+                buf[k] = nextRandom(state) * 0.25f;
+        }
+
+        if (! writer->writeFromAudioSampleBuffer(buffer, 0, static_cast<int>(opts.bufferSize)))
+            return false;
+    }
+
+    return true;
+}
+
+static bool writeInputMidi(const File& file, const BenchmarkOptions& opts)
+{
+    MidiMessageSequence seq;
+
+    // a note on and a note off every 8 blocks, plus a controller every block
+    for (uint i=0; i < opts.blocks; ++i)
+    {
+        const double blockStart(static_cast<double>(i) * opts.bufferSize / opts.sampleRate);
+        const double frameTime(1.0 / opts.sampleRate);
+        const int note(36 + static_cast<int>((i/8) % 48));
+
+        if (i % 8 == 0)
+            seq.addEvent(MidiMessage::noteOn(1, note, static_cast<juce::uint8>(100)), blockStart * kBenchMidiTicksPerSecond);
+        else if (i % 8 == 4)
+            seq.addEvent(MidiMessage::noteOff(1, note), (blockStart + frameTime * (opts.bufferSize/2)) * kBenchMidiTicksPerSecond);
+
+        seq.addEvent(MidiMessage::controllerEvent(1, MIDI_CONTROL_MODULATION_WHEEL, static_cast<int>(i % 128)),
+                     (blockStart + frameTime * (opts.bufferSize*3/4)) * kBenchMidiTicksPerSecond);
+    }
+
+    seq.updateMatchedPairs();
+
+    MidiFile midi;
+    midi.setTicksPerQuarterNote(kBenchMidiTicksPerQuarterNote);
+    midi.addTrack(seq);
+
+    FileOutputStream stream(file);
+    return stream.openedOk() && midi.writeTo(stream);
+}
+
+// -----------------------------------------------------------------------
+// graph
+
+static bool buildGraph(CarlaEngine* const engine, const BenchmarkOptions& opts, const BenchmarkGroups& groups)
+{
+    std::vector<std::string> labels;
+
+    for (const char* label = opts.labels;;)
+    {
+        const char* const sep(std::strchr(label, ','));
+
+        if (sep == nullptr)
+        {
+            labels.push_back(label);
+            break;
+        }
+
+        labels.push_back(std::string(label, static_cast<std::size_t>(sep - label)));
+        label = sep + 1;
+    }
+
+    for (uint i=0; i < opts.plugins; ++i)
+    {
+        const char* const label(labels[i % labels.size()].c_str());
+
+        if (! engine->addPlugin(PLUGIN_INTERNAL, nullptr, label, label, 0, nullptr))
+        {
+            carla_stderr("Failed to add plugin '%s': %s", label, engine->getLastError());
+            return false;
+        }
+    }
+
+    if (! opts.patchbay)
+    {
+        // the rack processes plugins in order, only the outer connections are needed
+        return engine->patchbayConnect(kExternalGraphGroupAudioIn,  1, kExternalGraphGroupCarla, kExternalGraphCarlaPortAudioIn1)
+            && engine->patchbayConnect(kExternalGraphGroupAudioIn,  2, kExternalGraphGroupCarla, kExternalGraphCarlaPortAudioIn2)
+            && engine->patchbayConnect(kExternalGraphGroupCarla, kExternalGraphCarlaPortAudioOut1, kExternalGraphGroupAudioOut, 1)
+            && engine->patchbayConnect(kExternalGraphGroupCarla, kExternalGraphCarlaPortAudioOut2, kExternalGraphGroupAudioOut, 2);
+    }
+
+    CARLA_SAFE_ASSERT_RETURN(groups.audioIn != 0 && groups.audioOut != 0 && groups.midiIn != 0, false);
+
+    uint audioSrcNode  = groups.audioIn;
+    uint audioSrcCount = kBenchAudioIns;
+    uint midiSrcNode   = groups.midiIn;
+
+    for (uint i=0, count=engine->getCurrentPluginCount(); i < count; ++i)
+    {
+        CarlaPlugin* const plugin(engine->getPlugin(i));
+        CARLA_SAFE_ASSERT_RETURN(plugin != nullptr, false);
+
+        const uint node(plugin->getPatchbayNodeId());
+
+        if (plugin->getMidiInCount() > 0)
+        {
+            if (! engine->patchbayConnect(midiSrcNode, kBenchMidiOutputPortOffset, node, kBenchMidiInputPortOffset))
+                return false;
+            if (plugin->getMidiOutCount() > 0 && ! opts.parallel)
+                midiSrcNode = node;
+        }
+
+        const uint audioIns(plugin->getAudioInCount());
+        const uint audioOuts(plugin->getAudioOutCount());
+
+        for (uint j=0; j < audioIns && audioSrcCount > 0; ++j)
+        {
+            if (! engine->patchbayConnect(audioSrcNode, kBenchAudioOutputPortOffset + j % audioSrcCount, node, kBenchAudioInputPortOffset + j))
+                return false;
+        }
+
+        if (audioOuts == 0)
+            continue;
+
+        if (opts.parallel)
+        {
+            // every plugin goes straight to the outputs
+            for (uint j=0; j < kBenchAudioOuts; ++j)
+            {
+                if (! engine->patchbayConnect(node, kBenchAudioOutputPortOffset + j % audioOuts, groups.audioOut, kBenchAudioInputPortOffset + j))
+                    return false;
+            }
+        }
+        else
+        {
+            audioSrcNode  = node;
+            audioSrcCount = audioOuts;
+        }
+    }
+
+    for (uint j=0; j < kBenchAudioOuts && ! opts.parallel; ++j)
+    {
+        if (! engine->patchbayConnect(audioSrcNode, kBenchAudioOutputPortOffset + j % audioSrcCount, groups.audioOut, kBenchAudioInputPortOffset + j))
+            return false;
+    }
+
+    return true;
+}
+
+// -----------------------------------------------------------------------
+
+static bool parseArg(const char* const arg, const char* const name, const char*& value)
+{
+    const std::size_t len(std::strlen(name));
+
+    if (std::strncmp(arg, name, len) != 0 || arg[len] != '=')
+        return false;
+
+    value = arg + len + 1;
+    return true;
+}
+
+static double percentile(const std::vector<double>& sorted, const double pct)
+{
+    const std::size_t index(static_cast<std::size_t>(pct / 100.0 * static_cast<double>(sorted.size() - 1) + 0.5));
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+// renders a number of blocks from the start of the input files, returns the allocations made
+static bool render(CarlaEngine* const engine, const BenchmarkOptions& opts, const File& dir, const uint blocks, uint64_t& allocations)
+{
+    const double seconds(static_cast<double>(blocks) * opts.bufferSize / opts.sampleRate);
+
+    gAllocationCount  = 0;
+    gCountAllocations = true;
+
+    const bool ok(engine->renderOffline(dir.getChildFile("output.wav").getFullPathName().toRawUTF8(),
+                                        dir.getChildFile("input.wav").getFullPathName().toRawUTF8(),
+                                        dir.getChildFile("input.mid").getFullPathName().toRawUTF8(),
+                                        seconds));
+
+    gCountAllocations = false;
+    allocations = gAllocationCount;
+
+    if (! ok)
+        carla_stderr("Failed to render: %s", engine->getLastError());
+
+    return ok;
+}
+
+int main(int argc, char* argv[])
+{
+    BenchmarkOptions opts;
+
+    for (int i=1; i < argc; ++i)
+    {
+        const char* value;
+
+        /**/ if (parseArg(argv[i], "--mode", value))
+            opts.patchbay = (std::strcmp(value, "patchbay") == 0);
+        else if (parseArg(argv[i], "--topology", value))
+            opts.parallel = (std::strcmp(value, "parallel") == 0);
+        else if (parseArg(argv[i], "--plugins", value))
+            opts.plugins = static_cast<uint>(std::atoi(value));
+        else if (parseArg(argv[i], "--labels", value))
+            opts.labels = value;
+        else if (parseArg(argv[i], "--buffer-size", value))
+            opts.bufferSize = static_cast<uint32_t>(std::atoi(value));
+        else if (parseArg(argv[i], "--sample-rate", value))
+            opts.sampleRate = static_cast<uint32_t>(std::atoi(value));
+        else if (parseArg(argv[i], "--blocks", value))
+            opts.blocks = static_cast<uint>(std::atoi(value));
+        else if (parseArg(argv[i], "--warmup", value))
+            opts.warmup = static_cast<uint>(std::atoi(value));
+        else if (parseArg(argv[i], "--seed", value))
+            opts.seed = static_cast<uint32_t>(std::atoi(value));
+        else
+        {
+            carla_stderr("Unknown argument '%s'", argv[i]);
+            return 1;
+        }
+    }
+
+    if (opts.bufferSize == 0 || opts.sampleRate == 0 || opts.blocks < 2)
+    {
+        carla_stderr("Invalid arguments");
+        return 1;
+    }
+
+    if (opts.plugins > (opts.patchbay ? MAX_PATCHBAY_PLUGINS - 4 : MAX_RACK_PLUGINS))
+    {
+        carla_stderr("Too many plugins for the selected mode");
+        return 1;
+    }
+
+    // generate input before anything is timed
+    const File dir(File::getSpecialLocation(File::tempDirectory).getNonexistentChildFile("carla-benchmark", ""));
+
+    if (! (dir.createDirectory() && writeInputAudio(dir.getChildFile("input.wav"), opts) && writeInputMidi(dir.getChildFile("input.mid"), opts)))
+    {
+        carla_stderr("Failed to write input files into '%s'", dir.getFullPathName().toRawUTF8());
+        dir.deleteRecursively();
+        return 1;
+    }
+
+    BenchmarkGroups groups;
+    ScopedPointer<CarlaEngine> engine(CarlaEngine::newOffline());
+
+    engine->setCallback(engineCallback, &groups);
+    engine->setOption(ENGINE_OPTION_PROCESS_MODE, opts.patchbay ? ENGINE_PROCESS_MODE_PATCHBAY : ENGINE_PROCESS_MODE_CONTINUOUS_RACK, nullptr);
+    engine->setOption(ENGINE_OPTION_AUDIO_BUFFER_SIZE, static_cast<int>(opts.bufferSize), nullptr);
+    engine->setOption(ENGINE_OPTION_AUDIO_SAMPLE_RATE, static_cast<int>(opts.sampleRate), nullptr);
+    engine->setOption(ENGINE_OPTION_PATH_RESOURCES, 0, "../../resources");
+
+    if (! engine->init("Benchmark"))
+    {
+        carla_stderr("Failed to init engine: %s", engine->getLastError());
+        dir.deleteRecursively();
+        return 1;
+    }
+
+    int ret = 1;
+    uint64_t warmupAllocations, setupAllocations, allocations;
+
+    // allocations made by the renders are counted on this thread only.
+    // a 1 block render tells how many of them come from opening and closing files.
+    tIsRenderThread = true;
+
+    if (! buildGraph(engine, opts, groups))
+    {
+        carla_stderr("Failed to build graph: %s", engine->getLastError());
+    }
+    else if ((opts.warmup == 0 || render(engine, opts, dir, opts.warmup, warmupAllocations))
+             && render(engine, opts, dir, 1, setupAllocations))
+    {
+        const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+
+        const bool ok(render(engine, opts, dir, opts.blocks, allocations));
+
+        const double total(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        const float* blockTimes;
+        const uint32_t blockCount(engine->getOfflineRenderBlockTimes(blockTimes));
+
+        if (ok && blockCount != 0)
+        {
+            std::vector<double> times(blockTimes, blockTimes + blockCount);
+            std::sort(times.begin(), times.end());
+
+            const double blockTime(1e6 * opts.bufferSize / opts.sampleRate);
+            const double frames(static_cast<double>(opts.blocks) * opts.bufferSize);
+
+            // the 1 block render processed one block too
+            allocations = allocations > setupAllocations ? allocations - setupAllocations : 0;
+
+            std::printf("mode: %s (%s), plugins: %u [%s], buffer size: %u, sample rate: %u, blocks: %u\n",
+                        opts.patchbay ? "patchbay" : "rack", opts.parallel ? "parallel" : "serial",
+                        opts.plugins, opts.labels, opts.bufferSize, opts.sampleRate, opts.blocks);
+            std::printf("block time (us): min %.2f, p50 %.2f, p90 %.2f, p99 %.2f, p99.9 %.2f, max %.2f (deadline %.2f)\n",
+                        times.front(), percentile(times, 50.0), percentile(times, 90.0), percentile(times, 99.0),
+                        percentile(times, 99.9), times.back(), blockTime);
+            std::printf("throughput: %.0f frames/s, %.2fx realtime (including file input and output)\n",
+                        frames / total, frames / total / opts.sampleRate);
+            std::printf("allocations: %llu (%.3f per block), plus %llu for opening and closing files\n",
+                        static_cast<unsigned long long>(allocations), static_cast<double>(allocations) / (opts.blocks - 1),
+                        static_cast<unsigned long long>(setupAllocations));
+            ret = 0;
+        }
+    }
+
+    tIsRenderThread = false;
+
+    engine->close();
+    engine = nullptr;
+
+    dir.deleteRecursively();
+    return ret;
+}
+
+// -----------------------------------------------------------------------
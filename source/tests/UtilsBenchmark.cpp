@@ -0,0 +1,495 @@
+/*
+ * Carla Tests
+ * Copyright (C) 2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+// Microbenchmarks for the utils containers and IPC primitives.
+//
+// Every benchmark runs for at least --time seconds (0.25 by default) and prints one
+// "name,value,unit" line, so results can be collected and compared over time.
+//
+// usage: UtilsBenchmark [--time=seconds] [name-filter]
+
+#include "CarlaBase64Utils.hpp"
+#include "CarlaBridgeUtils.hpp"
+#include "CarlaPipeUtils.hpp"
+#include "CarlaRingBuffer.hpp"
+#include "CarlaSemUtils.hpp"
+#include "CarlaShmUtils.hpp"
+#include "CarlaString.hpp"
+#include "LinkedList.hpp"
+#include "Lv2AtomRingBuffer.hpp"
+#include "RtLinkedList.hpp"
+
+#include <chrono>
+#include <thread>
+
+// -----------------------------------------------------------------------
+
+static double gMinTime = 0.25;
+static const char* gFilter = nullptr;
+
+static bool shouldRun(const char* const name)
+{
+    return (gFilter == nullptr || std::strstr(name, gFilter) != nullptr);
+}
+
+static void report(const char* const name, const double value, const char* const unit)
+{
+    std::printf("%s,%.2f,%s\n", name, value, unit);
+    std::fflush(stdout);
+}
+
+// runs 'func' in batches of 'batch' operations until enough time has passed, returns operations per second
+template <typename Func>
+static double runTimed(const uint64_t batch, Func func)
+{
+    // warmup
+    func(batch);
+
+    uint64_t ops = 0;
+    const std::chrono::steady_clock::time_point start(std::chrono::steady_clock::now());
+    double elapsed;
+
+    do {
+        func(batch);
+        ops += batch;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    } while (elapsed < gMinTime);
+
+    return static_cast<double>(ops) / elapsed;
+}
+
+// keep the compiler from optimizing results away
+static volatile uint64_t gSink = 0;
+
+// -----------------------------------------------------------------------
+// ring buffers
+
+static void benchRingBuffers()
+{
+    if (shouldRun("ringbuffer.small.messages"))
+    {
+        CarlaSmallStackRingBuffer rb;
+
+        // same layout as a bridge parameter event
+        const double rate = runTimed(64, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+            {
+                rb.writeUInt(3);
+                rb.writeUInt(static_cast<uint32_t>(i));
+                rb.writeFloat(0.5f);
+                rb.commitWrite();
+            }
+            for (uint64_t i=0; i < count; ++i)
+            {
+                gSink += rb.readUInt();
+                gSink += rb.readUInt();
+                gSink += static_cast<uint64_t>(rb.readFloat());
+            }
+        });
+
+        report("ringbuffer.small.messages", rate, "msgs/s");
+    }
+
+    if (shouldRun("ringbuffer.heap.throughput"))
+    {
+        CarlaHeapRingBuffer rb;
+        rb.createBuffer(1024*1024);
+
+        uint8_t chunk[1024];
+        carla_zeroBytes(chunk, sizeof(chunk));
+
+        const double rate = runTimed(256, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+                rb.writeCustomData(chunk, sizeof(chunk));
+            rb.commitWrite();
+            for (uint64_t i=0; i < count; ++i)
+                rb.readCustomData(chunk, sizeof(chunk));
+            gSink += chunk[0];
+        });
+
+        report("ringbuffer.heap.throughput", rate * sizeof(chunk) / (1024.0*1024.0), "MB/s");
+        rb.deleteBuffer();
+    }
+
+    if (shouldRun("ringbuffer.lv2atom.messages"))
+    {
+        Lv2AtomRingBuffer rb;
+        rb.createBuffer(64*1024);
+
+        struct {
+            LV2_Atom atom;
+            uint8_t data[56];
+        } event;
+        carla_zeroStruct(event);
+        event.atom.size = sizeof(event.data);
+        event.atom.type = 1;
+
+        const double rate = runTimed(64, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+                rb.put(&event.atom, 0);
+
+            const LV2_Atom* atom;
+            uint32_t portIndex;
+
+            rb.tryLock();
+            while (rb.get(atom, portIndex))
+                gSink += atom->size;
+            rb.unlock();
+        });
+
+        report("ringbuffer.lv2atom.messages", rate, "msgs/s");
+    }
+}
+
+// -----------------------------------------------------------------------
+// linked lists
+
+struct BenchListData {
+    uint32_t id;
+    float value;
+    char pad[24];
+};
+
+static void benchLinkedLists()
+{
+    if (shouldRun("linkedlist.append-iterate-clear"))
+    {
+        LinkedList<BenchListData> list;
+        BenchListData data;
+        carla_zeroStruct(data);
+
+        const double rate = runTimed(256, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+            {
+                data.id = static_cast<uint32_t>(i);
+                list.append(data);
+            }
+            for (LinkedList<BenchListData>::Itenerator it = list.begin2(); it.valid(); it.next())
+                gSink += it.getValue(data).id;
+            list.clear();
+        });
+
+        report("linkedlist.append-iterate-clear", rate, "items/s");
+    }
+
+    if (shouldRun("rtlinkedlist.append-remove"))
+    {
+        RtLinkedList<BenchListData>::Pool pool(512, 1024);
+        RtLinkedList<BenchListData> list(pool);
+        BenchListData data, fallback;
+        carla_zeroStruct(data);
+        carla_zeroStruct(fallback);
+
+        const double rate = runTimed(256, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+            {
+                data.id = static_cast<uint32_t>(i);
+                list.append(data);
+            }
+            for (uint64_t i=0; i < count; ++i)
+                gSink += list.getFirst(fallback, true).id;
+        });
+
+        report("rtlinkedlist.append-remove", rate, "items/s");
+    }
+}
+
+// -----------------------------------------------------------------------
+// strings and base64
+
+static void benchStrings()
+{
+    if (shouldRun("string.build-compare"))
+    {
+        const double rate = runTimed(1024, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+            {
+                CarlaString str("Carla plugin ");
+                str += CarlaString(static_cast<int>(i));
+                str += ":audio-out1";
+                gSink += (str == "Carla plugin 0:audio-out1") ? 1 : str.length();
+            }
+        });
+
+        report("string.build-compare", rate, "ops/s");
+    }
+
+    uint8_t chunk[64*1024];
+
+    for (std::size_t i=0; i < sizeof(chunk); ++i)
+        chunk[i] = static_cast<uint8_t>(i*31 + 7);
+
+    if (shouldRun("base64.encode"))
+    {
+        const double rate = runTimed(4, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+                gSink += CarlaString::asBase64(chunk, sizeof(chunk)).length();
+        });
+
+        report("base64.encode", rate * sizeof(chunk) / (1024.0*1024.0), "MB/s");
+    }
+
+    if (shouldRun("base64.decode"))
+    {
+        const CarlaString encoded(CarlaString::asBase64(chunk, sizeof(chunk)));
+
+        const double rate = runTimed(4, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+                gSink += carla_getChunkFromBase64String(encoded.buffer()).size();
+        });
+
+        report("base64.decode", rate * sizeof(chunk) / (1024.0*1024.0), "MB/s");
+    }
+}
+
+// -----------------------------------------------------------------------
+// bridge semaphores, same shared memory layout and handshake as the RT bridge client
+
+static void benchBridgeSemaphores()
+{
+    if (! shouldRun("bridge.sem.roundtrip"))
+        return;
+
+    char shmName[] = PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT "XXXXXX";
+    carla_shm_t shm(carla_shm_create_temp(shmName));
+    CARLA_SAFE_ASSERT_RETURN(carla_is_shm_valid(shm),);
+
+    BridgeRtClientData* data = nullptr;
+
+    if (! carla_shm_map<BridgeRtClientData>(shm, data))
+    {
+        carla_shm_close(shm);
+        return;
+    }
+
+    carla_sem_t& semServer(*(carla_sem_t*)&data->sem.server);
+    carla_sem_t& semClient(*(carla_sem_t*)&data->sem.client);
+
+    carla_sem_create2(semServer);
+    carla_sem_create2(semClient);
+
+    volatile bool quit = false;
+
+    // client side, waits for the server and replies
+    std::thread client([&]() {
+        for (;;)
+        {
+            if (! carla_sem_timedwait(semServer, 5))
+                break;
+            if (quit)
+                break;
+            carla_sem_post(semClient);
+        }
+    });
+
+    const double rate = runTimed(256, [&](const uint64_t count) {
+        for (uint64_t i=0; i < count; ++i)
+        {
+            carla_sem_post(semServer);
+            carla_sem_timedwait(semClient, 5);
+        }
+    });
+
+    quit = true;
+    carla_sem_post(semServer);
+    client.join();
+
+    report("bridge.sem.roundtrip", rate, "roundtrips/s");
+    report("bridge.sem.latency", 1e6 / rate, "us");
+
+    carla_sem_destroy2(semServer);
+    carla_sem_destroy2(semClient);
+    carla_shm_unmap(shm, data);
+    carla_shm_close(shm);
+}
+
+// -----------------------------------------------------------------------
+// pipes, the client runs as a child process of this same binary
+
+static const uint kPipeBatchSize = 64;
+
+class BenchPipeClient : public CarlaPipeClient
+{
+public:
+    BenchPipeClient()
+        : CarlaPipeClient(),
+          fQuit(false) {}
+
+    bool shouldQuit() const noexcept
+    {
+        return fQuit;
+    }
+
+    bool msgReceived(const char* const msg) noexcept override
+    {
+        if (std::strcmp(msg, "ping") == 0)
+        {
+            const CarlaMutexLocker cml(getPipeLock());
+            writeMessage("pong\n");
+            flushMessages();
+            return true;
+        }
+
+        if (std::strcmp(msg, "control") == 0)
+        {
+            uint32_t index;
+            float value;
+
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsUInt(index), true);
+            CARLA_SAFE_ASSERT_RETURN(readNextLineAsFloat(value), true);
+            return true;
+        }
+
+        if (std::strcmp(msg, "quit") == 0)
+        {
+            fQuit = true;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    bool fQuit;
+};
+
+class BenchPipeServer : public CarlaPipeServer
+{
+public:
+    BenchPipeServer()
+        : CarlaPipeServer(),
+          fPongs(0) {}
+
+    void ping()
+    {
+        const uint64_t pongs(fPongs);
+
+        {
+            const CarlaMutexLocker cml(getPipeLock());
+            writeMessage("ping\n");
+            flushMessages();
+        }
+
+        while (fPongs == pongs && isPipeRunning())
+        {
+            idlePipe();
+            std::this_thread::yield();
+        }
+    }
+
+    bool msgReceived(const char* const msg) noexcept override
+    {
+        if (std::strcmp(msg, "pong") == 0)
+        {
+            ++fPongs;
+            return true;
+        }
+
+        return false;
+    }
+
+private:
+    uint64_t fPongs;
+};
+
+static int runPipeClient(const char* argv[])
+{
+    BenchPipeClient client;
+
+    if (! client.initPipeClient(argv))
+        return 1;
+
+    while (! client.shouldQuit() && client.isPipeRunning())
+    {
+        client.idlePipe();
+        std::this_thread::yield();
+    }
+
+    client.closePipeClient();
+    return 0;
+}
+
+static void benchPipes(const char* const binary)
+{
+    if (! shouldRun("pipe."))
+        return;
+
+    BenchPipeServer server;
+
+    if (! server.startPipeServer(binary, "pipe-client", "-"))
+    {
+        carla_stderr("Failed to start pipe client");
+        return;
+    }
+
+    if (shouldRun("pipe.roundtrip"))
+    {
+        const double rate = runTimed(64, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+                server.ping();
+        });
+
+        report("pipe.roundtrip", rate, "roundtrips/s");
+        report("pipe.latency", 1e6 / rate, "us");
+    }
+
+    if (shouldRun("pipe.messages"))
+    {
+        // messages are sent in batches followed by a ping, so the pipe never fills up
+        const double rate = runTimed(kPipeBatchSize, [&](const uint64_t count) {
+            for (uint64_t i=0; i < count; ++i)
+                server.writeControlMessage(static_cast<uint32_t>(i), 0.5f);
+            server.ping();
+        });
+
+        report("pipe.messages", rate, "msgs/s");
+    }
+
+    server.stopPipeServer(2000);
+}
+
+// -----------------------------------------------------------------------
+
+int main(int argc, const char* argv[])
+{
+    if (argc == 7 && std::strcmp(argv[1], "pipe-client") == 0)
+        return runPipeClient(argv);
+
+    for (int i=1; i < argc; ++i)
+    {
+        if (std::strncmp(argv[i], "--time=", 7) == 0)
+            gMinTime = std::atof(argv[i]+7);
+        else
+            gFilter = argv[i];
+    }
+
+    std::printf("benchmark,value,unit\n");
+
+    benchRingBuffers();
+    benchLinkedLists();
+    benchStrings();
+    benchBridgeSemaphores();
+    benchPipes(argv[0]);
+
+    return 0;
+}
+
+// -----------------------------------------------------------------------
+
+#include "../utils/CarlaPipeUtils.cpp"
+
+// -----------------------------------------------------------------------
@@ -280,6 +280,8 @@ const char* EngineCallbackOpcode2Str(const EngineCallbackOpcode opcode) noexcept
         return "ENGINE_CALLBACK_ERROR";
     case ENGINE_CALLBACK_QUIT:
         return "ENGINE_CALLBACK_QUIT";
+    case ENGINE_CALLBACK_PROJECT_SAVED:
+        return "ENGINE_CALLBACK_PROJECT_SAVED";
     }
 
     carla_stderr("CarlaBackend::EngineCallbackOpcode2Str(%i) - invalid opcode", opcode);
@@ -327,6 +329,24 @@ const char* EngineOption2Str(const EngineOption option) noexcept
         return "ENGINE_OPTION_PREVENT_BAD_BEHAVIOUR";
     case ENGINE_OPTION_FRONTEND_WIN_ID:
         return "ENGINE_OPTION_FRONTEND_WIN_ID";
+    case ENGINE_OPTION_MIN_SUB_BLOCK_SIZE:
+        return "ENGINE_OPTION_MIN_SUB_BLOCK_SIZE";
+    case ENGINE_OPTION_SHARE_PLUGIN_BRIDGES:
+        return "ENGINE_OPTION_SHARE_PLUGIN_BRIDGES";
+    case ENGINE_OPTION_CALLBACK_BATCH_INTERVAL:
+        return "ENGINE_OPTION_CALLBACK_BATCH_INTERVAL";
+    case ENGINE_OPTION_TELEMETRY:
+        return "ENGINE_OPTION_TELEMETRY";
+    case ENGINE_OPTION_TELEMETRY_SCOPE_SIZE:
+        return "ENGINE_OPTION_TELEMETRY_SCOPE_SIZE";
+    case ENGINE_OPTION_SKIP_SILENT_PLUGINS:
+        return "ENGINE_OPTION_SKIP_SILENT_PLUGINS";
+    case ENGINE_OPTION_SILENT_PLUGIN_TAIL:
+        return "ENGINE_OPTION_SILENT_PLUGIN_TAIL";
+    case ENGINE_OPTION_FLUSH_DENORMALS:
+        return "ENGINE_OPTION_FLUSH_DENORMALS";
+    case ENGINE_OPTION_ANTI_DENORMAL_OFFSET:
+        return "ENGINE_OPTION_ANTI_DENORMAL_OFFSET";
     }
 
     carla_stderr("CarlaBackend::EngineOption2Str(%i) - invalid option", option);
@@ -21,7 +21,6 @@
 
 #include "CarlaUtils.hpp"
 
-#include <cctype>
 #include <vector>
 
 // -----------------------------------------------------------------------
@@ -29,30 +28,41 @@
 
 namespace CarlaBase64Helpers {
 
-static const char* const kBase64Chars =
-    "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-    "abcdefghijklmnopqrstuvwxyz"
-    "0123456789+/";
+// reverse of "A-Za-z0-9+/", -1 for anything else
+static const int8_t kBase64DecodeTable[256] = {
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 62, -1, -1, -1, 63,
+    52, 53, 54, 55, 56, 57, 58, 59, 60, 61, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14,
+    15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25, -1, -1, -1, -1, -1,
+    -1, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40,
+    41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
+};
 
 static inline
-uint8_t findBase64CharIndex(const char c)
+int8_t getBase64CharIndex(const char c) noexcept
 {
-    static const uint8_t kBase64CharsLen(static_cast<uint8_t>(std::strlen(kBase64Chars)));
-
-    for (uint8_t i=0; i<kBase64CharsLen; ++i)
-    {
-        if (kBase64Chars[i] == c)
-            return i;
-    }
-
-    carla_stderr2("findBase64CharIndex('%c') - failed", c);
-    return 0;
+    return kBase64DecodeTable[static_cast<uint8_t>(c)];
 }
 
 static inline
-bool isBase64Char(const char c)
+void decodeBase64Quad(const int8_t* const quad, uint8_t* const out) noexcept
 {
-    return (std::isalnum(c) || (c == '+') || (c == '/'));
+    const uint value = static_cast<uint>(quad[0]) << 18 | static_cast<uint>(quad[1]) << 12
+                     | static_cast<uint>(quad[2]) << 6  | static_cast<uint>(quad[3]);
+
+    out[0] = static_cast<uint8_t>(value >> 16);
+    out[1] = static_cast<uint8_t>(value >> 8);
+    out[2] = static_cast<uint8_t>(value);
 }
 
 } // namespace CarlaBase64Helpers
@@ -64,57 +74,69 @@ std::vector<uint8_t> carla_getChunkFromBase64String(const char* const base64stri
 {
     CARLA_SAFE_ASSERT_RETURN(base64string != nullptr, std::vector<uint8_t>());
 
-    uint i=0, j=0;
-    uint charArray3[3], charArray4[4];
+    const std::size_t len = std::strlen(base64string);
+
+    std::vector<uint8_t> ret(len*3/4 + 3);
+    uint8_t* const retBuf = ret.data();
 
-    std::vector<uint8_t> ret;
-    ret.reserve(std::strlen(base64string)*3/4 + 4);
+    std::size_t l=0, r=0;
+    uint i=0;
+    int8_t quad[4];
 
-    for (std::size_t l=0, len=std::strlen(base64string); l<len; ++l)
+    for (; l < len;)
     {
-        const char c = base64string[l];
+        // fast path, 4 plain characters at once
+        if (i == 0 && l+4 <= len)
+        {
+            quad[0] = CarlaBase64Helpers::getBase64CharIndex(base64string[l]);
+            quad[1] = CarlaBase64Helpers::getBase64CharIndex(base64string[l+1]);
+            quad[2] = CarlaBase64Helpers::getBase64CharIndex(base64string[l+2]);
+            quad[3] = CarlaBase64Helpers::getBase64CharIndex(base64string[l+3]);
+
+            if ((quad[0] | quad[1] | quad[2] | quad[3]) >= 0)
+            {
+                CarlaBase64Helpers::decodeBase64Quad(quad, retBuf + r);
+                l += 4;
+                r += 3;
+                continue;
+            }
+        }
+
+        // slow path, whitespace, padding or invalid characters
+        const char c = base64string[l++];
 
-        if (c == '\0' || c == '=')
+        if (c == '=')
             break;
-        if (c == ' ' || c == '\n')
+        if (c == ' ' || c == '\n' || c == '\r' || c == '\t')
             continue;
 
-         CARLA_SAFE_ASSERT_CONTINUE(CarlaBase64Helpers::isBase64Char(c));
+        const int8_t index = CarlaBase64Helpers::getBase64CharIndex(c);
+        CARLA_SAFE_ASSERT_CONTINUE(index >= 0);
 
-        charArray4[i++] = static_cast<uint>(c);
+        quad[i++] = index;
 
         if (i == 4)
         {
-            for (i=0; i<4; ++i)
-                charArray4[i] = CarlaBase64Helpers::findBase64CharIndex(static_cast<char>(charArray4[i]));
-
-            charArray3[0] =  (charArray4[0] << 2)        + ((charArray4[1] & 0x30) >> 4);
-            charArray3[1] = ((charArray4[1] & 0xf) << 4) + ((charArray4[2] & 0x3c) >> 2);
-            charArray3[2] = ((charArray4[2] & 0x3) << 6) +   charArray4[3];
-
-            for (i=0; i<3; ++i)
-                ret.push_back(static_cast<uint8_t>(charArray3[i]));
-
+            CarlaBase64Helpers::decodeBase64Quad(quad, retBuf + r);
+            r += 3;
             i = 0;
         }
     }
 
-    if (i != 0)
+    // 2 or 3 leftover characters make 1 or 2 bytes
+    if (i > 1)
     {
-        for (j=0; j<i && j<4; ++j)
-            charArray4[j] = CarlaBase64Helpers::findBase64CharIndex(static_cast<char>(charArray4[j]));
-
-        for (j=i; j<4; ++j)
-            charArray4[j] = 0;
+        for (uint j=i; j<4; ++j)
+            quad[j] = 0;
 
-        charArray3[0] =  (charArray4[0] << 2)        + ((charArray4[1] & 0x30) >> 4);
-        charArray3[1] = ((charArray4[1] & 0xf) << 4) + ((charArray4[2] & 0x3c) >> 2);
-        charArray3[2] = ((charArray4[2] & 0x3) << 6) +   charArray4[3];
+        uint8_t tail[3];
+        CarlaBase64Helpers::decodeBase64Quad(quad, tail);
 
-        for (j=0; i>0 && j<i-1; j++)
-            ret.push_back(static_cast<uint8_t>(charArray3[j]));
+        for (uint j=0; j<i-1; ++j)
+            retBuf[r++] = tail[j];
     }
 
+    ret.resize(r);
     return ret;
 }
 
@@ -25,11 +25,13 @@
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "Global\\carla-bridge_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "Global\\carla-bridge_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "Global\\carla-bridge_shm_nonrtS_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_SHARED_HOST   "Global\\carla-bridge_shm_shH_"
 #else
 # define PLUGIN_BRIDGE_NAMEPREFIX_AUDIO_POOL    "/carla-bridge_shm_ap_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_RT_CLIENT     "/carla-bridge_shm_rtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_CLIENT "/carla-bridge_shm_nonrtC_"
 # define PLUGIN_BRIDGE_NAMEPREFIX_NON_RT_SERVER "/carla-bridge_shm_nonrtS_"
+# define PLUGIN_BRIDGE_NAMEPREFIX_SHARED_HOST   "/carla-bridge_shm_shH_"
 #endif
 
 // -----------------------------------------------------------------------
@@ -45,7 +47,9 @@ enum PluginBridgeRtClientOpcode {
     kPluginBridgeRtClientControlEventAllNotesOff, // uint/frame, byte/chan
     kPluginBridgeRtClientMidiEvent,               // uint/frame, byte/port, byte/size, byte[]/data
     kPluginBridgeRtClientProcess,
-    kPluginBridgeRtClientQuit
+    kPluginBridgeRtClientQuit,
+    kPluginBridgeRtClientSetRealtime,             // int/priority, ulong/affinity
+    kPluginBridgeRtClientProcessChain             // uint/count, count * char[6] (rt client shm id), process then run the plugins of those ids in order
 };
 
 // Server sends these to client during non-RT
@@ -109,6 +113,13 @@ enum PluginBridgeNonRtServerOpcode {
     kPluginBridgeNonRtServerError               // uint/size, str[]
 };
 
+// Server sends these to a shared bridge process, which hosts many plugins (non-RT)
+enum PluginBridgeSharedHostOpcode {
+    kPluginBridgeSharedHostNull = 0,
+    kPluginBridgeSharedHostAddPlugin, // uint/size, str[] (shm ids), uint/type, long/uniqueId, uint/size, str[] (filename), uint/size, str[] (label), uint/count, count * (uint/size, str[] (env key), uint/size, str[] (env value))
+    kPluginBridgeSharedHostQuit
+};
+
 // -----------------------------------------------------------------------
 
 struct BridgeSemaphore {
@@ -156,6 +167,11 @@ struct BridgeNonRtServerData {
     HugeStackBuffer ringBuffer;
 };
 
+// Server => Shared bridge process Non-RT
+struct BridgeSharedHostData {
+    BigStackBuffer ringBuffer;
+};
+
 // -----------------------------------------------------------------------
 
 static inline
@@ -183,6 +199,10 @@ const char* PluginBridgeRtClientOpcode2str(const PluginBridgeRtClientOpcode opco
         return "kPluginBridgeRtClientProcess";
     case kPluginBridgeRtClientQuit:
         return "kPluginBridgeRtClientQuit";
+    case kPluginBridgeRtClientSetRealtime:
+        return "kPluginBridgeRtClientSetRealtime";
+    case kPluginBridgeRtClientProcessChain:
+        return "kPluginBridgeRtClientProcessChain";
     }
 
     carla_stderr("CarlaBackend::PluginBridgeRtClientOpcode2str(%i) - invalid opcode", opcode);
@@ -317,6 +337,23 @@ const char* PluginBridgeNonRtServerOpcode2str(const PluginBridgeNonRtServerOpcod
     return nullptr;
 }
 
+static inline
+const char* PluginBridgeSharedHostOpcode2str(const PluginBridgeSharedHostOpcode opcode) noexcept
+{
+    switch (opcode)
+    {
+    case kPluginBridgeSharedHostNull:
+        return "kPluginBridgeSharedHostNull";
+    case kPluginBridgeSharedHostAddPlugin:
+        return "kPluginBridgeSharedHostAddPlugin";
+    case kPluginBridgeSharedHostQuit:
+        return "kPluginBridgeSharedHostQuit";
+    }
+
+    carla_stderr("CarlaBackend::PluginBridgeSharedHostOpcode2str(%i) - invalid opcode", opcode);
+    return nullptr;
+}
+
 // -----------------------------------------------------------------------
 
 #endif // CARLA_BRIDGE_UTILS_HPP_INCLUDED
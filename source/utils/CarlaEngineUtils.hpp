@@ -51,6 +51,8 @@ const char* EngineType2Str(const EngineType type) noexcept
         return "kEngineTypePlugin";
     case kEngineTypeBridge:
         return "kEngineTypeBridge";
+    case kEngineTypeOffline:
+        return "kEngineTypeOffline";
     }
 
     carla_stderr("CarlaBackend::EngineType2Str(%i) - invalid type", type);
@@ -22,93 +22,130 @@
 #include "CarlaMutex.hpp"
 #include "LinkedList.hpp"
 
+#ifndef CARLA_OS_WIN
+# include <sys/stat.h>
+#endif
+
 // -----------------------------------------------------------------------
+// Reference counted library loader, safe to use from many threads at once.
+// Libraries are kept in a hash table of independently locked buckets, keyed by file identity.
+// Opening the same library from several threads calls lib_open once, the others wait for it.
+// Opening different libraries never waits on each other.
 
 class LibCounter
 {
 public:
     LibCounter() noexcept
-        : fMutex(),
-          fLibs() {}
+        : fPrewarmMutex(),
+          fPrewarmed() {}
 
     ~LibCounter() noexcept
     {
+        releasePrewarmed();
+
         // might have some leftovers
-        for (LinkedList<Lib>::Itenerator it = fLibs.begin2(); it.valid(); it.next())
+        for (uint i=0; i < kBucketCount; ++i)
         {
-            static Lib libFallback = { nullptr, nullptr, 0, false };
+            Bucket& bucket(fBuckets[i]);
+            const CarlaMutexLocker cml(bucket.mutex);
 
-            Lib& lib(it.getValue(libFallback));
-            CARLA_SAFE_ASSERT_CONTINUE(lib.count > 0);
-            CARLA_SAFE_ASSERT_CONTINUE(lib.lib != nullptr);
-
-            // all libs should be closed by now except those explicitly marked non-delete
-            CARLA_SAFE_ASSERT(! lib.canDelete);
+            for (LinkedList<Lib*>::Itenerator it = bucket.libs.begin2(); it.valid(); it.next())
+            {
+                Lib* const lib(it.getValue(nullptr));
+                CARLA_SAFE_ASSERT_CONTINUE(lib != nullptr);
+                CARLA_SAFE_ASSERT(lib->count > 0);
 
-            if (! lib_close(lib.lib))
-                carla_stderr("LibCounter cleanup failed, reason:\n%s", lib_error(lib.filename));
+                // all libs should be closed by now except those explicitly marked non-delete
+                CARLA_SAFE_ASSERT(! lib->canDelete);
 
-            lib.lib = nullptr;
+                if (lib->getLib() != nullptr && ! lib_close(lib->getLib()))
+                    carla_stderr("LibCounter cleanup failed, reason:\n%s", lib_error(lib->filename));
 
-            if (lib.filename != nullptr)
-            {
-                delete[] lib.filename;
-                lib.filename = nullptr;
+                delete lib;
             }
-        }
 
-        fLibs.clear();
+            bucket.libs.clear();
+        }
     }
 
     lib_t open(const char* const filename, const bool canDelete = true) noexcept
     {
         CARLA_SAFE_ASSERT_RETURN(filename != nullptr && filename[0] != '\0', nullptr);
 
-        // try duplicating filename first, it can throw
-        const char* dfilename = nullptr;
+        Key key;
+        getKey(filename, key);
 
-        try {
-            dfilename = carla_strdup(filename);
-        } CARLA_SAFE_EXCEPTION_RETURN("LibCounter::open", nullptr);
+        Bucket& bucket(fBuckets[key.hash % kBucketCount]);
 
-        const CarlaMutexLocker cml(fMutex);
-
-        for (LinkedList<Lib>::Itenerator it = fLibs.begin2(); it.valid(); it.next())
+        // if someone else failed to open the library, try again once, so that lib_error() works in this thread
+        for (int attempt = 0; attempt < 2; ++attempt)
         {
-            static Lib libFallback = { nullptr, nullptr, 0, false };
-
-            Lib& lib(it.getValue(libFallback));
-            CARLA_SAFE_ASSERT_CONTINUE(lib.count > 0);
-            CARLA_SAFE_ASSERT_CONTINUE(lib.filename != nullptr);
+            Lib* lib = nullptr;
+            bool isOpener = false;
 
-            if (std::strcmp(lib.filename, filename) == 0)
             {
-                // will not be needed
-                delete[] dfilename;
+                const CarlaMutexLocker cml(bucket.mutex);
 
-                ++lib.count;
-                return lib.lib;
+                for (LinkedList<Lib*>::Itenerator it = bucket.libs.begin2(); it.valid(); it.next())
+                {
+                    Lib* const lib2(it.getValue(nullptr));
+                    CARLA_SAFE_ASSERT_CONTINUE(lib2 != nullptr);
+                    CARLA_SAFE_ASSERT_CONTINUE(lib2->count > 0);
+
+                    if (! lib2->isFailed() && lib2->matches(key, filename))
+                    {
+                        lib = lib2;
+                        break;
+                    }
+                }
+
+                if (lib != nullptr)
+                {
+                    ++lib->count;
+                }
+                else
+                {
+                    try {
+                        lib = new Lib(filename, key, canDelete);
+                    } CARLA_SAFE_EXCEPTION_RETURN("LibCounter::open", nullptr);
+
+                    if (! bucket.libs.append(lib))
+                    {
+                        delete lib;
+                        return nullptr;
+                    }
+
+                    // others opening the same library wait until we're done
+                    lib->openMutex.lock();
+                    isOpener = true;
+                }
             }
-        }
 
-        const lib_t libPtr(lib_open(filename));
+            lib_t libPtr;
 
-        if (libPtr == nullptr)
-        {
-            delete[] dfilename;
-            return nullptr;
-        }
+            if (isOpener)
+            {
+                libPtr = lib_open(filename);
+                lib->setOpened(libPtr);
+                lib->openMutex.unlock();
+            }
+            else
+            {
+                lib->openMutex.lock();
+                libPtr = lib->getLib();
+                lib->openMutex.unlock();
+            }
 
-        Lib lib;
-        lib.lib       = libPtr;
-        lib.filename  = dfilename;
-        lib.count     = 1;
-        lib.canDelete = canDelete;
+            if (libPtr != nullptr)
+                return libPtr;
 
-        if (fLibs.append(lib))
-            return libPtr;
+            // drop our reference to the failed library, nothing to close
+            release(bucket, lib);
+
+            if (isOpener)
+                break;
+        }
 
-        delete[] dfilename;
         return nullptr;
     }
 
@@ -116,55 +153,227 @@ public:
     {
         CARLA_SAFE_ASSERT_RETURN(libPtr != nullptr, false);
 
-        const CarlaMutexLocker cml(fMutex);
-
-        for (LinkedList<Lib>::Itenerator it = fLibs.begin2(); it.valid(); it.next())
+        for (uint i=0; i < kBucketCount; ++i)
         {
-            static Lib libFallback = { nullptr, nullptr, 0, false };
+            Bucket& bucket(fBuckets[i]);
+            Lib* lib = nullptr;
+            bool found = false;
+
+            {
+                const CarlaMutexLocker cml(bucket.mutex);
 
-            Lib& lib(it.getValue(libFallback));
-            CARLA_SAFE_ASSERT_CONTINUE(lib.count > 0);
-            CARLA_SAFE_ASSERT_CONTINUE(lib.lib != nullptr);
+                for (LinkedList<Lib*>::Itenerator it = bucket.libs.begin2(); it.valid(); it.next())
+                {
+                    Lib* const lib2(it.getValue(nullptr));
+                    CARLA_SAFE_ASSERT_CONTINUE(lib2 != nullptr);
+                    CARLA_SAFE_ASSERT_CONTINUE(lib2->count > 0);
 
-            if (lib.lib != libPtr)
-                continue;
+                    if (lib2->getLib() != libPtr)
+                        continue;
 
-            if (lib.count == 1 && ! lib.canDelete)
-                return true;
+                    found = true;
 
-            if (--lib.count == 0)
-            {
-                if (! lib_close(lib.lib))
-                    carla_stderr("LibCounter::close() failed, reason:\n%s", lib_error(lib.filename));
+                    if (lib2->count == 1 && ! lib2->canDelete)
+                        break;
 
-                lib.lib = nullptr;
+                    if (--lib2->count == 0)
+                    {
+                        lib = lib2;
+                        bucket.libs.remove(it);
+                    }
 
-                if (lib.filename != nullptr)
-                {
-                    delete[] lib.filename;
-                    lib.filename = nullptr;
+                    break;
                 }
-
-                fLibs.remove(it);
             }
 
-            return true;
+            if (! found)
+                continue;
+
+            // last reference, close outside the lock
+            return (lib == nullptr) || closeLib(lib);
         }
 
         carla_safe_assert("invalid lib pointer", __FILE__, __LINE__);
         return false;
     }
 
+    /*
+     * Open a library ahead of time, from any thread.
+     * It stays open until releasePrewarmed() is called, so that opening it later is fast.
+     */
+    bool prewarm(const char* const filename) noexcept
+    {
+        const lib_t libPtr(open(filename));
+
+        if (libPtr == nullptr)
+            return false;
+
+        {
+            const CarlaMutexLocker cml(fPrewarmMutex);
+
+            if (fPrewarmed.append(libPtr))
+                return true;
+        }
+
+        close(libPtr);
+        return false;
+    }
+
+    /*
+     * Close all libraries opened by prewarm(), those in use stay open.
+     */
+    void releasePrewarmed() noexcept
+    {
+        for (lib_t fallback = nullptr;;)
+        {
+            lib_t libPtr;
+
+            {
+                const CarlaMutexLocker cml(fPrewarmMutex);
+
+                if (fPrewarmed.isEmpty())
+                    break;
+
+                libPtr = fPrewarmed.getFirst(fallback, true);
+            }
+
+            CARLA_SAFE_ASSERT_CONTINUE(libPtr != nullptr);
+
+            close(libPtr);
+        }
+    }
+
 private:
+    static const uint kBucketCount = 64;
+
+    // file identity, device and inode when available, filename otherwise
+    struct Key {
+        uint64_t device;
+        uint64_t inode;
+        uint hash;
+    };
+
     struct Lib {
-        lib_t lib;
+        lib_t lib;      // set once by the first opener, atomic access only
         const char* filename;
-        int count;
+        Key key;
+        int count;      // protected by the bucket mutex
         bool canDelete;
+        bool failed;    // set once by the first opener, atomic access only
+        CarlaMutex openMutex;
+
+        Lib(const char* const fname, const Key& k, const bool canDel)
+            : lib(nullptr),
+              filename(carla_strdup(fname)),
+              key(k),
+              count(1),
+              canDelete(canDel),
+              failed(false),
+              openMutex() {}
+
+        ~Lib() noexcept
+        {
+            if (filename != nullptr)
+            {
+                delete[] filename;
+                filename = nullptr;
+            }
+        }
+
+        lib_t getLib() const noexcept
+        {
+            return __atomic_load_n(&lib, __ATOMIC_ACQUIRE);
+        }
+
+        bool isFailed() const noexcept
+        {
+            return __atomic_load_n(&failed, __ATOMIC_ACQUIRE);
+        }
+
+        void setOpened(const lib_t libPtr) noexcept
+        {
+            __atomic_store_n(&failed, libPtr == nullptr, __ATOMIC_RELEASE);
+            __atomic_store_n(&lib, libPtr, __ATOMIC_RELEASE);
+        }
+
+        bool matches(const Key& k, const char* const fname) const noexcept
+        {
+            if (key.inode != 0 || k.inode != 0)
+                return key.device == k.device && key.inode == k.inode;
+
+            return std::strcmp(filename, fname) == 0;
+        }
+
+        CARLA_DECLARE_NON_COPY_STRUCT(Lib)
     };
 
-    CarlaMutex fMutex;
-    LinkedList<Lib> fLibs;
+    struct Bucket {
+        CarlaMutex mutex;
+        LinkedList<Lib*> libs;
+
+        Bucket() noexcept
+            : mutex(),
+              libs() {}
+
+        CARLA_DECLARE_NON_COPY_STRUCT(Bucket)
+    };
+
+    Bucket fBuckets[kBucketCount];
+
+    CarlaMutex fPrewarmMutex;
+    LinkedList<lib_t> fPrewarmed;
+
+    static void getKey(const char* const filename, Key& key) noexcept
+    {
+        key.device = 0;
+        key.inode  = 0;
+        key.hash   = 5381;
+
+#ifndef CARLA_OS_WIN
+        struct stat st;
+
+        if (::stat(filename, &st) == 0 && st.st_ino != 0)
+        {
+            key.device = static_cast<uint64_t>(st.st_dev);
+            key.inode  = static_cast<uint64_t>(st.st_ino);
+            key.hash   = static_cast<uint>((key.inode * 31) ^ key.device);
+            return;
+        }
+#endif
+
+        for (const char* c = filename; *c != '\0'; ++c)
+            key.hash = key.hash * 33 + static_cast<uchar>(*c);
+    }
+
+    void release(Bucket& bucket, Lib* const lib) noexcept
+    {
+        {
+            const CarlaMutexLocker cml(bucket.mutex);
+
+            if (--lib->count > 0)
+                return;
+
+            bucket.libs.removeOne(lib);
+        }
+
+        closeLib(lib);
+    }
+
+    static bool closeLib(Lib* const lib) noexcept
+    {
+        bool ret = true;
+
+        if (lib->getLib() != nullptr && ! lib_close(lib->getLib()))
+        {
+            carla_stderr("LibCounter::close() failed, reason:\n%s", lib_error(lib->filename));
+            ret = false;
+        }
+
+        delete lib;
+        return ret;
+    }
+
+    CARLA_DECLARE_NON_COPY_CLASS(LibCounter)
 };
 
 // -----------------------------------------------------------------------
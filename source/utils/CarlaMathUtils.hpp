@@ -23,6 +23,10 @@
 #include <cmath>
 #include <limits>
 
+#ifdef __SSE2__
+# include <xmmintrin.h>
+#endif
+
 // --------------------------------------------------------------------------------------------------------------------
 // math functions (base)
 
@@ -200,6 +204,104 @@ void carla_zeroFloats(float floats[], const std::size_t count) noexcept
     std::memset(floats, 0, count*sizeof(float));
 }
 
+// --------------------------------------------------------------------------------------------------------------------
+// floating point environment
+
+/*
+ * Flush denormals to zero in the current thread, returning the previous floating point control state.
+ * Sets FTZ and DAZ on x86 with SSE2, FZ on ARM. Does nothing and returns 0 on other architectures.
+ */
+static inline
+uintptr_t carla_enableDenormalsFlush() noexcept
+{
+#if defined(__SSE2__)
+    const uint oldState = _mm_getcsr();
+    const uint newState = oldState | 0x8040; // FTZ | DAZ
+
+    if (newState != oldState)
+        _mm_setcsr(newState);
+
+    return oldState;
+#elif defined(__aarch64__)
+    uint64_t oldState;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r" (oldState));
+    const uint64_t newState = oldState | (1ULL << 24); // FZ
+
+    if (newState != oldState)
+        __asm__ __volatile__("msr fpcr, %0" : : "r" (newState));
+
+    return static_cast<uintptr_t>(oldState);
+#elif defined(__arm__) && ! defined(__SOFTFP__)
+    uint32_t oldState;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r" (oldState));
+    const uint32_t newState = oldState | (1U << 24); // FZ
+
+    if (newState != oldState)
+        __asm__ __volatile__("vmsr fpscr, %0" : : "r" (newState));
+
+    return oldState;
+#else
+    return 0;
+#endif
+}
+
+/*
+ * Restore the denormal flags of a floating point control state returned by carla_enableDenormalsFlush().
+ * Other bits, like exception flags raised meanwhile, are kept.
+ */
+static inline
+void carla_restoreDenormalsFlush(const uintptr_t oldState) noexcept
+{
+#if defined(__SSE2__)
+    const uint curState = _mm_getcsr();
+    const uint newState = (curState & ~0x8040U) | (static_cast<uint>(oldState) & 0x8040U);
+
+    if (newState != curState)
+        _mm_setcsr(newState);
+#elif defined(__aarch64__)
+    uint64_t curState;
+    __asm__ __volatile__("mrs %0, fpcr" : "=r" (curState));
+    const uint64_t newState = (curState & ~(1ULL << 24)) | (static_cast<uint64_t>(oldState) & (1ULL << 24));
+
+    if (newState != curState)
+        __asm__ __volatile__("msr fpcr, %0" : : "r" (newState));
+#elif defined(__arm__) && ! defined(__SOFTFP__)
+    uint32_t curState;
+    __asm__ __volatile__("vmrs %0, fpscr" : "=r" (curState));
+    const uint32_t newState = (curState & ~(1U << 24)) | (static_cast<uint32_t>(oldState) & (1U << 24));
+
+    if (newState != curState)
+        __asm__ __volatile__("vmsr fpscr, %0" : : "r" (newState));
+#else
+    // unused
+    (void)oldState;
+#endif
+}
+
+/*
+ * Flush denormals to zero in the current thread while in scope, if enabled.
+ */
+class CarlaScopedDenormalsFlush
+{
+public:
+    CarlaScopedDenormalsFlush(const bool enabled) noexcept
+        : fEnabled(enabled),
+          fOldState(enabled ? carla_enableDenormalsFlush() : 0) {}
+
+    ~CarlaScopedDenormalsFlush() noexcept
+    {
+        if (fEnabled)
+            carla_restoreDenormalsFlush(fOldState);
+    }
+
+private:
+    const bool      fEnabled;
+    const uintptr_t fOldState;
+
+    CARLA_PREVENT_HEAP_ALLOCATION
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaScopedDenormalsFlush)
+};
+
 // --------------------------------------------------------------------------------------------------------------------
 // Missing functions in OSX.
 
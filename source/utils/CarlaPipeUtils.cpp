@@ -1352,7 +1352,7 @@ bool CarlaPipeServer::startPipeServer(const char* const filename, const char* co
     {
         pData->pipeRecv = pipeRecvClient;
         pData->pipeSend = pipeSendClient;
-        carla_stdout("ALL OK!");
+        carla_debug("CarlaPipeServer::startPipeServer() - ok");
         return true;
     }
 
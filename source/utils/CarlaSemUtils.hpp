@@ -145,6 +145,44 @@ bool carla_sem_timedwait(carla_sem_t& sem, const uint secs) noexcept
 #endif
 }
 
+/*
+ * Wait for a semaphore (lock), with a timeout in milliseconds.
+ */
+static inline
+bool carla_sem_timedwait_ms(carla_sem_t& sem, const uint msecs) noexcept
+{
+    CARLA_SAFE_ASSERT_RETURN(msecs > 0, false);
+
+#if defined(CARLA_OS_WIN)
+    return (::WaitForSingleObject(sem.handle, msecs) == WAIT_OBJECT_0);
+#elif defined(CARLA_OS_MAC)
+    // TODO
+    return false;
+#else
+    timespec timeout;
+# ifdef CARLA_OS_LINUX
+    ::clock_gettime(CLOCK_REALTIME, &timeout);
+# else
+    timeval now;
+    ::gettimeofday(&now, nullptr);
+    timeout.tv_sec  = now.tv_sec;
+    timeout.tv_nsec = now.tv_usec * 1000;
+# endif
+    timeout.tv_sec  += static_cast<time_t>(msecs / 1000);
+    timeout.tv_nsec += static_cast<long>(msecs % 1000) * 1000000L;
+
+    if (timeout.tv_nsec >= 1000000000L)
+    {
+        timeout.tv_sec  += 1;
+        timeout.tv_nsec -= 1000000000L;
+    }
+
+    try {
+        return (::sem_timedwait(&sem.sem, &timeout) == 0);
+    } CARLA_SAFE_EXCEPTION_RETURN("sem_timedwait", false);
+#endif
+}
+
 // -----------------------------------------------------------------------
 
 #endif // CARLA_SEM_UTILS_HPP_INCLUDED
@@ -0,0 +1,164 @@
+/*
+ * Carla Server utils
+ * Copyright (C) 2011-2014 Filipe Coelho <falktx@falktx.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License, or any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * For a full copy of the GNU General Public License see the doc/GPL.txt file.
+ */
+
+#ifndef CARLA_SERVER_UTILS_HPP_INCLUDED
+#define CARLA_SERVER_UTILS_HPP_INCLUDED
+
+#include "CarlaUtils.hpp"
+
+// -----------------------------------------------------------------------
+// carla-server control protocol
+//
+// Every message is a 12 byte header followed by its payload:
+//   uint/size, ushort/opcode, ushort/flags (unused, must be 0), uint/requestId
+// All values are little-endian, floats are IEEE-754 and strings are uint/size followed by the characters (not null terminated).
+//
+// Clients can send many requests without waiting for replies, the server handles them in order and
+// replies to each one with kCarlaServerReplyOk or kCarlaServerReplyError, using the same request id.
+// Events are only sent to clients that subscribed to them, always with a request id of 0.
+//
+// TCP clients must authenticate first, with a kCarlaServerRequestHello carrying the token the server writes
+// to its token file (only readable by the server user) when listening on TCP.
+// Any other request, a wrong token or a message bigger than kCarlaServerMaxHelloSize before that is
+// replied with kCarlaServerReplyError and the connection is closed, as is not authenticating within kCarlaServerHelloTimeout.
+// UNIX socket clients are already restricted by the socket permissions, their token is ignored.
+
+#define CARLA_SERVER_PROTOCOL_VERSION 2
+
+static const uint32_t kCarlaServerHeaderSize     = 12;
+static const uint32_t kCarlaServerMaxPayloadSize = 16*1024*1024;
+static const uint32_t kCarlaServerMaxHelloSize   = 1024;
+static const uint32_t kCarlaServerHelloTimeout   = 5000; // ms
+
+// Client sends these to server, reply data is shown after "->"
+enum CarlaServerRequestOpcode {
+    kCarlaServerRequestNull = 0,
+    kCarlaServerRequestHello,              // uint/version, uint/size, str[] (token) -> uint/version
+    kCarlaServerRequestPing,
+    kCarlaServerRequestEngineInfo,         // -> uint/size, str[] (driver), uint/bufferSize, double/sampleRate, uint/pluginCount, uint/maxPluginCount, byte/running, uint/size, str[] (telemetry filename)
+    kCarlaServerRequestSessionInfo,        // uint/flags -> uint/count, count * session plugin (see below)
+    kCarlaServerRequestAddPlugin,          // uint/btype, uint/ptype, uint/size, str[] (filename), uint/size, str[] (name), uint/size, str[] (label), long/uniqueId, uint/options -> uint/pluginId
+    kCarlaServerRequestRemovePlugin,       // uint/pluginId
+    kCarlaServerRequestRemoveAllPlugins,
+    kCarlaServerRequestRenamePlugin,       // uint/pluginId, uint/size, str[] (name) -> uint/size, str[] (final name)
+    kCarlaServerRequestSetParameterValues, // uint/count, count * (uint/pluginId, int/parameterId, float/value) -> uint/applied
+    kCarlaServerRequestSetProgram,         // uint/pluginId, uint/programId
+    kCarlaServerRequestSetMidiProgram,     // uint/pluginId, uint/midiProgramId
+    kCarlaServerRequestSendMidiNote,       // uint/pluginId, byte/channel, byte/note, byte/velocity
+    kCarlaServerRequestPatchbayConnect,    // uint/groupA, uint/portA, uint/groupB, uint/portB
+    kCarlaServerRequestPatchbayDisconnect, // uint/connectionId
+    kCarlaServerRequestPatchbayRefresh,    // byte/external
+    kCarlaServerRequestTransportPlay,
+    kCarlaServerRequestTransportPause,
+    kCarlaServerRequestTransportRelocate,  // ulong/frame
+    kCarlaServerRequestLoadProject,        // uint/size, str[] (filename)
+    kCarlaServerRequestSaveProject,        // uint/size, str[] (filename)
+    kCarlaServerRequestSubscribe           // uint/mask, uint/interval (ms)
+};
+
+// Server sends these to clients, as replies or events
+enum CarlaServerReplyOpcode {
+    kCarlaServerReplyNull = 0,
+    kCarlaServerReplyOk,                 // request specific data
+    kCarlaServerReplyError,              // uint/size, str[] (error)
+    kCarlaServerEventCallback,           // uint/action, uint/pluginId, int/value1, int/value2, float/value3, uint/size, str[] (valueStr)
+    kCarlaServerEventParameterValues,    // uint/count, count * (uint/pluginId, uint/parameterId, float/value)
+    kCarlaServerEventTelemetry           // ulong/transport frame, uint/count, count * (uint/states, float/inPeakL, float/inPeakR, float/outPeakL, float/outPeakR)
+};
+
+// Session info flags.
+// Each plugin is sent as:
+//  uint/pluginId, uint/type, uint/category, uint/hints, uint/optionsEnabled, long/uniqueId,
+//  uint/size, str[] (name), uint/size, str[] (label), uint/size, str[] (maker), uint/size, str[] (filename),
+//  uint/audioIns, uint/audioOuts, uint/midiIns, uint/midiOuts, byte/active,
+//  float/dryWet, float/volume, float/balanceLeft, float/balanceRight, float/panning, int/ctrlChannel,
+//  int/currentProgram, int/currentMidiProgram, uint/parameterCount, parameterCount * session parameter
+// Each parameter is sent as:
+//  [kCarlaServerSessionParameterInfo] uint/type, uint/hints, uint/size, str[] (name), uint/size, str[] (symbol), uint/size, str[] (unit),
+//                                     float/default, float/minimum, float/maximum
+//  [kCarlaServerSessionParameterValues] float/value
+static const uint32_t kCarlaServerSessionParameterInfo   = 0x1;
+static const uint32_t kCarlaServerSessionParameterValues = 0x2;
+
+// Subscription mask bits.
+// Engine callbacks caused by a request are always sent before its reply.
+// Parameter changes are coalesced and sent at the fastest interval among subscribed clients,
+// telemetry is sent at each client's own interval.
+static const uint32_t kCarlaServerSubscribeCallbacks  = 0x1; // engine callbacks, like plugins being added or removed
+static const uint32_t kCarlaServerSubscribeParameters = 0x2; // parameter value changes, batched
+static const uint32_t kCarlaServerSubscribeTelemetry  = 0x4; // plugin peaks and run states
+
+// -----------------------------------------------------------------------
+
+static inline
+const char* CarlaServerRequestOpcode2str(const CarlaServerRequestOpcode opcode) noexcept
+{
+    switch (opcode)
+    {
+    case kCarlaServerRequestNull:
+        return "kCarlaServerRequestNull";
+    case kCarlaServerRequestHello:
+        return "kCarlaServerRequestHello";
+    case kCarlaServerRequestPing:
+        return "kCarlaServerRequestPing";
+    case kCarlaServerRequestEngineInfo:
+        return "kCarlaServerRequestEngineInfo";
+    case kCarlaServerRequestSessionInfo:
+        return "kCarlaServerRequestSessionInfo";
+    case kCarlaServerRequestAddPlugin:
+        return "kCarlaServerRequestAddPlugin";
+    case kCarlaServerRequestRemovePlugin:
+        return "kCarlaServerRequestRemovePlugin";
+    case kCarlaServerRequestRemoveAllPlugins:
+        return "kCarlaServerRequestRemoveAllPlugins";
+    case kCarlaServerRequestRenamePlugin:
+        return "kCarlaServerRequestRenamePlugin";
+    case kCarlaServerRequestSetParameterValues:
+        return "kCarlaServerRequestSetParameterValues";
+    case kCarlaServerRequestSetProgram:
+        return "kCarlaServerRequestSetProgram";
+    case kCarlaServerRequestSetMidiProgram:
+        return "kCarlaServerRequestSetMidiProgram";
+    case kCarlaServerRequestSendMidiNote:
+        return "kCarlaServerRequestSendMidiNote";
+    case kCarlaServerRequestPatchbayConnect:
+        return "kCarlaServerRequestPatchbayConnect";
+    case kCarlaServerRequestPatchbayDisconnect:
+        return "kCarlaServerRequestPatchbayDisconnect";
+    case kCarlaServerRequestPatchbayRefresh:
+        return "kCarlaServerRequestPatchbayRefresh";
+    case kCarlaServerRequestTransportPlay:
+        return "kCarlaServerRequestTransportPlay";
+    case kCarlaServerRequestTransportPause:
+        return "kCarlaServerRequestTransportPause";
+    case kCarlaServerRequestTransportRelocate:
+        return "kCarlaServerRequestTransportRelocate";
+    case kCarlaServerRequestLoadProject:
+        return "kCarlaServerRequestLoadProject";
+    case kCarlaServerRequestSaveProject:
+        return "kCarlaServerRequestSaveProject";
+    case kCarlaServerRequestSubscribe:
+        return "kCarlaServerRequestSubscribe";
+    }
+
+    carla_stderr("CarlaBackend::CarlaServerRequestOpcode2str(%i) - invalid opcode", opcode);
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------
+
+#endif // CARLA_SERVER_UTILS_HPP_INCLUDED
@@ -18,13 +18,28 @@
 #include "CarlaStateUtils.hpp"
 
 #include "CarlaBackendUtils.hpp"
+#include "CarlaBase64Utils.hpp"
 #include "CarlaMathUtils.hpp"
 #include "CarlaMIDI.h"
 
 #include <string>
 
+using juce::ByteOrder;
+using juce::File;
+using juce::FileInputStream;
+using juce::FileOutputStream;
+using juce::GZIPCompressorOutputStream;
+using juce::GZIPDecompressorInputStream;
+using juce::MemoryBlock;
+using juce::MemoryInputStream;
+using juce::MemoryMappedFile;
 using juce::MemoryOutputStream;
+using juce::OutputStream;
+using juce::OwnedArray;
+using juce::ScopedPointer;
 using juce::String;
+using juce::TemporaryFile;
+using juce::XmlDocument;
 using juce::XmlElement;
 
 CARLA_BACKEND_START_NAMESPACE
@@ -32,15 +47,14 @@ CARLA_BACKEND_START_NAMESPACE
 // -----------------------------------------------------------------------
 // getNewLineSplittedString
 
-static void getNewLineSplittedString(MemoryOutputStream& stream, const String& string)
+static void getNewLineSplittedString(MemoryOutputStream& stream, const char* const raw)
 {
-    static const int kLineWidth = 120;
+    static const std::size_t kLineWidth = 120;
 
-    int i = 0;
-    const int length = string.length();
-    const char* const raw = string.toUTF8();
+    std::size_t i = 0;
+    const std::size_t length = std::strlen(raw);
 
-    stream.preallocate(static_cast<std::size_t>(length + length/kLineWidth + 3));
+    stream.preallocate(stream.getDataSize() + length + length/kLineWidth + 3);
 
     for (; i+kLineWidth < length; i += kLineWidth)
     {
@@ -48,7 +62,7 @@ static void getNewLineSplittedString(MemoryOutputStream& stream, const String& s
         stream.writeByte('\n');
     }
 
-    stream << (raw+i);
+    stream.write(raw+i, length-i);
 }
 
 // -----------------------------------------------------------------------
@@ -200,6 +214,9 @@ CarlaStateSave::CarlaStateSave() noexcept
       currentMidiBank(-1),
       currentMidiProgram(-1),
       chunk(nullptr),
+      chunkData(nullptr),
+      chunkDataSize(0),
+      chunkDataStorage(),
       parameters(),
       customData() {}
 
@@ -241,6 +258,10 @@ void CarlaStateSave::clear() noexcept
         chunk = nullptr;
     }
 
+    chunkData     = nullptr;
+    chunkDataSize = 0;
+    chunkDataStorage.reset();
+
     uniqueId = 0;
     options  = 0x0;
 
@@ -277,7 +298,7 @@ void CarlaStateSave::clear() noexcept
 // -----------------------------------------------------------------------
 // fillFromXmlElement
 
-bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
+bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement, CarlaStateChunkStore* const chunkStore)
 {
     CARLA_SAFE_ASSERT_RETURN(xmlElement != nullptr, false);
 
@@ -480,6 +501,15 @@ bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
                 {
                     chunk = carla_strdup(text.toRawUTF8());
                 }
+                else if (tag.equalsIgnoreCase("chunkref"))
+                {
+                    CARLA_SAFE_ASSERT_CONTINUE(chunkStore != nullptr);
+
+                    const int index(text.getIntValue());
+                    CARLA_SAFE_ASSERT_CONTINUE(index >= 0);
+
+                    chunkData = chunkStore->getChunk(static_cast<uint>(index), chunkDataSize);
+                }
             }
         }
     }
@@ -490,7 +520,7 @@ bool CarlaStateSave::fillFromXmlElement(const XmlElement* const xmlElement)
 // -----------------------------------------------------------------------
 // fillXmlStringFromStateSave
 
-void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
+void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content, CarlaStateChunkStore* const chunkStore) const
 {
     {
         MemoryOutputStream infoXml;
@@ -662,21 +692,514 @@ void CarlaStateSave::dumpToMemoryStream(MemoryOutputStream& content) const
         content << customDataXml;
     }
 
-    if (chunk != nullptr && chunk[0] != '\0')
+    if (chunkStore != nullptr && (chunkData != nullptr || (chunk != nullptr && chunk[0] != '\0')))
     {
-        MemoryOutputStream chunkXml, chunkSplt;
-        getNewLineSplittedString(chunkSplt, chunk);
+        uint index;
 
-        chunkXml << "\n   <Chunk>\n";
-        chunkXml << chunkSplt;
-        chunkXml << "\n   </Chunk>\n";
+        if (chunkData != nullptr)
+        {
+            index = chunkStore->addChunk(chunkData, chunkDataSize);
+        }
+        else
+        {
+            const std::vector<uint8_t> data(carla_getChunkFromBase64String(chunk));
+            index = chunkStore->addChunk(data.data(), data.size());
+        }
 
-        content << chunkXml;
+        content << "\n   <ChunkRef>" << static_cast<int>(index) << "</ChunkRef>\n";
+    }
+    else if (chunk != nullptr && chunk[0] != '\0')
+    {
+        // chunks can be huge, write them directly without extra copies
+        content << "\n   <Chunk>\n";
+        getNewLineSplittedString(content, chunk);
+        content << "\n   </Chunk>\n";
+    }
+    else if (chunkData != nullptr)
+    {
+        content << "\n   <Chunk>\n";
+        getNewLineSplittedString(content, CarlaString::asBase64(chunkData, chunkDataSize));
+        content << "\n   </Chunk>\n";
     }
 
     content << "  </Data>\n";
 }
 
+// -----------------------------------------------------------------------
+// CarlaStateChunkStore
+
+/* Binary project layout, all values are little-endian:
+ *   header:      magic (8 bytes), version (uint32), chunk count (uint32), XML index size (uint64)
+ *   chunk table: offset (uint64), stored size (uint64), size (uint64), flags (uint32), reserved (uint32)
+ *   XML index:   the usual project XML, with <ChunkRef> in place of <Chunk>
+ *   chunks:      raw or zlib-compressed data, each aligned to kBinaryProjectAlignment
+ */
+static const char        kBinaryProjectMagic[8] = { 'C', 'A', 'R', 'L', 'A', 'B', 'I', 'N' };
+static const uint        kBinaryProjectVersion  = 1;
+static const std::size_t kBinaryProjectHeaderSize     = 24;
+static const std::size_t kBinaryProjectTableEntrySize = 32;
+static const std::size_t kBinaryProjectAlignment      = 16;
+static const uint        kBinaryProjectChunkCompressed = 0x1;
+
+// limits for decompressed chunks, zlib can not go over ~1032:1 so anything bigger is a corrupt or hostile file
+static const uint64_t    kBinaryProjectMaxChunkSize        = 1024*1024*1024;
+static const uint64_t    kBinaryProjectMaxCompressionRatio = 1032;
+
+static std::size_t getBinaryProjectAlignedSize(const std::size_t size) noexcept
+{
+    return (size + kBinaryProjectAlignment - 1) & ~(kBinaryProjectAlignment - 1);
+}
+
+static bool isValidCompressedChunkSize(const uint64_t storedSize, const uint64_t dataSize) noexcept
+{
+    if (dataSize > kBinaryProjectMaxChunkSize)
+        return false;
+
+    // storedSize is checked against the file size first, so this can't overflow
+    return dataSize <= storedSize * kBinaryProjectMaxCompressionRatio;
+}
+
+static uint64_t getChunkHash(const void* const data, const std::size_t dataSize) noexcept
+{
+    // FNV-1a
+    const uint8_t* const bytes(static_cast<const uint8_t*>(data));
+    uint64_t hash = 14695981039346656037ULL;
+
+    for (std::size_t i=0; i < dataSize; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+
+    return hash;
+}
+
+static bool compressChunkData(const void* const data, const std::size_t dataSize, MemoryBlock& compressedData)
+{
+    {
+        MemoryOutputStream outStream(compressedData, false);
+        GZIPCompressorOutputStream gzStream(&outStream);
+        gzStream.write(data, dataSize);
+        gzStream.flush();
+    }
+
+    // not worth it
+    if (compressedData.getSize() >= dataSize)
+    {
+        compressedData.reset();
+        return false;
+    }
+
+    return true;
+}
+
+struct CarlaStateChunkStore::Chunk {
+    uint64_t    hash;
+    const void* data;
+    std::size_t dataSize;
+    const void* storedData; // data as stored in file, only used while compressed
+    std::size_t storedSize;
+    bool        compressed;
+    MemoryBlock ownedData;
+    MemoryBlock compressedData; // compressed when added, used for writing
+
+    Chunk() noexcept
+        : hash(0),
+          data(nullptr),
+          dataSize(0),
+          storedData(nullptr),
+          storedSize(0),
+          compressed(false),
+          ownedData(),
+          compressedData() {}
+
+    CARLA_DECLARE_NON_COPY_STRUCT(Chunk)
+};
+
+CarlaStateChunkStore::CarlaStateChunkStore(const bool compressChunks) noexcept
+    : fCompressChunks(compressChunks),
+      fChunks(),
+      fMappedFile(),
+      fMutex() {}
+
+CarlaStateChunkStore::~CarlaStateChunkStore() noexcept
+{
+    clear();
+}
+
+void CarlaStateChunkStore::clear() noexcept
+{
+    const CarlaMutexLocker cml(fMutex);
+
+    fChunks.clear();
+    fMappedFile = nullptr;
+}
+
+uint CarlaStateChunkStore::addChunk(const void* const data, const std::size_t dataSize)
+{
+    CARLA_SAFE_ASSERT_RETURN(data != nullptr || dataSize == 0, 0);
+
+    const uint64_t hash(getChunkHash(data, dataSize));
+
+    {
+        const CarlaMutexLocker cml(fMutex);
+
+        const int index(findChunk(hash, data, dataSize));
+
+        if (index >= 0)
+            return static_cast<uint>(index);
+    }
+
+    // copy and compress without the lock, other threads might be adding their own chunks
+    ScopedPointer<Chunk> chunk(new Chunk());
+    chunk->hash = hash;
+    chunk->ownedData.replaceWith(data, dataSize);
+    chunk->data     = chunk->ownedData.getData();
+    chunk->dataSize = dataSize;
+
+    if (fCompressChunks && dataSize > 0)
+        compressChunkData(data, dataSize, chunk->compressedData);
+
+    const CarlaMutexLocker cml(fMutex);
+
+    // the same chunk might have been added meanwhile
+    const int index(findChunk(hash, data, dataSize));
+
+    if (index >= 0)
+        return static_cast<uint>(index);
+
+    fChunks.add(chunk.release());
+    return static_cast<uint>(fChunks.size()-1);
+}
+
+int CarlaStateChunkStore::findChunk(const uint64_t hash, const void* const data, const std::size_t dataSize) const noexcept
+{
+    for (int i=0, count=fChunks.size(); i < count; ++i)
+    {
+        const Chunk* const chunk(fChunks.getUnchecked(i));
+
+        if (chunk->hash == hash && chunk->dataSize == dataSize && std::memcmp(chunk->data, data, dataSize) == 0)
+            return i;
+    }
+
+    return -1;
+}
+
+const void* CarlaStateChunkStore::getChunk(const uint index, std::size_t& dataSize)
+{
+    dataSize = 0;
+
+    const CarlaMutexLocker cml(fMutex);
+
+    CARLA_SAFE_ASSERT_RETURN(index < static_cast<uint>(fChunks.size()), nullptr);
+
+    Chunk* const chunk(fChunks.getUnchecked(static_cast<int>(index)));
+
+    if (chunk->compressed)
+    {
+        CARLA_SAFE_ASSERT_RETURN(isValidCompressedChunkSize(chunk->storedSize, chunk->dataSize), nullptr);
+
+        MemoryInputStream inStream(chunk->storedData, chunk->storedSize, false);
+        GZIPDecompressorInputStream gzStream(inStream);
+
+        chunk->ownedData.setSize(chunk->dataSize);
+
+        for (std::size_t done=0; done < chunk->dataSize;)
+        {
+            const std::size_t toRead(std::min<std::size_t>(chunk->dataSize-done, 0x40000000));
+            const int ret(gzStream.read(static_cast<char*>(chunk->ownedData.getData())+done, static_cast<int>(toRead)));
+
+            if (ret <= 0)
+            {
+                carla_stderr2("CarlaStateChunkStore::getChunk(%u) - failed to decompress chunk", index);
+                chunk->ownedData.reset();
+                return nullptr;
+            }
+
+            done += static_cast<std::size_t>(ret);
+        }
+
+        chunk->data       = chunk->ownedData.getData();
+        chunk->compressed = false;
+    }
+
+    dataSize = chunk->dataSize;
+    return chunk->data;
+}
+
+bool CarlaStateChunkStore::writeToStream(OutputStream& stream, const String& xmlIndex, const bool compress) const
+{
+    const CarlaMutexLocker cml(fMutex);
+
+    const int numChunks(fChunks.size());
+
+    // compress first, final sizes are needed for the chunk table
+    OwnedArray<MemoryBlock> newCompressedChunks;
+    juce::Array<const MemoryBlock*> compressedChunks;
+
+    for (int i=0; i < numChunks; ++i)
+    {
+        const Chunk* const chunk(fChunks.getUnchecked(i));
+
+        if (chunk->compressedData.getSize() > 0)
+        {
+            compressedChunks.add(&chunk->compressedData);
+        }
+        else if (compress && chunk->dataSize > 0)
+        {
+            MemoryBlock* const compressedChunk(newCompressedChunks.add(new MemoryBlock()));
+
+            compressedChunks.add(compressChunkData(chunk->data, chunk->dataSize, *compressedChunk) ? compressedChunk : nullptr);
+        }
+        else
+        {
+            compressedChunks.add(nullptr);
+        }
+    }
+
+    const std::size_t indexSize(xmlIndex.getNumBytesAsUTF8());
+    const std::size_t dataStart(getBinaryProjectAlignedSize(kBinaryProjectHeaderSize
+                                                            + kBinaryProjectTableEntrySize*static_cast<std::size_t>(numChunks)
+                                                            + indexSize));
+
+    bool ok = stream.write(kBinaryProjectMagic, sizeof(kBinaryProjectMagic));
+    ok = ok && stream.writeInt(static_cast<int>(kBinaryProjectVersion));
+    ok = ok && stream.writeInt(numChunks);
+    ok = ok && stream.writeInt64(static_cast<juce::int64>(indexSize));
+
+    // chunk table
+    std::size_t offset = dataStart;
+
+    for (int i=0; ok && i < numChunks; ++i)
+    {
+        const Chunk* const chunk(fChunks.getUnchecked(i));
+        const MemoryBlock* const compressedChunk(compressedChunks.getUnchecked(i));
+        const std::size_t storedSize(compressedChunk != nullptr ? compressedChunk->getSize() : chunk->dataSize);
+
+        ok = ok && stream.writeInt64(static_cast<juce::int64>(offset));
+        ok = ok && stream.writeInt64(static_cast<juce::int64>(storedSize));
+        ok = ok && stream.writeInt64(static_cast<juce::int64>(chunk->dataSize));
+        ok = ok && stream.writeInt(static_cast<int>(compressedChunk != nullptr ? kBinaryProjectChunkCompressed : 0x0));
+        ok = ok && stream.writeInt(0);
+
+        offset = getBinaryProjectAlignedSize(offset + storedSize);
+    }
+
+    // XML index
+    ok = ok && stream.write(xmlIndex.toRawUTF8(), indexSize);
+
+    std::size_t written = kBinaryProjectHeaderSize + kBinaryProjectTableEntrySize*static_cast<std::size_t>(numChunks) + indexSize;
+
+    // chunks
+    for (int i=0; ok && i < numChunks; ++i)
+    {
+        const Chunk* const chunk(fChunks.getUnchecked(i));
+        const MemoryBlock* const compressedChunk(compressedChunks.getUnchecked(i));
+
+        if (const std::size_t padding = getBinaryProjectAlignedSize(written) - written)
+            ok = ok && stream.writeRepeatedByte(0, padding);
+
+        written = getBinaryProjectAlignedSize(written);
+
+        if (compressedChunk != nullptr)
+        {
+            ok = ok && stream.write(compressedChunk->getData(), compressedChunk->getSize());
+            written += compressedChunk->getSize();
+        }
+        else if (chunk->dataSize > 0)
+        {
+            ok = ok && stream.write(chunk->data, chunk->dataSize);
+            written += chunk->dataSize;
+        }
+    }
+
+    return ok;
+}
+
+bool CarlaStateChunkStore::openFile(const File& file, String& xmlIndex)
+{
+    clear();
+
+    const CarlaMutexLocker cml(fMutex);
+
+    fMappedFile = new MemoryMappedFile(file, MemoryMappedFile::readOnly);
+
+    const uint8_t* const fileData(static_cast<const uint8_t*>(fMappedFile->getData()));
+    const std::size_t    fileSize(fMappedFile->getSize());
+
+    CARLA_SAFE_ASSERT_RETURN(fileData != nullptr && fileSize >= kBinaryProjectHeaderSize, false);
+    CARLA_SAFE_ASSERT_RETURN(std::memcmp(fileData, kBinaryProjectMagic, sizeof(kBinaryProjectMagic)) == 0, false);
+
+    const uint version(ByteOrder::littleEndianInt(fileData+8));
+
+    if (version != kBinaryProjectVersion)
+    {
+        carla_stderr2("CarlaStateChunkStore::openFile() - unsupported binary project version %u", version);
+        return false;
+    }
+
+    const std::size_t numChunks(ByteOrder::littleEndianInt(fileData+12));
+    const uint64_t    indexSize(ByteOrder::littleEndianInt64(fileData+16));
+    const std::size_t indexStart(kBinaryProjectHeaderSize + kBinaryProjectTableEntrySize*numChunks);
+
+    CARLA_SAFE_ASSERT_RETURN(indexStart <= fileSize, false);
+    CARLA_SAFE_ASSERT_RETURN(indexSize <= fileSize - indexStart, false);
+
+    OwnedArray<Chunk> chunks;
+    chunks.ensureStorageAllocated(static_cast<int>(numChunks));
+
+    for (std::size_t i=0; i < numChunks; ++i)
+    {
+        const uint8_t* const entry(fileData + kBinaryProjectHeaderSize + kBinaryProjectTableEntrySize*i);
+
+        const uint64_t offset(ByteOrder::littleEndianInt64(entry));
+        const uint64_t storedSize(ByteOrder::littleEndianInt64(entry+8));
+        const uint64_t dataSize(ByteOrder::littleEndianInt64(entry+16));
+        const uint     flags(ByteOrder::littleEndianInt(entry+24));
+
+        CARLA_SAFE_ASSERT_RETURN(offset <= fileSize && storedSize <= fileSize - offset, false);
+
+        if ((flags & kBinaryProjectChunkCompressed) != 0 && ! isValidCompressedChunkSize(storedSize, dataSize))
+        {
+            carla_stderr2("CarlaStateChunkStore::openFile() - chunk " P_SIZE " has an invalid size " P_UINT64 " (stored as " P_UINT64 ")",
+                          i, dataSize, storedSize);
+            return false;
+        }
+
+        Chunk* const chunk(new Chunk());
+        chunk->storedData = fileData + offset;
+        chunk->storedSize = static_cast<std::size_t>(storedSize);
+        chunk->dataSize   = static_cast<std::size_t>(dataSize);
+        chunk->compressed = (flags & kBinaryProjectChunkCompressed) != 0;
+
+        if (! chunk->compressed)
+        {
+            CARLA_SAFE_ASSERT_INT2(storedSize == dataSize, storedSize, dataSize);
+            chunk->data     = chunk->storedData;
+            chunk->dataSize = chunk->storedSize;
+        }
+
+        chunks.add(chunk);
+    }
+
+    xmlIndex = String::fromUTF8(reinterpret_cast<const char*>(fileData + indexStart), static_cast<int>(indexSize));
+    fChunks.swapWith(chunks);
+    return true;
+}
+
+bool CarlaStateChunkStore::isBinaryProjectFile(const File& file)
+{
+    FileInputStream inStream(file);
+
+    if (inStream.failedToOpen())
+        return false;
+
+    char magic[sizeof(kBinaryProjectMagic)];
+
+    if (inStream.read(magic, sizeof(magic)) != sizeof(magic))
+        return false;
+
+    return std::memcmp(magic, kBinaryProjectMagic, sizeof(magic)) == 0;
+}
+
+// -----------------------------------------------------------------------
+// carla_convertProject
+
+static bool replaceProjectChunks(XmlElement* const xmlElement, CarlaStateChunkStore& chunkStore, const bool toBinary)
+{
+    XmlElement* nextElem;
+
+    for (XmlElement* elem = xmlElement->getFirstChildElement(); elem != nullptr; elem = nextElem)
+    {
+        // elem might get replaced below
+        nextElem = elem->getNextElement();
+
+        const String& tag(elem->getTagName());
+
+        if (toBinary && tag.equalsIgnoreCase("chunk"))
+        {
+            const std::vector<uint8_t> data(carla_getChunkFromBase64String(elem->getAllSubText().trim().toRawUTF8()));
+            const uint index(chunkStore.addChunk(data.data(), data.size()));
+
+            XmlElement* const newElem(new XmlElement("ChunkRef"));
+            newElem->addTextElement(String(index));
+            xmlElement->replaceChildElement(elem, newElem);
+        }
+        else if (! toBinary && tag.equalsIgnoreCase("chunkref"))
+        {
+            const int index(elem->getAllSubText().trim().getIntValue());
+            CARLA_SAFE_ASSERT_RETURN(index >= 0, false);
+
+            std::size_t dataSize;
+            const void* const data(chunkStore.getChunk(static_cast<uint>(index), dataSize));
+
+            // a missing chunk would silently become an empty one
+            if (data == nullptr && dataSize == 0)
+            {
+                carla_stderr2("carla_convertProjectToXml() - invalid chunk reference %i", index);
+                return false;
+            }
+
+            XmlElement* const newElem(new XmlElement("Chunk"));
+            newElem->addTextElement(CarlaString::asBase64(data, dataSize).buffer());
+            xmlElement->replaceChildElement(elem, newElem);
+        }
+        else if (! replaceProjectChunks(elem, chunkStore, toBinary))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool carla_convertProjectToBinary(const File& xmlFile, const File& binaryFile, const bool compress)
+{
+    XmlDocument xmlDoc(xmlFile);
+    ScopedPointer<XmlElement> xmlElement(xmlDoc.getDocumentElement(false));
+    CARLA_SAFE_ASSERT_RETURN(xmlElement != nullptr, false);
+
+    CarlaStateChunkStore chunkStore;
+
+    if (! replaceProjectChunks(xmlElement, chunkStore, true))
+        return false;
+
+    const String xmlIndex(xmlElement->createDocument("<!DOCTYPE " + xmlElement->getTagName() + ">"));
+
+    TemporaryFile tempFile(binaryFile, TemporaryFile::useHiddenFile);
+
+    {
+        FileOutputStream outStream(tempFile.getFile());
+        CARLA_SAFE_ASSERT_RETURN(! outStream.failedToOpen(), false);
+
+        if (! chunkStore.writeToStream(outStream, xmlIndex, compress))
+            return false;
+
+        outStream.flush();
+        CARLA_SAFE_ASSERT_RETURN(outStream.getStatus().wasOk(), false);
+    }
+
+    return tempFile.overwriteTargetFileWithTemporary();
+}
+
+bool carla_convertProjectToXml(const File& binaryFile, const File& xmlFile)
+{
+    CarlaStateChunkStore chunkStore;
+    String xmlIndex;
+
+    if (! chunkStore.openFile(binaryFile, xmlIndex))
+        return false;
+
+    XmlDocument xmlDoc(xmlIndex);
+    ScopedPointer<XmlElement> xmlElement(xmlDoc.getDocumentElement(false));
+    CARLA_SAFE_ASSERT_RETURN(xmlElement != nullptr, false);
+
+    if (! replaceProjectChunks(xmlElement, chunkStore, false))
+        return false;
+
+    return xmlElement->writeToFile(xmlFile, "<!DOCTYPE " + xmlElement->getTagName() + ">");
+}
+
 // -----------------------------------------------------------------------
 
 CARLA_BACKEND_END_NAMESPACE
@@ -19,12 +19,15 @@
 #define CARLA_STATE_UTILS_HPP_INCLUDED
 
 #include "CarlaBackend.h"
+#include "CarlaMutex.hpp"
 #include "LinkedList.hpp"
 
 #include "juce_core.h"
 
 CARLA_BACKEND_START_NAMESPACE
 
+class CarlaStateChunkStore;
+
 // -----------------------------------------------------------------------
 
 struct CarlaStateSave {
@@ -86,6 +89,13 @@ struct CarlaStateSave {
     int32_t     currentMidiProgram;
     const char* chunk;
 
+    // raw chunk data, used instead of 'chunk' if set.
+    // when coming from a binary project it is not owned and valid for as long as the store it came from,
+    // when copied from a plugin for saving it points to 'chunkDataStorage'.
+    const void* chunkData;
+    std::size_t chunkDataSize;
+    juce::MemoryBlock chunkDataStorage;
+
     ParameterList parameters;
     CustomDataList customData;
 
@@ -93,8 +103,8 @@ struct CarlaStateSave {
     ~CarlaStateSave() noexcept;
     void clear() noexcept;
 
-    bool fillFromXmlElement(const juce::XmlElement* const xmlElement);
-    void dumpToMemoryStream(juce::MemoryOutputStream& stream) const;
+    bool fillFromXmlElement(const juce::XmlElement* const xmlElement, CarlaStateChunkStore* const chunkStore = nullptr);
+    void dumpToMemoryStream(juce::MemoryOutputStream& stream, CarlaStateChunkStore* const chunkStore = nullptr) const;
 
     CARLA_DECLARE_NON_COPY_STRUCT(CarlaStateSave)
 };
@@ -123,6 +133,78 @@ juce::String xmlSafeString(const juce::String& string, const bool toXml)
 
 // -----------------------------------------------------------------------
 
+/*!
+ * Out-of-line chunk storage for binary projects (carxb).
+ *
+ * A binary project is a small header and chunk table, followed by the usual XML project (without any chunk data inside)
+ * and then the raw chunks. Inside the XML each chunk is replaced by a <ChunkRef> with its index in the table.
+ * Chunks are deduplicated by content, so plugins with identical state share the same data.
+ *
+ * When loading, the file is memory-mapped and uncompressed chunks are given to plugins directly from the mapping.
+ */
+class CarlaStateChunkStore
+{
+public:
+    /*!
+     * If @a compressChunks is true, chunks are compressed as they are added (when that makes them smaller),
+     * so it happens in the threads calling addChunk() instead of while writing.
+     */
+    CarlaStateChunkStore(const bool compressChunks = false) noexcept;
+    ~CarlaStateChunkStore() noexcept;
+
+    void clear() noexcept;
+
+    /*!
+     * Add a chunk to the store, returning its index.
+     * If an identical chunk already exists, its index is returned instead.
+     * @note Can be called from several threads at once, compression does not block other threads.
+     */
+    uint addChunk(const void* const data, const std::size_t dataSize);
+
+    /*!
+     * Get a chunk by its index.
+     * Compressed chunks are decompressed on first access.
+     */
+    const void* getChunk(const uint index, std::size_t& dataSize);
+
+    /*!
+     * Write a binary project, using @a xmlIndex as the XML part.
+     * If @a compress is true, chunks not compressed yet are stored compressed when that makes them smaller.
+     */
+    bool writeToStream(juce::OutputStream& stream, const juce::String& xmlIndex, const bool compress) const;
+
+    /*!
+     * Open a binary project, returning its XML part in @a xmlIndex.
+     */
+    bool openFile(const juce::File& file, juce::String& xmlIndex);
+
+    /*!
+     * Check if a file is a binary project, by looking at its header.
+     */
+    static bool isBinaryProjectFile(const juce::File& file);
+
+private:
+    struct Chunk;
+
+    const bool fCompressChunks;
+    juce::OwnedArray<Chunk> fChunks;
+    juce::ScopedPointer<juce::MemoryMappedFile> fMappedFile;
+    mutable CarlaMutex fMutex;
+
+    // must be called with the mutex locked
+    int findChunk(const uint64_t hash, const void* const data, const std::size_t dataSize) const noexcept;
+
+    CARLA_DECLARE_NON_COPY_CLASS(CarlaStateChunkStore)
+};
+
+/*!
+ * Convert a XML project or preset into the binary format, and back.
+ */
+bool carla_convertProjectToBinary(const juce::File& xmlFile, const juce::File& binaryFile, const bool compress);
+bool carla_convertProjectToXml(const juce::File& binaryFile, const juce::File& xmlFile);
+
+// -----------------------------------------------------------------------
+
 CARLA_BACKEND_END_NAMESPACE
 
 #endif // CARLA_STATE_UTILS_HPP_INCLUDED
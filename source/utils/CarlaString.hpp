@@ -585,67 +585,50 @@ public:
             "abcdefghijklmnopqrstuvwxyz"
             "0123456789+/";
 
-        const std::size_t kTmpBufSize = carla_nextPowerOf2(static_cast<uint32_t>(dataSize/3));
+        CarlaString ret;
 
-        const uchar* bytesToEncode((const uchar*)data);
+        if (data == nullptr || dataSize == 0)
+            return ret;
 
-        uint i=0, j=0;
-        uint charArray3[3], charArray4[4];
+        // encoded size is known in advance, allocate it only once
+        const std::size_t retLen = ((dataSize + 2) / 3) * 4;
+        char* const retBuf = (char*)std::malloc(retLen+1);
+        CARLA_SAFE_ASSERT_RETURN(retBuf != nullptr, ret);
 
-        char strBuf[kTmpBufSize+1];
-        strBuf[kTmpBufSize] = '\0';
-        std::size_t strBufIndex = 0;
+        const uchar* const bytesToEncode((const uchar*)data);
 
-        CarlaString ret;
+        std::size_t s=0, r=0;
 
-        for (std::size_t s=0; s<dataSize; ++s)
+        for (; s+2 < dataSize; s += 3)
         {
-            charArray3[i++] = *(bytesToEncode++);
-
-            if (i == 3)
-            {
-                charArray4[0] =  (charArray3[0] & 0xfc) >> 2;
-                charArray4[1] = ((charArray3[0] & 0x03) << 4) + ((charArray3[1] & 0xf0) >> 4);
-                charArray4[2] = ((charArray3[1] & 0x0f) << 2) + ((charArray3[2] & 0xc0) >> 6);
-                charArray4[3] =   charArray3[2] & 0x3f;
-
-                for (i=0; i<4; ++i)
-                    strBuf[strBufIndex++] = kBase64Chars[charArray4[i]];
-
-                if (strBufIndex >= kTmpBufSize-7)
-                {
-                    strBuf[strBufIndex] = '\0';
-                    strBufIndex = 0;
-                    ret += strBuf;
-                }
-
-                i = 0;
-            }
+            const uint b0 = bytesToEncode[s];
+            const uint b1 = bytesToEncode[s+1];
+            const uint b2 = bytesToEncode[s+2];
+
+            retBuf[r++] = kBase64Chars[  (b0 & 0xfc) >> 2];
+            retBuf[r++] = kBase64Chars[((b0 & 0x03) << 4) + ((b1 & 0xf0) >> 4)];
+            retBuf[r++] = kBase64Chars[((b1 & 0x0f) << 2) + ((b2 & 0xc0) >> 6)];
+            retBuf[r++] = kBase64Chars[  b2 & 0x3f];
         }
 
-        if (i != 0)
+        if (s < dataSize)
         {
-            for (j=i; j<3; ++j)
-              charArray3[j] = '\0';
-
-            charArray4[0] =  (charArray3[0] & 0xfc) >> 2;
-            charArray4[1] = ((charArray3[0] & 0x03) << 4) + ((charArray3[1] & 0xf0) >> 4);
-            charArray4[2] = ((charArray3[1] & 0x0f) << 2) + ((charArray3[2] & 0xc0) >> 6);
-            charArray4[3] =   charArray3[2] & 0x3f;
+            const bool hasTwo = (s+1 < dataSize);
 
-            for (j=0; j<4 && i<3 && j<i+1; ++j)
-                strBuf[strBufIndex++] = kBase64Chars[charArray4[j]];
+            const uint b0 = bytesToEncode[s];
+            const uint b1 = hasTwo ? bytesToEncode[s+1] : 0;
 
-            for (; i++ < 3;)
-                strBuf[strBufIndex++] = '=';
+            retBuf[r++] = kBase64Chars[  (b0 & 0xfc) >> 2];
+            retBuf[r++] = kBase64Chars[((b0 & 0x03) << 4) + ((b1 & 0xf0) >> 4)];
+            retBuf[r++] = hasTwo ? kBase64Chars[(b1 & 0x0f) << 2] : '=';
+            retBuf[r++] = '=';
         }
 
-        if (strBufIndex != 0)
-        {
-            strBuf[strBufIndex] = '\0';
-            ret += strBuf;
-        }
+        CARLA_SAFE_ASSERT(r == retLen);
+        retBuf[r] = '\0';
 
+        ret.fBuffer    = retBuf;
+        ret.fBufferLen = r;
         return ret;
     }
 
@@ -25,6 +25,10 @@
 # include <sys/prctl.h>
 #endif
 
+#ifndef CARLA_OS_WIN
+# include <sys/mman.h>
+#endif
+
 // -----------------------------------------------------------------------
 // CarlaThread class
 
@@ -42,7 +46,9 @@ protected:
 #else
           fHandle(0),
 #endif
-          fShouldExit(false) {}
+          fShouldExit(false),
+          fRtPriority(0),
+          fAffinityMask(0) {}
 
     /*
      * Destructor.
@@ -104,9 +110,8 @@ public:
             CARLA_SAFE_ASSERT_RETURN(handle != 0, false);
 #endif
             pthread_detach(handle);
-            _copyFrom(handle);
 
-            // wait for thread to start
+            // wait for thread to start, it sets its own handle before reporting ready
             fLock.lock();
 
             return true;
@@ -206,11 +211,187 @@ public:
 
     // -------------------------------------------------------------------
 
+    /*
+     * Set the realtime priority and CPU affinity the thread will use once started.
+     * A priority of 0 keeps normal scheduling, an affinity mask of 0 keeps all CPUs.
+     * Realtime threads also get their stack pre-faulted before running.
+     *
+     * Only threads that do audio work for a realtime caller should use this, like plugin worker threads.
+     * Idle, save, log, UI and offline render threads keep normal scheduling on purpose, they must not
+     * compete with the audio thread. The bridge RT thread does not use it either, as it follows the
+     * scheduling of the host thread at runtime instead (see kPluginBridgeRtClientSetRealtime).
+     */
+    void setRealtimeOptions(const int priority, const uint64_t affinityMask = 0) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(priority >= 0,);
+        CARLA_SAFE_ASSERT(! isThreadRunning());
+
+        fRtPriority   = priority;
+        fAffinityMask = affinityMask;
+    }
+
+    /*
+     * Returns the realtime priority of the caller thread, or 0 if it is not realtime.
+     */
+    static int getCurrentThreadRealtimePriority() noexcept
+    {
+#ifdef CARLA_OS_WIN
+        return (GetThreadPriority(GetCurrentThread()) == THREAD_PRIORITY_TIME_CRITICAL) ? kWindowsRealtimePriority : 0;
+#else
+        int policy = 0;
+        struct sched_param param;
+        carla_zeroStruct(param);
+
+        if (pthread_getschedparam(pthread_self(), &policy, &param) != 0)
+            return 0;
+
+        return (policy == SCHED_FIFO || policy == SCHED_RR) ? param.sched_priority : 0;
+#endif
+    }
+
+    /*
+     * Changes the scheduling of the caller thread.
+     * A priority > 0 uses SCHED_FIFO, 0 goes back to normal scheduling.
+     */
+    static bool setCurrentThreadRealtimePriority(const int priority) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(priority >= 0, false);
+
+#ifdef CARLA_OS_WIN
+        return SetThreadPriority(GetCurrentThread(), (priority > 0) ? THREAD_PRIORITY_TIME_CRITICAL : THREAD_PRIORITY_NORMAL) != FALSE;
+#else
+        struct sched_param param;
+        carla_zeroStruct(param);
+
+        if (priority == 0)
+            return (pthread_setschedparam(pthread_self(), SCHED_OTHER, &param) == 0);
+
+        const int minPriority(sched_get_priority_min(SCHED_FIFO));
+        const int maxPriority(sched_get_priority_max(SCHED_FIFO));
+
+        param.sched_priority = (priority < minPriority) ? minPriority : ((priority > maxPriority) ? maxPriority : priority);
+
+        return (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0);
+#endif
+    }
+
+    /*
+     * Returns the CPU affinity of the caller thread (first 64 CPUs), or 0 if unknown.
+     */
+    static uint64_t getCurrentThreadAffinityMask() noexcept
+    {
+#ifdef CARLA_OS_LINUX
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+
+        if (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) != 0)
+            return 0;
+
+        uint64_t mask = 0;
+
+        for (uint i=0; i < 64; ++i)
+        {
+            if (CPU_ISSET(i, &cpuset))
+                mask |= static_cast<uint64_t>(1) << i;
+        }
+
+        return mask;
+#else
+        return 0;
+#endif
+    }
+
+    /*
+     * Restricts the caller thread to the CPUs in 'mask' (first 64 CPUs).
+     */
+    static bool setCurrentThreadAffinityMask(const uint64_t mask) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(mask != 0, false);
+
+#if defined(CARLA_OS_LINUX)
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+
+        for (uint i=0; i < 64; ++i)
+        {
+            if (mask & (static_cast<uint64_t>(1) << i))
+                CPU_SET(i, &cpuset);
+        }
+
+        return (pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpuset) == 0);
+#elif defined(CARLA_OS_WIN)
+        return (SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(mask)) != 0);
+#else
+        // not supported
+        return false;
+#endif
+    }
+
+    /*
+     * Lock a memory region into RAM and fault-in all of its pages, so realtime code can use it without page-faults.
+     * The lock is released automatically when the memory is unmapped.
+     */
+    static bool lockMemory(const void* const ptr, const std::size_t size) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(ptr != nullptr && size > 0, false);
+
+#ifdef CARLA_OS_WIN
+        const bool locked(VirtualLock(const_cast<void*>(ptr), size) != FALSE);
+#else
+        const bool locked(::mlock(ptr, size) == 0);
+#endif
+
+        // reading is enough to map each page, and works for read-only memory too
+        const volatile char* const bytes(static_cast<const volatile char*>(ptr));
+
+        for (std::size_t i=0; i < size; i += kPrefaultPageSize)
+            (void)bytes[i];
+
+        return locked;
+    }
+
+    /*
+     * Unlock a memory region previously locked with lockMemory().
+     */
+    static void unlockMemory(const void* const ptr, const std::size_t size) noexcept
+    {
+        CARLA_SAFE_ASSERT_RETURN(ptr != nullptr && size > 0,);
+
+#ifdef CARLA_OS_WIN
+        VirtualUnlock(const_cast<void*>(ptr), size);
+#else
+        ::munlock(ptr, size);
+#endif
+    }
+
+    /*
+     * Touch the next 'kPrefaultStackSize' bytes of the caller thread stack,
+     * so realtime code does not page-fault the first time it goes deep into it.
+     */
+    static void prefaultCurrentThreadStack() noexcept
+    {
+        char stack[kPrefaultStackSize];
+        volatile char* const bytes(stack);
+
+        for (std::size_t i=0; i < kPrefaultStackSize; i += kPrefaultPageSize)
+            bytes[i] = 0;
+    }
+
+    // -------------------------------------------------------------------
+
 private:
     CarlaMutex         fLock;       // Thread lock
     const CarlaString  fName;       // Thread name
     volatile pthread_t fHandle;     // Handle for this thread
     volatile bool      fShouldExit; // true if thread should exit
+    int                fRtPriority;   // Realtime priority, 0 for none
+    uint64_t           fAffinityMask; // CPU affinity, 0 for all
+
+    static const std::size_t kPrefaultPageSize  = 4096;
+    static const std::size_t kPrefaultStackSize = 64*1024;
+#ifdef CARLA_OS_WIN
+    static const int kWindowsRealtimePriority = 15;
+#endif
 
     /*
      * Init pthread type.
@@ -256,11 +437,25 @@ private:
      */
     void _runEntryPoint() noexcept
     {
+        // set handle here, as the thread might finish before pthread_create returns to the caller
+        _copyFrom(pthread_self());
+
         // report ready
         fLock.unlock();
 
         setCurrentThreadName(fName);
 
+        if (fRtPriority > 0)
+        {
+            if (! setCurrentThreadRealtimePriority(fRtPriority))
+                carla_stderr("CarlaThread '%s' failed to get realtime priority %i", fName.buffer(), fRtPriority);
+
+            prefaultCurrentThreadStack();
+        }
+
+        if (fAffinityMask != 0 && ! setCurrentThreadAffinityMask(fAffinityMask))
+            carla_stderr("CarlaThread '%s' failed to set CPU affinity", fName.buffer());
+
         try {
             run();
         } catch(...) {}